@@ -20,6 +20,9 @@ static bool g_enable_validation = true;
 static bool g_enable_validation = false;
 #endif
 
+// pipeline cache of skity is kept in working directory between runs
+static const char* g_pipeline_cache_file = "skity_vk_pipeline.cache";
+
 #ifdef ENABLE_VALIDATION
 
 static VkResult create_debug_utils_messenger_ext(
@@ -250,10 +253,26 @@ void VkApp::OnStart() {
 
 void VkApp::OnDestroy() { canvas_.reset(); }
 
+std::shared_ptr<skity::Data> VkApp::GetPipelineCacheData() {
+  return skity::Data::MakeFromFileName(g_pipeline_cache_file);
+}
+
+void VkApp::SavePipelineCacheData(std::shared_ptr<skity::Data> const& data) {
+  data->WriteToFile(g_pipeline_cache_file);
+}
+
 void VkApp::Loop() {
   while (!glfwWindowShouldClose(window_)) {
     glfwPollEvents();
 
+    // wait for the frame which used this slot last time, later frames keep
+    // running on gpu while this one is recorded
+    if (vkWaitForFences(vk_device_, 1, &cmd_fences_[frame_index_], VK_TRUE,
+                        std::numeric_limits<uint64_t>::max()) != VK_SUCCESS) {
+      spdlog::error("Error in wait fences");
+      break;
+    }
+
     VkResult result = vkAcquireNextImageKHR(
         vk_device_, vk_swap_chain_, std::numeric_limits<uint64_t>::max(),
         present_semaphore_[frame_index_], nullptr, &current_frame_);
@@ -326,12 +345,6 @@ void VkApp::Loop() {
       break;
     }
 
-    if (vkWaitForFences(vk_device_, 1, &cmd_fences_[frame_index_], VK_TRUE,
-                        std::numeric_limits<uint64_t>::max()) != VK_SUCCESS) {
-      spdlog::error("Error in wait fences");
-      break;
-    }
-
     VkPresentInfoKHR present_info{VK_STRUCTURE_TYPE_PRESENT_INFO_KHR};
     present_info.swapchainCount = 1;
     present_info.pSwapchains = &vk_swap_chain_;
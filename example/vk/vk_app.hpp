@@ -64,6 +64,10 @@ class VkApp : public skity::GPUVkContext {
     return vk_surface_transform_;
   }
 
+  std::shared_ptr<skity::Data> GetPipelineCacheData() override;
+
+  void SavePipelineCacheData(std::shared_ptr<skity::Data> const& data) override;
+
  protected:
   virtual void OnStart();
   virtual void OnUpdate(float elapsed_time) {}
@@ -23,6 +23,18 @@ class SK_API MaskFilter {
 
   float blurRadius() const { return radius_; }
 
+  /**
+   * Resolution scale the blur is allowed to be computed at.
+   *
+   * Large normal blur is applied on content downsampled by a power of two,
+   * so the kernel never exceeds 8 pixels in the reduced space and the cost
+   * per pixel does not grow with radius. The result is upsampled with
+   * bilinear filter. Other styles need the sharp source and always return 1.
+   *
+   * @return scale in (0, 1]
+   */
+  float blurScale() const { return scale_; }
+
   /**
    * @brief
    *
@@ -44,6 +56,7 @@ class SK_API MaskFilter {
  private:
   BlurStyle style_ = {};
   float radius_ = {};
+  float scale_ = 1.f;
 };
 
 }  // namespace skity
@@ -55,8 +55,26 @@ class SK_API Shader {
 
   virtual GradientType asGradient(GradientInfo* info) const;
 
+  /**
+   * How pixels of an image shader are sampled when the image is scaled.
+   */
+  enum class SamplingMode {
+    // nearest pixel, keeps hard edges of pixel art
+    kNearest,
+    // bilinear filter of the full size image
+    kLinear,
+    // filter between prefiltered smaller copies of the image, for images drawn
+    // much smaller than their size, like thumbnails
+    kMipmap,
+  };
+
   virtual std::shared_ptr<Pixmap> asImage() const;
 
+  /**
+   * @return sampling mode of image shader, kLinear for other shaders
+   */
+  virtual SamplingMode GetSamplingMode() const;
+
   /**
    * Returns a shader that generates a linear gradient between the two specified
    * points.
@@ -101,9 +119,14 @@ class SK_API Shader {
    * Return a shader that fill color with pixel content
    *
    * @param pixmap
+   * @param sampling  how pixels are filtered when the image is scaled, GPU
+   *                  backends build mip levels at upload for kMipmap. Raster
+   *                  backend samples kMipmap like kLinear
    * @return std::shared_ptr<Shader>
    */
-  static std::shared_ptr<Shader> MakeShader(std::shared_ptr<Pixmap> pixmap);
+  static std::shared_ptr<Shader> MakeShader(
+      std::shared_ptr<Pixmap> pixmap,
+      SamplingMode sampling = SamplingMode::kLinear);
 
  private:
   Matrix local_matrix_ = glm::identity<Matrix>();
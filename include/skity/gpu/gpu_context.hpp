@@ -1,6 +1,7 @@
 #ifndef SKITY_GPU_GPU_CONTEXT_HPP
 #define SKITY_GPU_GPU_CONTEXT_HPP
 
+#include <cstdint>
 #include <skity/config.hpp>
 
 namespace skity {
@@ -34,6 +35,15 @@ struct GPUContext {
    */
   void* proc_loader = nullptr;
 
+  /**
+   * Sample count of multisample attachments used by offscreen passes like
+   * mask filter, **0** or **1** disables multisample. It is clamped to the
+   * limit of device, and ignored by backends without multisample offscreen
+   * passes.
+   *
+   */
+  uint32_t offscreen_sample_count = 4;
+
   GPUContext(GPUBackendType type, void* proc_loader)
       : type(type), proc_loader(proc_loader) {}
 };
@@ -8,6 +8,9 @@
 
 #include <vulkan/vulkan.h>
 
+#include <memory>
+#include <skity/io/data.hpp>
+
 namespace skity {
 
 /**
@@ -93,6 +96,10 @@ struct GPUVkContext : public GPUContext {
   /**
    * @brief Get the Current Buffer Index number
    *
+   * Skity keeps per frame resources for each index and reuses them once the
+   * index is current again, the caller must make sure the frame previously
+   * submitted with this index is finished on GPU before that.
+   *
    * @return uint32_t
    */
   virtual uint32_t GetCurrentBufferIndex() = 0;
@@ -150,6 +157,27 @@ struct GPUVkContext : public GPUContext {
    * @return VkSurfaceTransformFlagBitsKHR
    */
   virtual VkSurfaceTransformFlagBitsKHR GetSurfaceTransform() = 0;
+
+  /**
+   * @brief Get the serialized pipeline cache saved by a previous run.
+   * @note  Pipelines are created through a VkPipelineCache initialized with
+   *        this data, so a warm cache skips most of the shader compilation at
+   *        startup. Data created by another driver or device is ignored by
+   *        Vulkan. The default implementation starts with an empty cache.
+   *
+   * @return std::shared_ptr<Data> or nullptr
+   */
+  virtual std::shared_ptr<Data> GetPipelineCacheData() { return nullptr; }
+
+  /**
+   * @brief Called with the serialized pipeline cache after new pipelines are
+   *        created, at the end of a frame or when the canvas is destroyed.
+   *        Write it to disk and return it in `GetPipelineCacheData` on the
+   *        next start to persist the cache.
+   *
+   * @param data serialized VkPipelineCache
+   */
+  virtual void SavePipelineCacheData(std::shared_ptr<Data> const& data) {}
 };
 
 }  // namespace skity
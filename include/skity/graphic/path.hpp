@@ -478,9 +478,32 @@ class SK_API Path {
   Path copyWithScale(float scale) const;
 
   void setConvexityType(ConvexityType type) { convexity_ = type; }
-  ConvexityType getConvexityType() const { return convexity_; }
+
+  /**
+   * Returns convexity set by setConvexityType. If it is unknown, convexity is
+   * computed from the points and cached until Path is edited. Only a single
+   * contour turning in one direction without self intersection is convex.
+   *
+   * @return ConvexityType::kConvex or ConvexityType::kConcave
+   */
+  ConvexityType getConvexityType() const;
+
+  /**
+   * Returns a non-zero id identifying the geometry of this Path. Copies share
+   * the same id until one of them is edited, every edit gives the Path a new
+   * id. FillType is not part of the geometry and does not change the id.
+   *
+   * @return generation id of current verbs, points and conic weights
+   */
+  uint32_t getGenerationID() const;
 
  private:
+  // called on every edit, also drops cached convexity
+  void dirtyGenerationID() {
+    generation_id_ = 0;
+    convexity_ = ConvexityType::kUnknown;
+  }
+  ConvexityType computeConvexity() const;
   void injectMoveToIfNeed();
   void computeBounds() const;
   inline const Point& atPoint(int32_t index) const { return points_[index]; }
@@ -495,7 +518,7 @@ class SK_API Path {
   friend class PathStroker;
 
   int32_t last_move_to_index_ = ~0;
-  ConvexityType convexity_ = ConvexityType::kUnknown;
+  mutable ConvexityType convexity_ = ConvexityType::kUnknown;
   mutable Direction first_direction_ = Direction::kCCW;
 
   std::vector<Point> points_;
@@ -504,6 +527,8 @@ class SK_API Path {
   mutable bool is_finite_ = true;
   mutable Rect bounds_;
   PathFillType fill_type_ = PathFillType::kWinding;
+  // 0 means not assigned yet, see getGenerationID()
+  mutable uint32_t generation_id_ = 0;
 };
 
 }  // namespace skity
@@ -58,13 +58,19 @@ class SK_API Data final {
   static std::shared_ptr<Data> MakeWithCString(const char cstr[]);
 
   /**
-   * Create a new dataref from a pointer allocated by malloc. The Data object
-   * takes ownership of that allocation, and will handling calling free.
+   * Create a new dataref with the content of a file. By default the file is
+   * read into memory with a single read.
    *
    * @param path
-   * @return std::shared_ptr<Data>
+   * @param map_file  if true and the platform supports it, the file is mapped
+   *                  read only into memory instead of being read, pages are
+   *                  loaded on demand and shared with other processes mapping
+   *                  the same file. The file must not be modified while the
+   *                  Data is alive. Falls back to read if mapping fails
+   * @return          empty Data if the file can not be opened
    */
-  static std::shared_ptr<Data> MakeFromFileName(const char path[]);
+  static std::shared_ptr<Data> MakeFromFileName(const char path[],
+                                                bool map_file = false);
 
   /**
    * Create a new dataref, taking the ptr as is, and using the
@@ -14,7 +14,7 @@ class Data;
  */
 class SK_API Pixmap final {
  public:
-  Pixmap() : data_(), pixels_(nullptr), row_bytes_(0), width_(0), height_(0) {}
+  Pixmap();
   Pixmap(std::shared_ptr<Data> data, size_t rowBytes, uint32_t width,
          uint32_t height);
   ~Pixmap() = default;
@@ -30,6 +30,15 @@ class SK_API Pixmap final {
   uint32_t Width() const { return width_; }
   uint32_t Height() const { return height_; }
 
+  /**
+   * Identify pixel content of this pixmap, gpu canvas keys its texture cache
+   * with it. Pixels are immutable so copies may share the id, a new id is
+   * assigned by constructors and Reset.
+   *
+   * @return non zero id unique in current process
+   */
+  uint32_t UniqueID() const { return unique_id_; }
+
  private:
   // hold this to make sure data not release
   std::shared_ptr<Data> data_;
@@ -37,6 +46,7 @@ class SK_API Pixmap final {
   size_t row_bytes_;
   uint32_t width_;
   uint32_t height_;
+  uint32_t unique_id_;
 };
 
 }  // namespace skity
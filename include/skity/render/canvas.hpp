@@ -22,6 +22,37 @@ class GPUContext;
  */
 class SK_API Canvas {
  public:
+  /**
+   * Counters of the image texture cache of GPU backends, all zero for other
+   * backends.
+   */
+  struct ImageCacheStats {
+    // queries served by a cached texture
+    size_t hit_count = 0;
+    // queries which uploaded a new texture
+    size_t miss_count = 0;
+    // bytes of all cached textures
+    size_t byte_size = 0;
+    // textures released by budget, purge or dead images
+    size_t evict_count = 0;
+  };
+
+  /**
+   * Glyph atlas usage of the last flushed frame, summed over the glyph atlas
+   * of every typeface. All zero for backends without glyph atlas.
+   */
+  struct GlyphAtlasStats {
+    uint32_t page_count = 0;
+    uint32_t glyph_count = 0;
+    // allocated pixels / atlas pixels
+    float occupancy = 0.f;
+    uint32_t upload_count = 0;
+    size_t upload_bytes = 0;
+    uint32_t evicted_pages = 0;
+    // glyphs which could not get an atlas region and were drawn as path
+    uint32_t failed_glyphs = 0;
+  };
+
   Canvas();
   virtual ~Canvas();
 
@@ -187,6 +218,26 @@ class SK_API Canvas {
    */
   void flush();
 
+  /**
+   * @brief Set max bytes of image textures kept by GPU backends. Once over
+   *        budget, textures least recently used are released in flush. Images
+   *        drawn in last few frames are always kept since GPU may still read
+   *        them.
+   *
+   * @param bytes budget in bytes
+   */
+  void setImageCacheLimit(size_t bytes);
+
+  /**
+   * @brief Release cached GPU resources not used in last few frames, like
+   *        image textures and offscreen render targets.
+   */
+  void purgeUnusedResources();
+
+  ImageCacheStats getImageCacheStats() const;
+
+  GlyphAtlasStats getGlyphAtlasStats() const;
+
   /**
    * @brief Set the Default Typeface object
    *        If no Typeface is profide by Paint, then the default Typeface is
@@ -295,6 +346,15 @@ class SK_API Canvas {
   virtual bool needGlyphPath(Paint const& paint);
 
   virtual void onUpdateViewport(uint32_t width, uint32_t height) = 0;
+
+  // default implement does nothing
+  virtual void onSetImageCacheLimit(size_t bytes);
+  // default implement does nothing
+  virtual void onPurgeUnusedResources();
+  // default implement returns empty stats
+  virtual ImageCacheStats onGetImageCacheStats() const;
+  // default implement returns empty stats
+  virtual GlyphAtlasStats onGetGlyphAtlasStats() const;
   inline bool isDrawDebugLine() const { return draw_debug_line_; }
 
  private:
@@ -1,6 +1,9 @@
 #ifndef SKITY_CODEC_CODEC_HPP
 #define SKITY_CODEC_CODEC_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <skity/codec/config.hpp>
 #include <skity/macros.hpp>
@@ -16,11 +19,53 @@ class Pixmap;
  */
 class SK_API Codec {
  public:
+  enum {
+    // rows passed to each DecodeRows callback, the last strip may be shorter
+    STRIP_ROWS = 16,
+  };
+
+  /**
+   * Receive a strip of decoded RGBA rows.
+   *
+   * @param rows       first pixel of the strip, only valid during the call
+   * @param row_bytes  distance in bytes between two rows of the strip
+   * @param y          index of the first row of the strip in the image
+   * @param count      number of rows in the strip
+   * @return           false to stop decoding
+   */
+  using RowCallback = std::function<bool(const void* rows, size_t row_bytes,
+                                         uint32_t y, uint32_t count)>;
+
   Codec() = default;
   virtual ~Codec() = default;
 
   virtual std::shared_ptr<Pixmap> Decode() = 0;
 
+  /**
+   * Read image size from the header of data without decoding pixels.
+   */
+  virtual bool GetImageSize(uint32_t* width, uint32_t* height) = 0;
+
+  /**
+   * Decode RGBA pixels straight into memory owned by the caller, like a
+   * Bitmap or a mapped staging buffer.
+   *
+   * @param dst        at least row_bytes * height bytes
+   * @param row_bytes  distance in bytes between two rows in dst, at least
+   *                   width * 4
+   * @return           false if decode fails
+   */
+  virtual bool DecodeInto(void* dst, size_t row_bytes) = 0;
+
+  /**
+   * Decode image from top to bottom in strips of STRIP_ROWS rows, so only a
+   * strip is kept in memory. Default implement decodes the whole image first
+   * for codecs which can not decode incrementally.
+   *
+   * @return false if decode fails or callback stops it
+   */
+  virtual bool DecodeRows(RowCallback const& callback);
+
   virtual std::shared_ptr<Data> Encode(const Pixmap* pixmap) = 0;
 
   virtual bool RecognizeFileType(const char* header, size_t size) = 0;
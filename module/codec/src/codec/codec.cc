@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <skity/codec/codec.hpp>
 #include <skity/io/data.hpp>
 #include <vector>
@@ -24,6 +25,29 @@ void Codec::SetupCodecs() {
 #endif  // SKITY_HAS_JPEG
 }
 
+bool Codec::DecodeRows(RowCallback const& callback) {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  if (!callback || !GetImageSize(&width, &height)) {
+    return false;
+  }
+
+  size_t row_bytes = static_cast<size_t>(width) * 4;
+  std::vector<uint8_t> pixels(row_bytes * height);
+  if (!DecodeInto(pixels.data(), row_bytes)) {
+    return false;
+  }
+
+  for (uint32_t y = 0; y < height; y += STRIP_ROWS) {
+    uint32_t count = std::min<uint32_t>(STRIP_ROWS, height - y);
+    if (!callback(pixels.data() + y * row_bytes, row_bytes, y, count)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 std::shared_ptr<Codec> Codec::MakeFromData(const std::shared_ptr<Data>& data) {
   if (codec_list.empty()) {
     SetupCodecs();
@@ -2,6 +2,8 @@
 
 #include <turbojpeg.h>
 
+#include <cstdint>
+#include <cstdlib>
 #include <skity/io/data.hpp>
 #include <skity/io/pixmap.hpp>
 
@@ -41,41 +43,79 @@ bool JPEGCodec::RecognizeFileType(const char* header, size_t size) {
 }
 
 std::shared_ptr<Pixmap> JPEGCodec::Decode() {
+  uint32_t width = 0;
+  uint32_t height = 0;
+
+  if (!GetImageSize(&width, &height)) {
+    return nullptr;
+  }
+
+  size_t row_bytes = static_cast<size_t>(width) * tjPixelSize[TJPF_RGBA];
+  void* buffer = std::malloc(row_bytes * height);
+  if (!buffer) {
+    // out of memory
+    return nullptr;
+  }
+
+  // decode into the buffer Data takes over, no copy of pixels
+  if (!DecodeInto(buffer, row_bytes)) {
+    std::free(buffer);
+    return nullptr;
+  }
+
+  auto image_data = skity::Data::MakeFromMalloc(buffer, row_bytes * height);
+
+  return std::make_shared<Pixmap>(image_data, row_bytes, width, height);
+}
+
+bool JPEGCodec::GetImageSize(uint32_t* width, uint32_t* height) {
+  if (!data_) {
+    return false;
+  }
+
   TJHandlerWrapper hw{tjInitDecompress()};
 
   if (!hw.handle) {
     // JPEG init failed
-    return nullptr;
+    return false;
   }
 
-  int32_t width;
-  int32_t height;
+  int32_t w;
+  int32_t h;
 
   int ret = tjDecompressHeader(hw.handle, (unsigned char*)data_->RawData(),
-                               data_->Size(), &width, &height);
+                               data_->Size(), &w, &h);
 
-  if (ret != 0) {
-    char* err = tjGetErrorStr2(hw.handle);
-    return nullptr;
+  if (ret != 0 || w <= 0 || h <= 0) {
+    return false;
   }
 
-  uint8_t* buffer = (uint8_t*)tjAlloc(width * height * tjPixelSize[TJPF_RGBA]);
+  *width = static_cast<uint32_t>(w);
+  *height = static_cast<uint32_t>(h);
+  return true;
+}
 
-  ret = tjDecompress2(hw.handle, (const unsigned char*)data_->RawData(),
-                      data_->Size(), (unsigned char*)buffer, width, 0, height,
-                      TJPF_RGBA, 0);
-  if (ret != 0) {
-    tjFree(buffer);
-    char* err = tjGetErrorStr2(hw.handle);
-    return nullptr;
+bool JPEGCodec::DecodeInto(void* dst, size_t row_bytes) {
+  uint32_t width = 0;
+  uint32_t height = 0;
+
+  if (!dst || !GetImageSize(&width, &height) ||
+      row_bytes < width * tjPixelSize[TJPF_RGBA] || row_bytes > INT32_MAX) {
+    return false;
+  }
+
+  TJHandlerWrapper hw{tjInitDecompress()};
+
+  if (!hw.handle) {
+    // JPEG init failed
+    return false;
   }
 
-  auto image_data = skity::Data::MakeWithCopy(
-      buffer, width * height * tjPixelSize[TJPF_RGBA]);
+  int ret = tjDecompress2(hw.handle, (const unsigned char*)data_->RawData(),
+                          data_->Size(), (unsigned char*)dst, width,
+                          static_cast<int>(row_bytes), height, TJPF_RGBA, 0);
 
-  tjFree(buffer);
-  return std::make_shared<Pixmap>(image_data, width * tjPixelSize[TJPF_RGBA],
-                                  width, height);
+  return ret == 0;
 }
 
 std::shared_ptr<Data> JPEGCodec::Encode(const Pixmap* pixmap) {
@@ -14,6 +14,10 @@ class JPEGCodec : public Codec {
 
   std::shared_ptr<Pixmap> Decode() override;
 
+  bool GetImageSize(uint32_t* width, uint32_t* height) override;
+
+  bool DecodeInto(void* dst, size_t row_bytes) override;
+
   std::shared_ptr<Data> Encode(const Pixmap* pixmap) override;
 
   bool RecognizeFileType(const char* header, size_t size) override;
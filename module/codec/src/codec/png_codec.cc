@@ -1,5 +1,7 @@
 #include "src/codec/png_codec.hpp"
 
+#include <algorithm>
+#include <climits>
 #include <cstdlib>
 #include <cstring>
 #include <skity/io/data.hpp>
@@ -21,45 +23,197 @@ static void png_write_callback(png_structp png_ptr, png_bytep data,
   }
 }
 
+struct PNGMemoryReader {
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+  size_t offset = 0;
+};
+
+static void png_read_callback(png_structp png_ptr, png_bytep data,
+                              png_size_t length) {
+  auto reader = (PNGMemoryReader*)png_get_io_ptr(png_ptr);
+
+  if (reader->size - reader->offset < length) {
+    png_error(png_ptr, "read past the end of png data");
+  }
+
+  std::memcpy(data, reader->data + reader->offset, length);
+  reader->offset += length;
+}
+
+static void png_error_callback(png_structp png_ptr, png_const_charp) {
+  png_longjmp(png_ptr, 1);
+}
+
+static void png_warning_callback(png_structp, png_const_charp) {}
+
+// libpng reports errors by longjmp to the setjmp in this function, so it
+// creates nothing with a destructor, the strip buffer is owned by the caller
+static bool png_read_strips(png_structp png_ptr, png_infop info_ptr,
+                            std::vector<uint8_t>* strip,
+                            Codec::RowCallback const& callback) {
+  if (setjmp(png_jmpbuf(png_ptr))) {
+    return false;
+  }
+
+  png_read_info(png_ptr, info_ptr);
+
+  // same output as PNG_FORMAT_RGBA of the simplified api
+  png_set_expand(png_ptr);
+  png_set_scale_16(png_ptr);
+  png_set_gray_to_rgb(png_ptr);
+  png_set_add_alpha(png_ptr, 0xFF, PNG_FILLER_AFTER);
+  png_set_alpha_mode(png_ptr, PNG_ALPHA_PNG, PNG_GAMMA_sRGB);
+  // simplified api takes 16 bit images without color space info as linear
+  if (png_get_bit_depth(png_ptr, info_ptr) == 16 &&
+      !png_get_valid(png_ptr, info_ptr,
+                     PNG_INFO_gAMA | PNG_INFO_sRGB | PNG_INFO_iCCP)) {
+    png_set_gamma(png_ptr, PNG_GAMMA_sRGB, PNG_GAMMA_LINEAR);
+  }
+  int passes = png_set_interlace_handling(png_ptr);
+  png_read_update_info(png_ptr, info_ptr);
+
+  uint32_t height = png_get_image_height(png_ptr, info_ptr);
+  size_t row_bytes = png_get_rowbytes(png_ptr, info_ptr);
+
+  // rows of interlaced images are complete only after the last pass, so the
+  // whole image is kept
+  uint32_t strip_rows = passes > 1 ? height : Codec::STRIP_ROWS;
+  strip->resize(row_bytes * std::min(strip_rows, height));
+
+  for (uint32_t y = 0; y < height; y += strip_rows) {
+    uint32_t count = std::min(strip_rows, height - y);
+
+    for (int pass = 0; pass < passes; pass++) {
+      for (uint32_t i = 0; i < count; i++) {
+        png_read_row(png_ptr, strip->data() + i * row_bytes, nullptr);
+      }
+    }
+
+    for (uint32_t i = 0; i < count; i += Codec::STRIP_ROWS) {
+      uint32_t rows = std::min<uint32_t>(Codec::STRIP_ROWS, count - i);
+      if (!callback(strip->data() + i * row_bytes, row_bytes, y + i, rows)) {
+        return false;
+      }
+    }
+  }
+
+  png_read_end(png_ptr, nullptr);
+
+  return true;
+}
+
 PNGCodec::PNGCodec() = default;
 
 PNGCodec::~PNGCodec() { png_image_free(&image_); }
 
-std::shared_ptr<Pixmap> skity::PNGCodec::Decode() {
+bool PNGCodec::BeginRead() {
   if (image_.opaque) {
     png_image_free(&image_);
     image_.opaque = nullptr;
   }
+
+  if (!data_) {
+    return false;
+  }
+
+  image_ = {};
   image_.version = PNG_IMAGE_VERSION;
   if (!png_image_begin_read_from_memory(&image_, data_->RawData(),
                                         data_->Size())) {
-    return nullptr;
+    return false;
   }
 
-  png_bytep buffer;
   image_.format = PNG_FORMAT_RGBA;
-  size_t raw_data_size = PNG_IMAGE_SIZE(image_);
-  buffer = static_cast<png_bytep>(std::malloc(raw_data_size));
+  return true;
+}
+
+std::shared_ptr<Pixmap> skity::PNGCodec::Decode() {
+  uint32_t width = 0;
+  uint32_t height = 0;
+
+  if (!GetImageSize(&width, &height)) {
+    return nullptr;
+  }
+
+  size_t row_bytes = static_cast<size_t>(width) * 4;
+  void* buffer = std::malloc(row_bytes * height);
   if (!buffer) {
     // out of memory
-    png_image_free(&image_);
     return nullptr;
   }
 
-  if (!png_image_finish_read(&image_, nullptr, buffer, 0, nullptr)) {
+  if (!DecodeInto(buffer, row_bytes)) {
     std::free(buffer);
     return nullptr;
   }
 
-  auto raw_data = Data::MakeFromMalloc(buffer, raw_data_size);
-  uint32_t width = image_.width;
-  uint32_t height = image_.height;
+  auto raw_data = Data::MakeFromMalloc(buffer, row_bytes * height);
 
-  pixmap_ = std::make_shared<Pixmap>(raw_data, width * 4, width, height);
+  pixmap_ = std::make_shared<Pixmap>(raw_data, row_bytes, width, height);
 
   return pixmap_;
 }
 
+bool PNGCodec::GetImageSize(uint32_t* width, uint32_t* height) {
+  if (!BeginRead()) {
+    return false;
+  }
+
+  *width = image_.width;
+  *height = image_.height;
+
+  png_image_free(&image_);
+  return true;
+}
+
+bool PNGCodec::DecodeInto(void* dst, size_t row_bytes) {
+  if (!dst || !BeginRead()) {
+    return false;
+  }
+
+  // row stride of the simplified api counts components, which are bytes for
+  // 8 bit rgba
+  if (row_bytes < PNG_IMAGE_ROW_STRIDE(image_) || row_bytes > INT32_MAX) {
+    png_image_free(&image_);
+    return false;
+  }
+
+  return png_image_finish_read(&image_, nullptr, dst,
+                               static_cast<png_int_32>(row_bytes), nullptr);
+}
+
+bool PNGCodec::DecodeRows(RowCallback const& callback) {
+  if (!data_ || !callback) {
+    return false;
+  }
+
+  png_structp png_ptr =
+      png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr,
+                             png_error_callback, png_warning_callback);
+  if (!png_ptr) {
+    return false;
+  }
+
+  png_infop info_ptr = png_create_info_struct(png_ptr);
+  if (!info_ptr) {
+    png_destroy_read_struct(&png_ptr, nullptr, nullptr);
+    return false;
+  }
+
+  PNGMemoryReader reader{};
+  reader.data = data_->Bytes();
+  reader.size = data_->Size();
+  png_set_read_fn(png_ptr, &reader, png_read_callback);
+
+  std::vector<uint8_t> strip{};
+  bool result = png_read_strips(png_ptr, info_ptr, &strip, callback);
+
+  png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
+
+  return result;
+}
+
 struct PNGDestructor {
   png_structp p;
   explicit PNGDestructor(png_structp p) : p(p) {}
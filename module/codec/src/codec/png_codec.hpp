@@ -13,9 +13,16 @@ class PNGCodec : public Codec {
   PNGCodec();
   ~PNGCodec() override;
   std::shared_ptr<Pixmap> Decode() override;
+  bool GetImageSize(uint32_t* width, uint32_t* height) override;
+  bool DecodeInto(void* dst, size_t row_bytes) override;
+  bool DecodeRows(RowCallback const& callback) override;
   std::shared_ptr<Data> Encode(const Pixmap* pixmap) override;
   bool RecognizeFileType(const char* header, size_t size) override;
 
+ private:
+  // begin read of data_ with the simplified api, image_ holds the header
+  bool BeginRead();
+
  private:
   png_image image_ = {};
   std::shared_ptr<Pixmap> pixmap_ = {};
@@ -1,3 +1,4 @@
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <skity/codec/codec.hpp>
@@ -42,5 +43,27 @@ int main(int argc, const char** argv) {
     std::cout << "png image size = {" << pixmap->Width() << " , " << pixmap->Height() << "}" << std::endl;
   }
 
+  if (pixmap) {
+    size_t row_bytes = pixmap->Width() * 4;
+    std::vector<uint8_t> pixels(row_bytes * pixmap->Height());
+    uint32_t next_row = 0;
+    bool rows_ok = codec->DecodeRows(
+        [&](const void* rows, size_t rows_stride, uint32_t y, uint32_t count) {
+          for (uint32_t i = 0; i < count; i++) {
+            std::memcpy(pixels.data() + (y + i) * row_bytes,
+                        (const uint8_t*)rows + i * rows_stride, row_bytes);
+          }
+          next_row = y + count;
+          return true;
+        });
+
+    if (!rows_ok || next_row != pixmap->Height() ||
+        std::memcmp(pixels.data(), pixmap->Addr(), pixels.size()) != 0) {
+      std::cerr << "png decode rows mismatch" << std::endl;
+    } else {
+      std::cout << "png decode rows success" << std::endl;
+    }
+  }
+
   return 0;
 }
\ No newline at end of file
@@ -104,7 +104,8 @@ class SVGDomParser : public XMLParser {
 SVGDom::~SVGDom() = default;
 
 std::unique_ptr<SVGDom> SVGDom::MakeFromFile(const char *file) {
-  auto data = Data::MakeFromFileName(file);
+  // svg files are only parsed once, map them instead of copying
+  auto data = Data::MakeFromFileName(file, true);
   if (!data) {
     return nullptr;
   }
@@ -20,6 +20,8 @@
 #define VERTEX_TYPE_QUAD_IN 3
 #define VERTEX_TYPE_QUAD_OUT 4
 #define VERTEX_TYPE_TEXT 5
+#define VERTEX_TYPE_RRECT 1024
+#define VERTEX_RRECT_STEPS 1023.0
 
 // image texture
 uniform sampler2D UserTexture;
@@ -44,6 +46,9 @@ uniform vec4 GradientBounds;
 // gradient color and stops
 uniform vec4 GradientColors[MAX_COLORS];
 uniform float GradientStops[MAX_COLORS];
+// v coordinate of gradient row in UserTexture, negative if colors come from
+// GradientColors and GradientStops
+uniform float GradientRampRow;
 
 // [x, y]
 in vec2 fPos;
@@ -57,6 +62,13 @@ vec4 lerp_color(float current) {
     current = 1.0;
   }
 
+  if (GradientRampRow >= 0.0) {
+    // texel i holds color at i / (width - 1)
+    float width = float(textureSize(UserTexture, 0).x);
+    float u = (clamp(current, 0.0, 1.0) * (width - 1.0) + 0.5) / width;
+    return texture(UserTexture, vec2(u, GradientRampRow));
+  }
+
   int colorCount = GradientCounts[0];
   int stopCount = GradientCounts[1];
   int premulAlpha = 0;
@@ -168,25 +180,37 @@ float calculate_blur_norm() {
 }
 
 float calculate_blur_coffe(float norm, float step) {
-  // blur mode kernelSize is passed through StrokeWidth
+  // blur mode kernelSize is passed through StrokeWidth, in texels of the
+  // render target. PostProcessDraw::BlurKernelSize shrinks it for downsampled
+  // targets so the 2.0 offset does not grow with the downsample factor
   float sigma = StrokeWidth + 2.0;
   return norm * exp(-1.5 * step * step / (sigma * sigma));
 }
 
-vec4 calculate_blur(vec2 uv, vec2 dir, vec2 step_vec) {
+vec4 calculate_blur(vec2 uv, vec2 dir) {
+  // step one texel, content may be rendered at reduced resolution
+  vec2 step_vec = dir / vec2(textureSize(UserTexture, 0));
   float norm = calculate_blur_norm();
 
   float total = norm;
 
   vec4 acc = texture(UserTexture, uv) * norm;
 
+  // merge two adjacent taps into one bilinear fetch, placed between the two
+  // texels by their weights
   int kernel_size = int(StrokeWidth);
-  for (int i = 1; i <= kernel_size; i++) {
-    float coffe = calculate_blur_coffe(norm, float(i));
-    float f_i = float(i);
+  for (int i = 1; i <= kernel_size; i += 2) {
+    float c1 = calculate_blur_coffe(norm, float(i));
+    float c2 = 0.0;
+    if (i + 1 <= kernel_size) {
+      c2 = calculate_blur_coffe(norm, float(i + 1));
+    }
 
-    acc += texture(UserTexture, uv - f_i * step_vec * dir) * coffe;
-    acc += texture(UserTexture, uv + f_i * step_vec * dir) * coffe;
+    float coffe = c1 + c2;
+    float offset = (float(i) * c1 + float(i + 1) * c2) / coffe;
+
+    acc += texture(UserTexture, uv - offset * step_vec) * coffe;
+    acc += texture(UserTexture, uv + offset * step_vec) * coffe;
 
     total += 2.0 * coffe;
   }
@@ -196,19 +220,29 @@ vec4 calculate_blur(vec2 uv, vec2 dir, vec2 step_vec) {
 }
 
 vec4 calculate_vertical_blur(vec2 uv) {
-  vec2 step_vec = vec2(1.0 / (GradientBounds.z - GradientBounds.x),
-                       1.0 / (GradientBounds.w - GradientBounds.y));
-  vec2 dir = vec2(0.0, 1.0);
-
-  return calculate_blur(uv, dir, step_vec);
+  return calculate_blur(uv, vec2(0.0, 1.0));
 }
 
 vec4 calculate_horizontal_blur(vec2 uv) {
-  vec2 step_vec = vec2(1.0 / (GradientBounds.z - GradientBounds.x),
-                       1.0 / (GradientBounds.w - GradientBounds.y));
-  vec2 dir = vec2(1.0, 0.0);
+  return calculate_blur(uv, vec2(1.0, 0.0));
+}
+
+// coverage of analytic rrect, uv is position relative to corner arc center
+// in units of corner radii
+float calculate_rrect_coverage(vec3 info) {
+  float ratio =
+      (floor(info.x + 0.5) - float(VERTEX_TYPE_RRECT)) / VERTEX_RRECT_STEPS;
+
+  float d = length(info.yz);
+  float aa = max(fwidth(d), 0.0001);
+
+  float coverage = clamp((1.0 - d) / aa + 0.5, 0.0, 1.0);
+  if (ratio > 0.0) {
+    // inner edge of stroke
+    coverage *= clamp((d - ratio) / aa + 0.5, 0.0, 1.0);
+  }
 
-  return calculate_blur(uv, dir, step_vec);
+  return coverage;
 }
 
 vec4 calculate_solid_blur(vec2 uv) {
@@ -291,7 +325,10 @@ void main() {
     FragColor = vec4(g_color.xyz * g_color.w, g_color.w) * GlobalAlpha;
   }
 
-  if (vertex_type == VERTEX_TYPE_TEXT) {
+  // interpolated type may be truncated to one below by int()
+  if (vertex_type >= VERTEX_TYPE_RRECT - 1) {
+    FragColor = FragColor * calculate_rrect_coverage(fPosInfo);
+  } else if (vertex_type == VERTEX_TYPE_TEXT) {
     // TODO use other info to pass
     float r = texture(FontTexture, vec2(fPosInfo.y, fPosInfo.z)).r;
     FragColor = FragColor * r;
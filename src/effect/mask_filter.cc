@@ -1,14 +1,37 @@
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <skity/effect/mask_filter.hpp>
 
 namespace skity {
 
+enum {
+  // max blur radius in pixels of the downsampled content
+  MAX_BLUR_KERNEL = 8,
+  MAX_BLUR_DOWNSAMPLE_LEVEL = 5,
+};
+
+static float calculate_blur_scale(BlurStyle style, float radius) {
+  if (style != BlurStyle::kNormal || !(radius > MAX_BLUR_KERNEL)) {
+    return 1.f;
+  }
+
+  // radius in downsampled pixels falls into (MAX_BLUR_KERNEL / 2,
+  // MAX_BLUR_KERNEL]
+  int32_t level =
+      static_cast<int32_t>(std::ceil(std::log2(radius / MAX_BLUR_KERNEL)));
+  level = std::min(level, static_cast<int32_t>(MAX_BLUR_DOWNSAMPLE_LEVEL));
+
+  return std::ldexp(1.f, -level);
+}
+
 std::shared_ptr<MaskFilter> MaskFilter::MakeBlur(BlurStyle style,
                                                  float radius) {
   auto filter = std::make_shared<MaskFilter>();
 
   filter->style_ = style;
   filter->radius_ = radius;
+  filter->scale_ = calculate_blur_scale(style, radius);
 
   return filter;
 }
@@ -4,9 +4,14 @@
 
 namespace skity {
 
-PixmapShader::PixmapShader(std::shared_ptr<Pixmap> pixmap)
-    : Shader(), pixmap_(std::move(pixmap)) {}
+PixmapShader::PixmapShader(std::shared_ptr<Pixmap> pixmap,
+                           SamplingMode sampling)
+    : Shader(), pixmap_(std::move(pixmap)), sampling_(sampling) {}
 
 std::shared_ptr<Pixmap> PixmapShader::asImage() const { return pixmap_; }
 
+Shader::SamplingMode PixmapShader::GetSamplingMode() const {
+  return sampling_;
+}
+
 }  // namespace skity
\ No newline at end of file
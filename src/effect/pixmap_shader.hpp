@@ -7,13 +7,16 @@ namespace skity {
 
 class PixmapShader : public Shader {
  public:
-  PixmapShader(std::shared_ptr<Pixmap> pixmap);
+  PixmapShader(std::shared_ptr<Pixmap> pixmap, SamplingMode sampling);
   ~PixmapShader() override = default;
 
   std::shared_ptr<Pixmap> asImage() const override;
 
+  SamplingMode GetSamplingMode() const override;
+
  private:
   std::shared_ptr<Pixmap> pixmap_;
+  SamplingMode sampling_;
 };
 
 }  // namespace skity
@@ -11,6 +11,10 @@ Shader::GradientType Shader::asGradient(GradientInfo* info) const {
 
 std::shared_ptr<Pixmap> Shader::asImage() const { return nullptr; }
 
+Shader::SamplingMode Shader::GetSamplingMode() const {
+  return SamplingMode::kLinear;
+}
+
 std::shared_ptr<Shader> Shader::MakeLinear(const Point pts[2],
                                            const Vec4 colors[],
                                            const float pos[], int count,
@@ -39,12 +43,13 @@ std::shared_ptr<Shader> Shader::MakeRadial(Point const& center, float radius,
                                                 count, flag);
 }
 
-std::shared_ptr<Shader> Shader::MakeShader(std::shared_ptr<Pixmap> pixmap) {
+std::shared_ptr<Shader> Shader::MakeShader(std::shared_ptr<Pixmap> pixmap,
+                                           SamplingMode sampling) {
   if (!pixmap) {
     return nullptr;
   }
 
-  return std::make_shared<PixmapShader>(pixmap);
+  return std::make_shared<PixmapShader>(pixmap, sampling);
 }
 
 }  // namespace skity
\ No newline at end of file
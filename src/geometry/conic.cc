@@ -310,6 +310,30 @@ commonFinitePtCheck:
   return 1 << pow2;
 }
 
+uint32_t Conic::computeQuadPOW2(float tol) const {
+  if (tol <= 0.f || !std::isfinite(tol)) {
+    return kMaxConicToQuadPOW2;
+  }
+
+  // distance between conic and the quad with the same control points, every
+  // halving cuts it by 4
+  float a = w - 1.f;
+  float k = a / (4.f * (2.f + a));
+  float x = k * (pts[0].x - 2.f * pts[1].x + pts[2].x);
+  float y = k * (pts[0].y - 2.f * pts[1].y + pts[2].y);
+
+  float error = std::sqrt(x * x + y * y);
+  uint32_t pow2 = 0;
+  for (; pow2 < kMaxConicToQuadPOW2; pow2++) {
+    if (error <= tol) {
+      break;
+    }
+    error *= 0.25f;
+  }
+
+  return pow2;
+}
+
 void Conic::evalAt(float t, Point* pt, Vector* tangent) const {
   assert(t >= 0 && t <= Float1);
 
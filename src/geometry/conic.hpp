@@ -67,6 +67,14 @@ struct Conic {
    * @return      number of quad storaged in pts
    */
   uint32_t chopIntoQuadsPOW2(Point pts[], uint32_t pow2);
+  /**
+   * @brief Compute how many times this conic needs to be halved so every quad
+   *        of chopIntoQuadsPOW2 stays within tolerance of it
+   *
+   * @param tol   max distance between conic and quads
+   * @return      pow2 for chopIntoQuadsPOW2, at most kMaxConicToQuadPOW2
+   */
+  uint32_t computeQuadPOW2(float tol) const;
   Point pts[3] = {};
   float w = 0.f;
 };
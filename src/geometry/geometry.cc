@@ -1,7 +1,9 @@
 
 #include "src/geometry/geometry.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 #include "src/geometry/conic.hpp"
 #include "src/geometry/math.hpp"
@@ -315,4 +317,41 @@ void CubicToQuadratic(const Point cubic[4], Point quad[3]) {
   quad[2] = cubic[3];
 }
 
+float MatrixMaxScale(Matrix const& matrix) {
+  return std::max(glm::length(glm::vec2{matrix[0][0], matrix[0][1]}),
+                  glm::length(glm::vec2{matrix[1][0], matrix[1][1]}));
+}
+
+static int32_t wangs_formula_count(float n2, int32_t max_count) {
+  // also filters out NaN caused by degenerated tolerance
+  if (!(n2 > 1.f)) {
+    return 1;
+  }
+
+  if (n2 >= static_cast<float>(max_count) * max_count) {
+    return max_count;
+  }
+
+  return static_cast<int32_t>(std::ceil(std::sqrt(n2)));
+}
+
+int32_t WangsFormulaQuad(glm::vec2 const& p0, glm::vec2 const& p1,
+                         glm::vec2 const& p2, float tolerance,
+                         int32_t max_count) {
+  // degree 2: n = sqrt(2 * 1 / 8 * |p0 - 2p1 + p2| / tol)
+  float dd = glm::length(p0 - 2.f * p1 + p2);
+
+  return wangs_formula_count(0.25f * dd / tolerance, max_count);
+}
+
+int32_t WangsFormulaCubic(glm::vec2 const& p0, glm::vec2 const& p1,
+                          glm::vec2 const& p2, glm::vec2 const& p3,
+                          float tolerance, int32_t max_count) {
+  // degree 3: n = sqrt(3 * 2 / 8 * max|second diff| / tol)
+  float dd = std::max(glm::length(p0 - 2.f * p1 + p2),
+                      glm::length(p1 - 2.f * p2 + p3));
+
+  return wangs_formula_count(0.75f * dd / tolerance, max_count);
+}
+
 }  // namespace skity
@@ -225,6 +225,31 @@ void SubDividedQuad(const Vec2 quad[3], Vec2 sub_quad1[3], Vec2 sub_quad2[3]);
 
 void CubicToQuadratic(const Point cubic[4], Point quad[3]);
 
+/**
+ * Max length a unit vector can get after transformed by the 2D part of
+ * matrix, perspective is ignored.
+ */
+float MatrixMaxScale(Matrix const& matrix);
+
+/**
+ * Number of uniform segments needed to flatten a quadratic curve, computed
+ * with Wang's formula.
+ *
+ * @param tolerance max allowed distance between curve and polyline
+ * @param max_count upper bound of result
+ * @return          segment count in [1, max_count]
+ */
+int32_t WangsFormulaQuad(glm::vec2 const& p0, glm::vec2 const& p1,
+                         glm::vec2 const& p2, float tolerance,
+                         int32_t max_count);
+
+/**
+ * Same as WangsFormulaQuad but for cubic curve.
+ */
+int32_t WangsFormulaCubic(glm::vec2 const& p0, glm::vec2 const& p1,
+                          glm::vec2 const& p2, glm::vec2 const& p3,
+                          float tolerance, int32_t max_count);
+
 }  // namespace skity
 
 #endif  // SKITY_SRC_GEOMETRY_GEOMETRY_HPP_
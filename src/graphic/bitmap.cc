@@ -80,7 +80,7 @@ void Bitmap::blendPixel(uint32_t x, uint32_t y, Color src, BlendMode blend) {
               static_cast<uint8_t>(ColorGetG(dst) * one_minus_alpha);
   uint8_t b = ColorGetB(src) * src_alpha +
               static_cast<uint8_t>(ColorGetB(dst) * one_minus_alpha);
-  uint8_t a = ColorGetA(src) * src_alpha +
+  uint8_t a = ColorGetA(src) +
               static_cast<uint8_t>(ColorGetA(dst) * one_minus_alpha);
 
   setPixel(x, y, ColorSetARGB(a, r, g, b));
@@ -1,5 +1,6 @@
 
 #include <array>
+#include <atomic>
 #include <cstring>
 #include <glm/gtc/matrix_transform.hpp>
 #include <skity/graphic/path.hpp>
@@ -486,6 +487,7 @@ static int _pts_in_verb(Path::Verb verb) {
 }
 
 Path& Path::moveTo(float x, float y) {
+  dirtyGenerationID();
   last_move_to_index_ = countPoints();
 
   verbs_.emplace_back(Verb::kMove);
@@ -496,6 +498,7 @@ Path& Path::moveTo(float x, float y) {
 
 Path& Path::lineTo(float x, float y) {
   injectMoveToIfNeed();
+  dirtyGenerationID();
 
   verbs_.emplace_back(Verb::kLine);
   points_.emplace_back(Point{x, y, 0, 1});
@@ -505,6 +508,7 @@ Path& Path::lineTo(float x, float y) {
 
 Path& Path::quadTo(float x1, float y1, float x2, float y2) {
   injectMoveToIfNeed();
+  dirtyGenerationID();
 
   verbs_.emplace_back(Verb::kQuad);
   points_.emplace_back(Point{x1, y1, 0, 1});
@@ -522,6 +526,7 @@ Path& Path::conicTo(float x1, float y1, float x2, float y2, float weight) {
     this->quadTo(x1, y1, x2, y2);
   } else {
     injectMoveToIfNeed();
+    dirtyGenerationID();
 
     verbs_.emplace_back(Verb::kConic);
     conic_weights_.emplace_back(weight);
@@ -534,6 +539,7 @@ Path& Path::conicTo(float x1, float y1, float x2, float y2, float weight) {
 Path& Path::cubicTo(float x1, float y1, float x2, float y2, float x3,
                     float y3) {
   injectMoveToIfNeed();
+  dirtyGenerationID();
 
   verbs_.emplace_back(Verb::kCubic);
 
@@ -818,6 +824,7 @@ Path& Path::close() {
       case Verb::kCubic:
       case Verb::kMove:
         verbs_.emplace_back(Verb::kClose);
+        dirtyGenerationID();
         break;
       case Verb::kClose:
         break;
@@ -1102,6 +1109,7 @@ void Path::swap(Path& that) {
     std::swap(verbs_, that.verbs_);
     std::swap(conic_weights_, that.conic_weights_);
     std::swap(is_finite_, that.is_finite_);
+    std::swap(generation_id_, that.generation_id_);
   }
 }
 
@@ -1126,6 +1134,8 @@ Path& Path::addPath(const Path& src, const Matrix& matrix, AddMode mode) {
   }
 
   if (mode == AddMode::kAppend) {
+    dirtyGenerationID();
+
     if (src.last_move_to_index_ >= 0) {
       last_move_to_index_ = countPoints() + src.last_move_to_index_;
     }
@@ -1200,7 +1210,125 @@ void Path::setLastPt(float x, float y) {
     moveTo(x, y);
   } else {
     PointSet(points_.back(), x, y);
+    dirtyGenerationID();
+  }
+}
+
+uint32_t Path::getGenerationID() const {
+  static std::atomic<uint32_t> next_id{1};
+
+  while (generation_id_ == 0) {
+    // skip 0 when the counter wraps around
+    generation_id_ = next_id.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  return generation_id_;
+}
+
+Path::ConvexityType Path::getConvexityType() const {
+  if (convexity_ == ConvexityType::kUnknown) {
+    convexity_ = computeConvexity();
+  }
+
+  return convexity_;
+}
+
+Path::ConvexityType Path::computeConvexity() const {
+  if (!isFinite()) {
+    return ConvexityType::kConcave;
+  }
+
+  // points of the only contour, curves are represented by their control
+  // points, a curve with convex control polygon is convex too
+  std::vector<Vec2> pts;
+  bool contour_closed = false;
+  size_t pt_index = 0;
+
+  for (auto verb : verbs_) {
+    int32_t count = _pts_in_verb(verb);
+
+    if (verb == Verb::kMove) {
+      contour_closed = contour_closed || pts.size() > 1;
+    } else if (verb == Verb::kClose) {
+      contour_closed = true;
+    } else if (contour_closed) {
+      // second contour
+      return ConvexityType::kConcave;
+    } else if (pts.empty() && pt_index > 0) {
+      // start point of the only contour
+      pts.emplace_back(Vec2{points_[pt_index - 1]});
+    }
+
+    for (int32_t i = 0; i < count; i++) {
+      Vec2 p{points_[pt_index + i]};
+
+      if (verb != Verb::kMove && (pts.empty() || pts.back() != p)) {
+        pts.emplace_back(p);
+      }
+    }
+
+    pt_index += count;
+  }
+
+  while (pts.size() > 1 && pts.back() == pts.front()) {
+    pts.pop_back();
+  }
+
+  size_t n = pts.size();
+  if (n < 3) {
+    return ConvexityType::kConvex;
+  }
+
+  float winding = 0.f;
+  int32_t dx_changes = 0;
+  int32_t dy_changes = 0;
+  float last_dx = 0.f;
+  float last_dy = 0.f;
+
+  // visit every edge pair once, plus the first edge again to count direction
+  // changes around the closing point
+  for (size_t i = 0; i <= n; i++) {
+    Vec2 e0 = pts[(i + 1) % n] - pts[i % n];
+    Vec2 e1 = pts[(i + 2) % n] - pts[(i + 1) % n];
+
+    if (i < n) {
+      float cross = CrossProduct(e0, e1);
+      float scale = glm::length(e0) * glm::length(e1);
+
+      if (std::abs(cross) <= scale * 1e-5f) {
+        if (glm::dot(e0, e1) < 0.f) {
+          // edge folds back on itself
+          return ConvexityType::kConcave;
+        }
+      } else if (winding == 0.f) {
+        winding = cross;
+      } else if ((winding > 0.f) != (cross > 0.f)) {
+        return ConvexityType::kConcave;
+      }
+    }
+
+    if (e0.x != 0.f) {
+      if (last_dx != 0.f && (last_dx > 0.f) != (e0.x > 0.f)) {
+        dx_changes++;
+      }
+      last_dx = e0.x;
+    }
+
+    if (e0.y != 0.f) {
+      if (last_dy != 0.f && (last_dy > 0.f) != (e0.y > 0.f)) {
+        dy_changes++;
+      }
+      last_dy = e0.y;
+    }
   }
+
+  // a simple convex loop changes x and y direction twice, a loop turning
+  // around more than once like a star changes them more often
+  if (dx_changes > 2 || dy_changes > 2) {
+    return ConvexityType::kConcave;
+  }
+
+  return ConvexityType::kConvex;
 }
 
 Path Path::copyWithMatrix(const Matrix& matrix) const {
@@ -1209,6 +1337,7 @@ Path Path::copyWithMatrix(const Matrix& matrix) const {
   ret.last_move_to_index_ = last_move_to_index_;
   ret.convexity_ = convexity_;
   ret.first_direction_ = first_direction_;
+  ret.fill_type_ = fill_type_;
 
   for (const auto& p : this->points_) {
     ret.points_.emplace_back(matrix * p);
@@ -1229,6 +1358,7 @@ Path Path::copyWithScale(float scale) const {
   ret.last_move_to_index_ = last_move_to_index_;
   ret.convexity_ = convexity_;
   ret.first_direction_ = first_direction_;
+  ret.fill_type_ = fill_type_;
 
   ret.points_.reserve(this->points_.size());
   for (auto p : this->points_) {
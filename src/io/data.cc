@@ -1,17 +1,101 @@
 #include <cassert>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <functional>
 #include <mutex>
 #include <skity/io/data.hpp>
-#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SKITY_DATA_MMAP 1
+#endif
 
 namespace skity {
 
+// first buffer size when reading a file of unknown length, doubled until the
+// whole file fits
+static constexpr size_t FILE_READ_CHUNK_SIZE = 64 * 1024;
+
 static void skity_free_releaseproc(const void* ptr, void*) {
   std::free((void*)ptr);
 }
 
+#ifdef SKITY_DATA_MMAP
+// context holds length of the mapping
+static void skity_munmap_releaseproc(const void* ptr, void* context) {
+  munmap(const_cast<void*>(ptr), reinterpret_cast<size_t>(context));
+}
+
+static std::shared_ptr<Data> map_file_data(const char path[]) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  struct stat st {};
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+    close(fd);
+    return nullptr;
+  }
+
+  size_t length = static_cast<size_t>(st.st_size);
+  void* addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  // mapping stays valid after the descriptor is closed
+  close(fd);
+
+  if (addr == MAP_FAILED) {
+    return nullptr;
+  }
+
+  return Data::MakeWithProc(addr, length, skity_munmap_releaseproc,
+                            reinterpret_cast<void*>(length));
+}
+#endif
+
+// read until end of file, for pipes and devices like /dev/stdin which can not
+// seek to report their size
+static std::shared_ptr<Data> read_file_chunks(FILE* file) {
+  char* buffer = nullptr;
+  size_t capacity = 0;
+  size_t size = 0;
+
+  while (true) {
+    if (size == capacity) {
+      size_t new_capacity = capacity ? capacity * 2 : FILE_READ_CHUNK_SIZE;
+      auto new_buffer =
+          reinterpret_cast<char*>(std::realloc(buffer, new_capacity));
+      if (new_buffer == nullptr) {
+        std::free(buffer);
+        return nullptr;
+      }
+
+      buffer = new_buffer;
+      capacity = new_capacity;
+    }
+
+    size_t request = capacity - size;
+    size_t read_size = std::fread(buffer + size, 1, request, file);
+    size += read_size;
+
+    // short read means end of file or an error
+    if (read_size < request) {
+      break;
+    }
+  }
+
+  if (std::ferror(file) || size == 0) {
+    std::free(buffer);
+    return nullptr;
+  }
+
+  return Data::MakeFromMalloc(buffer, size);
+}
+
 Data::Data(const void* ptr, size_t size, ReleaseProc proc, void* context)
     : ptr_(ptr), size_(size), proc_(proc), context_(context) {}
 
@@ -47,6 +131,10 @@ std::shared_ptr<Data> Data::PrivateNewWithCopy(const void* srcOrNull,
   }
 
   void* data = std::malloc(length);
+  if (data == nullptr) {
+    return Data::MakeEmpty();
+  }
+
   std::memcpy(data, srcOrNull, length);
 
   return Data::MakeFromMalloc(data, length);
@@ -77,13 +165,54 @@ std::shared_ptr<Data> Data::MakeWithCString(const char cStr[]) {
   return MakeWithCopy(cStr, size);
 }
 
-std::shared_ptr<Data> Data::MakeFromFileName(const char path[]) {
-  std::ifstream in_stream{path, std::ios::in | std::ios::binary};
-  std::vector<uint8_t> raw_file_data(
-      (std::istreambuf_iterator<char>(in_stream)),
-      std::istreambuf_iterator<char>());
+std::shared_ptr<Data> Data::MakeFromFileName(const char path[],
+                                             bool map_file) {
+  if (path == nullptr) {
+    return MakeEmpty();
+  }
+
+#ifdef SKITY_DATA_MMAP
+  if (map_file) {
+    auto data = map_file_data(path);
+    if (data) {
+      return data;
+    }
+  }
+#endif
+
+  FILE* file = std::fopen(path, "rb");
+  if (file == nullptr) {
+    return MakeEmpty();
+  }
+
+  long length = -1;
+  if (std::fseek(file, 0, SEEK_END) == 0) {
+    length = std::ftell(file);
+  }
+
+  // files reporting no size may still have content, e.g. under /proc
+  if (length <= 0 || std::fseek(file, 0, SEEK_SET) != 0) {
+    auto data = read_file_chunks(file);
+    std::fclose(file);
+
+    return data ? data : MakeEmpty();
+  }
+
+  void* buffer = std::malloc(length);
+  if (buffer == nullptr) {
+    std::fclose(file);
+    return MakeEmpty();
+  }
+
+  size_t read_size = std::fread(buffer, 1, length, file);
+  std::fclose(file);
+
+  if (read_size != static_cast<size_t>(length)) {
+    std::free(buffer);
+    return MakeEmpty();
+  }
 
-  return MakeWithCopy(raw_file_data.data(), raw_file_data.size());
+  return MakeFromMalloc(buffer, read_size);
 }
 
 std::shared_ptr<Data> Data::MakeWithProc(const void* ptr, size_t length,
@@ -1,16 +1,38 @@
+#include <atomic>
 #include <skity/io/data.hpp>
 #include <skity/io/pixmap.hpp>
 #include <utility>
 
 namespace skity {
 
+static uint32_t NextUniqueID() {
+  static std::atomic<uint32_t> next_id{1};
+
+  uint32_t id = 0;
+  while (id == 0) {
+    // skip 0 when the counter wraps
+    id = next_id.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  return id;
+}
+
+Pixmap::Pixmap()
+    : data_(),
+      pixels_(nullptr),
+      row_bytes_(0),
+      width_(0),
+      height_(0),
+      unique_id_(NextUniqueID()) {}
+
 Pixmap::Pixmap(std::shared_ptr<Data> data, size_t rowBytes, uint32_t width,
                uint32_t height)
     : data_(std::move(data)),
       pixels_(nullptr),
       row_bytes_(rowBytes),
       width_(width),
-      height_(height) {
+      height_(height),
+      unique_id_(NextUniqueID()) {
   if (data_) {
     pixels_ = data_->RawData();
   }
@@ -22,6 +44,7 @@ void Pixmap::Reset() {
   row_bytes_ = 0;
   width_ = 0;
   height_ = 0;
+  unique_id_ = NextUniqueID();
 }
 
 }  // namespace skity
\ No newline at end of file
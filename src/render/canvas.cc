@@ -96,6 +96,20 @@ void Canvas::drawPath(const Path &path, const Paint &paint) {
 
 void Canvas::flush() { this->onFlush(); }
 
+void Canvas::setImageCacheLimit(size_t bytes) {
+  this->onSetImageCacheLimit(bytes);
+}
+
+void Canvas::purgeUnusedResources() { this->onPurgeUnusedResources(); }
+
+Canvas::ImageCacheStats Canvas::getImageCacheStats() const {
+  return this->onGetImageCacheStats();
+}
+
+Canvas::GlyphAtlasStats Canvas::getGlyphAtlasStats() const {
+  return this->onGetGlyphAtlasStats();
+}
+
 void Canvas::setDefaultTypeface(std::shared_ptr<Typeface> typeface) {
   default_typeface_ = std::move(typeface);
 }
@@ -223,4 +237,16 @@ bool Canvas::needGlyphPath(Paint const &paint) {
   return paint.getStyle() != Paint::kFill_Style;
 }
 
+void Canvas::onSetImageCacheLimit(size_t bytes) {}
+
+void Canvas::onPurgeUnusedResources() {}
+
+Canvas::ImageCacheStats Canvas::onGetImageCacheStats() const {
+  return ImageCacheStats{};
+}
+
+Canvas::GlyphAtlasStats Canvas::onGetGlyphAtlasStats() const {
+  return GlyphAtlasStats{};
+}
+
 }  // namespace skity
@@ -75,8 +75,7 @@ std::unique_ptr<HWRenderTarget> GLCanvas::GenerateBackendRenderTarget(
     uint32_t width, uint32_t height) {
   auto fbo = std::make_unique<GLRenderTarget>(width, height);
 
-  // always enable multisample fbo
-  fbo->SetEnableMultiSample(true);
+  fbo->SetSampleCount(OffscreenSampleCount());
 
   fbo->Init();
 
@@ -58,6 +58,7 @@ void GLInterface::InitGlobalInterface(void* proc_loader) {
   GET_PROC(Flush);
   GET_PROC(FramebufferTexture2D);
   GET_PROC(GenBuffers);
+  GET_PROC(GenerateMipmap);
   GET_PROC(GenTextures);
   GET_PROC(GenVertexArrays);
   GET_PROC(GetError);
@@ -68,6 +69,7 @@ void GLInterface::InitGlobalInterface(void* proc_loader) {
   GET_PROC(GetUniformLocation);
   GET_PROC(LinkProgram);
   GET_PROC(PixelStorei);
+  GET_PROC(Scissor);
   GET_PROC(ShaderSource);
   GET_PROC(StencilFunc);
   GET_PROC(StencilMask);
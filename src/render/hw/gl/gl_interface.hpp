@@ -60,6 +60,7 @@ struct GLInterface {
   PFNGLFLUSHPROC fFlush = nullptr;
   PFNGLFRAMEBUFFERTEXTURE2DPROC fFramebufferTexture2D = nullptr;
   PFNGLGENBUFFERSPROC fGenBuffers = nullptr;
+  PFNGLGENERATEMIPMAPPROC fGenerateMipmap = nullptr;
   PFNGLGENTEXTURESPROC fGenTextures = nullptr;
   PFNGLGENVERTEXARRAYSPROC fGenVertexArrays = nullptr;
   PFNGLGETERRORPROC fGetError = nullptr;
@@ -70,6 +71,7 @@ struct GLInterface {
   PFNGLGETUNIFORMLOCATIONPROC fGetUniformLocation = nullptr;
   PFNGLLINKPROGRAMPROC fLinkProgram = nullptr;
   PFNGLPIXELSTOREIPROC fPixelStorei = nullptr;
+  PFNGLSCISSORPROC fScissor = nullptr;
   PFNGLSHADERSOURCEPROC fShaderSource = nullptr;
   PFNGLSTENCILFUNCPROC fStencilFunc = nullptr;
   PFNGLSTENCILMASKPROC fStencilMask = nullptr;
@@ -15,9 +15,11 @@ void check_fbo_state(GLuint fbo) {
 }
 
 void GLRenderTarget::Init() {
-  int32_t max_sample_count = 0;
-  GL_CALL(GetIntegerv, GL_MAX_SAMPLES, &max_sample_count);
-  msaa_sample_count_ = std::min((uint32_t)max_sample_count, msaa_sample_count_);
+  if (EnableMultiSample()) {
+    int32_t max_sample_count = 0;
+    GL_CALL(GetIntegerv, GL_MAX_SAMPLES, &max_sample_count);
+    SetSampleCount(std::min((uint32_t)max_sample_count, SampleCount()));
+  }
   // step 1 init all internal textures
   InitTextures();
 
@@ -92,6 +94,10 @@ void GLRenderTarget::UnBind() {
 
 void GLRenderTarget::Destroy() {
   GL_CALL(DeleteFramebuffers, 1, &fbo_);
+  if (msaa_fbo_) {
+    GL_CALL(DeleteFramebuffers, 1, &msaa_fbo_);
+    GL_CALL(DeleteTextures, 1, &msaa_target_);
+  }
   color_texture_.Destroy();
   horizontal_texture_.Destroy();
   vertical_texture_.Destroy();
@@ -118,7 +124,7 @@ void GLRenderTarget::InitTextures() {
 
   // init stencil texture
   if (EnableMultiSample()) {
-    stencil_texture_.SetMultisample(msaa_sample_count_);
+    stencil_texture_.SetMultisample(SampleCount());
   }
   stencil_texture_.Init(HWTexture::Type::kStencilTexture,
                         HWTexture::Format::kS);
@@ -172,7 +178,7 @@ void GLRenderTarget::InitMultiSampleTexture() {
 
   GL_CALL(BindTexture, GL_TEXTURE_2D_MULTISAMPLE, msaa_target_);
 
-  GL_CALL(TexImage2DMultisample, GL_TEXTURE_2D_MULTISAMPLE, msaa_sample_count_,
+  GL_CALL(TexImage2DMultisample, GL_TEXTURE_2D_MULTISAMPLE, SampleCount(),
           color_texture_.GetInternalFormat(), Width(), Height(), GL_TRUE);
 
   GL_CALL(BindTexture, GL_TEXTURE_2D_MULTISAMPLE, 0);
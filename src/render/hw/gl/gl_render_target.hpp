@@ -46,7 +46,6 @@ class GLRenderTarget : public HWRenderTarget {
  private:
   uint32_t fbo_ = {};
   uint32_t msaa_fbo_ = {};
-  uint32_t msaa_sample_count_ = 8;
   uint32_t msaa_target_ = {};
   GLTexture color_texture_;
   GLTexture horizontal_texture_;
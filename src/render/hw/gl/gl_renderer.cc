@@ -1,7 +1,11 @@
 #include "src/render/hw/gl/gl_renderer.hpp"
 
+#include <algorithm>
+#include <cstddef>
+
 #include "src/render/hw/gl/gl_interface.hpp"
 #include "src/render/hw/gl/gl_render_target.hpp"
+#include "src/render/hw/hw_mesh.hpp"
 
 namespace skity {
 
@@ -56,8 +60,10 @@ GLRenderer::GLRenderer(GPUContext* ctx, bool use_gs)
     : HWRenderer(), ctx_(ctx), use_gs_(use_gs) {}
 
 GLRenderer::~GLRenderer() {
-  GL_CALL(DeleteBuffers, buffers_.size(), buffers_.data());
-  GL_CALL(DeleteVertexArrays, 1, &vao_);
+  for (auto& set : buffer_sets_) {
+    GL_CALL(DeleteBuffers, set.buffers.size(), set.buffers.data());
+    GL_CALL(DeleteVertexArrays, 1, &set.vao);
+  }
 }
 
 void GLRenderer::Init() {
@@ -75,9 +81,14 @@ void GLRenderer::Bind() {
   shader_->SetUserTexture(0);
   shader_->SetFontTexture(1);
   BindBuffers();
+
+  GL_CALL(GetIntegerv, GL_VIEWPORT, &viewport_[0]);
+  GL_CALL(Disable, GL_SCISSOR_TEST);
+  scissor_enabled_ = false;
 }
 
 void GLRenderer::UnBind() {
+  DisableScissorTest();
   UnBindBuffers();
   shader_->UnBind();
 }
@@ -119,28 +130,60 @@ void GLRenderer::SetGradientPositions(const std::vector<float>& pos) {
   shader_->SetGradientPostions(pos);
 }
 
-void GLRenderer::UploadVertexBuffer(void* data, size_t data_size) {
-  GL_CALL(BindBuffer, GL_ARRAY_BUFFER, buffers_[0]);
-  if (data_size > buffer_sizes_[0]) {
-    // resize gpu buffer
-    buffer_sizes_[0] = data_size;
-    GL_CALL(BufferData, GL_ARRAY_BUFFER, data_size, nullptr, GL_STREAM_DRAW);
+void GLRenderer::SetGradientRampRow(float row) {
+  shader_->SetGradientRampRow(row);
+}
+
+uint32_t GLRenderer::BeginBufferFrame() {
+  current_set_ = (current_set_ + 1) % kBufferSetCount;
+
+  return current_set_;
+}
+
+uint32_t GLRenderer::BufferSetCount() const { return kBufferSetCount; }
+
+bool GLRenderer::SupportCompactVertex() const { return true; }
+
+bool GLRenderer::SupportAnalyticShape() const { return true; }
+
+bool GLRenderer::SupportGradientRamp() const { return true; }
+
+void GLRenderer::SetMeshFormat(HWMeshFormat const& format) {
+  mesh_format_ = format;
+
+  auto& set = CurrentBufferSet();
+  if (set.compact_vertex == format.compact_vertex) {
+    return;
   }
 
-  GL_CALL(BufferSubData, GL_ARRAY_BUFFER, 0, data_size, data);
+  GL_CALL(BindVertexArray, set.vao);
+  GL_CALL(BindBuffer, GL_ARRAY_BUFFER, set.buffers[0]);
+  SetupVertexLayout(format.compact_vertex);
+  GL_CALL(BindVertexArray, 0);
   GL_CALL(BindBuffer, GL_ARRAY_BUFFER, 0);
+
+  set.compact_vertex = format.compact_vertex;
 }
 
-void GLRenderer::UploadIndexBuffer(void* data, size_t data_size) {
-  GL_CALL(BindBuffer, GL_ELEMENT_ARRAY_BUFFER, buffers_[1]);
-  if (data_size > buffer_sizes_[1]) {
-    // resize gpu buffer
-    buffer_sizes_[1] = data_size;
-    GL_CALL(BufferData, GL_ELEMENT_ARRAY_BUFFER, data_size, nullptr,
-            GL_STREAM_DRAW);
-  }
+bool GLRenderer::ReserveVertexBuffer(size_t data_size) {
+  return ReserveBuffer(GL_ARRAY_BUFFER, 0, data_size);
+}
+
+bool GLRenderer::ReserveIndexBuffer(size_t data_size) {
+  return ReserveBuffer(GL_ELEMENT_ARRAY_BUFFER, 1, data_size);
+}
 
-  GL_CALL(BufferSubData, GL_ELEMENT_ARRAY_BUFFER, 0, data_size, data);
+void GLRenderer::UpdateVertexBuffer(void* data, size_t offset,
+                                    size_t data_size) {
+  GL_CALL(BindBuffer, GL_ARRAY_BUFFER, CurrentBufferSet().buffers[0]);
+  GL_CALL(BufferSubData, GL_ARRAY_BUFFER, offset, data_size, data);
+  GL_CALL(BindBuffer, GL_ARRAY_BUFFER, 0);
+}
+
+void GLRenderer::UpdateIndexBuffer(void* data, size_t offset,
+                                   size_t data_size) {
+  GL_CALL(BindBuffer, GL_ELEMENT_ARRAY_BUFFER, CurrentBufferSet().buffers[1]);
+  GL_CALL(BufferSubData, GL_ELEMENT_ARRAY_BUFFER, offset, data_size, data);
   GL_CALL(BindBuffer, GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
@@ -167,9 +210,39 @@ void GLRenderer::UpdateStencilFunc(HWStencilFunc func, uint32_t value,
   GL_CALL(StencilFunc, hw_stencil_func_to_gl(func), value, compare_mask);
 }
 
+void GLRenderer::EnableScissorTest(Rect const& rect) {
+  glm::ivec4 box = CalculateScissorBox(rect, viewport_.z, viewport_.w);
+  box.x += viewport_.x;
+  box.y += viewport_.y;
+
+  if (!scissor_enabled_) {
+    GL_CALL(Enable, GL_SCISSOR_TEST);
+    scissor_enabled_ = true;
+  } else if (box == scissor_box_) {
+    return;
+  }
+
+  GL_CALL(Scissor, box.x, box.y, box.z, box.w);
+  scissor_box_ = box;
+}
+
+void GLRenderer::DisableScissorTest() {
+  if (!scissor_enabled_) {
+    return;
+  }
+
+  GL_CALL(Disable, GL_SCISSOR_TEST);
+  scissor_enabled_ = false;
+}
+
 void GLRenderer::DrawIndex(uint32_t start, uint32_t count) {
-  GL_CALL(DrawElements, GL_TRIANGLES, count, GL_UNSIGNED_INT,
-          (void*)(start * sizeof(GLuint)));
+  if (mesh_format_.short_index) {
+    GL_CALL(DrawElements, GL_TRIANGLES, count, GL_UNSIGNED_SHORT,
+            (void*)(start * sizeof(GLushort)));
+  } else {
+    GL_CALL(DrawElements, GL_TRIANGLES, count, GL_UNSIGNED_INT,
+            (void*)(start * sizeof(GLuint)));
+  }
 }
 
 void GLRenderer::InitShader() {
@@ -181,30 +254,64 @@ void GLRenderer::InitShader() {
 }
 
 void GLRenderer::InitBufferObject() {
-  GL_CALL(GenVertexArrays, 1, &vao_);
-  GL_CALL(GenBuffers, 2, buffers_.data());
+  for (auto& set : buffer_sets_) {
+    GL_CALL(GenVertexArrays, 1, &set.vao);
+    GL_CALL(GenBuffers, 2, set.buffers.data());
 
-  GL_CALL(BindVertexArray, vao_);
-  GL_CALL(BindBuffer, GL_ARRAY_BUFFER, buffers_[0]);
+    GL_CALL(BindVertexArray, set.vao);
+    GL_CALL(BindBuffer, GL_ARRAY_BUFFER, set.buffers[0]);
 
-  GL_CALL(EnableVertexAttribArray, 0);
-  GL_CALL(VertexAttribPointer, 0, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float),
-          (void*)0);
-  GL_CALL(EnableVertexAttribArray, 1);
-  GL_CALL(VertexAttribPointer, 1, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float),
-          (void*)(2 * sizeof(float)));
+    GL_CALL(EnableVertexAttribArray, 0);
+    GL_CALL(EnableVertexAttribArray, 1);
+    SetupVertexLayout(set.compact_vertex);
 
-  GL_CALL(BindBuffer, GL_ELEMENT_ARRAY_BUFFER, buffers_[1]);
+    GL_CALL(BindBuffer, GL_ELEMENT_ARRAY_BUFFER, set.buffers[1]);
 
-  GL_CALL(BindVertexArray, 0);
+    GL_CALL(BindVertexArray, 0);
+  }
+
+  GL_CALL(BindBuffer, GL_ELEMENT_ARRAY_BUFFER, 0);
+  GL_CALL(BindBuffer, GL_ARRAY_BUFFER, 0);
+}
+
+bool GLRenderer::ReserveBuffer(uint32_t target, uint32_t index,
+                               size_t data_size) {
+  auto& set = CurrentBufferSet();
+
+  if (data_size <= set.buffer_sizes[index]) {
+    return true;
+  }
+
+  // grow geometrically so steady scenes stop reallocating quickly
+  size_t new_size = std::max(data_size, set.buffer_sizes[index] * 2);
 
-  GL_CALL(BindBuffer, GL_ELEMENT_ARRAY_BUFFER , 0);
-  GL_CALL(BindBuffer, GL_ARRAY_BUFFER , 0);
+  GL_CALL(BindBuffer, target, set.buffers[index]);
+  GL_CALL(BufferData, target, new_size, nullptr, GL_DYNAMIC_DRAW);
+  GL_CALL(BindBuffer, target, 0);
+
+  set.buffer_sizes[index] = new_size;
+
+  return false;
+}
+
+void GLRenderer::SetupVertexLayout(bool compact_vertex) {
+  if (compact_vertex) {
+    // [x, y] float, [mix, u, v] half float
+    GL_CALL(VertexAttribPointer, 0, 2, GL_FLOAT, GL_FALSE,
+            sizeof(HWCompactVertex), (void*)offsetof(HWCompactVertex, x));
+    GL_CALL(VertexAttribPointer, 1, 3, GL_HALF_FLOAT, GL_FALSE,
+            sizeof(HWCompactVertex), (void*)offsetof(HWCompactVertex, mix));
+  } else {
+    GL_CALL(VertexAttribPointer, 0, 2, GL_FLOAT, GL_FALSE, sizeof(HWVertex),
+            (void*)offsetof(HWVertex, x));
+    GL_CALL(VertexAttribPointer, 1, 3, GL_FLOAT, GL_FALSE, sizeof(HWVertex),
+            (void*)offsetof(HWVertex, mix));
+  }
 }
 
 void GLRenderer::BindBuffers() {
-  GL_CALL(BindVertexArray, vao_);
-  GL_CALL(BindBuffer, GL_ELEMENT_ARRAY_BUFFER, buffers_[1]);
+  GL_CALL(BindVertexArray, CurrentBufferSet().vao);
+  GL_CALL(BindBuffer, GL_ELEMENT_ARRAY_BUFFER, CurrentBufferSet().buffers[1]);
 }
 
 void GLRenderer::UnBindBuffers() {
@@ -224,6 +331,7 @@ void GLRenderer::BindRenderTarget(HWRenderTarget* render_target) {
   // save current viewport
   GL_CALL(GetIntegerv, GL_VIEWPORT, &saved_viewport_[0]);
 
+  viewport_ = {0, 0, fbo->Width(), fbo->Height()};
   GL_CALL(Viewport, 0, 0, fbo->Width(), fbo->Height());
 }
 
@@ -237,6 +345,7 @@ void GLRenderer::UnBindRenderTarget(HWRenderTarget* render_target) {
   }
 
   // restore saved viewport
+  viewport_ = saved_viewport_;
   GL_CALL(Viewport, saved_viewport_[0], saved_viewport_[1], saved_viewport_[2],
           saved_viewport_[3]);
 }
@@ -41,9 +41,27 @@ class GLRenderer : public HWRenderer {
 
   void SetGradientPositions(std::vector<float> const& pos) override;
 
-  void UploadVertexBuffer(void* data, size_t data_size) override;
+  void SetGradientRampRow(float row) override;
 
-  void UploadIndexBuffer(void* data, size_t data_size) override;
+  uint32_t BeginBufferFrame() override;
+
+  uint32_t BufferSetCount() const override;
+
+  bool SupportCompactVertex() const override;
+
+  bool SupportAnalyticShape() const override;
+
+  bool SupportGradientRamp() const override;
+
+  void SetMeshFormat(HWMeshFormat const& format) override;
+
+  bool ReserveVertexBuffer(size_t data_size) override;
+
+  bool ReserveIndexBuffer(size_t data_size) override;
+
+  void UpdateVertexBuffer(void* data, size_t offset, size_t data_size) override;
+
+  void UpdateIndexBuffer(void* data, size_t offset, size_t data_size) override;
 
   void SetGlobalAlpha(float alpha) override;
 
@@ -62,6 +80,10 @@ class GLRenderer : public HWRenderer {
   void UpdateStencilFunc(HWStencilFunc func, uint32_t value,
                          uint32_t compare_mask) override;
 
+  void EnableScissorTest(Rect const& rect) override;
+
+  void DisableScissorTest() override;
+
   void DrawIndex(uint32_t start, uint32_t count) override;
 
   void BindTexture(HWTexture* texture, uint32_t slot) override;
@@ -77,14 +99,39 @@ class GLRenderer : public HWRenderer {
   void BindBuffers();
   void UnBindBuffers();
 
+ private:
+  // vertex array with its own vertex and index buffer
+  struct BufferSet {
+    uint32_t vao = 0;
+    std::array<uint32_t, 2> buffers = {};
+    std::array<size_t, 2> buffer_sizes = {};
+    // attribute layout currently set in vao
+    bool compact_vertex = false;
+  };
+
+  // frames rotate through buffer sets, so BufferSubData does not need to wait
+  // for the gpu finishing the previous frame
+  static constexpr uint32_t kBufferSetCount = 3;
+
+  BufferSet& CurrentBufferSet() { return buffer_sets_[current_set_]; }
+
+  bool ReserveBuffer(uint32_t target, uint32_t index, size_t data_size);
+
+  // vertex array and vertex buffer of set need to be bound
+  static void SetupVertexLayout(bool compact_vertex);
+
  private:
   GPUContext* ctx_;
   bool use_gs_;
   std::unique_ptr<GLPipelineShader> shader_ = {};
-  uint32_t vao_ = 0;
-  std::array<uint32_t, 2> buffers_ = {};
-  std::array<size_t, 2> buffer_sizes_ = {};
+  std::array<BufferSet, kBufferSetCount> buffer_sets_ = {};
+  uint32_t current_set_ = 0;
+  HWMeshFormat mesh_format_ = {};
   glm::ivec4 saved_viewport_ = {};
+  // viewport of current framebuffer, scissor boxes are relative to it
+  glm::ivec4 viewport_ = {};
+  bool scissor_enabled_ = false;
+  glm::ivec4 scissor_box_ = {};
   int32_t root_fbo_ = 0;
 };
 
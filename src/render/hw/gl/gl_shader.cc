@@ -204,6 +204,7 @@ void GLPipelineShader::InitLocations() {
   gradient_bound_location_ = GetUniformLocation("GradientBounds");
   gradient_colors_location_ = GetUniformLocation("GradientColors");
   gradient_pos_location_ = GetUniformLocation("GradientStops");
+  gradient_ramp_location_ = GetUniformLocation("GradientRampRow");
   global_alpha_location_ = GetUniformLocation("GlobalAlpha");
 }
 
@@ -254,6 +255,10 @@ void GLPipelineShader::SetGradientPostions(const std::vector<float>& pos) {
   SetUniform(gradient_pos_location_, (float*)pos.data(), pos.size());
 }
 
+void GLPipelineShader::SetGradientRampRow(float row) {
+  SetUniform(gradient_ramp_location_, row);
+}
+
 void GLPipelineShader::SetGlobalAlpha(float alpha) {
   SetUniform(global_alpha_location_, alpha);
 }
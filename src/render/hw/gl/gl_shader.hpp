@@ -63,6 +63,7 @@ class GLPipelineShader : public GLShader {
   void SetGradientBoundInfo(glm::vec4 const& info);
   void SetGradientColors(std::vector<glm::vec4> const& colors);
   void SetGradientPostions(std::vector<float> const& pos);
+  void SetGradientRampRow(float row);
   void SetGlobalAlpha(float alpha);
 
  private:
@@ -77,6 +78,7 @@ class GLPipelineShader : public GLShader {
   int32_t gradient_bound_location_ = -1;
   int32_t gradient_colors_location_ = -1;
   int32_t gradient_pos_location_ = -1;
+  int32_t gradient_ramp_location_ = -1;
   int32_t global_alpha_location_ = -1;
 };
 
@@ -19,6 +19,19 @@ static GLenum hw_texture_format_to_gl(HWTexture::Format format) {
   return GL_RGBA;
 }
 
+static GLenum hw_texture_min_filter_to_gl(HWTexture::Filter filter) {
+  switch (filter) {
+    case HWTexture::Filter::kNearest:
+      return GL_NEAREST;
+    case HWTexture::Filter::kLinear:
+      return GL_LINEAR;
+    case HWTexture::Filter::kMipmap:
+      return GL_LINEAR_MIPMAP_LINEAR;
+  }
+
+  return GL_LINEAR;
+}
+
 GLTexture::~GLTexture() {
   if (texture_id_) {
     GL_CALL(DeleteTextures, 1, &texture_id_);
@@ -36,8 +49,10 @@ void GLTexture::Init(HWTexture::Type type, HWTexture::Format format) {
     // texture common config
     GL_CALL(TexParameteri, GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     GL_CALL(TexParameteri, GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    GL_CALL(TexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    GL_CALL(TexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    GL_CALL(TexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+            hw_texture_min_filter_to_gl(filter_));
+    GL_CALL(TexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+            filter_ == Filter::kNearest ? GL_NEAREST : GL_LINEAR);
     if (format == HWTexture::Format::kR) {
       GL_CALL(PixelStorei, GL_UNPACK_ALIGNMENT, 1);
     }
@@ -91,6 +106,14 @@ void GLTexture::UploadData(uint32_t offset_x, uint32_t offset_y, uint32_t width,
           format_, GetInternalType(), data);
 }
 
+void GLTexture::GenerateMipmaps() {
+  if (msaa_count_ > 0 || filter_ != Filter::kMipmap) {
+    return;
+  }
+
+  GL_CALL(GenerateMipmap, GL_TEXTURE_2D);
+}
+
 uint32_t GLTexture::GetInternalType() const {
   if (format_ == GL_DEPTH_STENCIL) {
     return GL_UNSIGNED_INT_24_8;
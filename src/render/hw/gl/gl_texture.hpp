@@ -27,6 +27,8 @@ class GLTexture : public HWTexture {
   void UploadData(uint32_t offset_x, uint32_t offset_y, uint32_t width,
                   uint32_t height, void* data) override;
 
+  void GenerateMipmaps() override;
+
   uint32_t GetInternalType() const;
 
   int32_t GetInternalFormat() const;
@@ -0,0 +1,172 @@
+#include "src/render/hw/hw_blur_cache.hpp"
+
+#include <skity/effect/mask_filter.hpp>
+
+#include "src/render/hw/hw_geometry_cache.hpp"
+
+namespace skity {
+
+enum {
+  // frames an unused target stays in cache
+  BLUR_CACHE_PURGE_LIMIT = 60,
+  // frames a shape seen once is remembered
+  BLUR_CACHE_CANDIDATE_LIMIT = 4,
+  // max pixel count of all cached targets
+  BLUR_CACHE_PIXEL_BUDGET = 1 << 21,
+};
+
+bool HWBlurCache::MakePathKey(Path const& path, Paint const& paint,
+                              Matrix const& matrix, Key* key) {
+  if (!MakeKey(paint, matrix, key)) {
+    return false;
+  }
+
+  key->path_id = path.getGenerationID();
+  key->fill_type = static_cast<uint32_t>(path.getFillType());
+
+  return true;
+}
+
+bool HWBlurCache::MakeRectKey(Rect const& rect, Paint const& paint,
+                              Matrix const& matrix, Key* key) {
+  return MakeRRectKey(RRect::MakeRect(rect), paint, matrix, key);
+}
+
+bool HWBlurCache::MakeRRectKey(RRect const& rrect, Paint const& paint,
+                               Matrix const& matrix, Key* key) {
+  if (!MakeKey(paint, matrix, key)) {
+    return false;
+  }
+
+  Rect const& rect = rrect.getBounds();
+  key->shape[0] = rect.left();
+  key->shape[1] = rect.top();
+  key->shape[2] = rect.right();
+  key->shape[3] = rect.bottom();
+  for (int32_t i = 0; i < 4; i++) {
+    Vec2 radii = rrect.radii(static_cast<RRect::Corner>(i));
+    key->shape[4 + i * 2] = radii.x;
+    key->shape[5 + i * 2] = radii.y;
+  }
+
+  return true;
+}
+
+HWRenderTarget* HWBlurCache::QueryTarget(Key const& key, Rect* bounds) {
+  auto it = entries_.find(key);
+
+  if (it == entries_.end() || !it->second.ready) {
+    return nullptr;
+  }
+
+  it->second.age = current_age_;
+  *bounds = it->second.bounds;
+
+  return it->second.target.get();
+}
+
+bool HWBlurCache::ShouldCache(Key const& key, uint32_t width,
+                              uint32_t height) {
+  if (entries_.count(key)) {
+    // stored in current frame and not ready yet
+    return false;
+  }
+
+  auto it = candidates_.find(key);
+
+  if (it == candidates_.end()) {
+    candidates_.insert(std::make_pair(key, current_age_));
+    return false;
+  }
+
+  if (it->second == current_age_) {
+    // drawn more than once in one frame, wait for another frame
+    return false;
+  }
+
+  size_t pixels = static_cast<size_t>(width) * height;
+  if (pixel_count_ + pixels > BLUR_CACHE_PIXEL_BUDGET) {
+    return false;
+  }
+
+  candidates_.erase(it);
+
+  return true;
+}
+
+HWRenderTarget* HWBlurCache::StoreTarget(
+    Key const& key, std::unique_ptr<HWRenderTarget> target,
+    Rect const& bounds) {
+  auto result = target.get();
+
+  pixel_count_ += static_cast<size_t>(target->Width()) * target->Height();
+  entries_[key] = Entry{std::move(target), bounds, current_age_, false};
+
+  return result;
+}
+
+void HWBlurCache::EndFrame() {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    auto& entry = it->second;
+
+    if (current_age_ - entry.age > BLUR_CACHE_PURGE_LIMIT) {
+      pixel_count_ -=
+          static_cast<size_t>(entry.target->Width()) * entry.target->Height();
+      entry.target->Destroy();
+      it = entries_.erase(it);
+    } else {
+      entry.ready = true;
+      it++;
+    }
+  }
+
+  for (auto it = candidates_.begin(); it != candidates_.end();) {
+    if (current_age_ - it->second > BLUR_CACHE_CANDIDATE_LIMIT) {
+      it = candidates_.erase(it);
+    } else {
+      it++;
+    }
+  }
+
+  current_age_++;
+}
+
+void HWBlurCache::CleanUp() {
+  for (auto& it : entries_) {
+    it.second.target->Destroy();
+  }
+
+  entries_.clear();
+  candidates_.clear();
+  pixel_count_ = 0;
+}
+
+bool HWBlurCache::MakeKey(Paint const& paint, Matrix const& matrix,
+                          Key* key) {
+  auto mask_filter = paint.getMaskFilter();
+
+  if (!mask_filter || paint.getShader() || paint.getPathEffect()) {
+    return false;
+  }
+
+  *key = Key{};
+  key->style = paint.getStyle();
+  if (paint.getStyle() != Paint::kFill_Style) {
+    key->stroke_width = paint.getStrokeWidth();
+    key->stroke_miter = paint.getStrokeMiter();
+    key->stroke_cap = paint.getStrokeCap();
+    key->stroke_join = paint.getStrokeJoin();
+    key->stroke_color = paint.getStrokeColor();
+  }
+  if (paint.getStyle() != Paint::kStroke_Style) {
+    key->fill_color = paint.getFillColor();
+  }
+  key->alpha = paint.getAlphaF();
+  key->blur_style = mask_filter->blurStyle();
+  key->blur_radius = mask_filter->blurRadius();
+  key->scale_class = HWGeometryCache::ScaleClass(matrix);
+
+  return true;
+}
+
+}  // namespace skity
@@ -0,0 +1,152 @@
+#ifndef SKITY_SRC_RENDER_HW_HW_BLUR_CACHE_HPP
+#define SKITY_SRC_RENDER_HW_HW_BLUR_CACHE_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <skity/geometry/point.hpp>
+#include <skity/geometry/rect.hpp>
+#include <skity/geometry/rrect.hpp>
+#include <skity/graphic/paint.hpp>
+#include <skity/graphic/path.hpp>
+#include <unordered_map>
+
+#include "src/render/hw/hw_render_target.hpp"
+
+namespace skity {
+
+/**
+ * Keeps the filtered render target of mask filter draws across frames, so a
+ * shape blurred with the same paint again is composited directly without
+ * the offscreen raster and blur passes.
+ *
+ * Content of the render target is rastered in local space, so the cached
+ * result does not depend on translation of the canvas. The key only carries
+ * the scale class of the transform since tessellation depends on it. Like
+ * HWGeometryCache, a shape is only cached after it is seen in two different
+ * frames.
+ */
+class HWBlurCache final {
+ public:
+  struct Key {
+    // generation id of path shape, 0 for rect and rrect shape
+    uint32_t path_id = {};
+    // [left, top, right, bottom, radii of four corners] of rect and rrect
+    std::array<float, 12> shape = {};
+    uint32_t fill_type = {};
+    uint32_t style = {};
+    float stroke_width = {};
+    float stroke_miter = {};
+    uint32_t stroke_cap = {};
+    uint32_t stroke_join = {};
+    glm::vec4 fill_color = {};
+    glm::vec4 stroke_color = {};
+    float alpha = {};
+    uint32_t blur_style = {};
+    float blur_radius = {};
+    int32_t scale_class = {};
+
+    bool operator==(Key const& other) const {
+      return path_id == other.path_id && shape == other.shape &&
+             fill_type == other.fill_type && style == other.style &&
+             stroke_width == other.stroke_width &&
+             stroke_miter == other.stroke_miter &&
+             stroke_cap == other.stroke_cap &&
+             stroke_join == other.stroke_join &&
+             fill_color == other.fill_color &&
+             stroke_color == other.stroke_color && alpha == other.alpha &&
+             blur_style == other.blur_style &&
+             blur_radius == other.blur_radius &&
+             scale_class == other.scale_class;
+    }
+  };
+
+  struct KeyHash {
+    std::size_t operator()(Key const& key) const {
+      size_t res = 17;
+
+      res = res * 31 + std::hash<uint32_t>()(key.path_id);
+      for (float value : key.shape) {
+        res = res * 31 + std::hash<float>()(value);
+      }
+      res = res * 31 + std::hash<uint32_t>()(key.fill_type);
+      res = res * 31 + std::hash<uint32_t>()(key.style);
+      res = res * 31 + std::hash<float>()(key.stroke_width);
+      for (int32_t i = 0; i < 4; i++) {
+        res = res * 31 + std::hash<float>()(key.fill_color[i]);
+        res = res * 31 + std::hash<float>()(key.stroke_color[i]);
+      }
+      res = res * 31 + std::hash<float>()(key.alpha);
+      res = res * 31 + std::hash<uint32_t>()(key.blur_style);
+      res = res * 31 + std::hash<float>()(key.blur_radius);
+      res = res * 31 + std::hash<int32_t>()(key.scale_class);
+
+      return res;
+    }
+  };
+
+  HWBlurCache() = default;
+  ~HWBlurCache() = default;
+
+  /**
+   * @return false if the draw is not cacheable, paints without mask filter,
+   *         or with shader or path effect are never cached
+   */
+  static bool MakePathKey(Path const& path, Paint const& paint,
+                          Matrix const& matrix, Key* key);
+
+  static bool MakeRectKey(Rect const& rect, Paint const& paint,
+                          Matrix const& matrix, Key* key);
+
+  static bool MakeRRectKey(RRect const& rrect, Paint const& paint,
+                           Matrix const& matrix, Key* key);
+
+  /**
+   * @param key     key created by MakeXXXKey
+   * @param bounds  filter bounds the cached target covers
+   * @return        render target with filtered result or nullptr, only
+   *                targets completely drawn in previous frames are returned
+   */
+  HWRenderTarget* QueryTarget(Key const& key, Rect* bounds);
+
+  /**
+   * Record a miss of key.
+   *
+   * @return true if the filtered result of this draw should be kept, the
+   *         caller then passes a new render target to StoreTarget
+   */
+  bool ShouldCache(Key const& key, uint32_t width, uint32_t height);
+
+  HWRenderTarget* StoreTarget(Key const& key,
+                              std::unique_ptr<HWRenderTarget> target,
+                              Rect const& bounds);
+
+  /**
+   * Purge unused targets, need to be called after all draws are submitted.
+   */
+  void EndFrame();
+
+  void CleanUp();
+
+ private:
+  struct Entry {
+    std::unique_ptr<HWRenderTarget> target = {};
+    Rect bounds = {};
+    size_t age = {};
+    // target is drawn when the frame storing it is flushed
+    bool ready = false;
+  };
+
+  static bool MakeKey(Paint const& paint, Matrix const& matrix, Key* key);
+
+ private:
+  std::unordered_map<Key, Entry, KeyHash> entries_ = {};
+  // shapes seen once, value is the age they were seen
+  std::unordered_map<Key, size_t, KeyHash> candidates_ = {};
+  size_t pixel_count_ = {};
+  size_t current_age_ = {};
+};
+
+}  // namespace skity
+
+#endif  // SKITY_SRC_RENDER_HW_HW_BLUR_CACHE_HPP
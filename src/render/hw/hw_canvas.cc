@@ -1,5 +1,7 @@
 #include "src/render/hw/hw_canvas.hpp"
 
+#include <array>
+#include <cmath>
 #include <glm/gtc/matrix_transform.hpp>
 #include <skity/config.hpp>
 #include <skity/effect/path_effect.hpp>
@@ -9,6 +11,7 @@
 #include <skity/text/text_run.hpp>
 
 #include "src/geometry/math.hpp"
+#include "src/render/hw/hw_draw_batcher.hpp"
 #include "src/render/hw/hw_mesh.hpp"
 #include "src/render/hw/hw_path_raster.hpp"
 #include "src/render/hw/hw_renderer.hpp"
@@ -23,6 +26,28 @@
 
 namespace skity {
 
+// size of render target content of mask filter draws
+static void filter_content_size(Rect const& filter_bounds,
+                                MaskFilter const& mask_filter, uint32_t* width,
+                                uint32_t* height) {
+  // content is rastered at reduced resolution for large blur radius, and
+  // upsampled by bilinear filter when drawn back
+  float scale = mask_filter.blurScale();
+  *width = std::max(1.f, std::ceil(filter_bounds.width() * scale));
+  *height = std::max(1.f, std::ceil(filter_bounds.height() * scale));
+}
+
+static HWTexture::Filter sampling_mode_to_filter(Shader::SamplingMode mode) {
+  switch (mode) {
+    case Shader::SamplingMode::kNearest:
+      return HWTexture::Filter::kNearest;
+    case Shader::SamplingMode::kMipmap:
+      return HWTexture::Filter::kMipmap;
+    default:
+      return HWTexture::Filter::kLinear;
+  }
+}
+
 std::unique_ptr<Canvas> Canvas::MakeHardwareAccelationCanvas(uint32_t width,
                                                              uint32_t height,
                                                              float density,
@@ -66,23 +91,27 @@ HWCanvas::HWCanvas(Matrix mvp, uint32_t width, uint32_t height, float density)
       mesh_(std::make_unique<HWMesh>()) {}
 
 HWCanvas::~HWCanvas() {
-  for (auto const& it : image_texture_store_) {
-    it.second->Destroy();
-  }
-
   for (auto const& it : font_texture_store_) {
     it.second->Destroy();
   }
 
   render_target_cache_.CleanUp();
+  blur_cache_.CleanUp();
+  gradient_cache_.CleanUp();
+  image_cache_.CleanUp();
 
   GetPipeline()->Destroy();
 }
 
 void HWCanvas::Init(GPUContext* ctx) {
+  offscreen_sample_count_ = ctx->offscreen_sample_count;
+
   this->OnInit(ctx);
 
   renderer_ = CreateRenderer();
+  if (renderer_->SupportGradientRamp()) {
+    gradient_cache_.Init(GenerateTexture());
+  }
   if (draw_list_stack_.empty()) {
     draw_list_stack_.emplace_back(DrawList());
   }
@@ -98,10 +127,53 @@ void HWCanvas::onUpdateViewport(uint32_t width, uint32_t height) {
   height_ = height;
 }
 
+void HWCanvas::onSetImageCacheLimit(size_t bytes) {
+  image_cache_.SetByteLimit(bytes);
+}
+
+void HWCanvas::onPurgeUnusedResources() {
+  image_cache_.PurgeUnused();
+  render_target_cache_.PurgeUnused();
+}
+
+Canvas::ImageCacheStats HWCanvas::onGetImageCacheStats() const {
+  return image_cache_.GetStats();
+}
+
+Canvas::GlyphAtlasStats HWCanvas::onGetGlyphAtlasStats() const {
+  GlyphAtlasStats stats{};
+  float used_pixels = 0.f;
+  float total_pixels = 0.f;
+
+  for (auto const& it : font_texture_store_) {
+    auto const& frame_stats = it.second->GetFrameStats();
+
+    stats.page_count += frame_stats.page_count;
+    stats.glyph_count += frame_stats.glyph_count;
+    stats.upload_count += frame_stats.upload_count;
+    stats.upload_bytes += frame_stats.upload_bytes;
+    stats.evicted_pages += frame_stats.evicted_pages;
+    stats.failed_glyphs += frame_stats.failed_glyphs;
+
+    float pixels = static_cast<float>(it.second->Width()) *
+                   static_cast<float>(it.second->Height());
+    used_pixels += frame_stats.occupancy * pixels;
+    total_pixels += pixels;
+  }
+
+  if (total_pixels > 0.f) {
+    stats.occupancy = used_pixels / total_pixels;
+  }
+
+  return stats;
+}
+
 HWMesh* HWCanvas::GetMesh() { return mesh_.get(); }
 
 std::unique_ptr<HWDraw> HWCanvas::GenerateOp() {
   auto draw = std::make_unique<HWDraw>(GetPipeline(), state_.HasClip());
+  draw->SetClipLevel(state_.CurrentClipLevel());
+  draw->SetScissorBox(state_.CurrentScissorBox());
 
   if (state_.MatrixDirty()) {
     draw->SetTransformMatrix(state_.CurrentMatrix());
@@ -117,7 +189,17 @@ std::unique_ptr<HWDraw> HWCanvas::GenerateColorOp(Paint const& paint,
   auto draw = GenerateOp();
   auto shader = paint.getShader();
 
-  if (shader) {
+  HWGradientCache::Gradient gradient{};
+  if (shader && gradient_cache_.QueryGradient(shader, &gradient)) {
+    if (gradient.type == Shader::kLinear) {
+      draw->SetPipelineColorMode(HWPipelineColorMode::kLinearGradient);
+    } else {
+      draw->SetPipelineColorMode(HWPipelineColorMode::kRadialGradient);
+    }
+    draw->SetGradientBounds({gradient.bounds.x, gradient.bounds.y},
+                            {gradient.bounds.z, gradient.bounds.w});
+    draw->SetGradientRamp(gradient_cache_.GetTexture(), gradient.row);
+  } else if (shader) {
     auto pixmap = paint.getShader()->asImage();
     Shader::GradientInfo gradient_info{};
     Shader::GradientType gradient_type = shader->asGradient(&gradient_info);
@@ -136,7 +218,8 @@ std::unique_ptr<HWDraw> HWCanvas::GenerateColorOp(Paint const& paint,
       draw->SetGradientColors(gradient_info.colors);
       draw->SetGradientPositions(gradient_info.color_offsets);
     } else if (pixmap) {
-      auto texture = QueryTexture(pixmap.get());
+      auto texture = QueryTexture(
+          pixmap, sampling_mode_to_filter(shader->GetSamplingMode()));
       draw->SetPipelineColorMode(HWPipelineColorMode::kImageTexture);
       draw->SetTexture(texture);
 
@@ -179,65 +262,80 @@ std::unique_ptr<HWDraw> HWCanvas::GenerateColorOp(Paint const& paint,
   return draw;
 }
 
-void HWCanvas::onClipPath(const Path& path, ClipOp op) {
-  // TODO support other ClipOp
-  Paint working_paint;
-  working_paint.setStyle(Paint::kFill_Style);
+void HWCanvas::onClipRect(Rect const& rect, ClipOp op) {
+  Matrix matrix = state_.CurrentMatrix();
 
-  HWPathRaster raster{GetMesh(), working_paint, SupportGeometryShader()};
+  bool scale_translate = matrix[0][1] == 0.f && matrix[1][0] == 0.f &&
+                         matrix[0][3] == 0.f && matrix[1][3] == 0.f &&
+                         matrix[3][3] == 1.f;
 
-  // raster path as normal path fill
-  raster.FillPath(path);
+  Rect device_rect;
+  if (op != ClipOp::kIntersect || !scale_translate ||
+      !MapDeviceBounds(rect, 0.f, &device_rect)) {
+    Canvas::onClipRect(rect, op);
+    return;
+  }
 
-  raster.FlushRaster();
+  // scissor box has no anti-alias, rect with edges between pixels keeps using
+  // stencil clip
+  auto on_pixel = [](float value) {
+    return std::abs(value - std::round(value)) < 1e-3f;
+  };
 
-  bool has_clip = state_.HasClip();
+  if (!on_pixel(device_rect.left()) || !on_pixel(device_rect.top()) ||
+      !on_pixel(device_rect.right()) || !on_pixel(device_rect.bottom())) {
+    Path path;
+    path.addRect(rect);
+    path.setConvexityType(Path::ConvexityType::kConvex);
 
-  if (full_rect_start_ == -1) {
-    // For recursive clip path, need to do full scene check
-    // to make stencil buffer right
-    // this may cause some performance issues and need optimization
-    HWPathRaster tmp_raster{GetMesh(), working_paint, SupportGeometryShader()};
-    tmp_raster.RasterRect(Rect::MakeXYWH(0, 0, width_, height_));
+    // temporary path never hits geometry_cache_ again
+    ClipPath(path, op, false);
+    return;
+  }
 
-    tmp_raster.FlushRaster();
+  state_.ClipRect(device_rect);
+}
 
-    full_rect_start_ = tmp_raster.ColorStart();
-    full_rect_count_ = tmp_raster.ColorCount();
-  }
+void HWCanvas::onClipPath(const Path& path, ClipOp op) {
+  ClipPath(path, op, true);
+}
 
-  if (raster.StencilFrontCount() == 0 && raster.StencilBackCount() == 0) {
-    // convex polygon save
-    state_.SaveClipPath(
-        {raster.ColorStart(), raster.ColorCount()},
-        {raster.StencilBackStart(), raster.StencilBackCount()},
-        {(uint32_t)full_rect_start_, (uint32_t)full_rect_count_},
-        state_.CurrentMatrix());
-  } else {
-    state_.SaveClipPath(
-        {raster.StencilFrontStart(), raster.StencilFrontCount()},
-        {raster.StencilBackStart(), raster.StencilBackCount()},
-        {(uint32_t)full_rect_start_, (uint32_t)full_rect_count_},
-        state_.CurrentMatrix());
-  }
+void HWCanvas::ClipPath(Path const& path, ClipOp op, bool cache_geometry) {
+  // TODO support other ClipOp
+  Paint working_paint;
+  working_paint.setStyle(Paint::kFill_Style);
+
+  // raster path as normal path fill
+  HWGeometry geometry = RasterPath(path, working_paint, cache_geometry);
 
-  auto draw = std::make_unique<HWDraw>(GetPipeline(), has_clip, true);
+  bool convex = geometry.stencil_front_range.count == 0 &&
+                geometry.stencil_back_range.count == 0;
 
-  if (raster.StencilBackCount() == 0 && raster.StencilFrontCount() == 0) {
-    // this is a convexity polygon
+  uint32_t level = state_.CurrentClipLevel();
+  // no free stencil level, intersect this clip into current level
+  bool folded = level == HWDraw::MAX_CLIP_LEVEL;
+
+  // folding also drops pixels of current level outside the path, so it covers
+  // the whole canvas
+  HWDrawRange bound_range{};
+  Rect device_bounds;
+  if (!folded && MapDeviceBounds(geometry.bounds, 1.f, &device_bounds)) {
+    HWPathRaster raster{GetMesh(), working_paint, SupportGeometryShader()};
+    raster.RasterRect(device_bounds);
+    raster.FlushRaster();
 
-    draw->SetStencilRange({raster.ColorStart(), raster.ColorCount()}, {0, 0});
+    bound_range = {raster.ColorStart(), raster.ColorCount()};
   } else {
-    draw->SetStencilRange(
-        {raster.StencilFrontStart(), raster.StencilFrontCount()},
-        {raster.StencilBackStart(), raster.StencilBackCount()});
+    bound_range = FullRectRange();
   }
 
-  draw->SetColorRange({(uint32_t)full_rect_start_, (uint32_t)full_rect_count_});
-
-  draw->SetTransformMatrix(state_.CurrentMatrix());
+  // convex polygon is rastered as color range, each pixel is covered once
+  state_.SaveClipPath(
+      convex ? geometry.color_range : geometry.stencil_front_range,
+      geometry.stencil_back_range, bound_range, state_.CurrentMatrix(),
+      folded);
 
-  EnqueueDrawOp(std::move(draw));
+  EnqueueClipPush(state_.CurrentClipStackValue(), level);
 }
 
 void HWCanvas::onDrawLine(float x0, float y0, float x1, float y1,
@@ -257,11 +355,133 @@ void HWCanvas::onDrawLine(float x0, float y0, float x1, float y1,
 
   draw->SetStrokeWidth(paint.getStrokeWidth());
   draw->SetColorRange(range);
+  SetDeviceBounds(draw.get(), raster.RasterBounds(), paint.getStrokeWidth());
 
   EnqueueDrawOp(std::move(draw), raster.RasterBounds(), paint.getMaskFilter());
 }
 
 void HWCanvas::onDrawPath(const Path& path, const Paint& paint) {
+  HWBlurCache::Key blur_key{};
+  bool cacheable = HWBlurCache::MakePathKey(path, paint, state_.CurrentMatrix(),
+                                            &blur_key);
+
+  DrawPath(path, paint, cacheable ? &blur_key : nullptr, true);
+}
+
+void HWCanvas::onDrawRRect(RRect const& rrect, Paint const& paint) {
+  HWBlurCache::Key blur_key{};
+  bool cacheable = HWBlurCache::MakeRRectKey(rrect, paint,
+                                             state_.CurrentMatrix(), &blur_key);
+
+  if (cacheable && DrawCachedBlur(blur_key, paint)) {
+    return;
+  }
+
+  if (DrawAnalyticRRect(rrect, paint, cacheable ? &blur_key : nullptr)) {
+    return;
+  }
+
+  // path built here gets a new generation id every time, so blur is keyed on
+  // the rrect instead and the geometry is not cached at all
+  Path path;
+  path.addRRect(rrect);
+  path.setConvexityType(Path::ConvexityType::kConvex);
+
+  DrawPath(path, paint, cacheable ? &blur_key : nullptr, false);
+}
+
+bool HWCanvas::DrawAnalyticRRect(RRect const& rrect, Paint const& paint,
+                                 HWBlurCache::Key const* blur_key) {
+  if (!GetPipeline()->SupportAnalyticShape() || paint.getPathEffect()) {
+    return false;
+  }
+
+  if (!rrect.isSimple() && !rrect.isOval()) {
+    return false;
+  }
+
+  Vec2 radii = rrect.getSimpleRadii();
+  if (radii.x <= 0.f || radii.y <= 0.f) {
+    return false;
+  }
+
+  Matrix matrix = state_.CurrentMatrix();
+  if (matrix[0][3] != 0.f || matrix[1][3] != 0.f || matrix[3][3] != 1.f) {
+    return false;
+  }
+
+  bool need_fill = paint.getStyle() != Paint::kStroke_Style;
+  bool need_stroke = paint.getStyle() != Paint::kFill_Style;
+  bool stroke_and_fill = need_fill && need_stroke;
+
+  if (need_stroke) {
+    // stroke coverage is a ring between two circles, elliptical corners and
+    // strokes wider than corners fall back to path
+    float stroke_radius = paint.getStrokeWidth() * 0.5f;
+    if (radii.x != radii.y || stroke_radius <= 0.f ||
+        stroke_radius >= radii.x) {
+      return false;
+    }
+
+    float ratio = (radii.x - stroke_radius) / (radii.x + stroke_radius);
+    if (std::round(ratio * HW_VERTEX_RRECT_STEPS) < 1.f) {
+      return false;
+    }
+  }
+
+  if (FloatNearlyZero(paint.getAlphaF())) {
+    return true;
+  }
+
+  // one device pixel in local space
+  float scale = std::min(glm::length(glm::vec2{matrix[0]}),
+                         glm::length(glm::vec2{matrix[1]}));
+  float aa_margin = scale > 0.f ? 1.f / scale : 1.f;
+
+  if (stroke_and_fill) {
+    PushDrawList();
+  }
+
+  Paint working_paint{paint};
+  Rect bounds;
+
+  for (bool stroke : {false, true}) {
+    if ((stroke && !need_stroke) || (!stroke && !need_fill)) {
+      continue;
+    }
+
+    working_paint.setStyle(stroke ? Paint::kStroke_Style
+                                  : Paint::kFill_Style);
+
+    HWGeometryRaster raster(GetMesh(), working_paint, SupportGeometryShader());
+    raster.RasterAnalyticRRect(rrect, aa_margin);
+    raster.FlushRaster();
+
+    // coverage is computed per fragment without uniforms, so the draw stays
+    // mergeable with other color draws
+    auto draw = GenerateColorOp(working_paint, stroke, raster.RasterBounds());
+    draw->SetColorRange({raster.ColorStart(), raster.ColorCount()});
+    SetDeviceBounds(draw.get(), raster.RasterBounds(), 0.f);
+
+    if (stroke_and_fill) {
+      bounds.join(raster.RasterBounds());
+      EnqueueDrawOp(std::move(draw));
+    } else {
+      EnqueueDrawOp(std::move(draw), raster.RasterBounds(),
+                    paint.getMaskFilter(), blur_key);
+    }
+  }
+
+  if (stroke_and_fill) {
+    HandleMaskFilter(PopDrawList(), bounds, paint.getMaskFilter(), blur_key);
+  }
+
+  return true;
+}
+
+void HWCanvas::DrawPath(Path const& path, Paint const& paint,
+                        HWBlurCache::Key const* blur_key,
+                        bool cache_geometry) {
   bool need_fill = paint.getStyle() != Paint::kStroke_Style;
   bool need_stroke = paint.getStyle() != Paint::kFill_Style;
 
@@ -271,6 +491,10 @@ void HWCanvas::onDrawPath(const Path& path, const Paint& paint) {
     return;
   }
 
+  if (blur_key && DrawCachedBlur(*blur_key, paint)) {
+    return;
+  }
+
   if (stroke_and_fill) {
     PushDrawList();
   }
@@ -281,75 +505,72 @@ void HWCanvas::onDrawPath(const Path& path, const Paint& paint) {
   if (need_fill) {
     working_paint.setStyle(Paint::kFill_Style);
 
-    HWPathRaster raster{GetMesh(), working_paint, SupportGeometryShader()};
+    HWGeometry geometry;
     Path dst;
     if (paint.getPathEffect() &&
         paint.getPathEffect()->filterPath(&dst, path, false, working_paint)) {
-      raster.FillPath(dst);
+      geometry = RasterPath(dst, working_paint, false);
     } else {
-      raster.FillPath(path);
+      geometry = RasterPath(path, working_paint, cache_geometry);
     }
-    raster.FlushRaster();
 
-    auto draw = GenerateColorOp(working_paint, false, raster.RasterBounds());
+    auto draw = GenerateColorOp(working_paint, false, geometry.bounds);
 
     draw->SetEvenOddFill(path.getFillType() == Path::PathFillType::kEvenOdd);
 
-    draw->SetStencilRange(
-        {raster.StencilFrontStart(), raster.StencilFrontCount()},
-        {raster.StencilBackStart(), raster.StencilBackCount()});
-    draw->SetColorRange({raster.ColorStart(), raster.ColorCount()});
+    draw->SetStencilRange(geometry.stencil_front_range,
+                          geometry.stencil_back_range);
+    draw->SetColorRange(geometry.color_range);
+    SetDeviceBounds(draw.get(), geometry.bounds, 0.f);
 
     if (stroke_and_fill) {
-      bounds = raster.RasterBounds();
+      bounds = geometry.bounds;
       EnqueueDrawOp(std::move(draw));
     } else {
-      EnqueueDrawOp(std::move(draw), raster.RasterBounds(),
-                    paint.getMaskFilter());
+      EnqueueDrawOp(std::move(draw), geometry.bounds, paint.getMaskFilter(),
+                    blur_key);
     }
   }
 
   if (need_stroke) {
     working_paint.setStyle(Paint::kStroke_Style);
 
-    HWPathRaster raster{GetMesh(), working_paint, SupportGeometryShader()};
-
+    HWGeometry geometry;
     Path dst;
     if (paint.getPathEffect() &&
         paint.getPathEffect()->filterPath(&dst, path, true, working_paint)) {
-      raster.StrokePath(dst);
+      geometry = RasterPath(dst, working_paint, false);
     } else {
-      raster.StrokePath(path);
+      geometry = RasterPath(path, working_paint, cache_geometry);
     }
 
-    raster.FlushRaster();
-
     // handle hairline
     if (paint.getStrokeWidth() < 0.5f) {
       float alpha = paint.getStrokeWidth() / 0.5f;
       working_paint.setAlphaF(alpha * paint.getAlphaF());
     }
 
-    auto draw = GenerateColorOp(working_paint, true, raster.RasterBounds());
+    auto draw = GenerateColorOp(working_paint, true, geometry.bounds);
 
     draw->SetStrokeWidth(std::max(paint.getStrokeWidth(), 0.5f));
 
-    draw->SetStencilRange(
-        {raster.StencilFrontStart(), raster.StencilFrontCount()},
-        {raster.StencilBackStart(), raster.StencilBackCount()});
-    draw->SetColorRange({raster.ColorStart(), raster.ColorCount()});
+    draw->SetStencilRange(geometry.stencil_front_range,
+                          geometry.stencil_back_range);
+    draw->SetColorRange(geometry.color_range);
+    SetDeviceBounds(draw.get(), geometry.bounds,
+                    std::max(paint.getStrokeWidth(), 0.5f));
 
     if (stroke_and_fill) {
-      bounds.join(raster.RasterBounds());
+      bounds.join(geometry.bounds);
       EnqueueDrawOp(std::move(draw));
     } else {
-      EnqueueDrawOp(std::move(draw), raster.RasterBounds(),
-                    paint.getMaskFilter());
+      EnqueueDrawOp(std::move(draw), geometry.bounds, paint.getMaskFilter(),
+                    blur_key);
     }
   }
 
   if (stroke_and_fill) {
-    HandleMaskFilter(PopDrawList(), bounds, paint.getMaskFilter());
+    HandleMaskFilter(PopDrawList(), bounds, paint.getMaskFilter(), blur_key);
   }
 }
 
@@ -358,6 +579,14 @@ void HWCanvas::onDrawRect(Rect const& rect, Paint const& paint) {
     return;
   }
 
+  HWBlurCache::Key blur_key{};
+  bool cacheable = HWBlurCache::MakeRectKey(rect, paint, state_.CurrentMatrix(),
+                                            &blur_key);
+
+  if (cacheable && DrawCachedBlur(blur_key, paint)) {
+    return;
+  }
+
   Paint work_paint{paint};
   bool need_fill = paint.getStyle() != Paint::kStroke_Style;
   bool need_stroke = paint.getStyle() != Paint::kFill_Style;
@@ -379,13 +608,14 @@ void HWCanvas::onDrawRect(Rect const& rect, Paint const& paint) {
 
     auto draw = GenerateColorOp(work_paint, false, raster.RasterBounds());
     draw->SetColorRange(range);
+    SetDeviceBounds(draw.get(), raster.RasterBounds(), 0.f);
 
     if (stroke_and_fill) {
       bounds.join(raster.RasterBounds());
       EnqueueDrawOp(std::move(draw));
     } else {
       EnqueueDrawOp(std::move(draw), raster.RasterBounds(),
-                    paint.getMaskFilter());
+                    paint.getMaskFilter(), cacheable ? &blur_key : nullptr);
     }
   }
 
@@ -402,18 +632,21 @@ void HWCanvas::onDrawRect(Rect const& rect, Paint const& paint) {
 
     draw->SetStrokeWidth(work_paint.getStrokeWidth());
     draw->SetColorRange(range);
+    SetDeviceBounds(draw.get(), raster.RasterBounds(),
+                    work_paint.getStrokeWidth());
 
     if (stroke_and_fill) {
       bounds.join(raster.RasterBounds());
       EnqueueDrawOp(std::move(draw));
     } else {
       EnqueueDrawOp(std::move(draw), raster.RasterBounds(),
-                    paint.getMaskFilter());
+                    paint.getMaskFilter(), cacheable ? &blur_key : nullptr);
     }
   }
 
   if (stroke_and_fill) {
-    HandleMaskFilter(PopDrawList(), bounds, paint.getMaskFilter());
+    HandleMaskFilter(PopDrawList(), bounds, paint.getMaskFilter(),
+                     cacheable ? &blur_key : nullptr);
   }
 }
 
@@ -439,13 +672,13 @@ void HWCanvas::onDrawBlob(const TextBlob* blob, float x, float y,
     working_paint.setStyle(Paint::kFill_Style);
 
     bool need_path_fill = paint.getTextSize() >= paint.getFontThreshold();
-    float offset_x = 0.f;
-    for (auto const& run : blob->getTextRun()) {
-      if (need_path_fill) {
+    if (need_path_fill) {
+      float offset_x = 0.f;
+      for (auto const& run : blob->getTextRun()) {
         offset_x += FillTextRunWithPath(x + offset_x, y, run, working_paint);
-      } else {
-        offset_x += FillTextRun(x + offset_x, y, run, working_paint);
       }
+    } else {
+      FillTextRuns(x, y, blob->getTextRun(), working_paint);
     }
   }
 
@@ -465,20 +698,24 @@ void HWCanvas::onDrawBlob(const TextBlob* blob, float x, float y,
 void HWCanvas::onSave() { state_.Save(); }
 
 void HWCanvas::onRestore() {
-  // step 1 check if there is clip path need clean
-  ClearClipMask();
+  // step 1 revert stencil levels of clips in current save level
+  bool rebuild = RevertClipMask(state_.SaveCount() - 1);
   // step 2 restore state
   state_.Restore();
-  // step 3 check if there is clip path need to apply
-  ForwardFillClipMask();
+  // step 3 folded clip can not be reverted, apply remaining clips again
+  if (rebuild) {
+    RebuildClipMask();
+  }
 }
 
 void HWCanvas::onRestoreToCount(int saveCount) {
-  ClearClipMask();
+  bool rebuild = RevertClipMask(saveCount + 1);
 
   state_.RestoreToCount(saveCount + 1);
-  // step 3 check if there is clip path need to apply
-  ForwardFillClipMask();
+
+  if (rebuild) {
+    RebuildClipMask();
+  }
 }
 
 void HWCanvas::onTranslate(float dx, float dy) { state_.Translate(dx, dy); }
@@ -496,6 +733,9 @@ void HWCanvas::onConcat(const Matrix& matrix) { state_.Concat(matrix); }
 void HWCanvas::onFlush() {
   render_target_cache_.BeginFrame();
 
+  HWDrawBatcher batcher{GetMesh()};
+  batcher.Batch(&CurrentDrawList());
+
   mesh_->UploadMesh(GetPipeline());
   GetPipeline()->Bind();
   // global props set to pipeline
@@ -508,21 +748,130 @@ void HWCanvas::onFlush() {
   GetPipeline()->UnBind();
 
   ClearDrawList();
+  for (auto const& it : font_texture_store_) {
+    it.second->EndFrame();
+  }
+  glyph_path_cache_.EndFrame();
+  geometry_cache_.EndFrame(GetMesh());
   mesh_->ResetMesh();
   global_alpha_.Reset();
   full_rect_start_ = full_rect_count_ = -1;
   render_target_cache_.EndFrame();
+  blur_cache_.EndFrame();
+  gradient_cache_.EndFrame();
+  image_cache_.EndFrame();
 }
 
-HWTexture* HWCanvas::QueryTexture(Pixmap* pixmap) {
-  auto it = image_texture_store_.find(pixmap);
+HWGeometry HWCanvas::RasterPath(Path const& path, Paint const& paint,
+                                bool cacheable) {
+  Matrix matrix = state_.CurrentMatrix();
 
-  if (it != image_texture_store_.end()) {
-    return it->second.get();
+  HWGeometryCache::Key key{};
+  if (cacheable) {
+    key = HWGeometryCache::MakeKey(path, paint, matrix);
+
+    auto cached = geometry_cache_.QueryGeometry(key);
+    if (cached) {
+      return *cached;
+    }
+  }
+
+  HWMeshRegion region{};
+  region.vertex_start = GetMesh()->VertexBase();
+  region.index_start = GetMesh()->IndexBase();
+
+  // flatten curves for the upper scale of the cache class, so cached geometry
+  // is valid for every transform hitting the same key
+  float scale = std::ldexp(1.f, HWGeometryCache::ScaleClass(matrix));
+
+  HWPathRaster raster{GetMesh(), paint, SupportGeometryShader(), scale};
+  // circle centers of round joins may move by a sixteenth of a pixel when
+  // stored as half floats
+  raster.SetCenterTolerance(1.f / (16.f * scale));
+  if (paint.getStyle() == Paint::kStroke_Style) {
+    raster.StrokePath(path);
+  } else {
+    raster.FillPath(path);
+  }
+  raster.FlushRaster();
+
+  HWGeometry geometry{};
+  geometry.stencil_front_range = {raster.StencilFrontStart(),
+                                  raster.StencilFrontCount()};
+  geometry.stencil_back_range = {raster.StencilBackStart(),
+                                 raster.StencilBackCount()};
+  geometry.color_range = {raster.ColorStart(), raster.ColorCount()};
+  geometry.bounds = raster.RasterBounds();
+
+  if (cacheable) {
+    region.vertex_count = GetMesh()->VertexBase() - region.vertex_start;
+    region.index_count = GetMesh()->IndexBase() - region.index_start;
+
+    geometry_cache_.StoreGeometry(key, region, geometry);
+  }
+
+  return geometry;
+}
+
+void HWCanvas::SetDeviceBounds(HWDraw* draw, Rect const& bounds,
+                               float outset) {
+  Rect device_bounds;
+
+  if (!MapDeviceBounds(bounds, outset, &device_bounds)) {
+    // perspective bounds is not reliable, leave this draw unbatched
+    return;
+  }
+
+  // one more pixel for anti-alias
+  draw->SetBounds(Rect::MakeLTRB(
+      device_bounds.left() - 1.f, device_bounds.top() - 1.f,
+      device_bounds.right() + 1.f, device_bounds.bottom() + 1.f));
+}
+
+bool HWCanvas::MapDeviceBounds(Rect const& bounds, float outset,
+                               Rect* device_bounds) {
+  Matrix matrix = state_.CurrentMatrix();
+
+  if (matrix[0][3] != 0.f || matrix[1][3] != 0.f || matrix[3][3] != 1.f) {
+    return false;
+  }
+
+  std::array<glm::vec4, 4> corners{
+      glm::vec4{bounds.left() - outset, bounds.top() - outset, 0.f, 1.f},
+      glm::vec4{bounds.right() + outset, bounds.top() - outset, 0.f, 1.f},
+      glm::vec4{bounds.right() + outset, bounds.bottom() + outset, 0.f, 1.f},
+      glm::vec4{bounds.left() - outset, bounds.bottom() + outset, 0.f, 1.f},
+  };
+
+  glm::vec2 min = matrix * corners[0];
+  glm::vec2 max = min;
+  for (auto const& corner : corners) {
+    glm::vec2 p = matrix * corner;
+    min = glm::min(min, p);
+    max = glm::max(max, p);
+  }
+
+  if (FloatIsNan(min.x) || FloatIsNan(min.y) || FloatIsNan(max.x) ||
+      FloatIsNan(max.y)) {
+    return false;
+  }
+
+  *device_bounds = Rect::MakeLTRB(min.x, min.y, max.x, max.y);
+
+  return true;
+}
+
+HWTexture* HWCanvas::QueryTexture(std::shared_ptr<Pixmap> const& pixmap,
+                                  HWTexture::Filter filter) {
+  auto cached = image_cache_.QueryTexture(*pixmap, filter);
+
+  if (cached) {
+    return cached;
   }
 
   auto texture = GenerateTexture();
 
+  texture->SetFilter(filter);
   texture->Init(HWTexture::Type::kColorTexture, HWTexture::Format::kRGBA);
 
   texture->Bind();
@@ -530,12 +879,11 @@ HWTexture* HWCanvas::QueryTexture(Pixmap* pixmap) {
   texture->Resize(pixmap->Width(), pixmap->Height());
   texture->UploadData(0, 0, pixmap->Width(), pixmap->Height(),
                       (void*)pixmap->Addr());
+  texture->GenerateMipmaps();
   // can we move this function call ?
   texture->UnBind();
 
-  image_texture_store_[pixmap] = std::move(texture);
-
-  return image_texture_store_[pixmap].get();
+  return image_cache_.StoreTexture(pixmap, filter, std::move(texture));
 }
 
 HWFontTexture* HWCanvas::QueryFontTexture(Typeface* typeface) {
@@ -555,69 +903,127 @@ HWFontTexture* HWCanvas::QueryFontTexture(Typeface* typeface) {
   return font_texture_store_[typeface].get();
 }
 
-HWRenderTarget* HWCanvas::QueryRenderTarget(Rect const& bounds) {
-  uint32_t width = bounds.width();
-  uint32_t height = bounds.height();
+HWRenderTarget* HWCanvas::QueryRenderTarget(uint32_t width, uint32_t height) {
   auto target = render_target_cache_.QueryTarget(width, height);
 
   if (target) {
     return target;
   }
 
+  auto size = HWRenderTargetCache::BucketSize(width, height);
+
   return render_target_cache_.StoreCache(
-      GenerateBackendRenderTarget(width, height));
+      GenerateBackendRenderTarget(size.width, size.height));
 }
 
-float HWCanvas::FillTextRun(float x, float y, TextRun const& run,
+void HWCanvas::FillTextRuns(float x, float y, std::vector<TextRun> const& runs,
                             Paint const& paint) {
-  auto typeface = run.lockTypeface();
-
-  if (typeface == nullptr) {
-    return 0.f;
-  }
+  HWPathRaster raster{GetMesh(), paint, SupportGeometryShader()};
 
-  float offset_x = x;
+  HWFontTexture* font_texture = nullptr;
+  // quads in current draw
+  Rect bounds;
+  float draw_start = x;
   float max_height = 0.f;
+  float offset_x = x;
 
-  HWPathRaster raster{GetMesh(), paint, SupportGeometryShader()};
+  // glyphs which can not be put into atlas, drawn with path instead
+  struct PathGlyph {
+    std::shared_ptr<Typeface> typeface;
+    GlyphInfo const* info;
+    float x;
+  };
+  std::vector<PathGlyph> path_glyphs;
 
-  auto font_texture = QueryFontTexture(typeface.get());
+  auto flush_draw = [&]() {
+    raster.FlushRaster();
 
-  for (auto const& info : run.getGlyphInfo()) {
-    auto region =
-        font_texture->GetGlyphRegion(info.id, info.font_size * density_);
-    float rx = offset_x + info.bearing_x;
-    float ry = y - info.ascent;
-    float rw = region.z / density_;
-    float rh = region.w / density_;
+    if (font_texture && raster.ColorCount() > 0) {
+      auto draw = GenerateColorOp(
+          paint, false,
+          skity::Rect::MakeXYWH(draw_start, y, offset_x, max_height));
 
-    max_height = std::max(rh, max_height);
+      draw->SetColorRange({raster.ColorStart(), raster.ColorCount()});
+      draw->SetFontTexture(font_texture->GetHWTexture());
+      SetDeviceBounds(draw.get(), bounds, 0.f);
 
-    offset_x += info.advance_x;
+      EnqueueDrawOp(std::move(draw));
+    }
+
+    raster.ResetRaster();
+    bounds.setEmpty();
+    draw_start = offset_x;
+    max_height = 0.f;
+  };
 
-    if (rh == 0) {
+  for (auto const& run : runs) {
+    auto typeface = run.lockTypeface();
+
+    if (typeface == nullptr) {
       continue;
     }
 
-    glm::vec4 bounds = {rx, ry, rx + rw, ry + rh};
-    glm::vec2 uv_lt = font_texture->CalculateUV(region.x, region.y);
-    glm::vec2 uv_rb = font_texture->CalculateUV(region.x + region.z - 1.f,
-                                                region.y + region.w - 1.f);
+    auto run_texture = QueryFontTexture(typeface.get());
+    if (run_texture != font_texture) {
+      flush_draw();
+      font_texture = run_texture;
+    }
 
-    raster.FillTextRect(bounds, uv_lt, uv_rb);
-  }
+    for (auto const& info : run.getGlyphInfo()) {
+      float font_size = info.font_size * density_;
+      auto region = font_texture->GetGlyphRegion(info.id, font_size);
 
-  raster.FlushRaster();
+      if (region.x < 0) {
+        path_glyphs.emplace_back(PathGlyph{typeface, &info, offset_x});
+        offset_x += info.advance_x;
+        continue;
+      }
 
-  auto draw = GenerateColorOp(
-      paint, false, skity::Rect::MakeXYWH(x, y, offset_x, max_height));
+      // bitmap is rastered with quantized font size
+      float raster_size = FontTexture::QuantizeFontSize(font_size);
+      float scale = raster_size > 0.f ? font_size / raster_size : 1.f;
 
-  draw->SetColorRange({raster.ColorStart(), raster.ColorCount()});
-  draw->SetFontTexture(font_texture->GetHWTexture());
+      float rx = offset_x + info.bearing_x;
+      float ry = y - info.ascent;
+      float rw = region.z * scale / density_;
+      float rh = region.w * scale / density_;
 
-  EnqueueDrawOp(std::move(draw));
+      max_height = std::max(rh, max_height);
 
-  return offset_x - x;
+      offset_x += info.advance_x;
+
+      if (rh == 0) {
+        continue;
+      }
+
+      glm::vec4 quad = {rx, ry, rx + rw, ry + rh};
+      glm::vec2 uv_lt = font_texture->CalculateUV(region.x, region.y);
+      glm::vec2 uv_rb = font_texture->CalculateUV(region.x + region.z - 1.f,
+                                                  region.y + region.w - 1.f);
+
+      raster.FillTextRect(quad, uv_lt, uv_rb);
+
+      Rect quad_bounds = Rect::MakeLTRB(quad.x, quad.y, quad.z, quad.w);
+      if (bounds.isEmpty()) {
+        bounds = quad_bounds;
+      } else {
+        bounds.join(quad_bounds);
+      }
+    }
+  }
+
+  flush_draw();
+
+  for (auto const& glyph : path_glyphs) {
+    Path const& path = glyph_path_cache_.QueryPath(
+        glyph.typeface, *glyph.info, paint.getTextSize());
+
+    if (path.isEmpty()) {
+      continue;
+    }
+
+    DrawGlyphPath(path, glyph.x, y, paint, path.getBounds());
+  }
 }
 
 float HWCanvas::FillTextRunWithPath(float x, float y, TextRun const& run,
@@ -632,10 +1038,8 @@ float HWCanvas::FillTextRunWithPath(float x, float y, TextRun const& run,
 
   Rect bounds;
   for (auto const& info : run.getGlyphInfo()) {
-    Path path = info.path;
-    if (path.isEmpty() || info.path_font_size != paint.getTextSize()) {
-      path = typeface->getGlyphInfo(info.id, paint.getTextSize(), true).path;
-    }
+    Path const& path =
+        glyph_path_cache_.QueryPath(typeface, info, paint.getTextSize());
 
     if (bounds.isEmpty()) {
       bounds = path.getBounds();
@@ -643,22 +1047,9 @@ float HWCanvas::FillTextRunWithPath(float x, float y, TextRun const& run,
       bounds.join(path.getBounds());
     }
 
-    glm::mat4 transform =
-        glm::translate(glm::identity<glm::mat4>(), {offset_x, y, 0.f});
-
-    HWPathRaster raster{GetMesh(), paint, SupportGeometryShader()};
-    raster.FillPath(path.copyWithMatrix(transform));
-
-    raster.FlushRaster();
-
-    auto draw = GenerateColorOp(paint, false, bounds);
-
-    draw->SetStencilRange(
-        {raster.StencilFrontStart(), raster.StencilFrontCount()},
-        {raster.StencilBackStart(), raster.StencilBackCount()});
-    draw->SetColorRange({raster.ColorStart(), raster.ColorCount()});
-
-    EnqueueDrawOp(std::move(draw));
+    if (!path.isEmpty()) {
+      DrawGlyphPath(path, offset_x, y, paint, bounds);
+    }
 
     offset_x += info.advance_x;
   }
@@ -678,78 +1069,141 @@ float HWCanvas::StrokeTextRun(float x, float y, TextRun const& run,
   float max_height = 0.f;
 
   for (auto const& info : run.getGlyphInfo()) {
-    HWPathRaster raster{GetMesh(), paint, SupportGeometryShader()};
-    glm::mat4 transform =
-        glm::translate(glm::identity<glm::mat4>(), {offset_x, y, 0.f});
-
-    Path path = info.path.copyWithMatrix(transform);
-
-    if (path.isEmpty() || info.path_font_size != paint.getTextSize()) {
-      // Solve reused TextBlob without path info
-      path = typeface->getGlyphInfo(info.id, paint.getTextSize(), true)
-                 .path.copyWithMatrix(transform);
-    }
+    Path const& path =
+        glyph_path_cache_.QueryPath(typeface, info, paint.getTextSize());
 
     if (path.isEmpty()) {
+      offset_x += info.advance_x;
       continue;
     }
 
-    Rect bounds = path.getBounds();
-    max_height = std::max(max_height, bounds.height());
-
-    raster.StrokePath(path);
-    raster.FlushRaster();
+    max_height = std::max(max_height, path.getBounds().height());
 
-    auto draw = GenerateColorOp(
-        paint, true, Rect::MakeXYWH(offset_x, y, info.advance_x, max_height));
+    DrawGlyphPath(path, offset_x, y, paint,
+                  Rect::MakeXYWH(offset_x, y, info.advance_x, max_height));
 
     offset_x += info.advance_x;
+  }
 
-    draw->SetStrokeWidth(paint.getStrokeWidth());
-    draw->SetStencilRange(
-        {raster.StencilFrontStart(), raster.StencilFrontCount()},
-        {raster.StencilBackStart(), raster.StencilBackCount()});
-    draw->SetColorRange({raster.ColorStart(), raster.ColorCount()});
+  return offset_x - x;
+}
 
-    EnqueueDrawOp(std::move(draw));
+void HWCanvas::DrawGlyphPath(Path const& path, float x, float y,
+                             Paint const& paint, Rect const& shader_bounds) {
+  bool stroke = paint.getStyle() == Paint::kStroke_Style;
+  HWGeometry geometry;
+
+  if (paint.getShader()) {
+    // shaders are mapped in user space, so geometry has to be there too
+    Path placed = path.copyWithMatrix(
+        glm::translate(glm::identity<glm::mat4>(), {x, y, 0.f}));
+
+    geometry = RasterPath(placed, paint, false);
+  } else {
+    // tessellate in glyph space with glyph origin moved by transform, so
+    // geometry of the same glyph is reused wherever it is drawn
+    state_.Save();
+    state_.Translate(x, y);
+
+    geometry = RasterPath(path, paint, true);
   }
 
-  return offset_x - x;
+  auto draw = GenerateColorOp(paint, stroke, shader_bounds);
+
+  if (stroke) {
+    draw->SetStrokeWidth(paint.getStrokeWidth());
+  }
+  draw->SetStencilRange(geometry.stencil_front_range,
+                        geometry.stencil_back_range);
+  draw->SetColorRange(geometry.color_range);
+  SetDeviceBounds(draw.get(), geometry.bounds,
+                  stroke ? paint.getStrokeWidth() : 0.f);
+
+  EnqueueDrawOp(std::move(draw));
+
+  if (!paint.getShader()) {
+    // next draw sets the canvas matrix again
+    state_.Restore();
+  }
 }
 
-void HWCanvas::ClearClipMask() {
-  if (!state_.NeedRevertClipStencil()) {
-    return;
+bool HWCanvas::RevertClipMask(size_t save_count) {
+  size_t count = state_.ClipCountAtSaveCount(save_count);
+  size_t size = state_.ClipStackSize();
+
+  if (count == size) {
+    return false;
   }
 
-  auto clip_info = state_.CurrentClipStackValue();
-  auto draw = std::make_unique<HWDraw>(GetPipeline(),
-                                       false,  // no need to handle clip mask
-                                       true);
-  draw->SetClearStencilClip(true);
-  draw->SetTransformMatrix(clip_info.stack_matrix);
+  uint32_t level = state_.CurrentClipLevel();
 
-  if (clip_info.bound_range.count > 0) {
-    draw->SetColorRange(clip_info.bound_range);
-  } else {
-    draw->SetStencilRange(clip_info.front_range, clip_info.back_range);
+  for (size_t i = count; i < size; i++) {
+    if (state_.ClipStackAt(i).folded) {
+      EnqueueClipPop(FullRectRange(), level, 0);
+      return true;
+    }
+  }
+
+  uint32_t target_level =
+      count == 0 ? 0 : state_.ClipStackAt(count - 1).stencil_level;
+
+  // pixels above target level are all inside the first popped clip
+  EnqueueClipPop(state_.ClipStackAt(count).bound_range, level, target_level);
+
+  return false;
+}
+
+void HWCanvas::RebuildClipMask() {
+  uint32_t level = 0;
+
+  for (size_t i = 0; i < state_.ClipStackSize(); i++) {
+    auto const& clip = state_.ClipStackAt(i);
+
+    EnqueueClipPush(clip, level);
+    level = clip.stencil_level;
   }
+}
+
+void HWCanvas::EnqueueClipPush(HWCanvasState::ClipStackValue const& clip,
+                               uint32_t level) {
+  auto draw = std::make_unique<HWDraw>(GetPipeline(), level > 0, true);
+
+  draw->SetClipLevel(level);
+  draw->SetClipTargetLevel(clip.stencil_level);
+  draw->SetTransformMatrix(clip.stack_matrix);
+  draw->SetStencilRange(clip.front_range, clip.back_range);
+  draw->SetColorRange(clip.bound_range);
 
   EnqueueDrawOp(std::move(draw));
 }
 
-void HWCanvas::ForwardFillClipMask() {
-  state_.ForEachClipStackValue(
-      [this](HWCanvasState::ClipStackValue const& clip_value, size_t i) {
-        bool has_clip = i != 0;
-        auto draw = std::make_unique<HWDraw>(GetPipeline(), has_clip, true);
+void HWCanvas::EnqueueClipPop(HWDrawRange const& cover, uint32_t level,
+                              uint32_t target_level) {
+  // cover is in device space, no need to handle clip mask
+  auto draw = std::make_unique<HWDraw>(GetPipeline(), false, true);
 
-        draw->SetTransformMatrix(clip_value.stack_matrix);
-        draw->SetStencilRange(clip_value.front_range, clip_value.back_range);
-        draw->SetColorRange(clip_value.bound_range);
+  draw->SetClipLevel(level);
+  draw->SetClipTargetLevel(target_level);
+  draw->SetColorRange(cover);
 
-        EnqueueDrawOp(std::move(draw));
-      });
+  EnqueueDrawOp(std::move(draw));
+}
+
+HWDrawRange HWCanvas::FullRectRange() {
+  if (full_rect_start_ == -1) {
+    Paint paint;
+    paint.setStyle(Paint::kFill_Style);
+
+    HWPathRaster raster{GetMesh(), paint, SupportGeometryShader()};
+    raster.RasterRect(Rect::MakeXYWH(0, 0, width_, height_));
+    raster.FlushRaster();
+
+    full_rect_start_ = raster.ColorStart();
+    full_rect_count_ = raster.ColorCount();
+  }
+
+  return {static_cast<uint32_t>(full_rect_start_),
+          static_cast<uint32_t>(full_rect_count_)};
 }
 
 HWCanvas::DrawList& HWCanvas::CurrentDrawList() {
@@ -779,61 +1233,38 @@ void HWCanvas::EnqueueDrawOp(std::unique_ptr<HWDraw> draw) {
 }
 
 void HWCanvas::EnqueueDrawOp(std::unique_ptr<HWDraw> draw, Rect const& bounds,
-                             std::shared_ptr<MaskFilter> const& mask_filter) {
+                             std::shared_ptr<MaskFilter> const& mask_filter,
+                             HWBlurCache::Key const* blur_key) {
   if (mask_filter) {
-    Rect filter_bounds = mask_filter->approximateFilteredBounds(bounds);
-    auto fbo = QueryRenderTarget(filter_bounds);
-
-    auto op = std::make_unique<PostProcessDraw>(
-        fbo, std::move(draw), filter_bounds, GetPipeline(), state_.HasClip());
-
-    Paint paint;
-    paint.setStyle(Paint::kFill_Style);
-    HWPathRaster raster{GetMesh(), paint, SupportGeometryShader()};
+    DrawList draw_list;
+    draw_list.emplace_back(std::move(draw));
 
-    raster.RasterRect(filter_bounds);
-    raster.FlushRaster();
-
-    op->SetColorRange({raster.ColorStart(), raster.ColorCount()});
-    op->SetPipelineColorMode(HWPipelineColorMode::kFBOTexture);
-    op->SetGradientBounds({filter_bounds.left(), filter_bounds.top()},
-                          {filter_bounds.right(), filter_bounds.bottom()});
-    op->SetBlurStyle(mask_filter->blurStyle());
-    op->SetBlurRadius(mask_filter->blurRadius());
-    op->SetTransformMatrix(state_.CurrentMatrix());
-    EnqueueDrawOp(std::move(op));
+    HandleMaskFilter(std::move(draw_list), bounds, mask_filter, blur_key);
   } else {
     EnqueueDrawOp(std::move(draw));
   }
 }
 
-void HWCanvas::HandleMaskFilter(
-    DrawList draw_list, Rect const& bounds,
-    std::shared_ptr<MaskFilter> const& mask_filter) {
+void HWCanvas::HandleMaskFilter(DrawList draw_list, Rect const& bounds,
+                                std::shared_ptr<MaskFilter> const& mask_filter,
+                                HWBlurCache::Key const* blur_key) {
   if (mask_filter) {
     Rect filter_bounds = mask_filter->approximateFilteredBounds(bounds);
 
-    auto fbo = QueryRenderTarget(filter_bounds);
-
-    auto op = std::make_unique<PostProcessDraw>(fbo, std::move(draw_list),
-                                                filter_bounds, GetPipeline(),
-                                                state_.HasClip());
+    uint32_t width = 0;
+    uint32_t height = 0;
+    filter_content_size(filter_bounds, *mask_filter, &width, &height);
 
-    Paint paint;
-    paint.setStyle(Paint::kFill_Style);
-    HWPathRaster raster{GetMesh(), paint, SupportGeometryShader()};
-
-    raster.RasterRect(filter_bounds);
-    raster.FlushRaster();
+    HWRenderTarget* fbo = nullptr;
+    if (blur_key && blur_cache_.ShouldCache(*blur_key, width, height)) {
+      fbo = blur_cache_.StoreTarget(
+          *blur_key, GenerateBackendRenderTarget(width, height), filter_bounds);
+    } else {
+      fbo = QueryRenderTarget(width, height);
+    }
 
-    op->SetColorRange({raster.ColorStart(), raster.ColorCount()});
-    op->SetPipelineColorMode(HWPipelineColorMode::kFBOTexture);
-    op->SetGradientBounds({filter_bounds.left(), filter_bounds.top()},
-                          {filter_bounds.right(), filter_bounds.bottom()});
-    op->SetBlurStyle(mask_filter->blurStyle());
-    op->SetBlurRadius(mask_filter->blurRadius());
-    op->SetTransformMatrix(state_.CurrentMatrix());
-    EnqueueDrawOp(std::move(op));
+    EnqueueDrawOp(GenerateFilterOp(fbo, std::move(draw_list), filter_bounds,
+                                   *mask_filter));
   } else {
     for (auto& op : draw_list) {
       CurrentDrawList().emplace_back(std::move(op));
@@ -841,4 +1272,64 @@ void HWCanvas::HandleMaskFilter(
   }
 }
 
+bool HWCanvas::DrawCachedBlur(HWBlurCache::Key const& key, Paint const& paint) {
+  Rect filter_bounds;
+  auto fbo = blur_cache_.QueryTarget(key, &filter_bounds);
+
+  if (!fbo) {
+    return false;
+  }
+
+  auto op = GenerateFilterOp(fbo, DrawList{}, filter_bounds,
+                             *paint.getMaskFilter());
+  op->SetFilterCached(true);
+
+  // composite pass uses the global alpha content draws would have set
+  if (!global_alpha_.IsValid() || *global_alpha_ != paint.getAlphaF()) {
+    global_alpha_.Set(paint.getAlphaF());
+    op->SetGlobalAlpha(paint.getAlphaF());
+  }
+
+  EnqueueDrawOp(std::move(op));
+
+  return true;
+}
+
+std::unique_ptr<PostProcessDraw> HWCanvas::GenerateFilterOp(
+    HWRenderTarget* target, DrawList draw_list, Rect const& filter_bounds,
+    MaskFilter const& mask_filter) {
+  // content only covers the top left part of pooled targets, offscreen passes
+  // and sampling both map these extended bounds onto the whole target
+  uint32_t width = 0;
+  uint32_t height = 0;
+  filter_content_size(filter_bounds, mask_filter, &width, &height);
+  Rect target_bounds = Rect::MakeXYWH(
+      filter_bounds.left(), filter_bounds.top(),
+      filter_bounds.width() * target->Width() / width,
+      filter_bounds.height() * target->Height() / height);
+
+  auto op = std::make_unique<PostProcessDraw>(target, std::move(draw_list),
+                                              target_bounds, GetPipeline(),
+                                              state_.HasClip());
+  op->SetClipLevel(state_.CurrentClipLevel());
+  op->SetScissorBox(state_.CurrentScissorBox());
+
+  Paint paint;
+  paint.setStyle(Paint::kFill_Style);
+  HWPathRaster raster{GetMesh(), paint, SupportGeometryShader()};
+
+  raster.RasterRect(filter_bounds);
+  raster.FlushRaster();
+
+  op->SetColorRange({raster.ColorStart(), raster.ColorCount()});
+  op->SetPipelineColorMode(HWPipelineColorMode::kFBOTexture);
+  op->SetGradientBounds({target_bounds.left(), target_bounds.top()},
+                        {target_bounds.right(), target_bounds.bottom()});
+  op->SetBlurStyle(mask_filter.blurStyle());
+  op->SetBlurRadius(mask_filter.blurRadius(), mask_filter.blurScale());
+  op->SetTransformMatrix(state_.CurrentMatrix());
+
+  return op;
+}
+
 }  // namespace skity
\ No newline at end of file
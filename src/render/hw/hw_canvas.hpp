@@ -8,9 +8,14 @@
 #include <vector>
 #include <string>
 
+#include "src/render/hw/hw_blur_cache.hpp"
 #include "src/render/hw/hw_canvas_state.hpp"
 #include "src/render/hw/hw_draw.hpp"
 #include "src/render/hw/hw_font_texture.hpp"
+#include "src/render/hw/hw_geometry_cache.hpp"
+#include "src/render/hw/hw_glyph_path_cache.hpp"
+#include "src/render/hw/hw_gradient_cache.hpp"
+#include "src/render/hw/hw_image_cache.hpp"
 #include "src/render/hw/hw_render_target.hpp"
 #include "src/render/hw/hw_texture.hpp"
 #include "src/utils/lazy.hpp"
@@ -48,11 +53,18 @@ class HWCanvas : public Canvas {
   virtual std::unique_ptr<HWRenderTarget> GenerateBackendRenderTarget(
       uint32_t width, uint32_t height) = 0;
 
+  // sample count of offscreen targets requested by GPUContext
+  uint32_t OffscreenSampleCount() const { return offscreen_sample_count_; }
+
   void onDrawLine(float x0, float y0, float x1, float y1,
                   Paint const& paint) override;
 
   void onDrawRect(Rect const& rect, Paint const& paint) override;
 
+  void onDrawRRect(RRect const& rrect, Paint const& paint) override;
+
+  void onClipRect(Rect const& rect, ClipOp op) override;
+
   void onClipPath(const Path& path, ClipOp op) override;
 
   void onDrawPath(const Path& path, const Paint& paint) override;
@@ -84,6 +96,14 @@ class HWCanvas : public Canvas {
 
   void onUpdateViewport(uint32_t width, uint32_t height) override;
 
+  void onSetImageCacheLimit(size_t bytes) override;
+
+  void onPurgeUnusedResources() override;
+
+  ImageCacheStats onGetImageCacheStats() const override;
+
+  GlyphAtlasStats onGetGlyphAtlasStats() const override;
+
   HWMesh* GetMesh();
 
   glm::mat4 GetCurrentMVP() const { return mvp_; }
@@ -97,18 +117,103 @@ class HWCanvas : public Canvas {
                                           bool stroke = false,
                                           Rect const& = {});
 
+  /**
+   * Fill or stroke path according to paint style, reuse geometry from
+   * geometry_cache_ if cacheable is true.
+   */
+  HWGeometry RasterPath(Path const& path, Paint const& paint, bool cacheable);
+
+  /**
+   * @param blur_key        key of the shape in blur_cache_, nullptr if the
+   *                        draw is not cacheable
+   * @param cache_geometry  false for temporary paths built by the canvas,
+   *                        whose generation id is never seen again
+   */
+  void DrawPath(Path const& path, Paint const& paint,
+                HWBlurCache::Key const* blur_key, bool cache_geometry);
+
+  /**
+   * Same as onClipPath, geometry of path is cached only if cache_geometry is
+   * true.
+   */
+  void ClipPath(Path const& path, ClipOp op, bool cache_geometry);
+
+  /**
+   * Draw simple rrect and oval with coverage computed in fragment shader,
+   * without stencil pass.
+   *
+   * @return false if the shape or pipeline is not supported, caller needs to
+   *         draw it as path
+   */
+  bool DrawAnalyticRRect(RRect const& rrect, Paint const& paint,
+                         HWBlurCache::Key const* blur_key);
+
+  /**
+   * Composite filtered result drawn in previous frames.
+   *
+   * @return false if blur_cache_ has no result of key
+   */
+  bool DrawCachedBlur(HWBlurCache::Key const& key, Paint const& paint);
+
+  /**
+   * Map local bounds of draw into device space for HWDrawBatcher.
+   *
+   * @param outset  local space outset for geometry expanded in shader
+   */
+  void SetDeviceBounds(HWDraw* draw, Rect const& bounds, float outset);
+
+  /**
+   * Map local bounds by current matrix, without anti-alias outset.
+   *
+   * @return false if the matrix has perspective and bounds is not reliable
+   */
+  bool MapDeviceBounds(Rect const& bounds, float outset, Rect* device_bounds);
+
   HWRenderer* GetPipeline() { return renderer_.get(); }
-  HWTexture* QueryTexture(Pixmap* pixmap);
+  HWTexture* QueryTexture(std::shared_ptr<Pixmap> const& pixmap,
+                          HWTexture::Filter filter);
   HWFontTexture* QueryFontTexture(Typeface* typeface);
-  HWRenderTarget* QueryRenderTarget(Rect const& bounds);
-
-  float FillTextRun(float x, float y, TextRun const& run, Paint const& paint);
+  HWRenderTarget* QueryRenderTarget(uint32_t width, uint32_t height);
+
+  /**
+   * Fill glyph bitmaps of all runs, consecutive runs sharing a font texture
+   * are drawn with a single draw.
+   */
+  void FillTextRuns(float x, float y, std::vector<TextRun> const& runs,
+                    Paint const& paint);
   float FillTextRunWithPath(float x, float y, TextRun const& run,
                             Paint const& paint);
   float StrokeTextRun(float x, float y, TextRun const& run, Paint const& paint);
 
-  void ClearClipMask();
-  void ForwardFillClipMask();
+  /**
+   * Fill or stroke glyph outline with its origin placed at (x, y).
+   *
+   * @param path          glyph outline from glyph_path_cache_
+   * @param shader_bounds bounds used to map paint shader
+   */
+  void DrawGlyphPath(Path const& path, float x, float y, Paint const& paint,
+                     Rect const& shader_bounds);
+
+  /**
+   * Revert stencil clip levels of clips popped by restoring to save_count,
+   * need to be called before state_ is restored.
+   *
+   * @return true if a folded clip is popped, the stencil clip is cleared and
+   *         RebuildClipMask needs to be called after state_ is restored
+   */
+  bool RevertClipMask(size_t save_count);
+
+  // fill every clip left in stack again
+  void RebuildClipMask();
+
+  void EnqueueClipPush(HWCanvasState::ClipStackValue const& clip,
+                       uint32_t level);
+
+  void EnqueueClipPop(HWDrawRange const& cover, uint32_t level,
+                      uint32_t target_level);
+
+  // full canvas rect in device space, rastered once per frame
+  HWDrawRange FullRectRange();
 
   DrawList& CurrentDrawList();
 
@@ -121,10 +226,16 @@ class HWCanvas : public Canvas {
   void EnqueueDrawOp(std::unique_ptr<HWDraw> draw);
 
   void EnqueueDrawOp(std::unique_ptr<HWDraw> draw, Rect const& bounds,
-                     std::shared_ptr<MaskFilter> const& mask_filter);
+                     std::shared_ptr<MaskFilter> const& mask_filter,
+                     HWBlurCache::Key const* blur_key = nullptr);
 
   void HandleMaskFilter(DrawList draw_list, Rect const& bounds,
-                        std::shared_ptr<MaskFilter> const& mask_filter);
+                        std::shared_ptr<MaskFilter> const& mask_filter,
+                        HWBlurCache::Key const* blur_key = nullptr);
+
+  std::unique_ptr<PostProcessDraw> GenerateFilterOp(
+      HWRenderTarget* target, DrawList draw_list, Rect const& filter_bounds,
+      MaskFilter const& mask_filter);
 
  private:
   Matrix mvp_;
@@ -133,14 +244,19 @@ class HWCanvas : public Canvas {
   int32_t full_rect_start_ = -1;
   int32_t full_rect_count_ = -1;
   float density_ = 2.f;
+  uint32_t offscreen_sample_count_ = 0;
   HWCanvasState state_;
   std::unique_ptr<HWMesh> mesh_;
   Lazy<float> global_alpha_ = {};
   std::unique_ptr<HWRenderer> renderer_ = {};
   std::vector<DrawList> draw_list_stack_ = {};
-  std::map<Pixmap*, std::unique_ptr<HWTexture>> image_texture_store_ = {};
   std::map<Typeface*, std::unique_ptr<HWFontTexture>> font_texture_store_ = {};
   HWRenderTargetCache render_target_cache_ = {};
+  HWGeometryCache geometry_cache_ = {};
+  HWGlyphPathCache glyph_path_cache_ = {};
+  HWBlurCache blur_cache_ = {};
+  HWGradientCache gradient_cache_ = {};
+  HWImageCache image_cache_ = {};
 };
 
 }  // namespace skity
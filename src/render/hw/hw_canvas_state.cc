@@ -8,6 +8,7 @@ namespace skity {
 HWCanvasState::HWCanvasState() {
   // init first stack matrix
   matrix_state_.emplace_back(glm::identity<Matrix>());
+  scissor_state_.emplace_back(Lazy<Rect>());
 }
 
 void HWCanvasState::Save() { PushMatrixStack(); }
@@ -22,13 +23,12 @@ void HWCanvasState::Restore() {
 
 void HWCanvasState::RestoreToCount(int save_count) {
   matrix_state_.erase(matrix_state_.begin() + save_count, matrix_state_.end());
+  scissor_state_.erase(scissor_state_.begin() + save_count,
+                       scissor_state_.end());
 
-  auto pend = std::remove_if(clip_stack_.begin(), clip_stack_.end(),
-                             [save_count](ClipStackValue const &value) {
-                               return value.stack_depth > save_count;
-                             });
+  PopClipStack();
 
-  clip_stack_.erase(pend, clip_stack_.end());
+  matrix_dirty_ = true;
 }
 
 void HWCanvasState::Translate(float dx, float dy) {
@@ -81,27 +81,49 @@ void HWCanvasState::Concat(const Matrix &matrix) {
 void HWCanvasState::SaveClipPath(HWDrawRange const &front_range,
                                  HWDrawRange const &back_range,
                                  HWDrawRange const &bound_range,
-                                 Matrix const &matrix) {
+                                 Matrix const &matrix, bool folded) {
   ClipStackValue value{};
   value.stack_depth = matrix_state_.size();
   value.front_range = front_range;
   value.back_range = back_range;
   value.bound_range = bound_range;
   value.stack_matrix = matrix;
+  value.stencil_level = CurrentClipLevel() + (folded ? 0 : 1);
+  value.folded = folded;
+
+  clip_stack_.emplace_back(value);
+}
+
+void HWCanvasState::ClipRect(Rect const &rect) {
+  auto &scissor = scissor_state_.back();
+
+  if (!scissor.IsValid()) {
+    scissor.Set(rect);
+    return;
+  }
+
+  float left = std::max(scissor->left(), rect.left());
+  float top = std::max(scissor->top(), rect.top());
+  float right = std::min(scissor->right(), rect.right());
+  float bottom = std::min(scissor->bottom(), rect.bottom());
 
-  if (clip_stack_.empty() ||
-      clip_stack_.back().stack_depth < value.stack_depth) {
-    clip_stack_.emplace_back(value);
+  if (left < right && top < bottom) {
+    scissor.Set(Rect::MakeLTRB(left, top, right, bottom));
   } else {
-    clip_stack_.back() = value;
+    scissor.Set(Rect::MakeEmpty());
   }
 }
 
+Lazy<Rect> const &HWCanvasState::CurrentScissorBox() {
+  return scissor_state_.back();
+}
+
 bool HWCanvasState::ClipStackEmpty() { return clip_stack_.empty(); }
 
-bool HWCanvasState::NeedRevertClipStencil() {
-  return !clip_stack_.empty() &&
-         clip_stack_.back().stack_depth == matrix_state_.size();
+size_t HWCanvasState::ClipStackSize() { return clip_stack_.size(); }
+
+HWCanvasState::ClipStackValue const &HWCanvasState::ClipStackAt(size_t index) {
+  return clip_stack_[index];
 }
 
 HWCanvasState::ClipStackValue HWCanvasState::CurrentClipStackValue() {
@@ -112,13 +134,22 @@ HWCanvasState::ClipStackValue HWCanvasState::CurrentClipStackValue() {
   }
 }
 
-void HWCanvasState::ForEachClipStackValue(
-    std::function<void(ClipStackValue const &, size_t)> const &func) {
-  for (size_t i = 0; i < clip_stack_.size(); i++) {
-    func(clip_stack_[i], i);
+uint32_t HWCanvasState::CurrentClipLevel() {
+  return clip_stack_.empty() ? 0 : clip_stack_.back().stencil_level;
+}
+
+size_t HWCanvasState::ClipCountAtSaveCount(size_t save_count) {
+  size_t count = clip_stack_.size();
+
+  while (count > 0 && clip_stack_[count - 1].stack_depth > save_count) {
+    count--;
   }
+
+  return count;
 }
 
+size_t HWCanvasState::SaveCount() { return matrix_state_.size(); }
+
 Matrix HWCanvasState::CurrentMatrix() { return matrix_state_.back(); }
 
 bool HWCanvasState::HasClip() { return !clip_stack_.empty(); }
@@ -129,20 +160,17 @@ void HWCanvasState::ClearMatrixDirty() { matrix_dirty_ = false; }
 
 void HWCanvasState::PushMatrixStack() {
   matrix_state_.emplace_back(CurrentMatrix());
+  Lazy<Rect> scissor = scissor_state_.back();
+  scissor_state_.emplace_back(scissor);
 }
 
-void HWCanvasState::PopMatrixStack() { matrix_state_.pop_back(); }
+void HWCanvasState::PopMatrixStack() {
+  matrix_state_.pop_back();
+  scissor_state_.pop_back();
+}
 
 void HWCanvasState::PopClipStack() {
-  if (clip_stack_.empty()) {
-    return;
-  }
-
-  if (clip_stack_.back().stack_depth <= matrix_state_.size()) {
-    return;
-  }
-
-  clip_stack_.pop_back();
+  clip_stack_.resize(ClipCountAtSaveCount(matrix_state_.size()));
 }
 
 }  // namespace skity
\ No newline at end of file
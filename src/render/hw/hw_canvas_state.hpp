@@ -1,11 +1,12 @@
 #ifndef SKITY_SRC_RENDER_HW_HW_CANVAS_STATE_HPP
 #define SKITY_SRC_RENDER_HW_HW_CANVAS_STATE_HPP
 
-#include <functional>
+#include <skity/geometry/rect.hpp>
 #include <skity/graphic/path.hpp>
 #include <vector>
 
 #include "src/render/hw/hw_draw.hpp"
+#include "src/utils/lazy.hpp"
 
 namespace skity {
 
@@ -15,8 +16,14 @@ class HWCanvasState {
     uint32_t stack_depth = {};
     HWDrawRange front_range = {};
     HWDrawRange back_range = {};
+    // device space rect covering all pixels inside this clip
     HWDrawRange bound_range = {};
     Matrix stack_matrix = {};
+    // stencil clip level of pixels inside this and all previous clips
+    uint32_t stencil_level = {};
+    // intersected into the level of previous clip since all levels are used,
+    // popping it needs to rebuild the stencil buffer
+    bool folded = false;
   };
 
   HWCanvasState();
@@ -31,18 +38,53 @@ class HWCanvasState {
   void Rotate(float degree, float px, float py);
   void Concat(Matrix const& matrix);
 
+  /**
+   * Push a stencil clip, every clip gets its own stencil level so restore
+   * only reverts levels of popped clips.
+   *
+   * @param bound_range device space cover of clip
+   * @param folded      true if there is no free stencil level and the clip is
+   *                    intersected into current level
+   */
   void SaveClipPath(HWDrawRange const& front_range,
                     HWDrawRange const& back_range,
-                    HWDrawRange const& bound_range, Matrix const& matrix);
+                    HWDrawRange const& bound_range, Matrix const& matrix,
+                    bool folded);
+
+  /**
+   * Intersect scissor box of current save level with rect.
+   *
+   * @param rect device space rect
+   */
+  void ClipRect(Rect const& rect);
+
+  /**
+   * @return scissor box of current save level, invalid if there is no rect
+   *         clip
+   */
+  Lazy<Rect> const& CurrentScissorBox();
 
   bool ClipStackEmpty();
 
-  bool NeedRevertClipStencil();
+  size_t ClipStackSize();
+
+  ClipStackValue const& ClipStackAt(size_t index);
 
   ClipStackValue CurrentClipStackValue();
 
-  void ForEachClipStackValue(
-      std::function<void(ClipStackValue const&, size_t)> const& func);
+  /**
+   * @return stencil level draws need to test against, 0 if there is no
+   *         stencil clip
+   */
+  uint32_t CurrentClipLevel();
+
+  /**
+   * @return number of clips in stack which are not popped by restoring to
+   *         save_count
+   */
+  size_t ClipCountAtSaveCount(size_t save_count);
+
+  size_t SaveCount();
 
   Matrix CurrentMatrix();
 
@@ -58,6 +100,8 @@ class HWCanvasState {
 
  private:
   std::vector<Matrix> matrix_state_ = {};
+  // scissor box of each save level
+  std::vector<Lazy<Rect>> scissor_state_ = {};
   std::vector<ClipStackValue> clip_stack_ = {};
   bool matrix_dirty_ = true;
 };
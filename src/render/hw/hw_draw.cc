@@ -1,5 +1,6 @@
 #include "src/render/hw/hw_draw.hpp"
 
+#include <algorithm>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "src/logging.hpp"
@@ -9,6 +10,9 @@
 
 namespace skity {
 
+// shaders compute sigma as kernel size plus this offset
+static constexpr float BLUR_SIGMA_OFFSET = 2.f;
+
 void HWDraw::Draw() {
   // update transform matrix
   if (transform_matrix_.IsValid()) {
@@ -25,6 +29,13 @@ void HWDraw::Draw() {
     renderer_->SetGlobalAlpha(*global_alpha_);
   }
 
+  // rect clip
+  if (scissor_box_.IsValid()) {
+    renderer_->EnableScissorTest(*scissor_box_);
+  } else {
+    renderer_->DisableScissorTest();
+  }
+
   DoStencilIfNeed();
   if (clip_stencil_) {
     DoStencilBufferMove();
@@ -67,7 +78,10 @@ void HWDraw::SetGradientPositions(std::vector<float> const& pos) {
   gradient_stops_ = pos;
 }
 
-void HWDraw::SetClearStencilClip(bool clear) { clear_stencil_clip_ = clear; }
+void HWDraw::SetGradientRamp(HWTexture* ramp, float row) {
+  texture_ = ramp;
+  gradient_ramp_row_ = row;
+}
 
 void HWDraw::SetTexture(HWTexture* texture) { texture_ = texture; }
 
@@ -77,6 +91,38 @@ void HWDraw::SetFontTexture(HWTexture* font_texture) {
 
 void HWDraw::SetGlobalAlpha(float alpha) { global_alpha_.Set(alpha); }
 
+bool HWDraw::CanMerge() const {
+  bool uniform_color = pipeline_mode_ == kUniformColor &&
+                       uniform_color_.IsValid() && texture_ == nullptr;
+  bool gradient_ramp = (pipeline_mode_ == kLinearGradient ||
+                        pipeline_mode_ == kRadialGradient) &&
+                       gradient_ramp_row_ >= 0.f;
+
+  return !clip_stencil_ && bounds_.IsValid() &&
+         (uniform_color || gradient_ramp) &&
+         stencil_front_range_.count == 0 && stencil_back_range_.count == 0 &&
+         !even_odd_fill_;
+}
+
+bool HWDraw::IsBatchBarrier() const {
+  // clip draws change stencil buffer for all draws after them
+  return clip_stencil_ || !bounds_.IsValid();
+}
+
+void HWDraw::InheritState(HWDraw const& other) {
+  if (!transform_matrix_.IsValid() && other.transform_matrix_.IsValid()) {
+    transform_matrix_.Set(*other.transform_matrix_);
+  }
+
+  if (!stroke_width_.IsValid() && other.stroke_width_.IsValid()) {
+    stroke_width_.Set(*other.stroke_width_);
+  }
+
+  if (!global_alpha_.IsValid() && other.global_alpha_.IsValid()) {
+    global_alpha_.Set(*other.global_alpha_);
+  }
+}
+
 void HWDraw::DoStencilIfNeed() {
   if (stencil_front_range_.count == 0 && stencil_back_range_.count == 0) {
     return;
@@ -84,12 +130,16 @@ void HWDraw::DoStencilIfNeed() {
 
   renderer_->DisableColorOutput();
   renderer_->EnableStencilTest();
-  renderer_->UpdateStencilMask(0x0F);
+  renderer_->UpdateStencilMask(WindingMask());
   renderer_->SetPipelineColorMode(HWPipelineColorMode::kStencil);
   if (has_clip_) {
-    renderer_->UpdateStencilFunc(HWStencilFunc::LESS_OR_EQUAL, 0x10, 0x1F);
+    // no pixel is above current clip level, so this only passes pixels of
+    // current level
+    renderer_->UpdateStencilFunc(HWStencilFunc::LESS_OR_EQUAL,
+                                 ClipStencilValue(clip_level_),
+                                 CLIP_LEVEL_MASK);
   } else {
-    renderer_->UpdateStencilFunc(HWStencilFunc::ALWAYS, 0x01, 0x0F);
+    renderer_->UpdateStencilFunc(HWStencilFunc::ALWAYS, 0x01, WindingMask());
   }
 
   if (stencil_front_range_.count > 0) {
@@ -123,12 +173,18 @@ void HWDraw::DoColorFill() {
   } else if (pipeline_mode_ == kLinearGradient ||
              pipeline_mode_ == kRadialGradient) {
     renderer_->SetPipelineColorMode((HWPipelineColorMode)pipeline_mode_);
-    renderer_->SetGradientCountInfo(gradient_colors_.size(),
-                                    gradient_stops_.size());
     renderer_->SetGradientBoundInfo(*gradient_bounds_);
-    renderer_->SetGradientColors(gradient_colors_);
-    if (!gradient_stops_.empty()) {
-      renderer_->SetGradientPositions(gradient_stops_);
+    renderer_->SetGradientRampRow(gradient_ramp_row_);
+    if (texture_) {
+      renderer_->BindTexture(texture_, 0);
+      texture_->Bind();
+    } else {
+      renderer_->SetGradientCountInfo(gradient_colors_.size(),
+                                      gradient_stops_.size());
+      renderer_->SetGradientColors(gradient_colors_);
+      if (!gradient_stops_.empty()) {
+        renderer_->SetGradientPositions(gradient_stops_);
+      }
     }
   } else if (pipeline_mode_ >= kImageTexture ||
              pipeline_mode_ <= kInnerBlurMix) {
@@ -168,7 +224,7 @@ void HWDraw::DoStencilBufferMove() {
     renderer_->SetModelMatrix(current_matrix);
   }
 
-  renderer_->UpdateStencilMask(0x0F);
+  renderer_->UpdateStencilMask(CLIP_WINDING_MASK);
   renderer_->UpdateStencilOp(HWStencilOp::KEEP);
   renderer_->DisableStencilTest();
   renderer_->EnableColorOutput();
@@ -179,32 +235,63 @@ void HWDraw::DoStencilBufferMoveInternal() {
     return;
   }
 
-  if (clear_stencil_clip_) {
-    // clear stencil clip value
-    renderer_->UpdateStencilFunc(HWStencilFunc::ALWAYS, 0x00, 0x0F);
-    renderer_->DrawIndex(color_range_.start, color_range_.count);
-  } else if (!has_clip_) {
-    // mark bit 9 if lower 8 bit is not zero
-    renderer_->UpdateStencilFunc(HWStencilFunc::NOT_EQUAL, 0x10, 0x0F);
+  if (clip_target_level_ > clip_level_) {
+    PushClipLevel();
+  } else if (clip_target_level_ == clip_level_) {
+    FoldClipLevel();
+  } else {
+    PopClipLevel();
+  }
+}
+
+void HWDraw::PushClipLevel() {
+  // pixels with winding are marked with next level, winding bits are cleared
+  // by the same replace
+  renderer_->UpdateStencilFunc(HWStencilFunc::NOT_EQUAL,
+                               ClipStencilValue(clip_target_level_),
+                               CLIP_WINDING_MASK);
+  renderer_->DrawIndex(color_range_.start, color_range_.count);
+}
+
+void HWDraw::FoldClipLevel() {
+  // step 1 pixels of current level outside clip drop to the level below,
+  // decrement also sets all their winding bits
+  renderer_->UpdateStencilOp(HWStencilOp::DECR_WRAP);
+  renderer_->UpdateStencilFunc(HWStencilFunc::EQUAL,
+                               ClipStencilValue(clip_level_), 0xFF);
+  renderer_->DrawIndex(color_range_.start, color_range_.count);
 
+  // step 2 pixels inside clip and dropped ones all have winding bits now
+  ClearStencilWinding();
+}
+
+void HWDraw::PopClipLevel() {
+  if (clip_target_level_ == 0) {
+    // no clip left, pixels of all levels are cleared
+    renderer_->UpdateStencilFunc(HWStencilFunc::ALWAYS, 0x00, 0xFF);
     renderer_->DrawIndex(color_range_.start, color_range_.count);
-  } else {
-    // recursive clip path
+    return;
+  }
 
-    // step 1 clear all 0x10 value
+  for (uint32_t level = clip_level_; level > clip_target_level_; level--) {
     renderer_->UpdateStencilOp(HWStencilOp::DECR_WRAP);
     renderer_->UpdateStencilMask(0xFF);
-    renderer_->UpdateStencilFunc(HWStencilFunc::EQUAL, 0x10, 0x1F);
+    renderer_->UpdateStencilFunc(HWStencilFunc::EQUAL,
+                                 ClipStencilValue(level), 0xFF);
     renderer_->DrawIndex(color_range_.start, color_range_.count);
 
-    // step 2 replace all great than 0x10 to 0x10
-    renderer_->UpdateStencilOp(HWStencilOp::REPLACE);
-    renderer_->UpdateStencilMask(0x0F);
-    renderer_->UpdateStencilFunc(HWStencilFunc::NOT_EQUAL, 0x00, 0x0F);
-    renderer_->DrawIndex(color_range_.start, color_range_.count);
+    ClearStencilWinding();
   }
 }
 
+void HWDraw::ClearStencilWinding() {
+  renderer_->UpdateStencilOp(HWStencilOp::REPLACE);
+  renderer_->UpdateStencilMask(CLIP_WINDING_MASK);
+  renderer_->UpdateStencilFunc(HWStencilFunc::NOT_EQUAL, 0x00,
+                               CLIP_WINDING_MASK);
+  renderer_->DrawIndex(color_range_.start, color_range_.count);
+}
+
 void HWDraw::DoStencilBufferClearIfNeed() {
   if (!even_odd_fill_) {
     return;
@@ -215,8 +302,8 @@ void HWDraw::DoStencilBufferClearIfNeed() {
   // and this need another draw for color fill range
   renderer_->DisableColorOutput();
   renderer_->UpdateStencilOp(HWStencilOp::REPLACE);
-  renderer_->UpdateStencilMask(0x0F);
-  renderer_->UpdateStencilFunc(HWStencilFunc::NOT_EQUAL, 0x00, 0x0F);
+  renderer_->UpdateStencilMask(WindingMask());
+  renderer_->UpdateStencilFunc(HWStencilFunc::NOT_EQUAL, 0x00, WindingMask());
   renderer_->DrawIndex(color_range_.start, color_range_.count);
 
   renderer_->EnableColorOutput();
@@ -233,12 +320,14 @@ void HWDraw::HandleStencilDiscard() {
     } else {
       HandleNormalStencilDiscard();
     }
-    renderer_->UpdateStencilMask(0x0F);
+    renderer_->UpdateStencilMask(WindingMask());
   } else {
     if (has_clip_) {
       renderer_->EnableStencilTest();
       renderer_->UpdateStencilOp(HWStencilOp::KEEP);
-      renderer_->UpdateStencilFunc(HWStencilFunc::EQUAL, 0x10, 0x1F);
+      renderer_->UpdateStencilFunc(HWStencilFunc::EQUAL,
+                                   ClipStencilValue(clip_level_),
+                                   CLIP_LEVEL_MASK);
     } else {
       renderer_->DisableStencilTest();
     }
@@ -247,15 +336,21 @@ void HWDraw::HandleStencilDiscard() {
 
 void HWDraw::HandleNormalStencilDiscard() {
   if (has_clip_) {
-    renderer_->UpdateStencilFunc(HWStencilFunc::LESS, 0x10, 0x1F);
+    // pixels of current level with winding
+    renderer_->UpdateStencilFunc(HWStencilFunc::LESS,
+                                 ClipStencilValue(clip_level_), 0xFF);
   } else {
-    renderer_->UpdateStencilFunc(HWStencilFunc::NOT_EQUAL, 0x0, 0x0F);
+    renderer_->UpdateStencilFunc(HWStencilFunc::NOT_EQUAL, 0x0,
+                                 WindingMask());
   }
 }
 
 void HWDraw::HandleEvenOddStencilDiscard() {
   if (has_clip_) {
-    renderer_->UpdateStencilFunc(HWStencilFunc::LESS, 0x10, 0x11);
+    // pixels of current level with odd winding
+    renderer_->UpdateStencilFunc(HWStencilFunc::LESS,
+                                 ClipStencilValue(clip_level_),
+                                 CLIP_LEVEL_MASK | 0x01);
   } else {
     renderer_->UpdateStencilFunc(HWStencilFunc::LESS, 0x00, 0x01);
   }
@@ -293,14 +388,31 @@ PostProcessDraw::PostProcessDraw(HWRenderTarget* render_target,
 
 PostProcessDraw::~PostProcessDraw() = default;
 
+float PostProcessDraw::BlurKernelSize(float radius, float scale) {
+  if (!(scale > 0.f) || scale >= 1.f) {
+    return radius;
+  }
+
+  return std::max(0.f, (radius + BLUR_SIGMA_OFFSET) * scale -
+                           BLUR_SIGMA_OFFSET);
+}
+
 void PostProcessDraw::Draw() {
   SetPipelineColorMode(HWPipelineColorMode::kImageTexture);
 
   SaveTransform();
 
-  DrawToRenderTarget();
+  // rect clip only applies to the composite pass
+  saved_scissor_box_ = ScissorBox();
+  SetScissorBox(Lazy<Rect>());
 
-  DoFilter();
+  if (!filter_cached_) {
+    DrawToRenderTarget();
+
+    DoFilter();
+  }
+
+  SetScissorBox(saved_scissor_box_);
 
   DrawToCanvas();
 }
@@ -322,6 +434,7 @@ void PostProcessDraw::DrawToRenderTarget() {
   for (const auto& op : draw_list_) {
     op->SetTransformMatrix(matrix);
     op->SetHasClip(false);
+    op->SetScissorBox(Lazy<Rect>());
     op->Draw();
   }
 
@@ -347,7 +460,11 @@ void PostProcessDraw::DoFilter() {
 }
 
 void PostProcessDraw::DrawToCanvas() {
-  GetPipeline()->UnBindRenderTarget(render_target_);
+  if (!filter_cached_) {
+    GetPipeline()->UnBindRenderTarget(render_target_);
+  } else {
+    saved_mvp_ = GetPipeline()->GetMVPMatrix();
+  }
 
   RestoreTransform();
 
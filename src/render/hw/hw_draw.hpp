@@ -21,6 +21,19 @@ class HWRenderTarget;
 
 class HWDraw {
  public:
+  enum {
+    // stencil clip level lives in the high 3 bits of stencil buffer, the low
+    // 5 bits count winding of path fills. Fills and clip paths drawn under a
+    // clip are exact while no pixel has a winding of 32 or more, which is why
+    // clips past MAX_CLIP_LEVEL are folded instead of taking more bits. Fills
+    // without clip count winding in all 8 bits.
+    CLIP_LEVEL_SHIFT = 5,
+    MAX_CLIP_LEVEL = 7,
+    CLIP_LEVEL_MASK = 0xE0,
+    CLIP_WINDING_MASK = 0x1F,
+    WINDING_MASK = 0xFF,
+  };
+
   HWDraw(HWRenderer* renderer, bool has_clip, bool clip_stencil = false)
       : renderer_(renderer), has_clip_(has_clip), clip_stencil_(clip_stencil) {}
   virtual ~HWDraw() = default;
@@ -46,7 +59,14 @@ class HWDraw {
 
   void SetGradientPositions(std::vector<float> const& pos);
 
-  void SetClearStencilClip(bool clear);
+  /**
+   * Sample gradient colors from a row of ramp texture instead of uploading
+   * color and stop arrays.
+   *
+   * @param ramp  ramp texture of HWGradientCache
+   * @param row   v coordinate of the row
+   */
+  void SetGradientRamp(HWTexture* ramp, float row);
 
   void SetTexture(HWTexture* texture);
 
@@ -56,11 +76,64 @@ class HWDraw {
 
   void SetHasClip(bool has_clip) { has_clip_ = has_clip; }
 
+  /**
+   * Set stencil clip level pixels inside clip are marked with, draws with clip
+   * only touch pixels of this level. For clip draws this is the level before
+   * the draw.
+   */
+  void SetClipLevel(uint32_t level) { clip_level_ = level; }
+
+  /**
+   * Set stencil clip level after a clip draw. A level above current one pushes
+   * a clip, a level below pops clips inside color range, and the same level
+   * intersects the clip into current level.
+   */
+  void SetClipTargetLevel(uint32_t level) { clip_target_level_ = level; }
+
+  /**
+   * Set device space rect outside which this draw is discarded, pass an
+   * invalid box to draw without scissor.
+   */
+  void SetScissorBox(Lazy<Rect> const& box) { scissor_box_ = box; }
+
   void SetEvenOddFill(bool is_even_odd) { even_odd_fill_ = is_even_odd; }
 
+  /**
+   * Set device space bounds covering all pixels this draw touches. Draws
+   * without bounds are never reordered or merged by HWDrawBatcher.
+   */
+  void SetBounds(Rect const& bounds) { bounds_.Set(bounds); }
+
+  /**
+   * @return true if this draw is a single uniform color or gradient ramp
+   *         pass without stencil and can be merged with other draws sharing
+   *         the same state, glyph quads are only merged with draws using the
+   *         same font texture
+   */
+  virtual bool CanMerge() const;
+
+  /**
+   * @return true if no draw is allowed to move across this one
+   */
+  virtual bool IsBatchBarrier() const;
+
+  /**
+   * @return false if this draw also depends on pipeline state left by
+   *         previous draws before applying its own state, in which case state
+   *         of a removed draw can not be handed over to it
+   */
+  virtual bool CanInheritState() const { return true; }
+
+  /**
+   * Take over pipeline state set by a draw which is removed from draw list,
+   * so draws after it still see the same pipeline state.
+   */
+  void InheritState(HWDraw const& other);
+
  protected:
   HWRenderer* GetPipeline() { return renderer_; }
   bool HasClip() { return has_clip_; }
+  Lazy<Rect> const& ScissorBox() const { return scissor_box_; }
 
   const Lazy<glm::mat4>& TransformMatrix() const { return transform_matrix_; }
 
@@ -72,16 +145,34 @@ class HWDraw {
   void DoStencilBufferMoveInternal();
   void DoStencilBufferClearIfNeed();
 
+  void PushClipLevel();
+  void FoldClipLevel();
+  void PopClipLevel();
+  void ClearStencilWinding();
+
+  uint32_t ClipStencilValue(uint32_t level) const {
+    return level << CLIP_LEVEL_SHIFT;
+  }
+
+  // stencil bits counting winding of this draw, all clip levels are 0 when
+  // a color draw has no clip
+  uint32_t WindingMask() const {
+    return has_clip_ || clip_stencil_ ? CLIP_WINDING_MASK : WINDING_MASK;
+  }
+
   void HandleStencilDiscard();
   void HandleNormalStencilDiscard();
   void HandleEvenOddStencilDiscard();
   void BindTexture();
 
  private:
+  friend class HWDrawBatcher;
+
   HWRenderer* renderer_;
   bool has_clip_;
   bool clip_stencil_;
-  bool clear_stencil_clip_ = false;
+  uint32_t clip_level_ = 0;
+  uint32_t clip_target_level_ = 0;
   uint32_t pipeline_type_ = 0;
   uint32_t pipeline_mode_ = 0;
   HWDrawRange stencil_front_range_ = {};
@@ -95,8 +186,12 @@ class HWDraw {
   Lazy<float> global_alpha_ = {};
   std::vector<glm::vec4> gradient_colors_ = {};
   std::vector<float> gradient_stops_ = {};
+  // negative if gradient colors are uploaded as uniform arrays
+  float gradient_ramp_row_ = -1.f;
   HWTexture* texture_ = {};
   HWTexture* font_texture_ = {};
+  Lazy<Rect> bounds_ = {};
+  Lazy<Rect> scissor_box_ = {};
 };
 
 class PostProcessDraw : public HWDraw {
@@ -114,10 +209,36 @@ class PostProcessDraw : public HWDraw {
 
   void SetBlurStyle(BlurStyle style) { blur_style_ = style; }
 
-  void SetBlurRadius(float sigma) { blur_radius_ = sigma; }
+  /**
+   * @param radius  blur radius in canvas pixels
+   * @param scale   resolution scale of the render target, see
+   *                MaskFilter::blurScale
+   */
+  void SetBlurRadius(float radius, float scale) {
+    blur_radius_ = BlurKernelSize(radius, scale);
+  }
+
+  /**
+   * Kernel size passed to blur shaders, in pixels of the render target.
+   *
+   * Shaders use kernel size + 2 as sigma. The offset is in pixels of the
+   * render target too, so the kernel size is reduced to keep sigma matching
+   * the full resolution blur when the target is downsampled.
+   */
+  static float BlurKernelSize(float radius, float scale);
+
+  // render target already holds filtered result drawn in previous frame,
+  // only composite it to canvas
+  void SetFilterCached(bool cached) { filter_cached_ = cached; }
 
   void Draw() override;
 
+  bool CanMerge() const override { return false; }
+
+  bool IsBatchBarrier() const override { return true; }
+
+  bool CanInheritState() const override { return false; }
+
  private:
   void DrawToRenderTarget();
 
@@ -134,8 +255,10 @@ class PostProcessDraw : public HWDraw {
   Rect bounds_ = {};
   BlurStyle blur_style_ = BlurStyle::kNormal;
   float blur_radius_ = 0.f;
+  bool filter_cached_ = false;
   glm::mat4 saved_mvp_ = {};
   glm::mat4 saved_transform_ = {};
+  Lazy<Rect> saved_scissor_box_ = {};
 };
 
 }  // namespace skity
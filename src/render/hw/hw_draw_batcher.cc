@@ -0,0 +1,157 @@
+#include "src/render/hw/hw_draw_batcher.hpp"
+
+#include "src/render/hw/hw_mesh.hpp"
+
+namespace skity {
+
+enum {
+  // max draws to look back when searching a draw to merge with
+  BATCH_LOOK_BACK_LIMIT = 16,
+};
+
+template <typename T>
+static bool lazy_equal(Lazy<T> const& a, Lazy<T> const& b) {
+  if (a.IsValid() != b.IsValid()) {
+    return false;
+  }
+
+  return !a.IsValid() || *a == *b;
+}
+
+static bool rect_overlap(Rect const& a, Rect const& b) {
+  return a.left() < b.right() && b.left() < a.right() && a.top() < b.bottom() &&
+         b.top() < a.bottom();
+}
+
+void HWDrawBatcher::Batch(std::vector<std::unique_ptr<HWDraw>>* draw_list) {
+  items_.clear();
+  items_.reserve(draw_list->size());
+
+  transform_.Reset();
+  stroke_width_.Reset();
+  global_alpha_.Reset();
+
+  for (size_t i = 0; i < draw_list->size(); i++) {
+    auto& draw = draw_list->at(i);
+
+    if (!draw->CanInheritState()) {
+      // nested draws leave unknown state behind
+      transform_.Reset();
+      stroke_width_.Reset();
+      global_alpha_.Reset();
+    } else {
+      TrackState(*draw);
+    }
+
+    Item item;
+    item.transform = transform_;
+    item.stroke_width = stroke_width_;
+    item.global_alpha = global_alpha_;
+    if (draw->bounds_.IsValid()) {
+      item.bounds = *draw->bounds_;
+    }
+    item.ranges.emplace_back(draw->color_range_);
+    item.draw = std::move(draw);
+
+    // a removed draw hands its state to the next one
+    bool can_remove = i + 1 == draw_list->size() ||
+                      draw_list->at(i + 1)->CanInheritState();
+
+    if (can_remove && item.draw->CanMerge() && TryMerge(&item)) {
+      if (i + 1 < draw_list->size()) {
+        draw_list->at(i + 1)->InheritState(*item.draw);
+      }
+      continue;
+    }
+
+    items_.emplace_back(std::move(item));
+  }
+
+  draw_list->clear();
+  for (auto& item : items_) {
+    FlushRanges(&item);
+    draw_list->emplace_back(std::move(item.draw));
+  }
+
+  items_.clear();
+}
+
+void HWDrawBatcher::TrackState(HWDraw const& draw) {
+  if (draw.transform_matrix_.IsValid()) {
+    transform_.Set(*draw.transform_matrix_);
+  }
+
+  if (draw.stroke_width_.IsValid()) {
+    stroke_width_.Set(*draw.stroke_width_);
+  }
+
+  if (draw.global_alpha_.IsValid()) {
+    global_alpha_.Set(*draw.global_alpha_);
+  }
+}
+
+bool HWDrawBatcher::TryMerge(Item* item) {
+  size_t count = 0;
+  for (size_t i = items_.size(); i > 0 && count < BATCH_LOOK_BACK_LIMIT;
+       i--, count++) {
+    auto& target = items_[i - 1];
+
+    if (target.draw->CanMerge() && IsSameState(target, *item)) {
+      target.ranges.insert(target.ranges.end(), item->ranges.begin(),
+                           item->ranges.end());
+      target.bounds.join(item->bounds);
+      return true;
+    }
+
+    if (target.draw->IsBatchBarrier() ||
+        rect_overlap(target.bounds, item->bounds)) {
+      return false;
+    }
+  }
+
+  return false;
+}
+
+bool HWDrawBatcher::IsSameState(Item const& a, Item const& b) {
+  return a.draw->has_clip_ == b.draw->has_clip_ &&
+         a.draw->clip_level_ == b.draw->clip_level_ &&
+         lazy_equal(a.draw->scissor_box_, b.draw->scissor_box_) &&
+         a.draw->pipeline_mode_ == b.draw->pipeline_mode_ &&
+         a.draw->font_texture_ == b.draw->font_texture_ &&
+         a.draw->texture_ == b.draw->texture_ &&
+         a.draw->gradient_ramp_row_ == b.draw->gradient_ramp_row_ &&
+         lazy_equal(a.draw->uniform_color_, b.draw->uniform_color_) &&
+         lazy_equal(a.draw->gradient_bounds_, b.draw->gradient_bounds_) &&
+         lazy_equal(a.transform, b.transform) &&
+         lazy_equal(a.stroke_width, b.stroke_width) &&
+         lazy_equal(a.global_alpha, b.global_alpha);
+}
+
+void HWDrawBatcher::FlushRanges(Item* item) {
+  if (item->ranges.size() <= 1) {
+    return;
+  }
+
+  bool adjacent = true;
+  uint32_t count = item->ranges.front().count;
+  for (size_t i = 1; i < item->ranges.size(); i++) {
+    auto const& prev = item->ranges[i - 1];
+    if (prev.start + prev.count != item->ranges[i].start) {
+      adjacent = false;
+    }
+    count += item->ranges[i].count;
+  }
+
+  HWDrawRange range{item->ranges.front().start, count};
+
+  if (!adjacent) {
+    range.start = mesh_->IndexBase();
+    for (auto const& r : item->ranges) {
+      mesh_->CopyIndices(r.start, r.count);
+    }
+  }
+
+  item->draw->SetColorRange(range);
+}
+
+}  // namespace skity
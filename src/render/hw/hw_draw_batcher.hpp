@@ -0,0 +1,61 @@
+#ifndef SKITY_SRC_RENDER_HW_HW_DRAW_BATCHER_HPP
+#define SKITY_SRC_RENDER_HW_HW_DRAW_BATCHER_HPP
+
+#include <glm/glm.hpp>
+#include <memory>
+#include <skity/geometry/rect.hpp>
+#include <vector>
+
+#include "src/render/hw/hw_draw.hpp"
+#include "src/utils/lazy.hpp"
+
+namespace skity {
+
+class HWMesh;
+
+/**
+ * Merges compatible draws in a draw list before it is executed.
+ *
+ * A mergeable draw ( see HWDraw::CanMerge ) is folded into an earlier draw
+ * with the same color and pipeline state if no draw between them overlaps
+ * its bounds, so painter's order is preserved. Merged draws are issued as a
+ * single DrawIndex call, index ranges which are not adjacent are copied into
+ * one new range at the end of the mesh.
+ */
+class HWDrawBatcher final {
+ public:
+  explicit HWDrawBatcher(HWMesh* mesh) : mesh_(mesh) {}
+  ~HWDrawBatcher() = default;
+
+  void Batch(std::vector<std::unique_ptr<HWDraw>>* draw_list);
+
+ private:
+  struct Item {
+    std::unique_ptr<HWDraw> draw = {};
+    // pipeline state when this draw is executed
+    Lazy<glm::mat4> transform = {};
+    Lazy<float> stroke_width = {};
+    Lazy<float> global_alpha = {};
+    Rect bounds = {};
+    std::vector<HWDrawRange> ranges = {};
+  };
+
+  void TrackState(HWDraw const& draw);
+
+  bool TryMerge(Item* item);
+
+  static bool IsSameState(Item const& a, Item const& b);
+
+  void FlushRanges(Item* item);
+
+ private:
+  HWMesh* mesh_;
+  std::vector<Item> items_ = {};
+  Lazy<glm::mat4> transform_ = {};
+  Lazy<float> stroke_width_ = {};
+  Lazy<float> global_alpha_ = {};
+};
+
+}  // namespace skity
+
+#endif  // SKITY_SRC_RENDER_HW_HW_DRAW_BATCHER_HPP
@@ -0,0 +1,161 @@
+#include "src/render/hw/hw_geometry_cache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "src/geometry/geometry.hpp"
+#include "src/render/hw/hw_path_raster.hpp"
+
+namespace skity {
+
+enum {
+  // frames an unused geometry stays in cache
+  GEOMETRY_CACHE_PURGE_LIMIT = 120,
+  // frames a path seen once is remembered
+  GEOMETRY_CACHE_CANDIDATE_LIMIT = 4,
+  // max vertex count of all retained geometry
+  GEOMETRY_CACHE_VERTEX_BUDGET = 1 << 18,
+};
+
+HWGeometryCache::Key HWGeometryCache::MakeKey(Path const& path,
+                                              Paint const& paint,
+                                              Matrix const& matrix) {
+  Key key{};
+
+  key.path_id = path.getGenerationID();
+  key.convexity = static_cast<uint32_t>(path.getConvexityType());
+  key.style = paint.getStyle();
+  if (paint.getStyle() != Paint::kFill_Style) {
+    key.stroke_width = paint.getStrokeWidth();
+    key.stroke_miter = paint.getStrokeMiter();
+    key.stroke_cap = paint.getStrokeCap();
+    key.stroke_join = paint.getStrokeJoin();
+    key.direct_stroke = HWPathRaster::CanStrokeDirectly(paint);
+  }
+  key.scale_class = ScaleClass(matrix);
+  key.perspective = matrix[0][3] != 0.f || matrix[1][3] != 0.f;
+
+  return key;
+}
+
+int32_t HWGeometryCache::ScaleClass(Matrix const& matrix) {
+  float scale = MatrixMaxScale(matrix);
+
+  if (!(scale > 0.f) || std::isinf(scale)) {
+    return 0;
+  }
+
+  // one class per power of two
+  int32_t scale_class = static_cast<int32_t>(std::ceil(std::log2(scale)));
+
+  return std::min(std::max(scale_class, -16), 16);
+}
+
+HWGeometry const* HWGeometryCache::QueryGeometry(Key const& key) {
+  auto it = entries_.find(key);
+
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+
+  it->second.age = current_age_;
+
+  return &it->second.geometry;
+}
+
+void HWGeometryCache::StoreGeometry(Key const& key, HWMeshRegion const& region,
+                                    HWGeometry const& geometry) {
+  auto it = candidates_.find(key);
+
+  if (it == candidates_.end()) {
+    candidates_.insert(std::make_pair(key, current_age_));
+    return;
+  }
+
+  candidates_.erase(it);
+
+  if (region.vertex_count > GEOMETRY_CACHE_VERTEX_BUDGET / 8) {
+    // too large to be worth keeping
+    return;
+  }
+
+  entries_[key] = Entry{region, geometry, current_age_};
+  vertex_count_ += region.vertex_count;
+}
+
+void HWGeometryCache::EndFrame(HWMesh* mesh) {
+  PurgeEntries();
+
+  std::vector<HWMeshRegion*> regions;
+  std::vector<uint32_t> old_index_starts;
+  regions.reserve(entries_.size());
+  old_index_starts.reserve(entries_.size());
+
+  for (auto& it : entries_) {
+    regions.emplace_back(&it.second.region);
+    old_index_starts.emplace_back(it.second.region.index_start);
+  }
+
+  mesh->RetainRegions(regions);
+
+  // move draw ranges together with their region
+  size_t i = 0;
+  for (auto& it : entries_) {
+    uint32_t old_start = old_index_starts[i++];
+    uint32_t new_start = it.second.region.index_start;
+    auto& geometry = it.second.geometry;
+
+    geometry.stencil_front_range.start += new_start - old_start;
+    geometry.stencil_back_range.start += new_start - old_start;
+    geometry.color_range.start += new_start - old_start;
+  }
+
+  for (auto it = candidates_.begin(); it != candidates_.end();) {
+    if (current_age_ - it->second > GEOMETRY_CACHE_CANDIDATE_LIMIT) {
+      it = candidates_.erase(it);
+    } else {
+      it++;
+    }
+  }
+
+  current_age_++;
+}
+
+void HWGeometryCache::PurgeEntries() {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (current_age_ - it->second.age > GEOMETRY_CACHE_PURGE_LIMIT) {
+      vertex_count_ -= it->second.region.vertex_count;
+      it = entries_.erase(it);
+    } else {
+      it++;
+    }
+  }
+
+  if (vertex_count_ <= GEOMETRY_CACHE_VERTEX_BUDGET) {
+    return;
+  }
+
+  // over budget, drop least recently used geometry first
+  std::vector<std::pair<size_t, Key>> ages;
+  ages.reserve(entries_.size());
+  for (auto const& it : entries_) {
+    ages.emplace_back(it.second.age, it.first);
+  }
+
+  std::sort(ages.begin(), ages.end(),
+            [](std::pair<size_t, Key> const& a,
+               std::pair<size_t, Key> const& b) { return a.first < b.first; });
+
+  for (auto const& age : ages) {
+    if (vertex_count_ <= GEOMETRY_CACHE_VERTEX_BUDGET) {
+      break;
+    }
+
+    auto it = entries_.find(age.second);
+    vertex_count_ -= it->second.region.vertex_count;
+    entries_.erase(it);
+  }
+}
+
+}  // namespace skity
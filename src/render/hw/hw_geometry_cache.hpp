@@ -0,0 +1,137 @@
+#ifndef SKITY_SRC_RENDER_HW_HW_GEOMETRY_CACHE_HPP
+#define SKITY_SRC_RENDER_HW_HW_GEOMETRY_CACHE_HPP
+
+#include <cstdint>
+#include <skity/geometry/point.hpp>
+#include <skity/geometry/rect.hpp>
+#include <skity/graphic/paint.hpp>
+#include <skity/graphic/path.hpp>
+#include <unordered_map>
+
+#include "src/render/hw/hw_draw.hpp"
+#include "src/render/hw/hw_mesh.hpp"
+
+namespace skity {
+
+/**
+ * Tessellation result of one path raster pass.
+ */
+struct HWGeometry {
+  HWDrawRange stencil_front_range = {};
+  HWDrawRange stencil_back_range = {};
+  HWDrawRange color_range = {};
+  Rect bounds = {};
+};
+
+/**
+ * Keeps tessellated paths in the retained part of HWMesh, so paths drawn again
+ * in later frames skip tessellation and gpu upload.
+ *
+ * A path is identified by its generation id together with the paint
+ * parameters affecting tessellation and a coarse class of the transform. To
+ * avoid copying geometry of paths changing every frame, a path is only cached
+ * after it is seen in two different frames.
+ */
+class HWGeometryCache final {
+ public:
+  struct Key {
+    uint32_t path_id = {};
+    // convexity may be set by user and is not covered by generation id
+    uint32_t convexity = {};
+    uint32_t style = {};
+    float stroke_width = {};
+    float stroke_miter = {};
+    uint32_t stroke_cap = {};
+    uint32_t stroke_join = {};
+    // stroke triangles are emitted as color range without stencil
+    bool direct_stroke = {};
+    int32_t scale_class = {};
+    bool perspective = {};
+
+    bool operator==(Key const& other) const {
+      return path_id == other.path_id && convexity == other.convexity &&
+             style == other.style &&
+             stroke_width == other.stroke_width &&
+             stroke_miter == other.stroke_miter &&
+             stroke_cap == other.stroke_cap &&
+             stroke_join == other.stroke_join &&
+             direct_stroke == other.direct_stroke &&
+             scale_class == other.scale_class &&
+             perspective == other.perspective;
+    }
+  };
+
+  struct KeyHash {
+    std::size_t operator()(Key const& key) const {
+      size_t res = 17;
+
+      res = res * 31 + std::hash<uint32_t>()(key.path_id);
+      res = res * 31 + std::hash<uint32_t>()(key.convexity);
+      res = res * 31 + std::hash<uint32_t>()(key.style);
+      res = res * 31 + std::hash<float>()(key.stroke_width);
+      res = res * 31 + std::hash<float>()(key.stroke_miter);
+      res = res * 31 + std::hash<uint32_t>()(key.stroke_cap);
+      res = res * 31 + std::hash<uint32_t>()(key.stroke_join);
+      res = res * 31 + std::hash<bool>()(key.direct_stroke);
+      res = res * 31 + std::hash<int32_t>()(key.scale_class);
+      res = res * 31 + std::hash<bool>()(key.perspective);
+
+      return res;
+    }
+  };
+
+  HWGeometryCache() = default;
+  ~HWGeometryCache() = default;
+
+  static Key MakeKey(Path const& path, Paint const& paint,
+                     Matrix const& matrix);
+
+  /**
+   * Coarse class of the max scale of matrix, one class per power of two.
+   * Geometry is tessellated for the upper scale of its class, so it stays
+   * smooth for every matrix of the same class.
+   */
+  static int32_t ScaleClass(Matrix const& matrix);
+
+  /**
+   * @return cached geometry or nullptr, geometry is only valid until next
+   *         EndFrame
+   */
+  HWGeometry const* QueryGeometry(Key const& key);
+
+  /**
+   * Record geometry just rastered into mesh.
+   *
+   * @param key       key created by MakeKey
+   * @param region    mesh region written by the raster pass
+   * @param geometry  draw ranges inside region
+   */
+  void StoreGeometry(Key const& key, HWMeshRegion const& region,
+                     HWGeometry const& geometry);
+
+  /**
+   * Purge unused geometry and retain the remaining one in mesh, need to be
+   * called after all draws are submitted and before HWMesh::ResetMesh.
+   */
+  void EndFrame(HWMesh* mesh);
+
+ private:
+  struct Entry {
+    HWMeshRegion region = {};
+    HWGeometry geometry = {};
+    size_t age = {};
+  };
+
+  void PurgeEntries();
+
+ private:
+  std::unordered_map<Key, Entry, KeyHash> entries_ = {};
+  // paths seen once, value is the age they were seen
+  std::unordered_map<Key, size_t, KeyHash> candidates_ = {};
+  size_t vertex_count_ = {};
+  size_t current_age_ = {};
+};
+
+}  // namespace skity
+
+#endif  // SKITY_SRC_RENDER_HW_HW_GEOMETRY_CACHE_HPP
@@ -1,12 +1,17 @@
 #include "src/render/hw/hw_geometry_raster.hpp"
 
 #include <algorithm>
+#include <cmath>
 
 #include "src/geometry/math.hpp"
 #include "src/render/hw/hw_mesh.hpp"
 
 namespace skity {
 
+// part of the aa margin analytic rrect coverage may shift when u and v are
+// rounded to half floats
+static constexpr float HW_RRECT_QUANTIZE_MARGIN = 1.f / 16.f;
+
 HWGeometryRaster::HWGeometryRaster(HWMesh* mesh, Paint const& paint,
                                    bool use_gs)
     : mesh_(mesh), paint_(paint), use_gs_(use_gs) {}
@@ -60,6 +65,58 @@ void HWGeometryRaster::FillCircle(float cx, float cy, float radius) {
   AppendRect(a, b, c, d);
 }
 
+void HWGeometryRaster::RasterAnalyticRRect(RRect const& rrect,
+                                           float aa_margin) {
+  bool stroke = paint_.getStyle() == Paint::kStroke_Style;
+  float stroke_radius = stroke ? StrokeWidth() * 0.5f : 0.f;
+
+  Rect const& rect = rrect.getBounds();
+  Vec2 radii = rrect.getSimpleRadii();
+  // corner arc radii of the outer edge
+  glm::vec2 outer_radii{radii.x + stroke_radius, radii.y + stroke_radius};
+
+  float type = HW_VERTEX_TYPE_RRECT;
+  if (stroke) {
+    float ratio = (radii.x - stroke_radius) / outer_radii.x;
+    type += std::round(ratio * HW_VERTEX_RRECT_STEPS);
+  }
+
+  // grid lines of the 3x3 patches, inner lines pass through arc centers
+  std::array<float, 4> xs{
+      rect.left() - stroke_radius - aa_margin, rect.left() + radii.x,
+      rect.right() - radii.x, rect.right() + stroke_radius + aa_margin};
+  std::array<float, 4> ys{
+      rect.top() - stroke_radius - aa_margin, rect.top() + radii.y,
+      rect.bottom() - radii.y, rect.bottom() + stroke_radius + aa_margin};
+
+  // u and v are in units of corner radii, allow a fraction of the aa margin
+  float tolerance = aa_margin * HW_RRECT_QUANTIZE_MARGIN /
+                    std::max(outer_radii.x, outer_radii.y);
+
+  std::array<uint32_t, 16> indices{};
+  for (size_t j = 0; j < 4; j++) {
+    for (size_t i = 0; i < 4; i++) {
+      float u = (xs[i] - glm::clamp(xs[i], xs[1], xs[2])) / outer_radii.x;
+      float v = (ys[j] - glm::clamp(ys[j], ys[1], ys[2])) / outer_radii.y;
+
+      indices[j * 4 + i] = AppendVertex(xs[i], ys[j], type, u, v, tolerance);
+    }
+  }
+
+  SetBufferType(kColor);
+  for (size_t j = 0; j < 3; j++) {
+    for (size_t i = 0; i < 3; i++) {
+      if (stroke && i == 1 && j == 1) {
+        // center patch is inside the hole of stroke
+        continue;
+      }
+
+      AppendRect(indices[j * 4 + i], indices[j * 4 + i + 4],
+                 indices[j * 4 + i + 1], indices[j * 4 + i + 5]);
+    }
+  }
+}
+
 void HWGeometryRaster::FillTextRect(const glm::vec4& bounds,
                                     const glm::vec2& uv_lt,
                                     const glm::vec2& uv_rb) {
@@ -165,13 +222,13 @@ uint32_t HWGeometryRaster::AppendCircleVertex(glm::vec2 const& p,
                                               glm::vec2 const& center) {
   ExpandBounds(p);
   return mesh_->AppendVertex(p.x, p.y, HW_VERTEX_TYPE_CIRCLE, center.x,
-                             center.y);
+                             center.y, center_tolerance_);
 }
 
 uint32_t HWGeometryRaster::AppendVertex(float x, float y, float mix, float u,
-                                        float v) {
+                                        float v, float tolerance) {
   ExpandBounds({x, y});
-  return mesh_->AppendVertex(x, y, mix, u, v);
+  return mesh_->AppendVertex(x, y, mix, u, v, tolerance);
 }
 
 void HWGeometryRaster::AppendRect(uint32_t a, uint32_t b, uint32_t c,
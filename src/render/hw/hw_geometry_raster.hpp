@@ -4,6 +4,7 @@
 #include <array>
 #include <glm/glm.hpp>
 #include <skity/geometry/rect.hpp>
+#include <skity/geometry/rrect.hpp>
 #include <skity/graphic/paint.hpp>
 #include <vector>
 
@@ -21,6 +22,16 @@ class HWGeometryRaster {
   void RasterLine(glm::vec2 const& p0, glm::vec2 const& p1);
   void RasterRect(Rect const& rect);
   void FillCircle(float cx, float cy, float radius);
+
+  /**
+   * Fill or stroke rrect with corner coverage computed in fragment shader,
+   * no stencil pass is needed.
+   *
+   * @param rrect     rrect with positive radii, same for all corners. Stroke
+   *                  also needs circle corners larger than stroke radius
+   * @param aa_margin local space outset covering anti-alias of the edge
+   */
+  void RasterAnalyticRRect(RRect const& rrect, float aa_margin);
   void FillTextRect(glm::vec4 const& bounds, glm::vec2 const& uv_lt,
                     glm::vec2 const& uv_rb);
 
@@ -38,6 +49,12 @@ class HWGeometryRaster {
 
   bool UseGeometryShader() const { return use_gs_; }
 
+  /**
+   * Max error in local space allowed when circle centers are rounded to half
+   * floats, 0 keeps them exact.
+   */
+  void SetCenterTolerance(float tolerance) { center_tolerance_ = tolerance; }
+
  protected:
   enum BufferType {
     kStencilFront,
@@ -51,6 +68,7 @@ class HWGeometryRaster {
   float StrokeMiter() const { return paint_.getStrokeMiter(); }
   Paint::Cap LineCap() const { return paint_.getStrokeCap(); }
   Paint::Join LineJoin() const { return paint_.getStrokeJoin(); }
+  Paint const& GetPaint() const { return paint_; }
 
   void ChangeLineJoin(Paint::Join join) { paint_.setStrokeJoin(join); }
 
@@ -63,7 +81,8 @@ class HWGeometryRaster {
 
   uint32_t AppendLineVertex(glm::vec2 const& p);
   uint32_t AppendCircleVertex(glm::vec2 const& p, glm::vec2 const& center);
-  uint32_t AppendVertex(float x, float y, float mix, float u, float v);
+  uint32_t AppendVertex(float x, float y, float mix, float u, float v,
+                        float tolerance = 0.f);
 
   void AppendRect(uint32_t a, uint32_t b, uint32_t c, uint32_t d);
 
@@ -91,6 +110,7 @@ class HWGeometryRaster {
   HWMesh* mesh_;
   Paint paint_;
   bool use_gs_;
+  float center_tolerance_ = 0.f;
   BufferType buffer_type_ = kColor;
 
   uint32_t stencil_front_start_ = {};
@@ -0,0 +1,78 @@
+#include "src/render/hw/hw_glyph_path_cache.hpp"
+
+#include <algorithm>
+#include <skity/text/typeface.hpp>
+#include <vector>
+
+namespace skity {
+
+enum {
+  // frames an unused outline stays in cache
+  GLYPH_PATH_CACHE_PURGE_LIMIT = 120,
+  // max outline count
+  GLYPH_PATH_CACHE_ENTRY_LIMIT = 2048,
+};
+
+Path const& HWGlyphPathCache::QueryPath(
+    std::shared_ptr<Typeface> const& typeface, GlyphInfo const& info,
+    float font_size) {
+  Key key{typeface.get(), info.id, font_size};
+
+  auto it = entries_.find(key);
+  if (it != entries_.end() && !it->second.typeface.expired()) {
+    it->second.age = current_age_;
+    return it->second.path;
+  }
+
+  Entry entry{};
+  entry.typeface = typeface;
+  if (!info.path.isEmpty() && info.path_font_size == font_size) {
+    entry.path = info.path;
+  } else {
+    entry.path = typeface->getGlyphInfo(info.id, font_size, true).path;
+  }
+  entry.age = current_age_;
+
+  if (it != entries_.end()) {
+    // typeface at this address was released, outline belongs to another one
+    it->second = std::move(entry);
+    return it->second.path;
+  }
+
+  return entries_.emplace(key, std::move(entry)).first->second.path;
+}
+
+void HWGlyphPathCache::EndFrame() {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.typeface.expired() ||
+        current_age_ - it->second.age > GLYPH_PATH_CACHE_PURGE_LIMIT) {
+      it = entries_.erase(it);
+    } else {
+      it++;
+    }
+  }
+
+  if (entries_.size() > GLYPH_PATH_CACHE_ENTRY_LIMIT) {
+    // drop least recently used outlines first
+    std::vector<std::pair<size_t, Key>> ages;
+    ages.reserve(entries_.size());
+    for (auto const& it : entries_) {
+      ages.emplace_back(it.second.age, it.first);
+    }
+
+    std::sort(
+        ages.begin(), ages.end(),
+        [](std::pair<size_t, Key> const& a, std::pair<size_t, Key> const& b) {
+          return a.first < b.first;
+        });
+
+    size_t drop = entries_.size() - GLYPH_PATH_CACHE_ENTRY_LIMIT;
+    for (size_t i = 0; i < drop; i++) {
+      entries_.erase(ages[i].second);
+    }
+  }
+
+  current_age_++;
+}
+
+}  // namespace skity
@@ -0,0 +1,79 @@
+#ifndef SKITY_SRC_RENDER_HW_HW_GLYPH_PATH_CACHE_HPP
+#define SKITY_SRC_RENDER_HW_HW_GLYPH_PATH_CACHE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <skity/graphic/path.hpp>
+#include <skity/text/text_run.hpp>
+#include <unordered_map>
+
+namespace skity {
+
+/**
+ * Glyph outlines shared by all text drawn through path.
+ *
+ * Outlines are kept in glyph space, so the same Path object ( and its
+ * generation id ) is handed out every frame and tessellation of it can be
+ * reused by HWGeometryCache.
+ *
+ * Entries are keyed by typeface address and hold a weak reference to it, an
+ * address reused by a new typeface never hits outlines of a released one.
+ */
+class HWGlyphPathCache final {
+ public:
+  struct Key {
+    Typeface* typeface = {};
+    GlyphID glyph_id = {};
+    float font_size = {};
+
+    bool operator==(Key const& other) const {
+      return typeface == other.typeface && glyph_id == other.glyph_id &&
+             font_size == other.font_size;
+    }
+  };
+
+  struct KeyHash {
+    std::size_t operator()(Key const& key) const {
+      size_t res = 17;
+
+      res = res * 31 + std::hash<Typeface*>()(key.typeface);
+      res = res * 31 + std::hash<GlyphID>()(key.glyph_id);
+      res = res * 31 + std::hash<float>()(key.font_size);
+
+      return res;
+    }
+  };
+
+  HWGlyphPathCache() = default;
+  ~HWGlyphPathCache() = default;
+
+  /**
+   * @param typeface  typeface of glyph
+   * @param info      glyph info, its path is reused if it is loaded with
+   *                  font_size
+   * @param font_size font size of outline
+   * @return          glyph outline with origin at the glyph baseline, valid
+   *                  until next EndFrame
+   */
+  Path const& QueryPath(std::shared_ptr<Typeface> const& typeface,
+                        GlyphInfo const& info, float font_size);
+
+  /**
+   * Purge outlines not used for a while, and outlines of released typefaces.
+   */
+  void EndFrame();
+
+ private:
+  struct Entry {
+    std::weak_ptr<Typeface> typeface = {};
+    Path path = {};
+    size_t age = {};
+  };
+
+  std::unordered_map<Key, Entry, KeyHash> entries_ = {};
+  size_t current_age_ = {};
+};
+
+}  // namespace skity
+
+#endif  // SKITY_SRC_RENDER_HW_HW_GLYPH_PATH_CACHE_HPP
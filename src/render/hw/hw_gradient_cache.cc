@@ -0,0 +1,205 @@
+#include "src/render/hw/hw_gradient_cache.hpp"
+
+#include <algorithm>
+
+#include "src/render/hw/hw_texture.hpp"
+
+namespace skity {
+
+static glm::vec4 gradient_color_at(Shader::GradientInfo const& info,
+                                   float offset) {
+  auto const& colors = info.colors;
+  size_t count = colors.size();
+
+  auto stop_at = [&info, count](size_t index) {
+    if (info.color_offsets.size() >= count) {
+      return info.color_offsets[index];
+    }
+
+    return static_cast<float>(index) / static_cast<float>(count - 1);
+  };
+
+  if (offset <= stop_at(0)) {
+    return colors.front();
+  }
+
+  for (size_t i = 1; i < count; i++) {
+    float end = stop_at(i);
+    if (offset > end) {
+      continue;
+    }
+
+    float start = stop_at(i - 1);
+    float t = end > start ? (offset - start) / (end - start) : 1.f;
+
+    glm::vec4 c0 = colors[i - 1];
+    glm::vec4 c1 = colors[i];
+    if (info.gradientFlags == 0) {
+      return glm::mix(c0, c1, t);
+    }
+
+    // interpolate in premultiplied space, ramp still holds unpremultiplied
+    // colors like the uniform array path
+    glm::vec4 c =
+        glm::mix(glm::vec4{glm::vec3{c0} * c0.a, c0.a},
+                 glm::vec4{glm::vec3{c1} * c1.a, c1.a}, t);
+    if (c.a > 0.f) {
+      c = glm::vec4{glm::vec3{c} / c.a, c.a};
+    }
+    return c;
+  }
+
+  return colors.back();
+}
+
+void HWGradientCache::Init(std::unique_ptr<HWTexture> texture) {
+  texture_ = std::move(texture);
+  texture_ready_ = false;
+}
+
+bool HWGradientCache::QueryGradient(std::shared_ptr<Shader> const& shader,
+                                    Gradient* gradient) {
+  if (!texture_ || !shader) {
+    return false;
+  }
+
+  auto it = entries_.find(shader.get());
+  if (it != entries_.end()) {
+    if (it->second.shader.lock() == shader) {
+      it->second.age = current_age_;
+      *gradient = it->second.gradient;
+      return true;
+    }
+
+    // address reused by a new shader, draws of the dead one in current frame
+    // may still sample its row
+    if (it->second.age == current_age_) {
+      retired_rows_.emplace_back(it->second.row);
+    } else {
+      free_rows_.emplace_back(it->second.row);
+    }
+    entries_.erase(it);
+  }
+
+  Shader::GradientInfo info{};
+  Shader::GradientType type = shader->asGradient(&info);
+
+  if ((type != Shader::kLinear && type != Shader::kRadial) ||
+      info.colors.empty()) {
+    return false;
+  }
+
+  int32_t row = AllocateRow();
+  if (row < 0) {
+    return false;
+  }
+
+  if (!texture_ready_) {
+    texture_->Init(HWTexture::Type::kColorTexture, HWTexture::Format::kRGBA);
+    texture_->Bind();
+    texture_->Resize(RAMP_WIDTH, RAMP_HEIGHT);
+    texture_->UnBind();
+    texture_ready_ = true;
+  }
+
+  std::vector<uint8_t> pixels(RAMP_WIDTH * 4);
+  BakeRamp(info, pixels.data());
+
+  texture_->Bind();
+  texture_->UploadData(0, row, RAMP_WIDTH, 1, pixels.data());
+  texture_->UnBind();
+
+  Entry entry{};
+  entry.shader = shader;
+  entry.gradient.type = type;
+  if (type == Shader::kLinear) {
+    entry.gradient.bounds = {glm::vec2{info.point[0]},
+                             glm::vec2{info.point[1]}};
+  } else {
+    entry.gradient.bounds = {glm::vec2{info.point[0]}, info.radius[0],
+                             info.radius[1]};
+  }
+  entry.gradient.row = (row + 0.5f) / static_cast<float>(RAMP_HEIGHT);
+  entry.row = row;
+  entry.age = current_age_;
+
+  *gradient = entry.gradient;
+  entries_[shader.get()] = entry;
+
+  return true;
+}
+
+void HWGradientCache::EndFrame() {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.shader.expired()) {
+      free_rows_.emplace_back(it->second.row);
+      it = entries_.erase(it);
+    } else {
+      it++;
+    }
+  }
+
+  free_rows_.insert(free_rows_.end(), retired_rows_.begin(),
+                    retired_rows_.end());
+  retired_rows_.clear();
+
+  current_age_++;
+}
+
+void HWGradientCache::CleanUp() {
+  if (texture_ && texture_ready_) {
+    texture_->Destroy();
+  }
+
+  texture_ready_ = false;
+  entries_.clear();
+  free_rows_.clear();
+  retired_rows_.clear();
+  row_count_ = 0;
+}
+
+void HWGradientCache::BakeRamp(Shader::GradientInfo const& info,
+                               uint8_t* row) {
+  for (uint32_t i = 0; i < RAMP_WIDTH; i++) {
+    float offset = static_cast<float>(i) / static_cast<float>(RAMP_WIDTH - 1);
+    glm::vec4 color = glm::clamp(gradient_color_at(info, offset), 0.f, 1.f);
+
+    for (int32_t c = 0; c < 4; c++) {
+      row[i * 4 + c] = static_cast<uint8_t>(color[c] * 255.f + 0.5f);
+    }
+  }
+}
+
+int32_t HWGradientCache::AllocateRow() {
+  if (!free_rows_.empty()) {
+    uint32_t row = free_rows_.back();
+    free_rows_.pop_back();
+    return row;
+  }
+
+  if (row_count_ < RAMP_HEIGHT) {
+    return row_count_++;
+  }
+
+  auto lru = entries_.end();
+  for (auto it = entries_.begin(); it != entries_.end(); it++) {
+    if (it->second.age == current_age_) {
+      continue;
+    }
+
+    if (lru == entries_.end() || it->second.age < lru->second.age) {
+      lru = it;
+    }
+  }
+
+  if (lru == entries_.end()) {
+    return -1;
+  }
+
+  uint32_t row = lru->second.row;
+  entries_.erase(lru);
+
+  return row;
+}
+
+}  // namespace skity
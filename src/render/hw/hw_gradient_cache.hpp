@@ -0,0 +1,104 @@
+#ifndef SKITY_SRC_RENDER_HW_HW_GRADIENT_CACHE_HPP
+#define SKITY_SRC_RENDER_HW_HW_GRADIENT_CACHE_HPP
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <skity/effect/shader.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace skity {
+
+class HWTexture;
+
+/**
+ * Bakes color stops of gradient shaders into rows of a shared ramp texture,
+ * so gradient draws only carry the row to sample instead of uploading color
+ * and stop arrays, and there is no limit on stop count.
+ *
+ * Gradient shaders are immutable after creation, so a row is keyed by the
+ * shader instance. Rows of dead shaders are released in EndFrame, and once
+ * all rows are taken the row least recently used is reused. Rows used in
+ * current frame are never reused.
+ */
+class HWGradientCache final {
+ public:
+  enum {
+    RAMP_WIDTH = 256,
+    RAMP_HEIGHT = 256,
+  };
+
+  struct Gradient {
+    Shader::GradientType type = Shader::kNone;
+    // [p0.x, p0.y, p1.x, p1.y] of linear gradient
+    // [center.x, center.y, radius, radius] of radial gradient
+    glm::vec4 bounds = {};
+    // v coordinate of the row center in ramp texture
+    float row = {};
+  };
+
+  HWGradientCache() = default;
+  ~HWGradientCache() = default;
+
+  /**
+   * @param texture empty texture to hold the ramp atlas, the cache takes the
+   *                ownership and resizes it on first use
+   */
+  void Init(std::unique_ptr<HWTexture> texture);
+
+  /**
+   * @param shader    shader of paint
+   * @param gradient  receive gradient info and row of shader
+   * @return          false if shader is not a linear or radial gradient, or
+   *                  all rows are used in current frame
+   */
+  bool QueryGradient(std::shared_ptr<Shader> const& shader,
+                     Gradient* gradient);
+
+  HWTexture* GetTexture() const { return texture_.get(); }
+
+  /**
+   * Release rows of dead shaders, need to be called after all draws are
+   * submitted.
+   */
+  void EndFrame();
+
+  void CleanUp();
+
+  /**
+   * Fill one ramp row with colors of gradient info, texel i holds the color
+   * at offset i / (RAMP_WIDTH - 1).
+   *
+   * @param info  gradient info returned by Shader::asGradient
+   * @param row   RAMP_WIDTH rgba pixels
+   */
+  static void BakeRamp(Shader::GradientInfo const& info, uint8_t* row);
+
+ private:
+  struct Entry {
+    std::weak_ptr<Shader> shader = {};
+    Gradient gradient = {};
+    uint32_t row = {};
+    size_t age = {};
+  };
+
+  /**
+   * @return free row index or -1 if all rows are used in current frame
+   */
+  int32_t AllocateRow();
+
+ private:
+  std::unique_ptr<HWTexture> texture_ = {};
+  bool texture_ready_ = false;
+  std::unordered_map<Shader const*, Entry> entries_ = {};
+  std::vector<uint32_t> free_rows_ = {};
+  // rows of dead shaders used in current frame, freed in EndFrame
+  std::vector<uint32_t> retired_rows_ = {};
+  uint32_t row_count_ = {};
+  size_t current_age_ = {};
+};
+
+}  // namespace skity
+
+#endif  // SKITY_SRC_RENDER_HW_HW_GRADIENT_CACHE_HPP
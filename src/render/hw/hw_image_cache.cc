@@ -0,0 +1,114 @@
+#include "src/render/hw/hw_image_cache.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace skity {
+
+enum {
+  // default max bytes of all cached textures
+  IMAGE_CACHE_BYTE_BUDGET = 128 * 1024 * 1024,
+  // textures used in recent frames may still be read by gpu, they are never
+  // released to honor the budget
+  IMAGE_CACHE_IN_FLIGHT_FRAMES = 3,
+};
+
+HWImageCache::HWImageCache() : byte_limit_(IMAGE_CACHE_BYTE_BUDGET) {}
+
+HWTexture* HWImageCache::QueryTexture(Pixmap const& pixmap,
+                                      HWTexture::Filter filter) {
+  auto it = entries_.find(MakeKey(pixmap.UniqueID(), filter));
+
+  if (it == entries_.end()) {
+    stats_.miss_count++;
+    return nullptr;
+  }
+
+  stats_.hit_count++;
+  it->second.age = current_age_;
+  return it->second.texture.get();
+}
+
+HWTexture* HWImageCache::StoreTexture(std::shared_ptr<Pixmap> const& pixmap,
+                                      HWTexture::Filter filter,
+                                      std::unique_ptr<HWTexture> texture) {
+  Entry entry{};
+  entry.texture = std::move(texture);
+  entry.pixmap = pixmap;
+  entry.byte_size = static_cast<size_t>(pixmap->Width()) * pixmap->Height() * 4;
+  // mip chain takes a third of level 0
+  if (filter == HWTexture::Filter::kMipmap) {
+    entry.byte_size += entry.byte_size / 3;
+  }
+  entry.age = current_age_;
+
+  HWTexture* result = entry.texture.get();
+
+  stats_.byte_size += entry.byte_size;
+  entries_[MakeKey(pixmap->UniqueID(), filter)] = std::move(entry);
+
+  return result;
+}
+
+void HWImageCache::EndFrame() {
+  PurgeEntries(byte_limit_);
+
+  current_age_++;
+}
+
+void HWImageCache::PurgeUnused() { PurgeEntries(0); }
+
+void HWImageCache::CleanUp() {
+  for (auto& it : entries_) {
+    it.second.texture->Destroy();
+  }
+
+  entries_.clear();
+  stats_.byte_size = 0;
+}
+
+uint64_t HWImageCache::MakeKey(uint32_t id, HWTexture::Filter filter) {
+  return (static_cast<uint64_t>(id) << 8) | static_cast<uint64_t>(filter);
+}
+
+void HWImageCache::PurgeEntries(size_t budget) {
+  std::vector<std::pair<size_t, uint64_t>> candidates;
+
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (current_age_ - it->second.age < IMAGE_CACHE_IN_FLIGHT_FRAMES) {
+      it++;
+      continue;
+    }
+
+    if (it->second.pixmap.expired()) {
+      stats_.byte_size -= it->second.byte_size;
+      stats_.evict_count++;
+      it->second.texture->Destroy();
+      it = entries_.erase(it);
+      continue;
+    }
+
+    candidates.emplace_back(it->second.age, it->first);
+    it++;
+  }
+
+  if (stats_.byte_size <= budget) {
+    return;
+  }
+
+  std::sort(candidates.begin(), candidates.end());
+
+  for (auto const& candidate : candidates) {
+    if (stats_.byte_size <= budget) {
+      break;
+    }
+
+    auto it = entries_.find(candidate.second);
+    stats_.byte_size -= it->second.byte_size;
+    stats_.evict_count++;
+    it->second.texture->Destroy();
+    entries_.erase(it);
+  }
+}
+
+}  // namespace skity
@@ -0,0 +1,81 @@
+#ifndef SKITY_SRC_RENDER_HW_HW_IMAGE_CACHE_HPP
+#define SKITY_SRC_RENDER_HW_HW_IMAGE_CACHE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <skity/io/pixmap.hpp>
+#include <skity/render/canvas.hpp>
+#include <unordered_map>
+
+#include "src/render/hw/hw_texture.hpp"
+
+namespace skity {
+
+/**
+ * Keeps textures of image shaders across frames under a byte budget.
+ *
+ * Pixels of a pixmap are immutable, so a texture is keyed by the unique id of
+ * the pixmap instead of its address, which may be reused by a new pixmap.
+ * Filter is part of the key since it decides mip levels and sampler of the
+ * texture.
+ * Textures of dead pixmaps are released in EndFrame, and while over budget
+ * the textures least recently used are released too. Textures used in recent
+ * frames may still be read by gpu and are never released.
+ */
+class HWImageCache final {
+ public:
+  HWImageCache();
+  ~HWImageCache() = default;
+
+  /**
+   * @return cached texture of pixmap or nullptr, a miss is counted and the
+   *         caller then uploads a new texture to StoreTexture
+   */
+  HWTexture* QueryTexture(Pixmap const& pixmap, HWTexture::Filter filter);
+
+  /**
+   * @param texture texture with pixels of pixmap, created with filter
+   */
+  HWTexture* StoreTexture(std::shared_ptr<Pixmap> const& pixmap,
+                          HWTexture::Filter filter,
+                          std::unique_ptr<HWTexture> texture);
+
+  void SetByteLimit(size_t bytes) { byte_limit_ = bytes; }
+
+  Canvas::ImageCacheStats GetStats() const { return stats_; }
+
+  /**
+   * Release textures of dead pixmaps and honor the budget, need to be called
+   * after all draws are submitted.
+   */
+  void EndFrame();
+
+  /**
+   * Release all textures not used in recent frames.
+   */
+  void PurgeUnused();
+
+  void CleanUp();
+
+ private:
+  struct Entry {
+    std::unique_ptr<HWTexture> texture = {};
+    std::weak_ptr<Pixmap> pixmap = {};
+    size_t byte_size = {};
+    size_t age = {};
+  };
+
+  static uint64_t MakeKey(uint32_t id, HWTexture::Filter filter);
+
+  void PurgeEntries(size_t budget);
+
+ private:
+  std::unordered_map<uint64_t, Entry> entries_ = {};
+  size_t byte_limit_ = {};
+  size_t current_age_ = {};
+  Canvas::ImageCacheStats stats_ = {};
+};
+
+}  // namespace skity
+
+#endif  // SKITY_SRC_RENDER_HW_HW_IMAGE_CACHE_HPP
@@ -1,21 +1,70 @@
 #include "src/render/hw/hw_mesh.hpp"
 
-#include "src/render/hw/hw_renderer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glm/gtc/packing.hpp>
 
 namespace skity {
 
-size_t HWMesh::AppendVertex(float x, float y, float mix, float u, float v) {
-  size_t base = VertexBase();
+// WebGL2 always enables primitive restart, so 0xFFFF can not be a vertex index
+static constexpr size_t kShortIndexVertexLimit = 0xFFFF;
 
-  raw_vertex_buffer_.emplace_back(x, y, mix, u, v);
+static bool IsHalfExact(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
 
-  return base;
+  if ((bits & 0x7FFFFFFF) == 0) {
+    return true;
+  }
+
+  // normal half float: 10 bits mantissa and exponent in [-14, 15]
+  int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127;
+  return (bits & 0x1FFF) == 0 && exponent >= -14 && exponent <= 15;
+}
+
+// round value to the nearest half float if it moves no more than tolerance
+static float QuantizeHalf(float value, float tolerance) {
+  if (!(tolerance > 0.f) || IsHalfExact(value)) {
+    return value;
+  }
+
+  if (std::abs(value) <= tolerance) {
+    return 0.f;
+  }
+
+  float half = glm::unpackHalf1x16(glm::packHalf1x16(value));
+  if (IsHalfExact(half) && std::abs(half - value) <= tolerance) {
+    return half;
+  }
+
+  return value;
+}
+
+static bool IsCompactVertex(HWVertex const &vertex) {
+  return IsHalfExact(vertex.mix) && IsHalfExact(vertex.u) &&
+         IsHalfExact(vertex.v);
+}
+
+size_t HWMesh::AppendVertex(float x, float y, float mix, float u, float v,
+                            float tolerance) {
+  return AppendVertex(HWVertex{x, y, mix, u, v}, tolerance);
 }
 
-size_t HWMesh::AppendVertex(const HWVertex &vertex) {
+size_t HWMesh::AppendVertex(const HWVertex &vertex, float tolerance) {
   size_t base = VertexBase();
 
-  raw_vertex_buffer_.emplace_back(vertex);
+  HWVertex quantized{vertex.x, vertex.y, vertex.mix,
+                     QuantizeHalf(vertex.u, tolerance),
+                     QuantizeHalf(vertex.v, tolerance)};
+  bool compact = IsCompactVertex(quantized);
+
+  // round either both or none, so u and v keep the same precision
+  vertex_buffer_.PushBack(compact ? quantized : vertex);
+
+  if (!compact) {
+    wide_vertex_count_++;
+  }
 
   return base;
 }
@@ -23,23 +72,192 @@ size_t HWMesh::AppendVertex(const HWVertex &vertex) {
 size_t HWMesh::AppendIndices(const std::vector<uint32_t> &indices) {
   size_t base = IndexBase();
 
-  raw_index_buffer_.insert(raw_index_buffer_.end(), indices.begin(),
-                           indices.end());
+  for (auto index : indices) {
+    index_buffer_.PushBack(index);
+  }
+
+  return base;
+}
+
+size_t HWMesh::CopyIndices(uint32_t start, uint32_t count) {
+  size_t base = IndexBase();
+
+  for (uint32_t i = 0; i < count; i++) {
+    index_buffer_.PushBack(index_buffer_[start + i]);
+  }
 
   return base;
 }
 
+void HWMesh::RetainRegions(std::vector<HWMeshRegion *> const &regions) {
+  struct Move {
+    HWMeshRegion *region;
+    HWMeshRegion old;
+  };
+
+  std::vector<Move> moves;
+  moves.reserve(regions.size());
+  for (auto region : regions) {
+    moves.emplace_back(Move{region, *region});
+  }
+
+  // Regions never overlap, so packing them in ascending order only moves
+  // data towards the front and can be done in place.
+  std::sort(moves.begin(), moves.end(), [](Move const &a, Move const &b) {
+    return a.old.vertex_start < b.old.vertex_start;
+  });
+
+  bool moved = false;
+  uint32_t vertex_cursor = 0;
+  for (auto &move : moves) {
+    if (move.old.vertex_start != vertex_cursor) {
+      for (uint32_t i = 0; i < move.old.vertex_count; i++) {
+        vertex_buffer_[vertex_cursor + i] =
+            vertex_buffer_[move.old.vertex_start + i];
+      }
+      moved = true;
+    }
+    move.region->vertex_start = vertex_cursor;
+    vertex_cursor += move.old.vertex_count;
+  }
+
+  std::sort(moves.begin(), moves.end(), [](Move const &a, Move const &b) {
+    return a.old.index_start < b.old.index_start;
+  });
+
+  uint32_t index_cursor = 0;
+  for (auto &move : moves) {
+    uint32_t old_base = move.old.vertex_start;
+    uint32_t new_base = move.region->vertex_start;
+    if (move.old.index_start != index_cursor || old_base != new_base) {
+      for (uint32_t i = 0; i < move.old.index_count; i++) {
+        index_buffer_[index_cursor + i] =
+            index_buffer_[move.old.index_start + i] - old_base + new_base;
+      }
+      moved = true;
+    }
+    move.region->index_start = index_cursor;
+    index_cursor += move.old.index_count;
+  }
+
+  if (moved || vertex_cursor != retained_vertex_count_ ||
+      index_cursor != retained_index_count_) {
+    retained_version_++;
+
+    retained_wide_vertex_count_ = 0;
+    for (uint32_t i = 0; i < vertex_cursor; i++) {
+      if (!IsCompactVertex(vertex_buffer_[i])) {
+        retained_wide_vertex_count_++;
+      }
+    }
+  }
+
+  retained_vertex_count_ = vertex_cursor;
+  retained_index_count_ = index_cursor;
+}
+
 void HWMesh::UploadMesh(HWRenderer *renderer) {
-  renderer->UploadVertexBuffer(raw_vertex_buffer_.data(),
-                               sizeof(HWVertex) * raw_vertex_buffer_.size());
+  uint32_t buffer_set = renderer->BeginBufferFrame();
+
+  if (uploaded_versions_.size() != renderer->BufferSetCount()) {
+    uploaded_versions_.assign(renderer->BufferSetCount(), 0);
+    uploaded_formats_.assign(renderer->BufferSetCount(), HWMeshFormat{});
+  }
+
+  format_ = ChooseFormat(renderer);
+  renderer->SetMeshFormat(format_);
+
+  size_t vertex_size =
+      format_.compact_vertex ? sizeof(HWCompactVertex) : sizeof(HWVertex);
+  size_t index_size = format_.short_index ? sizeof(uint16_t) : sizeof(uint32_t);
+
+  bool vertex_kept =
+      renderer->ReserveVertexBuffer(vertex_size * vertex_buffer_.Size());
+  bool index_kept =
+      renderer->ReserveIndexBuffer(index_size * index_buffer_.Size());
+
+  // only geometry recorded in this frame need to be uploaded if retained part
+  // is already in current gpu buffer with the same layout
+  bool retained_valid = vertex_kept && index_kept &&
+                        uploaded_versions_[buffer_set] == retained_version_ &&
+                        uploaded_formats_[buffer_set] == format_;
+
+  UploadVertices(renderer, retained_valid ? retained_vertex_count_ : 0);
+  UploadIndices(renderer, retained_valid ? retained_index_count_ : 0);
 
-  renderer->UploadIndexBuffer(raw_index_buffer_.data(),
-                              sizeof(uint32_t) * raw_index_buffer_.size());
+  uploaded_versions_[buffer_set] = retained_version_;
+  uploaded_formats_[buffer_set] = format_;
 }
 
 void HWMesh::ResetMesh() {
-  raw_index_buffer_.clear();
-  raw_vertex_buffer_.clear();
+  index_buffer_.Truncate(retained_index_count_);
+  vertex_buffer_.Truncate(retained_vertex_count_);
+  wide_vertex_count_ = retained_wide_vertex_count_;
+}
+
+HWMeshFormat HWMesh::ChooseFormat(HWRenderer *renderer) {
+  HWMeshFormat format;
+
+  format.short_index = vertex_buffer_.Size() < kShortIndexVertexLimit;
+  format.compact_vertex =
+      renderer->SupportCompactVertex() && wide_vertex_count_ == 0;
+
+  return format;
+}
+
+void HWMesh::UploadVertices(HWRenderer *renderer, size_t begin) {
+  if (!format_.compact_vertex) {
+    vertex_buffer_.ForEachRange(
+        begin, vertex_buffer_.Size(),
+        [renderer](HWVertex *data, size_t offset, size_t count) {
+          renderer->UpdateVertexBuffer(data, sizeof(HWVertex) * offset,
+                                       sizeof(HWVertex) * count);
+        });
+    return;
+  }
+
+  vertex_buffer_.ForEachRange(
+      begin, vertex_buffer_.Size(),
+      [this, renderer](HWVertex *data, size_t offset, size_t count) {
+        compact_vertices_.resize(count);
+        for (size_t i = 0; i < count; i++) {
+          auto &dst = compact_vertices_[i];
+          dst.x = data[i].x;
+          dst.y = data[i].y;
+          dst.mix = glm::packHalf1x16(data[i].mix);
+          dst.u = glm::packHalf1x16(data[i].u);
+          dst.v = glm::packHalf1x16(data[i].v);
+        }
+
+        renderer->UpdateVertexBuffer(compact_vertices_.data(),
+                                     sizeof(HWCompactVertex) * offset,
+                                     sizeof(HWCompactVertex) * count);
+      });
+}
+
+void HWMesh::UploadIndices(HWRenderer *renderer, size_t begin) {
+  if (!format_.short_index) {
+    index_buffer_.ForEachRange(
+        begin, index_buffer_.Size(),
+        [renderer](uint32_t *data, size_t offset, size_t count) {
+          renderer->UpdateIndexBuffer(data, sizeof(uint32_t) * offset,
+                                      sizeof(uint32_t) * count);
+        });
+    return;
+  }
+
+  index_buffer_.ForEachRange(
+      begin, index_buffer_.Size(),
+      [this, renderer](uint32_t *data, size_t offset, size_t count) {
+        short_indices_.resize(count);
+        for (size_t i = 0; i < count; i++) {
+          short_indices_[i] = static_cast<uint16_t>(data[i]);
+        }
+
+        renderer->UpdateIndexBuffer(short_indices_.data(),
+                                    sizeof(uint16_t) * offset,
+                                    sizeof(uint16_t) * count);
+      });
 }
 
-}  // namespace skity
\ No newline at end of file
+}  // namespace skity
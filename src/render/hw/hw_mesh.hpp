@@ -1,13 +1,14 @@
 #ifndef SKITY_SRC_RENDER_HW_HW_MESH_HPP
 #define SKITY_SRC_RENDER_HW_HW_MESH_HPP
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <vector>
 
-namespace skity {
+#include "src/render/hw/hw_renderer.hpp"
 
-class HWRenderer;
+namespace skity {
 
 enum {
   HW_VERTEX_TYPE_LINE_NORMAL = 1,
@@ -20,6 +21,12 @@ enum {
   HW_VERTEX_TYPE_TEXT = 5,
   // stroke quad
   HW_VERTEX_TYPE_QUAD_STROKE = 6,
+  // analytic rrect, u,v store position relative to the nearest corner arc
+  // center in units of corner radii. Stroke encodes inner / outer radius
+  // ratio in type as HW_VERTEX_TYPE_RRECT + ratio * HW_VERTEX_RRECT_STEPS,
+  // integers in this range are exact in half float
+  HW_VERTEX_TYPE_RRECT = 1024,
+  HW_VERTEX_RRECT_STEPS = 1023,
 };
 
 struct HWVertex {
@@ -33,27 +40,188 @@ struct HWVertex {
       : x(v1), y(v2), mix(v3), u(v4), v(v5) {}
 };
 
+/**
+ * 16 bytes layout of HWVertex. mix, u and v are stored as half floats, it is
+ * only used when every value in the frame converts without loss.
+ *
+ * Vertex type tags are integers below 2048 and always exact in mix. Rasters
+ * which know the precision u and v need round them with
+ * HWMesh::AppendVertex. padding keeps the attribute 4 components wide, the
+ * only half float vertex format every Vulkan device supports.
+ */
+struct HWCompactVertex {
+  float x = 0.f;
+  float y = 0.f;
+  uint16_t mix = 0;
+  uint16_t u = 0;
+  uint16_t v = 0;
+  uint16_t padding = 0;
+};
+
+/**
+ * Part of HWMesh produced by one raster pass, indices in it only reference
+ * vertices inside the same region.
+ */
+struct HWMeshRegion {
+  uint32_t vertex_start = 0;
+  uint32_t vertex_count = 0;
+  uint32_t index_start = 0;
+  uint32_t index_count = 0;
+};
+
+/**
+ * Growable array stored in fixed size chunks. Growing never moves elements
+ * already written, and chunk memory is kept for reuse when the array shrinks.
+ */
+template <typename T>
+class HWChunkBuffer final {
+ public:
+  // 16K elements per chunk
+  static constexpr size_t kChunkShift = 14;
+  static constexpr size_t kChunkSize = 1 << kChunkShift;
+
+  size_t Size() const { return size_; }
+
+  T& operator[](size_t index) {
+    return chunks_[index >> kChunkShift][index & (kChunkSize - 1)];
+  }
+
+  void PushBack(T const& value) {
+    size_t chunk = size_ >> kChunkShift;
+    if (chunk == chunks_.size()) {
+      chunks_.emplace_back();
+      chunks_.back().reserve(kChunkSize);
+    }
+
+    chunks_[chunk].emplace_back(value);
+    size_++;
+  }
+
+  void Truncate(size_t size) {
+    if (size >= size_) {
+      return;
+    }
+
+    for (size_t i = size >> kChunkShift; i < chunks_.size(); i++) {
+      size_t begin = i << kChunkShift;
+      size_t keep = size > begin ? size - begin : 0;
+      if (keep < chunks_[i].size()) {
+        chunks_[i].erase(chunks_[i].begin() + keep, chunks_[i].end());
+      }
+    }
+
+    size_ = size;
+  }
+
+  /**
+   * Visit elements in [begin, end) as contiguous pieces.
+   *
+   * @param func  void(T* data, size_t offset, size_t count), offset is the
+   *              index of data[0] in this array
+   */
+  template <typename F>
+  void ForEachRange(size_t begin, size_t end, F&& func) {
+    while (begin < end) {
+      size_t offset = begin & (kChunkSize - 1);
+      size_t count = std::min(kChunkSize - offset, end - begin);
+
+      func(chunks_[begin >> kChunkShift].data() + offset, begin, count);
+
+      begin += count;
+    }
+  }
+
+ private:
+  // every chunk reserves kChunkSize elements, so it never reallocates
+  std::vector<std::vector<T>> chunks_ = {};
+  size_t size_ = 0;
+};
+
+/**
+ * Geometry of one frame, plus geometry retained across frames.
+ *
+ * Rasters append into chunked storage directly. UploadMesh streams only the
+ * ranges which the gpu buffer of current frame does not hold yet.
+ *
+ * Frames with fewer than 65535 vertices upload uint16_t indices, and frames
+ * whose vertex attributes all fit in half floats upload HWCompactVertex if the
+ * renderer supports it.
+ */
 class HWMesh {
  public:
   HWMesh() = default;
   ~HWMesh() = default;
 
+  /**
+   * @param tolerance max change of u and v allowed. If both can be rounded to
+   *                  half floats within it, the rounded values are stored so
+   *                  the vertex still fits HWCompactVertex
+   */
   size_t AppendVertex(float x, float y, float mix, float u = 0.f,
-                      float v = 0.f);
-  size_t AppendVertex(HWVertex const& vertex);
+                      float v = 0.f, float tolerance = 0.f);
+  size_t AppendVertex(HWVertex const& vertex, float tolerance = 0.f);
 
-  size_t VertexBase() { return raw_vertex_buffer_.size(); }
+  size_t VertexBase() { return vertex_buffer_.Size(); }
 
-  size_t IndexBase() { return raw_index_buffer_.size(); }
+  /**
+   * @return true if every vertex in the mesh fits HWCompactVertex
+   */
+  bool IsCompact() const { return wide_vertex_count_ == 0; }
+
+  size_t IndexBase() { return index_buffer_.Size(); }
 
   size_t AppendIndices(std::vector<uint32_t> const& indices);
 
+  /**
+   * Append a copy of indices in [start, start + count) already in this mesh.
+   *
+   * @return index base of the copy
+   */
+  size_t CopyIndices(uint32_t start, uint32_t count);
+
+  /**
+   * Keep regions alive across ResetMesh. Regions are packed to the front of
+   * the buffers and their start fields are updated in place, all geometry not
+   * listed here ( including previously retained one ) is dropped by the next
+   * ResetMesh.
+   *
+   * Retained geometry is only uploaded again when it changes or the gpu
+   * buffer holding it is reallocated.
+   */
+  void RetainRegions(std::vector<HWMeshRegion*> const& regions);
+
   void UploadMesh(HWRenderer* renderer);
   void ResetMesh();
 
+  /**
+   * @return layout used by the last UploadMesh
+   */
+  HWMeshFormat const& GetFormat() const { return format_; }
+
+ private:
+  HWMeshFormat ChooseFormat(HWRenderer* renderer);
+
+  void UploadVertices(HWRenderer* renderer, size_t begin);
+  void UploadIndices(HWRenderer* renderer, size_t begin);
+
  private:
-  std::vector<HWVertex> raw_vertex_buffer_;
-  std::vector<uint32_t> raw_index_buffer_;
+  HWChunkBuffer<HWVertex> vertex_buffer_ = {};
+  HWChunkBuffer<uint32_t> index_buffer_ = {};
+  size_t retained_vertex_count_ = 0;
+  size_t retained_index_count_ = 0;
+  // vertices which can not be stored in HWCompactVertex
+  size_t wide_vertex_count_ = 0;
+  size_t retained_wide_vertex_count_ = 0;
+  // bumped every time retained geometry changes
+  uint64_t retained_version_ = 1;
+  // retained version held by each gpu buffer set, 0 means nothing
+  std::vector<uint64_t> uploaded_versions_ = {};
+  // layout of data in each gpu buffer set
+  std::vector<HWMeshFormat> uploaded_formats_ = {};
+  HWMeshFormat format_ = {};
+  // conversion buffers, hold at most one chunk
+  std::vector<HWCompactVertex> compact_vertices_ = {};
+  std::vector<uint16_t> short_indices_ = {};
 };
 
 }  // namespace skity
@@ -1,6 +1,7 @@
 #include "src/render/hw/hw_path_raster.hpp"
 
 #include <array>
+#include <skity/effect/shader.hpp>
 
 #include "src/geometry/geometry.hpp"
 #include "src/render/hw/hw_mesh.hpp"
@@ -30,6 +31,11 @@ void HWPathRaster::StrokePath(const Path& path) {
 
   VisitPath(path, false);
 
+  if (CanStrokeDirectly(GetPaint())) {
+    SwitchStencilToColor();
+    return;
+  }
+
   SetBufferType(BufferType::kColor);
 
   Rect bounds = RasterBounds();
@@ -37,6 +43,19 @@ void HWPathRaster::StrokePath(const Path& path) {
   FillRect(bounds);
 }
 
+bool HWPathRaster::CanStrokeDirectly(Paint const& paint) {
+  // hairline is drawn with reduced alpha
+  if (paint.getStrokeWidth() < 0.5f || paint.getAlphaF() < 1.f) {
+    return false;
+  }
+
+  if (paint.getShader()) {
+    return paint.getShader()->isOpaque();
+  }
+
+  return paint.getStrokeColor().a >= 1.f;
+}
+
 void HWPathRaster::OnBeginPath() { ResetRaster(); }
 
 void HWPathRaster::OnEndPath() {
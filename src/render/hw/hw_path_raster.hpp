@@ -13,13 +13,23 @@ enum class Orientation;
 
 class HWPathRaster : public HWPathVisitor {
  public:
-  HWPathRaster(HWMesh* mesh, Paint const& paint, bool use_gs)
-      : HWPathVisitor(mesh, paint, use_gs) {}
+  HWPathRaster(HWMesh* mesh, Paint const& paint, bool use_gs,
+               float scale = 1.f)
+      : HWPathVisitor(mesh, paint, use_gs, scale) {}
   ~HWPathRaster() override = default;
 
   void FillPath(Path const& path);
   void StrokePath(Path const& path);
 
+  /**
+   * Overlapping stroke triangles only need the stencil pass when blending a
+   * pixel twice is visible. Strokes of opaque paints are written to color
+   * buffer directly.
+   *
+   * @return true if StrokePath skips stencil for this paint
+   */
+  static bool CanStrokeDirectly(Paint const& paint);
+
  protected:
   void OnBeginPath() override;
   void OnEndPath() override;
@@ -1,39 +1,28 @@
 #include "src/render/hw/hw_path_visitor.hpp"
 
 #include <array>
+#include <cmath>
 
 #include "src/geometry/conic.hpp"
+#include "src/geometry/geometry.hpp"
 
 namespace skity {
 
-#define QUAD_BEVEL_LIMIT 0.01f
+enum {
+  // upper bound of segments a single curve can be flattened into
+  HW_MAX_CURVE_SEGMENTS = 256,
+};
 
-static void split_cubic(glm::vec2* base) {
-  glm::vec2 a, b, c;
+// max distance in pixels between curve and flattened polyline
+static constexpr float HW_CURVE_TOLERANCE = 0.25f;
 
-  base[6] = base[3];
-  a = base[0] + base[1];
-  b = base[1] + base[2];
-  c = base[2] + base[3];
-
-  base[5] = c / 2.f;
-  c += b;
-  base[4] = c / 4.f;
-  base[1] = a / 2.f;
-  a += b;
-  base[2] = a / 4.f;
-  base[3] = (a + c) / 8.f;
-}
-
-static void split_quad(glm::vec2* base) {
-  glm::vec2 a, b;
-
-  base[4] = base[2];
-  a = base[0] + base[1];
-  b = base[1] + base[2];
-  base[3] = b / 2.f;
-  base[2] = (a + b) / 4.f;
-  base[1] = a / 2.f;
+HWPathVisitor::HWPathVisitor(HWMesh* mesh, Paint const& paint, bool use_gs,
+                             float scale)
+    : HWGeometryRaster(mesh, paint, use_gs),
+      tolerance_(HW_CURVE_TOLERANCE) {
+  if (scale > 0.f && !std::isinf(scale)) {
+    tolerance_ = HW_CURVE_TOLERANCE / scale;
+  }
 }
 
 void HWPathVisitor::VisitPath(Path const& path, bool force_close) {
@@ -89,6 +78,11 @@ void HWPathVisitor::HandleLineTo(const glm::vec2& p1, const glm::vec2& p2) {
 
 void HWPathVisitor::HandleQuadTo(const glm::vec2& p1, const glm::vec2& p2,
                                  const glm::vec2& p3) {
+  FlattenQuad(p1, p2, p3, tolerance_);
+}
+
+void HWPathVisitor::FlattenQuad(const glm::vec2& p1, const glm::vec2& p2,
+                                const glm::vec2& p3, float tolerance) {
   if (UseGeometryShader()) {
     OnQuadTo(p1, p2, p3);
     return;
@@ -97,53 +91,14 @@ void HWPathVisitor::HandleQuadTo(const glm::vec2& p1, const glm::vec2& p2,
   auto saved_join = LineJoin();
   ChangeLineJoin(Paint::kRound_Join);
 
-  std::array<glm::vec2, 33 * 3 + 1> bez_stack{};
-  std::array<int32_t, 33> level_stack{};
+  int32_t count =
+      WangsFormulaQuad(p1, p2, p3, tolerance, HW_MAX_CURVE_SEGMENTS);
 
-  int32_t top, level;
-  int32_t* levels = level_stack.data();
-
-  auto arc = bez_stack.data();
-  arc[0] = p3;
-  arc[1] = p2;
-  arc[2] = p1;
-
-  top = 0;
-
-  glm::vec2 delta = glm::abs(arc[2] + arc[0] - 2.f * arc[1]);
-
-  // If delta.x or delta.y is zero maybe this is a circle approximate
-  // And need to make sure at least 3 split to make curve smooth
-  float d = 0.f;
-  if (FloatNearlyZero(delta.x)) {
-    d = delta.y;
-  } else if (FloatNearlyZero(delta.y)) {
-    d = delta.x;
-  } else {
-    d = glm::min(delta.x, delta.y);
+  QuadCoeff coeff{p3 - 2.f * p2 + p1, 2.f * (p2 - p1), p1};
+  for (int32_t i = 1; i < count; i++) {
+    HandleLineTo(prev_pt_, coeff.eval(static_cast<float>(i) / count));
   }
-
-  level = 0;
-  do {
-    d = d / 4.f;
-    level++;
-  } while (d > QUAD_BEVEL_LIMIT);
-
-  levels[0] = std::max(3, level);
-  do {
-    level = levels[top];
-    if (level > 0) {
-      split_quad(arc);
-      arc += 2;
-      top++;
-      levels[top] = levels[top - 1] = level - 1;
-      continue;
-    }
-  Draw:
-    HandleLineTo(prev_pt_, arc[0]);
-    top--;
-    arc -= 2;
-  } while (top >= 0);
+  HandleLineTo(prev_pt_, p3);
 
   ChangeLineJoin(saved_join);
 }
@@ -154,49 +109,38 @@ void HWPathVisitor::HandleConicTo(glm::vec2 const& p1, glm::vec2 const& p2,
   Point control = {p2.x, p2.y, 0.f, 1.f};
   Point end = {p3.x, p3.y, 0.f, 1.f};
 
-  std::array<Point, 5> quads{};
+  // half of the tolerance goes to approximating the conic with quads, the
+  // other half to flattening those quads
+  float tolerance = tolerance_ * 0.5f;
+
+  std::array<Point, 2 * (1 << Conic::kMaxConicToQuadPOW2) + 1> quads{};
   Conic conic{start, control, end, weight};
-  conic.chopIntoQuadsPOW2(quads.data(), 1);
+  uint32_t count =
+      conic.chopIntoQuadsPOW2(quads.data(), conic.computeQuadPOW2(tolerance));
   quads[0] = start;
 
-  HandleQuadTo(quads[0], quads[1], quads[2]);
-  HandleQuadTo(quads[2], quads[3], quads[4]);
+  for (uint32_t i = 0; i < count; i++) {
+    FlattenQuad(quads[2 * i], quads[2 * i + 1], quads[2 * i + 2], tolerance);
+  }
 }
 
 void HWPathVisitor::HandleCubicTo(glm::vec2 const& p1, glm::vec2 const& p2,
                                   glm::vec2 const& p3, glm::vec2 const& p4) {
-  std::array<glm::vec2, 32 * 3 + 1> bez_stack;
-
-  auto arc = bez_stack.data();
-
-  arc[0] = p4;
-  arc[1] = p3;
-  arc[2] = p2;
-  arc[3] = p1;
-
-  glm::vec2 from = p1;
-  for (;;) {
-    auto delta1 = glm::abs(2.f * arc[0] - 3.f * arc[1] + arc[3]);
-    auto delta2 = glm::abs(arc[0] - 3.f * arc[2] + 2.f * arc[3]);
-
-    if (std::max(delta1.x, delta1.y) > 0.5f ||
-        std::max(delta2.x, delta2.y) > 0.5f) {
-      goto SPLIT;
-    }
-
-    HandleLineTo(prev_pt_, arc[0]);
-    if (arc == bez_stack.data()) {
-      return;
-    }
+  auto saved_join = LineJoin();
+  ChangeLineJoin(Paint::kRound_Join);
 
-    arc -= 3;
-    from = arc[0];
-    continue;
+  int32_t count =
+      WangsFormulaCubic(p1, p2, p3, p4, tolerance_, HW_MAX_CURVE_SEGMENTS);
 
-  SPLIT:
-    split_cubic(arc);
-    arc += 3;
+  std::array<Point, 4> src{Point{p1, 0.f, 1.f}, Point{p2, 0.f, 1.f},
+                           Point{p3, 0.f, 1.f}, Point{p4, 0.f, 1.f}};
+  CubicCoeff coeff{src};
+  for (int32_t i = 1; i < count; i++) {
+    HandleLineTo(prev_pt_, coeff.eval(static_cast<float>(i) / count));
   }
+  HandleLineTo(prev_pt_, p4);
+
+  ChangeLineJoin(saved_join);
 }
 
 void HWPathVisitor::HandleClose() {}
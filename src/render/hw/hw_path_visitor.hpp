@@ -11,10 +11,18 @@ namespace skity {
 class HWDrawRange;
 class HWMesh;
 
+/**
+ * Walks a path and flattens curves into line segments. Segment count of every
+ * curve is computed once with Wang's formula, against a tolerance in pixels
+ * mapped into path space by the max scale of the transform.
+ */
 class HWPathVisitor : public HWGeometryRaster {
  public:
-  HWPathVisitor(HWMesh* mesh, Paint const& paint, bool use_gs)
-      : HWGeometryRaster(mesh, paint, use_gs) {}
+  /**
+   * @param scale max scale of the transform the path is drawn with
+   */
+  HWPathVisitor(HWMesh* mesh, Paint const& paint, bool use_gs,
+                float scale = 1.f);
   virtual ~HWPathVisitor() = default;
 
   void VisitPath(Path const& path, bool force_close);
@@ -24,6 +32,8 @@ class HWPathVisitor : public HWGeometryRaster {
   void HandleLineTo(glm::vec2 const& p1, glm::vec2 const& p2);
   void HandleQuadTo(glm::vec2 const& p1, glm::vec2 const& p2,
                     glm::vec2 const& p3);
+  void FlattenQuad(glm::vec2 const& p1, glm::vec2 const& p2,
+                   glm::vec2 const& p3, float tolerance);
   void HandleConicTo(glm::vec2 const& p1, glm::vec2 const& p2,
                      glm::vec2 const& p3, float weight);
   void HandleCubicTo(glm::vec2 const& p1, glm::vec2 const& p2,
@@ -50,6 +60,8 @@ class HWPathVisitor : public HWGeometryRaster {
   glm::vec2 first_pt_ = {};
   glm::vec2 prev_dir_ = {};
   glm::vec2 prev_pt_ = {};
+  // flatten tolerance in path space
+  float tolerance_;
 };
 
 }  // namespace skity
@@ -1,14 +1,50 @@
 #include "src/render/hw/hw_render_target.hpp"
 
+#include <algorithm>
+
 namespace skity {
 
 enum {
   CACHE_PERGE_LIMIT = 1000,
+  // sizes are rounded up to multiple of this
+  CACHE_BUCKET_STEP = 64,
+  // max bytes of all cached targets
+  CACHE_BYTE_BUDGET = 64 * 1024 * 1024,
+  // targets used in recent frames may still be read by gpu, they are never
+  // destroyed to honor the budget
+  CACHE_IN_FLIGHT_FRAMES = 3,
 };
 
+size_t HWRenderTarget::ByteSize() const {
+  size_t pixels = static_cast<size_t>(width_) * height_;
+  size_t samples = std::max<uint32_t>(sample_count_, 1);
+
+  // color, horizontal and vertical rgba textures
+  size_t bytes = pixels * 4 * 3;
+  // stencil attachment
+  bytes += pixels * 4 * samples;
+  // multisample color attachment
+  if (EnableMultiSample()) {
+    bytes += pixels * 4 * samples;
+  }
+
+  return bytes;
+}
+
+HWRenderTargetCache::Size HWRenderTargetCache::BucketSize(uint32_t width,
+                                                          uint32_t height) {
+  Size size;
+  size.width = (std::max(width, 1u) + CACHE_BUCKET_STEP - 1) /
+               CACHE_BUCKET_STEP * CACHE_BUCKET_STEP;
+  size.height = (std::max(height, 1u) + CACHE_BUCKET_STEP - 1) /
+                CACHE_BUCKET_STEP * CACHE_BUCKET_STEP;
+
+  return size;
+}
+
 HWRenderTarget* HWRenderTargetCache::QueryTarget(uint32_t width,
                                                  uint32_t height) {
-  Size target_size{width, height};
+  Size target_size = BucketSize(width, height);
 
   auto const& it = info_map_.find(target_size);
 
@@ -27,7 +63,9 @@ HWRenderTarget* HWRenderTargetCache::QueryTarget(uint32_t width,
 
 HWRenderTarget* HWRenderTargetCache::StoreCache(
     std::unique_ptr<HWRenderTarget> target) {
-  Size target_size{target->Width(), target->Height()};
+  Size target_size{};
+  target_size.width = target->Width();
+  target_size.height = target->Height();
   Info target_info{current_age_, true, target.get()};
 
   auto it = info_map_.find(target_size);
@@ -38,6 +76,7 @@ HWRenderTarget* HWRenderTargetCache::StoreCache(
     info_map_.insert(std::make_pair(target_size, info_list));
   }
 
+  byte_size_ += target->ByteSize();
   target_cache_.insert(std::make_pair(target_info.target, std::move(target)));
 
   return target_info.target;
@@ -48,16 +87,43 @@ void HWRenderTargetCache::BeginFrame() {
   ClearUsedFlags();
 }
 
-void HWRenderTargetCache::EndFrame() {
+void HWRenderTargetCache::EndFrame() { PurgeTargets(CACHE_BYTE_BUDGET); }
+
+void HWRenderTargetCache::PurgeUnused() { PurgeTargets(0); }
+
+void HWRenderTargetCache::CleanUp() {
+  for (auto& it : target_cache_) {
+    it.second->Destroy();
+  }
+
+  target_cache_.clear();
+  info_map_.clear();
+  byte_size_ = 0;
+}
+
+void HWRenderTargetCache::ClearUsedFlags() {
+  for (auto& it : info_map_) {
+    for (auto& list : it.second) {
+      list.used = false;
+    }
+  }
+}
+
+void HWRenderTargetCache::PurgeTargets(size_t budget) {
+  std::vector<Info> candidates;
+
   for (auto map_it = info_map_.begin(); map_it != info_map_.end();) {
     for (auto it = map_it->second.begin(); it != map_it->second.end();) {
       if (current_age_ - it->age > CACHE_PERGE_LIMIT) {
-        auto rt = it->target;
+        DestroyTarget(it->target);
         it = map_it->second.erase(it);
-        target_cache_.erase(rt);
-      } else {
-        it++;
+        continue;
       }
+
+      if (current_age_ - it->age >= CACHE_IN_FLIGHT_FRAMES) {
+        candidates.emplace_back(*it);
+      }
+      it++;
     }
 
     if (map_it->second.empty()) {
@@ -66,20 +132,46 @@ void HWRenderTargetCache::EndFrame() {
       map_it++;
     }
   }
-}
 
-void HWRenderTargetCache::CleanUp() {
-  for (auto& it : target_cache_) {
-    it.second->Destroy();
+  if (byte_size_ <= budget) {
+    return;
   }
-}
 
-void HWRenderTargetCache::ClearUsedFlags() {
-  for (auto& it : info_map_) {
-    for (auto& list : it.second) {
-      list.used = false;
+  std::sort(candidates.begin(), candidates.end(),
+            [](Info const& a, Info const& b) { return a.age < b.age; });
+
+  for (auto const& info : candidates) {
+    if (byte_size_ <= budget) {
+      break;
     }
+
+    Size target_size{};
+    target_size.width = info.target->Width();
+    target_size.height = info.target->Height();
+
+    auto map_it = info_map_.find(target_size);
+    auto& list = map_it->second;
+    list.erase(std::find_if(list.begin(), list.end(), [&info](Info const& i) {
+      return i.target == info.target;
+    }));
+    if (list.empty()) {
+      info_map_.erase(map_it);
+    }
+
+    DestroyTarget(info.target);
   }
 }
 
-}  // namespace skity
\ No newline at end of file
+void HWRenderTargetCache::DestroyTarget(HWRenderTarget* target) {
+  auto it = target_cache_.find(target);
+
+  if (it == target_cache_.end()) {
+    return;
+  }
+
+  byte_size_ -= target->ByteSize();
+  target->Destroy();
+  target_cache_.erase(it);
+}
+
+}  // namespace skity
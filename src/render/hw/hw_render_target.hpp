@@ -38,16 +38,36 @@ class HWRenderTarget {
 
   virtual void Destroy() = 0;
 
-  void SetEnableMultiSample(bool enable) { msaa_ = enable; }
+  /**
+   * @param count sample count of multisample attachments, 0 or 1 disables
+   *              multisample, need to be set before Init
+   */
+  void SetSampleCount(uint32_t count) { sample_count_ = count; }
 
-  bool EnableMultiSample() const { return msaa_; }
+  uint32_t SampleCount() const { return sample_count_; }
+
+  bool EnableMultiSample() const { return sample_count_ > 1; }
+
+  /**
+   * @return approximate gpu memory held by all attachments of this target
+   */
+  size_t ByteSize() const;
 
  private:
   uint32_t width_ = 0;
   uint32_t height_ = 0;
-  bool msaa_ = false;
+  uint32_t sample_count_ = 0;
 };
 
+/**
+ * Pool of offscreen targets used by mask filter passes.
+ *
+ * Target sizes are rounded up to buckets, so draws with slightly different
+ * bounds share targets and only render into the top left part of them. Memory
+ * of all targets is kept under a budget, targets least recently used are
+ * destroyed first once the pool grows over it.
+ */
+
 class HWRenderTargetCache final {
   using RefRenderTarget = std::unique_ptr<HWRenderTarget>;
 
@@ -83,23 +103,46 @@ class HWRenderTargetCache final {
   HWRenderTargetCache() = default;
   ~HWRenderTargetCache() = default;
 
+  /**
+   * @return bucket size of targets holding content of width x height
+   */
+  static Size BucketSize(uint32_t width, uint32_t height);
+
+  /**
+   * @return free target of the bucket of width x height or nullptr, the
+   *         target is marked used until next BeginFrame
+   */
   HWRenderTarget* QueryTarget(uint32_t width, uint32_t height);
 
+  /**
+   * @param target target created with BucketSize, marked used in current
+   *               frame
+   */
   HWRenderTarget* StoreCache(std::unique_ptr<HWRenderTarget> target);
 
   void BeginFrame();
 
   void EndFrame();
 
+  /**
+   * Destroy all targets not used in recent frames.
+   */
+  void PurgeUnused();
+
   void CleanUp();
 
  private:
   void ClearUsedFlags();
 
+  void PurgeTargets(size_t budget);
+
+  void DestroyTarget(HWRenderTarget* target);
+
  private:
   std::unordered_map<HWRenderTarget*, RefRenderTarget> target_cache_ = {};
   std::unordered_map<Size, std::vector<Info>, HWRenderTargetCache::SizeHash>
       info_map_ = {};
+  size_t byte_size_ = {};
   size_t current_age_ = {};
 };
 
@@ -1,7 +1,10 @@
 #ifndef SKITY_SRC_RENDER_HW_HW_SHADER_HPP
 #define SKITY_SRC_RENDER_HW_HW_SHADER_HPP
 
+#include <algorithm>
+#include <cmath>
 #include <glm/glm.hpp>
+#include <skity/geometry/rect.hpp>
 #include <skity/graphic/color.hpp>
 #include <vector>
 
@@ -38,6 +41,25 @@ enum class HWStencilFunc {
   ALWAYS,
 };
 
+/**
+ * Layout of geometry uploaded by HWMesh in one frame.
+ */
+struct HWMeshFormat {
+  // uint16_t indices instead of uint32_t
+  bool short_index = false;
+  // HWCompactVertex instead of HWVertex
+  bool compact_vertex = false;
+
+  bool operator==(HWMeshFormat const& other) const {
+    return short_index == other.short_index &&
+           compact_vertex == other.compact_vertex;
+  }
+
+  bool operator!=(HWMeshFormat const& other) const {
+    return !(*this == other);
+  }
+};
+
 class HWTexture;
 class HWRenderTarget;
 
@@ -121,14 +143,74 @@ class HWRenderer {
   virtual void SetGradientPositions(std::vector<float> const& pos) = 0;
 
   /**
-   * @brief Upload vertex buffer data to GPU
+   * @brief Upload v coordinate of gradient row in ramp texture bound to slot
+   *        0, negative value means colors come from uniform arrays
+   *
+   * @param row
+   */
+  virtual void SetGradientRampRow(float row) {}
+
+  /**
+   * @brief Start uploading geometry of a new frame. Backends which keep
+   *        several buffer sets switch to the next one, so buffers the gpu may
+   *        still read are not written.
+   *
+   * @return index of buffer set used by this frame, in [0, BufferSetCount())
+   */
+  virtual uint32_t BeginBufferFrame() { return 0; }
+
+  virtual uint32_t BufferSetCount() const { return 1; }
+
+  /**
+   * @return true if vertex input of this backend can switch to
+   *         HWCompactVertex
+   */
+  virtual bool SupportCompactVertex() const { return false; }
+
+  /**
+   * @return true if fragment shader computes coverage of
+   *         HW_VERTEX_TYPE_RRECT vertices
+   */
+  virtual bool SupportAnalyticShape() const { return false; }
+
+  /**
+   * @return true if gradient colors can be sampled from ramp texture of
+   *         HWGradientCache
+   */
+  virtual bool SupportGradientRamp() const { return false; }
+
+  /**
+   * @brief Set layout of geometry in current buffer set, called after
+   *        BeginBufferFrame and before any buffer is reserved. Draw calls
+   *        until next frame read indices and vertices in this layout.
+   */
+  virtual void SetMeshFormat(HWMeshFormat const& format) = 0;
+
+  /**
+   * @brief Make sure vertex buffer of current buffer set holds at least
+   *        data_size bytes
+   *
+   * @param data_size size of buffer data
+   * @return          false if buffer is reallocated and previous content is
+   *                  lost
+   */
+  virtual bool ReserveVertexBuffer(size_t data_size) = 0;
+
+  virtual bool ReserveIndexBuffer(size_t data_size) = 0;
+
+  /**
+   * @brief Upload data into vertex buffer of current buffer set, content
+   *        outside [offset, offset + data_size) is kept untouched
    *
-   * @param data pointer to buffer data
+   * @param data      pointer to buffer data
+   * @param offset    byte offset in gpu buffer
    * @param data_size size of buffer data
    */
-  virtual void UploadVertexBuffer(void* data, size_t data_size) = 0;
+  virtual void UpdateVertexBuffer(void* data, size_t offset,
+                                  size_t data_size) = 0;
 
-  virtual void UploadIndexBuffer(void* data, size_t data_size) = 0;
+  virtual void UpdateIndexBuffer(void* data, size_t offset,
+                                 size_t data_size) = 0;
 
   virtual void SetGlobalAlpha(float alpha) = 0;
 
@@ -147,6 +229,15 @@ class HWRenderer {
   virtual void UpdateStencilFunc(HWStencilFunc func, uint32_t value,
                                  uint32_t compare_mask) = 0;
 
+  /**
+   * @brief Discard fragments outside rect
+   *
+   * @param rect  rect in the space MVP matrix maps to clip space
+   */
+  virtual void EnableScissorTest(Rect const& rect) = 0;
+
+  virtual void DisableScissorTest() = 0;
+
   virtual void DrawIndex(uint32_t start, uint32_t count) = 0;
 
   virtual void BindTexture(HWTexture* texture, uint32_t slot) = 0;
@@ -155,6 +246,36 @@ class HWRenderer {
 
   virtual void UnBindRenderTarget(HWRenderTarget* render_target) = 0;
 
+ protected:
+  /**
+   * @brief Map rect through MVP matrix to pixels of a framebuffer, in window
+   *        coordinates of the backend, edges are rounded to nearest pixel
+   *
+   * @return [x, y, width, height] clamped to framebuffer size
+   */
+  glm::ivec4 CalculateScissorBox(Rect const& rect, int32_t width,
+                                 int32_t height) const {
+    glm::vec4 p0 = mvp_matrix_ * glm::vec4{rect.left(), rect.top(), 0.f, 1.f};
+    glm::vec4 p1 =
+        mvp_matrix_ * glm::vec4{rect.right(), rect.bottom(), 0.f, 1.f};
+
+    glm::vec2 size{width, height};
+    glm::vec2 a = (glm::vec2{p0} / p0.w * 0.5f + 0.5f) * size;
+    glm::vec2 b = (glm::vec2{p1} / p1.w * 0.5f + 0.5f) * size;
+
+    auto to_pixel = [](float value, int32_t limit) {
+      value = std::min(std::max(value, 0.f), static_cast<float>(limit));
+      return static_cast<int32_t>(std::round(value));
+    };
+
+    int32_t left = to_pixel(std::min(a.x, b.x), width);
+    int32_t top = to_pixel(std::min(a.y, b.y), height);
+    int32_t right = to_pixel(std::max(a.x, b.x), width);
+    int32_t bottom = to_pixel(std::max(a.y, b.y), height);
+
+    return {left, top, std::max(right - left, 0), std::max(bottom - top, 0)};
+  }
+
  private:
   glm::mat4 mvp_matrix_ = {};
   glm::mat4 model_matrix_ = {};
@@ -24,8 +24,23 @@ class HWTexture {
     kStencilTexture,
   };
 
+  enum class Filter {
+    kNearest,
+    kLinear,
+    // linear filter between mip levels, levels below 0 are filled by
+    // GenerateMipmaps
+    kMipmap,
+  };
+
   virtual ~HWTexture() = default;
 
+  /**
+   * Need to be called before Init, default is kLinear.
+   */
+  void SetFilter(Filter filter) { filter_ = filter; }
+
+  Filter GetFilter() const { return filter_; }
+
   virtual void Init(HWTexture::Type type, HWTexture::Format format) = 0;
 
   virtual void Destroy() = 0;
@@ -40,6 +55,28 @@ class HWTexture {
 
   virtual void UploadData(uint32_t offset_x, uint32_t offset_y, uint32_t width,
                           uint32_t height, void* data) = 0;
+
+  /**
+   * Rebuild all mip levels from level 0, does nothing if filter is not
+   * kMipmap. Need to be called after UploadData.
+   */
+  virtual void GenerateMipmaps() = 0;
+
+  /**
+   * @return number of mip levels of a kMipmap texture with given size
+   */
+  static uint32_t MipLevelCount(uint32_t width, uint32_t height) {
+    uint32_t levels = 1;
+    uint32_t size = width > height ? width : height;
+    while (size > 1) {
+      size >>= 1;
+      levels++;
+    }
+    return levels;
+  }
+
+ protected:
+  Filter filter_ = Filter::kLinear;
 };
 
 }  // namespace skity
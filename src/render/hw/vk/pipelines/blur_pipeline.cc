@@ -12,7 +12,8 @@ namespace skity {
 
 std::unique_ptr<AbsPipelineWrapper>
 AbsPipelineWrapper::CreateStaticBlurPipeline(VKInterface* interface,
-                                             GPUVkContext* ctx, bool use_gs) {
+                                             GPUVkContext* ctx, bool use_gs,
+                                             VkPipelineCache pipeline_cache) {
   return PipelineBuilder<FinalBlurPipeline>{
       interface,
       use_gs ? (const char*)vk_gs_common_vert_spv
@@ -23,12 +24,14 @@ AbsPipelineWrapper::CreateStaticBlurPipeline(VKInterface* interface,
       use_gs ? (const char*)vk_gs_geometry_geom_spv : nullptr,
       use_gs ? vk_gs_geometry_geom_spv_size : 0,
       ctx,
+      pipeline_cache,
   }();
 }
 
 std::unique_ptr<AbsPipelineWrapper>
 AbsPipelineWrapper::CreateStaticBlurPipeline(VKInterface* interface,
                                              GPUVkContext* ctx, bool use_gs,
+                                             VkPipelineCache pipeline_cache,
                                              VkRenderPass render_pass) {
   return PipelineBuilder<StaticBlurPipeline>{
       interface,
@@ -40,18 +43,21 @@ AbsPipelineWrapper::CreateStaticBlurPipeline(VKInterface* interface,
       use_gs ? (const char*)vk_gs_geometry_geom_spv : nullptr,
       use_gs ? vk_gs_geometry_geom_spv_size : 0,
       ctx,
+      pipeline_cache,
       render_pass}();
 }
 
 std::unique_ptr<AbsPipelineWrapper>
 AbsPipelineWrapper::CreateComputeBlurPipeline(VKInterface* vk_interface,
-                                              GPUVkContext* ctx) {
+                                              GPUVkContext* ctx,
+                                              VkPipelineCache pipeline_cache) {
   auto compute_shader = VKUtils::CreateShader(
       vk_interface, ctx->GetDevice(), (const char*)vk_blur_effect_comp_spv,
       vk_blur_effect_comp_spv_size);
 
   auto pipeline = std::make_unique<ComputeBlurPipeline>();
   pipeline->SetInterface(vk_interface);
+  pipeline->SetPipelineCache(pipeline_cache);
   pipeline->Init(ctx, compute_shader, VK_NULL_HANDLE, VK_NULL_HANDLE);
 
   VK_CALL_I(vkDestroyShaderModule, ctx->GetDevice(), compute_shader, nullptr);
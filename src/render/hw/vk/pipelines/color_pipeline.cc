@@ -53,28 +53,6 @@ StencilDiscardColorPipeline::GetDepthStencilStateCreateInfo() {
   return RenderPipeline::StencilDiscardInfo();
 }
 
-void StencilClipColorPipeline::UpdateStencilInfo(uint32_t reference,
-                                                 uint32_t compare_mask,
-                                                 uint32_t write_mask,
-                                                 GPUVkContext* ctx) {
-  VK_CALL(vkCmdSetStencilReference, GetBindCMD(),
-          VK_STENCIL_FACE_FRONT_AND_BACK, reference);
-  VK_CALL(vkCmdSetStencilCompareMask, GetBindCMD(),
-          VK_STENCIL_FACE_FRONT_AND_BACK, compare_mask);
-  VK_CALL(vkCmdSetStencilWriteMask, GetBindCMD(),
-          VK_STENCIL_FACE_FRONT_AND_BACK, write_mask);
-}
-
-std::vector<VkDynamicState> StencilClipColorPipeline::GetDynamicStates() {
-  auto dynamic_states = StaticColorPipeline::GetDynamicStates();
-
-  dynamic_states.emplace_back(VK_DYNAMIC_STATE_STENCIL_REFERENCE);
-  dynamic_states.emplace_back(VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK);
-  dynamic_states.emplace_back(VK_DYNAMIC_STATE_STENCIL_WRITE_MASK);
-
-  return dynamic_states;
-}
-
 VkPipelineDepthStencilStateCreateInfo
 StencilClipColorPipeline::GetDepthStencilStateCreateInfo() {
   return RenderPipeline::StencilLessDiscardInfo();
@@ -96,6 +74,7 @@ std::unique_ptr<AbsPipelineWrapper> ColorPipelineFamily::CreateStaticPipeline(
       UseGeometryShader(), sizeof(GlobalPushConst));
 
   pipeline->SetInterface(GetInterface());
+  pipeline->SetPipelineCache(PipelineCache());
 
   pipeline->Init(ctx, GetVertexShader(), GetFragmentShader(),
                  GetGeometryShader());
@@ -109,6 +88,7 @@ ColorPipelineFamily::CreateStencilDiscardPipeline(GPUVkContext* ctx) {
       UseGeometryShader(), sizeof(GlobalPushConst));
 
   pipeline->SetInterface(GetInterface());
+  pipeline->SetPipelineCache(PipelineCache());
 
   pipeline->Init(ctx, GetVertexShader(), GetFragmentShader(),
                  GetGeometryShader());
@@ -122,6 +102,7 @@ ColorPipelineFamily::CreateStencilClipPipeline(GPUVkContext* ctx) {
       UseGeometryShader(), sizeof(GlobalPushConst));
 
   pipeline->SetInterface(GetInterface());
+  pipeline->SetPipelineCache(PipelineCache());
 
   pipeline->Init(ctx, GetVertexShader(), GetFragmentShader(),
                  GetGeometryShader());
@@ -135,6 +116,7 @@ ColorPipelineFamily::CreateStencilKeepPipeline(GPUVkContext* ctx) {
       UseGeometryShader(), sizeof(GlobalPushConst));
 
   pipeline->SetInterface(GetInterface());
+  pipeline->SetPipelineCache(PipelineCache());
 
   pipeline->Init(ctx, GetVertexShader(), GetFragmentShader(),
                  GetGeometryShader());
@@ -148,6 +130,7 @@ std::unique_ptr<AbsPipelineWrapper> ColorPipelineFamily::CreateOSStaticPipeline(
       UseGeometryShader(), sizeof(GlobalPushConst));
 
   pipeline->SetInterface(GetInterface());
+  pipeline->SetPipelineCache(PipelineCache());
 
   pipeline->SetRenderPass(OffScreenRenderPass());
 
@@ -163,6 +146,7 @@ ColorPipelineFamily::CreateOSStencilPipeline(GPUVkContext* ctx) {
       UseGeometryShader(), sizeof(GlobalPushConst));
 
   pipeline->SetInterface(GetInterface());
+  pipeline->SetPipelineCache(PipelineCache());
 
   pipeline->SetRenderPass(OffScreenRenderPass());
 
@@ -51,28 +51,6 @@ StencilDiscardGradientPipeline::GetDepthStencilStateCreateInfo() {
   return RenderPipeline::StencilDiscardInfo();
 }
 
-void StencilClipGradientPipeline::UpdateStencilInfo(uint32_t reference,
-                                                    uint32_t compare_mask,
-                                                    uint32_t write_mask,
-                                                    GPUVkContext* ctx) {
-  VK_CALL(vkCmdSetStencilReference, GetBindCMD(),
-          VK_STENCIL_FACE_FRONT_AND_BACK, reference);
-  VK_CALL(vkCmdSetStencilCompareMask, GetBindCMD(),
-          VK_STENCIL_FACE_FRONT_AND_BACK, compare_mask);
-  VK_CALL(vkCmdSetStencilWriteMask, GetBindCMD(),
-          VK_STENCIL_FACE_FRONT_AND_BACK, write_mask);
-}
-
-std::vector<VkDynamicState> StencilClipGradientPipeline::GetDynamicStates() {
-  auto dynamic_states = StaticGradientPipeline::GetDynamicStates();
-
-  dynamic_states.emplace_back(VK_DYNAMIC_STATE_STENCIL_REFERENCE);
-  dynamic_states.emplace_back(VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK);
-  dynamic_states.emplace_back(VK_DYNAMIC_STATE_STENCIL_WRITE_MASK);
-
-  return dynamic_states;
-}
-
 VkPipelineDepthStencilStateCreateInfo
 StencilClipGradientPipeline::GetDepthStencilStateCreateInfo() {
   return RenderPipeline::StencilLessDiscardInfo();
@@ -94,6 +72,7 @@ GradientPipelineFamily::CreateStaticPipeline(GPUVkContext* ctx) {
   auto pipeline = std::make_unique<StaticGradientPipeline>(
       UseGeometryShader(), sizeof(GlobalPushConst));
   pipeline->SetInterface(GetInterface());
+  pipeline->SetPipelineCache(PipelineCache());
   pipeline->Init(ctx, GetVertexShader(), GetFragmentShader(),
                  GetGeometryShader());
   return pipeline;
@@ -105,6 +84,7 @@ GradientPipelineFamily::CreateStencilDiscardPipeline(GPUVkContext* ctx) {
       UseGeometryShader(), sizeof(GlobalPushConst));
 
   pipeline->SetInterface(GetInterface());
+  pipeline->SetPipelineCache(PipelineCache());
   pipeline->Init(ctx, GetVertexShader(), GetFragmentShader(),
                  GetGeometryShader());
   return pipeline;
@@ -116,6 +96,7 @@ GradientPipelineFamily::CreateStencilClipPipeline(GPUVkContext* ctx) {
       UseGeometryShader(), sizeof(GlobalPushConst));
 
   pipeline->SetInterface(GetInterface());
+  pipeline->SetPipelineCache(PipelineCache());
   pipeline->Init(ctx, GetVertexShader(), GetFragmentShader(),
                  GetGeometryShader());
   return pipeline;
@@ -126,6 +107,7 @@ GradientPipelineFamily::CreateStencilKeepPipeline(GPUVkContext* ctx) {
   auto pipeline = std::make_unique<StencilKeepGradientPipeline>(
       UseGeometryShader(), sizeof(GlobalPushConst));
   pipeline->SetInterface(GetInterface());
+  pipeline->SetPipelineCache(PipelineCache());
   pipeline->Init(ctx, GetVertexShader(), GetFragmentShader(),
                  GetGeometryShader());
   return pipeline;
@@ -137,6 +119,7 @@ GradientPipelineFamily::CreateOSStaticPipeline(GPUVkContext* ctx) {
       UseGeometryShader(), sizeof(GlobalPushConst));
 
   pipeline->SetInterface(GetInterface());
+  pipeline->SetPipelineCache(PipelineCache());
   pipeline->SetRenderPass(OffScreenRenderPass());
   pipeline->Init(ctx, GetVertexShader(), GetFragmentShader(),
                  GetGeometryShader());
@@ -149,6 +132,7 @@ GradientPipelineFamily::CreateOSStencilPipeline(GPUVkContext* ctx) {
       UseGeometryShader(), sizeof(GlobalPushConst));
 
   pipeline->SetInterface(GetInterface());
+  pipeline->SetPipelineCache(PipelineCache());
   pipeline->SetRenderPass(OffScreenRenderPass());
   pipeline->Init(ctx, GetVertexShader(), GetFragmentShader(),
                  GetGeometryShader());
@@ -38,11 +38,7 @@ class StencilClipGradientPipeline : public StaticGradientPipeline {
 
   ~StencilClipGradientPipeline() override = default;
 
-  void UpdateStencilInfo(uint32_t reference, uint32_t compare_mask,
-                         uint32_t write_mask, GPUVkContext* ctx) override;
-
  protected:
-  std::vector<VkDynamicState> GetDynamicStates() override;
   VkPipelineDepthStencilStateCreateInfo GetDepthStencilStateCreateInfo()
       override;
 };
@@ -72,28 +72,6 @@ StencilDiscardImagePipeline::GetDepthStencilStateCreateInfo() {
   return RenderPipeline::StencilDiscardInfo();
 }
 
-void StencilClipImagePipeline::UpdateStencilInfo(uint32_t reference,
-                                                 uint32_t compare_mask,
-                                                 uint32_t write_mask,
-                                                 GPUVkContext* ctx) {
-  VK_CALL(vkCmdSetStencilReference, GetBindCMD(),
-          VK_STENCIL_FACE_FRONT_AND_BACK, reference);
-  VK_CALL(vkCmdSetStencilCompareMask, GetBindCMD(),
-          VK_STENCIL_FACE_FRONT_AND_BACK, compare_mask);
-  VK_CALL(vkCmdSetStencilWriteMask, GetBindCMD(),
-          VK_STENCIL_FACE_FRONT_AND_BACK, write_mask);
-}
-
-std::vector<VkDynamicState> StencilClipImagePipeline::GetDynamicStates() {
-  auto dynamic_states = StaticImagePipeline::GetDynamicStates();
-
-  dynamic_states.emplace_back(VK_DYNAMIC_STATE_STENCIL_REFERENCE);
-  dynamic_states.emplace_back(VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK);
-  dynamic_states.emplace_back(VK_DYNAMIC_STATE_STENCIL_WRITE_MASK);
-
-  return dynamic_states;
-}
-
 VkPipelineDepthStencilStateCreateInfo
 StencilClipImagePipeline::GetDepthStencilStateCreateInfo() {
   return RenderPipeline::StencilLessDiscardInfo();
@@ -114,6 +92,7 @@ std::unique_ptr<AbsPipelineWrapper> ImagePipelineFamily::CreateStaticPipeline(
       UseGeometryShader(), sizeof(GlobalPushConst));
 
   pipeline->SetInterface(GetInterface());
+  pipeline->SetPipelineCache(PipelineCache());
   pipeline->Init(ctx, GetVertexShader(), GetFragmentShader(),
                  GetGeometryShader());
 
@@ -126,6 +105,7 @@ ImagePipelineFamily::CreateStencilDiscardPipeline(GPUVkContext* ctx) {
       UseGeometryShader(), sizeof(GlobalPushConst));
 
   pipeline->SetInterface(GetInterface());
+  pipeline->SetPipelineCache(PipelineCache());
   pipeline->Init(ctx, GetVertexShader(), GetFragmentShader(),
                  GetGeometryShader());
 
@@ -138,6 +118,7 @@ ImagePipelineFamily::CreateStencilClipPipeline(GPUVkContext* ctx) {
       UseGeometryShader(), sizeof(GlobalPushConst));
 
   pipeline->SetInterface(GetInterface());
+  pipeline->SetPipelineCache(PipelineCache());
   pipeline->Init(ctx, GetVertexShader(), GetFragmentShader(),
                  GetGeometryShader());
 
@@ -150,6 +131,7 @@ ImagePipelineFamily::CreateStencilKeepPipeline(GPUVkContext* ctx) {
       UseGeometryShader(), sizeof(GlobalPushConst));
 
   pipeline->SetInterface(GetInterface());
+  pipeline->SetPipelineCache(PipelineCache());
   pipeline->Init(ctx, GetVertexShader(), GetFragmentShader(),
                  GetGeometryShader());
 
@@ -162,6 +144,7 @@ std::unique_ptr<AbsPipelineWrapper> ImagePipelineFamily::CreateOSStaticPipeline(
       UseGeometryShader(), sizeof(GlobalPushConst));
 
   pipeline->SetInterface(GetInterface());
+  pipeline->SetPipelineCache(PipelineCache());
   pipeline->SetRenderPass(OffScreenRenderPass());
   pipeline->Init(ctx, GetVertexShader(), GetFragmentShader(),
                  GetGeometryShader());
@@ -175,6 +158,7 @@ ImagePipelineFamily::CreateOSStencilPipeline(GPUVkContext* ctx) {
       UseGeometryShader(), sizeof(GlobalPushConst));
 
   pipeline->SetInterface(GetInterface());
+  pipeline->SetPipelineCache(PipelineCache());
   pipeline->SetRenderPass(OffScreenRenderPass());
   pipeline->Init(ctx, GetVertexShader(), GetFragmentShader(),
                  GetGeometryShader());
@@ -147,28 +147,6 @@ StencilRecursiveClipPipeline::GetDepthStencilStateCreateInfo() {
   return depth_stencil_state;
 }
 
-void StencilReplacePipeline::UpdateStencilInfo(uint32_t reference,
-                                               uint32_t compare_mask,
-                                               uint32_t write_mask,
-                                               GPUVkContext* ctx) {
-  VK_CALL(vkCmdSetStencilReference, GetBindCMD(),
-          VK_STENCIL_FACE_FRONT_AND_BACK, reference);
-  VK_CALL(vkCmdSetStencilCompareMask, GetBindCMD(),
-          VK_STENCIL_FACE_FRONT_AND_BACK, compare_mask);
-  VK_CALL(vkCmdSetStencilWriteMask, GetBindCMD(),
-          VK_STENCIL_FACE_FRONT_AND_BACK, write_mask);
-}
-
-std::vector<VkDynamicState> StencilReplacePipeline::GetDynamicStates() {
-  auto dynamic_state = StencilPipeline::GetDynamicStates();
-
-  dynamic_state.emplace_back(VK_DYNAMIC_STATE_STENCIL_REFERENCE);
-  dynamic_state.emplace_back(VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK);
-  dynamic_state.emplace_back(VK_DYNAMIC_STATE_STENCIL_WRITE_MASK);
-
-  return dynamic_state;
-}
-
 VkPipelineDepthStencilStateCreateInfo
 StencilReplacePipeline::GetDepthStencilStateCreateInfo() {
   auto depth_stencil_state = VKUtils::PipelineDepthStencilStateCreateInfo(
@@ -212,43 +190,14 @@ AbsPipelineWrapper* StencilPipelineFamily::ChoosePipeline(bool enable_stencil,
 }
 
 void StencilPipelineFamily::OnInit(GPUVkContext* ctx) {
-  // shader
-  VkShaderModule vs_shader = VK_NULL_HANDLE;
-  VkShaderModule fs_shader = VK_NULL_HANDLE;
-  VkShaderModule gs_shader = VK_NULL_HANDLE;
-
-  std::tie(vs_shader, fs_shader, gs_shader) = GenerateShader(ctx);
-
-  front_ = CreatePipeline<StencilFrontPipeline>(ctx, vs_shader, fs_shader,
-                                                gs_shader);
-  os_front_ = CreatePipeline<StencilFrontPipeline>(
-      ctx, vs_shader, fs_shader, gs_shader, OffScreenRenderPass());
-  clip_front_ = CreatePipeline<StencilClipFrontPipeline>(ctx, vs_shader,
-                                                         fs_shader, gs_shader);
-
-  back_ =
-      CreatePipeline<StencilBackPipeline>(ctx, vs_shader, fs_shader, gs_shader);
-  os_back_ = CreatePipeline<StencilBackPipeline>(
-      ctx, vs_shader, fs_shader, gs_shader, OffScreenRenderPass());
-  clip_back_ = CreatePipeline<StencilClipBackPipeline>(ctx, vs_shader,
-                                                       fs_shader, gs_shader);
-
-  clip_ =
-      CreatePipeline<StencilClipPipeline>(ctx, vs_shader, fs_shader, gs_shader);
-
-  recursive_ = CreatePipeline<StencilRecursiveClipPipeline>(
-      ctx, vs_shader, fs_shader, gs_shader);
-  recursive_back_ = CreatePipeline<StencilRecursiveClipBackPipeline>(
-      ctx, vs_shader, fs_shader, gs_shader);
-
-  replace_ = CreatePipeline<StencilReplacePipeline>(ctx, vs_shader, fs_shader,
-                                                    gs_shader);
-
-  VK_CALL(vkDestroyShaderModule, ctx->GetDevice(), vs_shader, VK_NULL_HANDLE);
-  VK_CALL(vkDestroyShaderModule, ctx->GetDevice(), fs_shader, VK_NULL_HANDLE);
-  if (gs_shader) {
-    VK_CALL(vkDestroyShaderModule, ctx->GetDevice(), gs_shader, VK_NULL_HANDLE);
-  }
+  std::tie(vs_shader_, fs_shader_, gs_shader_) = GenerateShader(ctx);
+
+  // winding passes of every path fill, other variants are only used with
+  // clip or offscreen drawing and are created on first use
+  front_ = CreatePipeline<StencilFrontPipeline>(ctx, vs_shader_, fs_shader_,
+                                                gs_shader_);
+  back_ = CreatePipeline<StencilBackPipeline>(ctx, vs_shader_, fs_shader_,
+                                              gs_shader_);
 }
 
 void StencilPipelineFamily::OnDestroy(GPUVkContext* ctx) {
@@ -266,6 +215,13 @@ void StencilPipelineFamily::OnDestroy(GPUVkContext* ctx) {
   SAFE_DESTROY(recursive_back_, ctx);
 
   SAFE_DESTROY(replace_, ctx);
+
+  VK_CALL(vkDestroyShaderModule, ctx->GetDevice(), vs_shader_, VK_NULL_HANDLE);
+  VK_CALL(vkDestroyShaderModule, ctx->GetDevice(), fs_shader_, VK_NULL_HANDLE);
+  if (gs_shader_) {
+    VK_CALL(vkDestroyShaderModule, ctx->GetDevice(), gs_shader_,
+            VK_NULL_HANDLE);
+  }
 }
 
 std::tuple<VkShaderModule, VkShaderModule, VkShaderModule>
@@ -299,9 +255,9 @@ StencilPipelineFamily::GenerateShader(GPUVkContext* ctx) {
 
 AbsPipelineWrapper* StencilPipelineFamily::PickOS() {
   if (StencilOp() == HWStencilOp::INCR_WRAP) {
-    return os_front_.get();
+    return ObtainPipeline(&os_front_, OffScreenRenderPass());
   } else if (StencilOp() == HWStencilOp::DECR_WRAP) {
-    return os_back_.get();
+    return ObtainPipeline(&os_back_, OffScreenRenderPass());
   }
 
   return nullptr;
@@ -312,16 +268,16 @@ AbsPipelineWrapper* StencilPipelineFamily::PickFront() {
     return front_.get();
   }
 
-  return clip_front_.get();
+  return ObtainPipeline(&clip_front_);
 }
 
 AbsPipelineWrapper* StencilPipelineFamily::PickBack() {
   if (StencilFunc() == HWStencilFunc::ALWAYS) {
     return back_.get();
   } else if (StencilFunc() == HWStencilFunc::LESS_OR_EQUAL) {
-    return clip_back_.get();
+    return ObtainPipeline(&clip_back_);
   } else if (StencilFunc() == HWStencilFunc::EQUAL) {
-    return recursive_back_.get();
+    return ObtainPipeline(&recursive_back_);
   }
 
   return nullptr;
@@ -329,14 +285,14 @@ AbsPipelineWrapper* StencilPipelineFamily::PickBack() {
 
 AbsPipelineWrapper* StencilPipelineFamily::PickReplace() {
   if (StencilFunc() == HWStencilFunc::ALWAYS) {
-    return replace_.get();
+    return ObtainPipeline(&replace_);
   }
 
   if (StencilFunc() == HWStencilFunc::NOT_EQUAL) {
     if (WriteMask() == 0xFF) {
-      return clip_.get();
+      return ObtainPipeline(&clip_);
     } else {
-      return recursive_.get();
+      return ObtainPipeline(&recursive_);
     }
   }
 
@@ -104,11 +104,7 @@ class StencilReplacePipeline : public StencilPipeline {
       : StencilPipeline(use_gs, push_const_size) {}
   ~StencilReplacePipeline() override = default;
 
-  void UpdateStencilInfo(uint32_t reference, uint32_t compare_mask,
-                         uint32_t write_mask, GPUVkContext* ctx) override;
-
  protected:
-  std::vector<VkDynamicState> GetDynamicStates() override;
   VkPipelineDepthStencilStateCreateInfo GetDepthStencilStateCreateInfo()
       override;
 };
@@ -134,7 +130,21 @@ class StencilPipelineFamily : public PipelineFamily {
   AbsPipelineWrapper* PickBack();
   AbsPipelineWrapper* PickReplace();
 
+  template <class T>
+  T* ObtainPipeline(std::unique_ptr<T>* pipeline,
+                    VkRenderPass render_pass = VK_NULL_HANDLE) {
+    if (!*pipeline) {
+      *pipeline = CreatePipeline<T>(Context(), vs_shader_, fs_shader_,
+                                    gs_shader_, render_pass);
+    }
+
+    return pipeline->get();
+  }
+
  private:
+  VkShaderModule vs_shader_ = VK_NULL_HANDLE;
+  VkShaderModule fs_shader_ = VK_NULL_HANDLE;
+  VkShaderModule gs_shader_ = VK_NULL_HANDLE;
   std::unique_ptr<StencilFrontPipeline> front_ = {};
   std::unique_ptr<StencilFrontPipeline> os_front_ = {};
   std::unique_ptr<StencilClipFrontPipeline> clip_front_ = {};
@@ -1,5 +1,6 @@
 #include "src/render/hw/vk/vk_framebuffer.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <skity/geometry/point.hpp>
@@ -12,6 +13,8 @@
 namespace skity {
 
 #define DEFAULT_UNIFORM_SIZE_PER_POOL 1000
+#define DEFAULT_STAGE_BUFFER_SIZE (4 * 1024 * 1024)
+#define DEFAULT_GEOMETRY_BUFFER_SIZE 512
 
 SKVkFrameBufferData::SKVkFrameBufferData(VKInterface* interface,
                                          VKMemoryAllocator* allocator)
@@ -19,9 +22,22 @@ SKVkFrameBufferData::SKVkFrameBufferData(VKInterface* interface,
 
 void SKVkFrameBufferData::Init(GPUVkContext* ctx) {
   AppendUniformBufferPool(ctx);
+
+  VkCommandPoolCreateInfo create_info{
+      VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+  create_info.queueFamilyIndex = ctx->GetGraphicQueueIndex();
+  create_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+  if (VK_CALL(vkCreateCommandPool, ctx->GetDevice(), &create_info, nullptr,
+              &cmd_pool_) != VK_SUCCESS) {
+    LOG_ERROR("Failed to create command pool of frame!");
+  }
 }
 
 void SKVkFrameBufferData::Destroy(GPUVkContext* ctx) {
+  WaitForSubmits(ctx);
+  FreeRetiredImages(ctx);
+
   for (auto buffer : transform_buffer_) {
     allocator_->FreeBuffer(buffer);
     delete buffer;
@@ -56,6 +72,40 @@ void SKVkFrameBufferData::Destroy(GPUVkContext* ctx) {
 
   uniform_buffer_pool_.clear();
   current_uniform_pool_index = -1;
+
+  for (auto fence : submit_fences_) {
+    VK_CALL(vkDestroyFence, ctx->GetDevice(), fence, nullptr);
+  }
+  submit_fences_.clear();
+
+  VK_CALL(vkDestroyCommandPool, ctx->GetDevice(), cmd_pool_, nullptr);
+  cmd_pool_ = VK_NULL_HANDLE;
+  upload_cmd_ = VK_NULL_HANDLE;
+
+  if (vertex_buffer_) {
+    allocator_->FreeBuffer(vertex_buffer_);
+    delete vertex_buffer_;
+    vertex_buffer_ = nullptr;
+  }
+
+  if (index_buffer_) {
+    allocator_->FreeBuffer(index_buffer_);
+    delete index_buffer_;
+    index_buffer_ = nullptr;
+  }
+
+  for (auto buffer : stage_buffer_) {
+    allocator_->FreeBuffer(buffer);
+    delete buffer;
+  }
+  stage_buffer_.clear();
+  stage_buffer_index_ = -1;
+
+  for (auto buffer : large_stage_buffer_) {
+    allocator_->FreeBuffer(buffer);
+    delete buffer;
+  }
+  large_stage_buffer_.clear();
 }
 
 void SKVkFrameBufferData::FrameBegin(GPUVkContext* ctx) {
@@ -86,6 +136,25 @@ void SKVkFrameBufferData::FrameBegin(GPUVkContext* ctx) {
   if (current_uniform_pool_index >= 0) {
     current_uniform_pool_index = 0;
   }
+
+  // work of this frame was submitted before its previous draws, so the fences
+  // are already signaled here in practice
+  WaitForSubmits(ctx);
+  FreeRetiredImages(ctx);
+
+  VK_CALL(vkResetCommandPool, ctx->GetDevice(), cmd_pool_, 0);
+  upload_cmd_ = VK_NULL_HANDLE;
+
+  if (stage_buffer_index_ >= 0) {
+    stage_buffer_index_ = 0;
+  }
+  stage_buffer_offset_ = 0;
+
+  for (auto buffer : large_stage_buffer_) {
+    allocator_->FreeBuffer(buffer);
+    delete buffer;
+  }
+  large_stage_buffer_.clear();
 }
 
 void SKVkFrameBufferData::AppendUniformBufferPool(GPUVkContext* ctx) {
@@ -202,4 +271,198 @@ VkDescriptorSet SKVkFrameBufferData::ObtainUniformBufferSet(
   return ret;
 }
 
+bool SKVkFrameBufferData::ReserveVertexBuffer(size_t size) {
+  if (vertex_buffer_ && vertex_buffer_->BufferSize() >= size) {
+    return true;
+  }
+
+  size_t new_size = vertex_buffer_ ? vertex_buffer_->BufferSize() * 2
+                                   : DEFAULT_GEOMETRY_BUFFER_SIZE;
+  new_size = std::max(new_size, size);
+
+  if (vertex_buffer_) {
+    allocator_->FreeBuffer(vertex_buffer_);
+    delete vertex_buffer_;
+  }
+  vertex_buffer_ = allocator_->AllocateVertexBuffer(new_size);
+
+  return false;
+}
+
+bool SKVkFrameBufferData::ReserveIndexBuffer(size_t size) {
+  if (index_buffer_ && index_buffer_->BufferSize() >= size) {
+    return true;
+  }
+
+  size_t new_size = index_buffer_ ? index_buffer_->BufferSize() * 2
+                                  : DEFAULT_GEOMETRY_BUFFER_SIZE;
+  new_size = std::max(new_size, size);
+
+  if (index_buffer_) {
+    allocator_->FreeBuffer(index_buffer_);
+    delete index_buffer_;
+  }
+  index_buffer_ = allocator_->AllocateIndexBuffer(new_size);
+
+  return false;
+}
+
+VkCommandBuffer SKVkFrameBufferData::ObtainInternalCMD(GPUVkContext* ctx) {
+  return AllocateCMD(ctx);
+}
+
+void SKVkFrameBufferData::SubmitInternalCMD(GPUVkContext* ctx,
+                                            VkCommandBuffer cmd) {
+  Submit(ctx, cmd);
+}
+
+VkCommandBuffer SKVkFrameBufferData::ObtainUploadCMD(GPUVkContext* ctx) {
+  if (upload_cmd_ == VK_NULL_HANDLE) {
+    upload_cmd_ = AllocateCMD(ctx);
+  }
+
+  return upload_cmd_;
+}
+
+void SKVkFrameBufferData::SubmitUploadCMD(GPUVkContext* ctx) {
+  if (upload_cmd_ == VK_NULL_HANDLE) {
+    return;
+  }
+
+  Submit(ctx, upload_cmd_);
+
+  upload_cmd_ = VK_NULL_HANDLE;
+}
+
+AllocatedBuffer* SKVkFrameBufferData::ObtainStageBuffer(size_t size,
+                                                        size_t alignment,
+                                                        size_t* offset) {
+  *offset = 0;
+
+  if (size > DEFAULT_STAGE_BUFFER_SIZE) {
+    auto buffer = allocator_->AllocateStageBuffer(size);
+    if (buffer) {
+      large_stage_buffer_.emplace_back(buffer);
+    }
+    return buffer;
+  }
+
+  if (stage_buffer_index_ >= 0) {
+    size_t aligned_offset =
+        (stage_buffer_offset_ + alignment - 1) / alignment * alignment;
+
+    if (aligned_offset + size <= DEFAULT_STAGE_BUFFER_SIZE) {
+      stage_buffer_offset_ = aligned_offset + size;
+      *offset = aligned_offset;
+      return stage_buffer_[stage_buffer_index_];
+    }
+  }
+
+  if (stage_buffer_index_ + 1 >= static_cast<int32_t>(stage_buffer_.size())) {
+    auto buffer = allocator_->AllocateStageBuffer(DEFAULT_STAGE_BUFFER_SIZE);
+    if (buffer == nullptr) {
+      return nullptr;
+    }
+    stage_buffer_.emplace_back(buffer);
+  }
+
+  stage_buffer_index_++;
+  stage_buffer_offset_ = size;
+
+  return stage_buffer_[stage_buffer_index_];
+}
+
+VkCommandBuffer SKVkFrameBufferData::AllocateCMD(GPUVkContext* ctx) {
+  VkCommandBufferAllocateInfo buffer_info{
+      VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+  buffer_info.commandBufferCount = 1;
+  buffer_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  buffer_info.commandPool = cmd_pool_;
+
+  VkCommandBuffer cmd = VK_NULL_HANDLE;
+
+  if (VK_CALL(vkAllocateCommandBuffers, ctx->GetDevice(), &buffer_info,
+              &cmd) != VK_SUCCESS) {
+    LOG_ERROR("Failed to allocate command buffer of frame!");
+    return VK_NULL_HANDLE;
+  }
+
+  VkCommandBufferBeginInfo begin_info{
+      VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+  begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+  VK_CALL(vkBeginCommandBuffer, cmd, &begin_info);
+
+  return cmd;
+}
+
+void SKVkFrameBufferData::Submit(GPUVkContext* ctx, VkCommandBuffer cmd) {
+  VK_CALL(vkEndCommandBuffer, cmd);
+
+  VkSubmitInfo submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+  submit_info.commandBufferCount = 1;
+  submit_info.pCommandBuffers = &cmd;
+
+  VK_CALL(vkQueueSubmit, ctx->GetGraphicQueue(), 1, &submit_info,
+          ObtainSubmitFence(ctx));
+}
+
+void SKVkFrameBufferData::WaitForSubmits(GPUVkContext* ctx) {
+  if (submit_fence_index_ == 0) {
+    return;
+  }
+
+  uint32_t count = static_cast<uint32_t>(submit_fence_index_);
+
+  VK_CALL(vkWaitForFences, ctx->GetDevice(), count, submit_fences_.data(),
+          VK_TRUE, UINT64_MAX);
+  VK_CALL(vkResetFences, ctx->GetDevice(), count, submit_fences_.data());
+
+  submit_fence_index_ = 0;
+}
+
+void SKVkFrameBufferData::RetireImage(AllocatedImage* image,
+                                      VkImageView view) {
+  if (image) {
+    retired_image_.emplace_back(image);
+  }
+
+  if (view) {
+    retired_image_view_.emplace_back(view);
+  }
+}
+
+void SKVkFrameBufferData::FreeRetiredImages(GPUVkContext* ctx) {
+  for (auto view : retired_image_view_) {
+    VK_CALL(vkDestroyImageView, ctx->GetDevice(), view, nullptr);
+  }
+  retired_image_view_.clear();
+
+  for (auto image : retired_image_) {
+    allocator_->FreeImage(image);
+    delete image;
+  }
+  retired_image_.clear();
+}
+
+VkFence SKVkFrameBufferData::ObtainSubmitFence(GPUVkContext* ctx) {
+  if (submit_fence_index_ < submit_fences_.size()) {
+    return submit_fences_[submit_fence_index_++];
+  }
+
+  VkFenceCreateInfo create_info{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+  VkFence fence = VK_NULL_HANDLE;
+
+  if (VK_CALL(vkCreateFence, ctx->GetDevice(), &create_info, nullptr,
+              &fence) != VK_SUCCESS) {
+    LOG_ERROR("Failed to create fence of frame!");
+    return VK_NULL_HANDLE;
+  }
+
+  submit_fences_.emplace_back(fence);
+  submit_fence_index_++;
+
+  return fence;
+}
+
 }  // namespace skity
\ No newline at end of file
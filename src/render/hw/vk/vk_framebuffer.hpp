@@ -12,8 +12,11 @@ namespace skity {
 
 class VKMemoryAllocator;
 struct AllocatedBuffer;
+struct AllocatedImage;
 
-// helper class to hold descriptor set buffer using per frame
+// helper class to hold descriptor set buffer using per frame, resources of one
+// frame are recycled in FrameBegin once gpu finished the frame using them last
+// time
 class SKVkFrameBufferData : public VkInterfaceClient {
  public:
   SKVkFrameBufferData(VKInterface* interface, VKMemoryAllocator* allocator);
@@ -39,9 +42,62 @@ class SKVkFrameBufferData : public VkInterfaceClient {
   VkDescriptorSet ObtainUniformBufferSet(GPUVkContext* ctx,
                                          VkDescriptorSetLayout layout);
 
+  /**
+   * Make sure vertex buffer of this frame holds at least size bytes.
+   *
+   * @return false if buffer is reallocated and previous content is lost
+   */
+  bool ReserveVertexBuffer(size_t size);
+
+  bool ReserveIndexBuffer(size_t size);
+
+  AllocatedBuffer* GetVertexBuffer() const { return vertex_buffer_; }
+
+  AllocatedBuffer* GetIndexBuffer() const { return index_buffer_; }
+
+  // command buffer for internal work like offscreen draws or image layout
+  // changes, already begun
+  VkCommandBuffer ObtainInternalCMD(GPUVkContext* ctx);
+
+  // submit internal command buffer without waiting for it
+  void SubmitInternalCMD(GPUVkContext* ctx, VkCommandBuffer cmd);
+
+  // command buffer recording texture uploads of this frame, begun on first
+  // call and recorded until SubmitUploadCMD
+  VkCommandBuffer ObtainUploadCMD(GPUVkContext* ctx);
+
+  // submit upload command buffer if any without waiting for it, it is
+  // recycled when this frame begins again
+  void SubmitUploadCMD(GPUVkContext* ctx);
+
+  /**
+   * Sub allocate staging memory of one upload from the ring of this frame.
+   *
+   * @param size       bytes to upload
+   * @param alignment  required alignment of offset
+   * @param offset     receive offset of the range in returned buffer
+   * @return           stage buffer or nullptr if allocation failed
+   */
+  AllocatedBuffer* ObtainStageBuffer(size_t size, size_t alignment,
+                                     size_t* offset);
+
+  // take ownership of an image which commands of this frame may still use, it
+  // is freed with its view when this frame begins again
+  void RetireImage(AllocatedImage* image, VkImageView view);
+
  private:
   void AppendUniformBufferPool(GPUVkContext* ctx);
 
+  VkCommandBuffer AllocateCMD(GPUVkContext* ctx);
+
+  void Submit(GPUVkContext* ctx, VkCommandBuffer cmd);
+
+  void WaitForSubmits(GPUVkContext* ctx);
+
+  void FreeRetiredImages(GPUVkContext* ctx);
+
+  VkFence ObtainSubmitFence(GPUVkContext* ctx);
+
  private:
   VKMemoryAllocator* allocator_ = {};
   std::vector<VkDescriptorPool> uniform_buffer_pool_ = {};
@@ -62,6 +118,27 @@ class SKVkFrameBufferData : public VkInterfaceClient {
 
   std::vector<AllocatedBuffer*> compute_info_buffer_ = {};
   int32_t compute_info_index = -1;
+
+  AllocatedBuffer* vertex_buffer_ = {};
+  AllocatedBuffer* index_buffer_ = {};
+
+  // internal and upload command buffers of this frame
+  VkCommandPool cmd_pool_ = {};
+  VkCommandBuffer upload_cmd_ = {};
+  // one fence per submission of this frame
+  std::vector<VkFence> submit_fences_ = {};
+  size_t submit_fence_index_ = 0;
+
+  // staging ring, uploads are packed into fixed size buffers
+  std::vector<AllocatedBuffer*> stage_buffer_ = {};
+  int32_t stage_buffer_index_ = -1;
+  size_t stage_buffer_offset_ = 0;
+  // buffers of uploads larger than the ring buffer, freed on frame begin
+  std::vector<AllocatedBuffer*> large_stage_buffer_ = {};
+
+  // images replaced during this frame, freed on frame begin
+  std::vector<AllocatedImage*> retired_image_ = {};
+  std::vector<VkImageView> retired_image_view_ = {};
 };
 
 }  // namespace skity
@@ -17,6 +17,7 @@ VKInterface* VKInterface::InitInterface(VkDevice device,
   GET_PROC(vkCmdBindIndexBuffer);
   GET_PROC(vkCmdBindPipeline);
   GET_PROC(vkCmdBindVertexBuffers);
+  GET_PROC(vkCmdBlitImage);
   GET_PROC(vkCmdCopyBufferToImage);
   GET_PROC(vkCmdDispatch);
   GET_PROC(vkCmdDrawIndexed);
@@ -36,6 +37,7 @@ VKInterface* VKInterface::InitInterface(VkDevice device,
   GET_PROC(vkCreateFramebuffer);
   GET_PROC(vkCreateGraphicsPipelines);
   GET_PROC(vkCreateImageView);
+  GET_PROC(vkCreatePipelineCache);
   GET_PROC(vkCreatePipelineLayout);
   GET_PROC(vkCreateRenderPass);
   GET_PROC(vkCreateSampler);
@@ -47,12 +49,14 @@ VKInterface* VKInterface::InitInterface(VkDevice device,
   GET_PROC(vkDestroyFramebuffer);
   GET_PROC(vkDestroyImageView);
   GET_PROC(vkDestroyPipeline);
+  GET_PROC(vkDestroyPipelineCache);
   GET_PROC(vkDestroyPipelineLayout);
   GET_PROC(vkDestroyRenderPass);
   GET_PROC(vkDestroySampler);
   GET_PROC(vkDestroyShaderModule);
   GET_PROC(vkEndCommandBuffer);
   GET_PROC(vkGetPhysicalDeviceFeatures);
+  GET_PROC(vkGetPipelineCacheData);
   GET_PROC(vkQueueSubmit);
   GET_PROC(vkQueueWaitIdle);
   GET_PROC(vkResetCommandPool);
@@ -20,6 +20,7 @@ struct VKInterface {
   PFN_vkCmdBindIndexBuffer fvkCmdBindIndexBuffer = {};
   PFN_vkCmdBindPipeline fvkCmdBindPipeline = {};
   PFN_vkCmdBindVertexBuffers fvkCmdBindVertexBuffers = {};
+  PFN_vkCmdBlitImage fvkCmdBlitImage = {};
   PFN_vkCmdCopyBufferToImage fvkCmdCopyBufferToImage = {};
   PFN_vkCmdDispatch fvkCmdDispatch = {};
   PFN_vkCmdDrawIndexed fvkCmdDrawIndexed = {};
@@ -39,6 +40,7 @@ struct VKInterface {
   PFN_vkCreateFramebuffer fvkCreateFramebuffer = {};
   PFN_vkCreateGraphicsPipelines fvkCreateGraphicsPipelines = {};
   PFN_vkCreateImageView fvkCreateImageView = {};
+  PFN_vkCreatePipelineCache fvkCreatePipelineCache = {};
   PFN_vkCreatePipelineLayout fvkCreatePipelineLayout = {};
   PFN_vkCreateRenderPass fvkCreateRenderPass = {};
   PFN_vkCreateSampler fvkCreateSampler = {};
@@ -50,12 +52,14 @@ struct VKInterface {
   PFN_vkDestroyFramebuffer fvkDestroyFramebuffer = {};
   PFN_vkDestroyImageView fvkDestroyImageView = {};
   PFN_vkDestroyPipeline fvkDestroyPipeline = {};
+  PFN_vkDestroyPipelineCache fvkDestroyPipelineCache = {};
   PFN_vkDestroyPipelineLayout fvkDestroyPipelineLayout = {};
   PFN_vkDestroyRenderPass fvkDestroyRenderPass = {};
   PFN_vkDestroySampler fvkDestroySampler = {};
   PFN_vkDestroyShaderModule fvkDestroyShaderModule = {};
   PFN_vkEndCommandBuffer fvkEndCommandBuffer = {};
   PFN_vkGetPhysicalDeviceFeatures fvkGetPhysicalDeviceFeatures = {};
+  PFN_vkGetPipelineCacheData fvkGetPipelineCacheData = {};
   PFN_vkQueueSubmit fvkQueueSubmit = {};
   PFN_vkQueueWaitIdle fvkQueueWaitIdle = {};
   PFN_vkResetCommandPool fvkResetCommandPool = {};
@@ -96,8 +96,10 @@ class VKMemoryAllocatorImpl : public VKMemoryAllocator,
     buffer_info.size = buffer_size;
     buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
 
+    // stage buffers are reused across frames, keep them mapped
     VmaAllocationCreateInfo vma_info{};
-    vma_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    vma_info.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+    vma_info.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
     vma_info.requiredFlags = VK_MEMORY_PROPERTY_HOST_COHERENT_BIT |
                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
 
@@ -105,9 +107,10 @@ class VKMemoryAllocatorImpl : public VKMemoryAllocator,
   }
 
   AllocatedImage* AllocateImage(VkFormat format, VkExtent3D extent,
-                                VkImageUsageFlags flags) override {
+                                VkImageUsageFlags flags,
+                                uint32_t mip_levels) override {
     VkImageCreateInfo image_info =
-        VKUtils::ImageCreateInfo(format, flags, extent);
+        VKUtils::ImageCreateInfo(format, flags, extent, mip_levels);
 
     VmaAllocationCreateInfo vma_info{};
     vma_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
@@ -46,7 +46,8 @@ class VKMemoryAllocator {
   virtual AllocatedBuffer* AllocateStageBuffer(size_t buffer_size) = 0;
 
   virtual AllocatedImage* AllocateImage(VkFormat format, VkExtent3D extent,
-                                        VkImageUsageFlags flags) = 0;
+                                        VkImageUsageFlags flags,
+                                        uint32_t mip_levels) = 0;
 
   virtual void FreeBuffer(AllocatedBuffer* allocated_buffer) = 0;
 
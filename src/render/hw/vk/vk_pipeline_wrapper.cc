@@ -1,10 +1,12 @@
 #include "src/render/hw/vk/vk_pipeline_wrapper.hpp"
 
 #include <array>
+#include <cstddef>
 #include <vector>
 
 #include "shader.hpp"
 #include "src/logging.hpp"
+#include "src/render/hw/hw_mesh.hpp"
 #include "src/render/hw/vk/vk_framebuffer.hpp"
 #include "src/render/hw/vk/vk_interface.hpp"
 #include "src/render/hw/vk/vk_memory.hpp"
@@ -15,7 +17,7 @@ namespace skity {
 
 void RenderPipeline::Init(GPUVkContext* ctx, VkShaderModule vertex,
                           VkShaderModule fragment, VkShaderModule geometry) {
-  std::vector<VkPipelineShaderStageCreateInfo> shaders{};
+  ctx_ = ctx;
 
   VkPipelineShaderStageCreateInfo vs_ci{};
   vs_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -23,7 +25,7 @@ void RenderPipeline::Init(GPUVkContext* ctx, VkShaderModule vertex,
   vs_ci.module = vertex;
   vs_ci.pName = "main";
 
-  shaders.emplace_back(vs_ci);
+  shader_stages_.emplace_back(vs_ci);
 
   VkPipelineShaderStageCreateInfo fs_ci{};
   fs_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -31,7 +33,7 @@ void RenderPipeline::Init(GPUVkContext* ctx, VkShaderModule vertex,
   fs_ci.module = fragment;
   fs_ci.pName = "main";
 
-  shaders.emplace_back(fs_ci);
+  shader_stages_.emplace_back(fs_ci);
 
   if (UseGeometryShader()) {
     VkPipelineShaderStageCreateInfo gs_ci{};
@@ -40,16 +42,20 @@ void RenderPipeline::Init(GPUVkContext* ctx, VkShaderModule vertex,
     gs_ci.module = geometry;
     gs_ci.pName = "main";
 
-    shaders.emplace_back(gs_ci);
+    shader_stages_.emplace_back(gs_ci);
   }
 
   InitDescriptorSetLayout(ctx);
   InitPipelineLayout(ctx);
 
+  pipeline_ = CreatePipeline(ctx, false);
+}
+
+VkPipeline RenderPipeline::CreatePipeline(GPUVkContext* ctx, bool compact) {
   // all pipeline use single input binding with 2 attributes
-  auto input_binding = GetVertexInputBinding();
+  auto input_binding = GetVertexInputBinding(compact);
   // input attributes
-  auto input_attr = GetVertexInputAttributes();
+  auto input_attr = GetVertexInputAttributes(compact);
   auto vertex_input_state = VKUtils::PipelineVertexInputStateCreateInfo();
   vertex_input_state.vertexBindingDescriptionCount = 1;
   vertex_input_state.pVertexBindingDescriptions = &input_binding;
@@ -66,6 +72,7 @@ void RenderPipeline::Init(GPUVkContext* ctx, VkShaderModule vertex,
   auto color_blend_state =
       VKUtils::PipelineColorBlendStateCreateInfo(1, &color_blend_attachment);
   auto depth_stencil_state = GetDepthStencilStateCreateInfo();
+  dynamic_stencil_ = depth_stencil_state.stencilTestEnable == VK_TRUE;
   auto view_port_state = VKUtils::PipelineViewportStateCreateInfo(1, 1);
   // TODO support multisample for vulkan
   auto multisample_state =
@@ -91,19 +98,31 @@ void RenderPipeline::Init(GPUVkContext* ctx, VkShaderModule vertex,
   pipeline_create_info.pViewportState = &view_port_state;
   pipeline_create_info.pDepthStencilState = &depth_stencil_state;
   pipeline_create_info.pDynamicState = &dynamic_state;
-  pipeline_create_info.stageCount = shaders.size();
-  pipeline_create_info.pStages = shaders.data();
-
-  if (VK_CALL(vkCreateGraphicsPipelines, ctx->GetDevice(), VK_NULL_HANDLE, 1,
-              &pipeline_create_info, nullptr, &pipeline_) != VK_SUCCESS) {
-    LOG_ERROR("Failed to create Graphic Pipeline");
+  pipeline_create_info.stageCount = shader_stages_.size();
+  pipeline_create_info.pStages = shader_stages_.data();
+
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  if (VK_CALL(vkCreateGraphicsPipelines, ctx->GetDevice(), GetPipelineCache(),
+              1, &pipeline_create_info, nullptr, &pipeline) != VK_SUCCESS) {
+    LOG_ERROR("Failed to create Graphic Pipeline, compact vertex: {}",
+              compact);
+    return VK_NULL_HANDLE;
   }
+
+  return pipeline;
 }
 
 void RenderPipeline::Destroy(GPUVkContext* ctx) {
   VK_CALL(vkDestroyPipeline, ctx->GetDevice(), pipeline_, nullptr);
+  VK_CALL(vkDestroyPipeline, ctx->GetDevice(), compact_pipeline_, nullptr);
   VK_CALL(vkDestroyPipelineLayout, ctx->GetDevice(), pipeline_layout_, nullptr);
 
+  if (own_shader_modules_) {
+    for (auto const& stage : shader_stages_) {
+      VK_CALL(vkDestroyShaderModule, ctx->GetDevice(), stage.module, nullptr);
+    }
+  }
+
   for (auto set_layout : descriptor_set_layout_) {
     VK_CALL(vkDestroyDescriptorSetLayout, ctx->GetDevice(), set_layout,
             nullptr);
@@ -111,7 +130,20 @@ void RenderPipeline::Destroy(GPUVkContext* ctx) {
 }
 
 void RenderPipeline::Bind(VkCommandBuffer cmd) {
-  VK_CALL(vkCmdBindPipeline, cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_);
+  // most frames never use the compact layout, create its variant on demand
+  // like other rarely used pipelines
+  if (CompactVertex() && compact_pipeline_ == VK_NULL_HANDLE &&
+      !compact_pipeline_failed_) {
+    compact_pipeline_ = CreatePipeline(ctx_, true);
+    compact_pipeline_failed_ = compact_pipeline_ == VK_NULL_HANDLE;
+  }
+
+  VkPipeline pipeline = pipeline_;
+  if (CompactVertex() && compact_pipeline_ != VK_NULL_HANDLE) {
+    pipeline = compact_pipeline_;
+  }
+
+  VK_CALL(vkCmdBindPipeline, cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
   bind_cmd_ = cmd;
 }
 
@@ -292,37 +324,65 @@ VkPipelineColorBlendAttachmentState RenderPipeline::GetColorBlendState() {
   return blend_attachment_state;
 }
 
+void RenderPipeline::UpdateStencilInfo(uint32_t reference,
+                                       uint32_t compare_mask,
+                                       uint32_t write_mask,
+                                       GPUVkContext* ctx) {
+  if (!dynamic_stencil_) {
+    return;
+  }
+
+  VK_CALL(vkCmdSetStencilReference, GetBindCMD(),
+          VK_STENCIL_FACE_FRONT_AND_BACK, reference);
+  VK_CALL(vkCmdSetStencilCompareMask, GetBindCMD(),
+          VK_STENCIL_FACE_FRONT_AND_BACK, compare_mask);
+  VK_CALL(vkCmdSetStencilWriteMask, GetBindCMD(),
+          VK_STENCIL_FACE_FRONT_AND_BACK, write_mask);
+}
+
 std::vector<VkDynamicState> RenderPipeline::GetDynamicStates() {
   std::vector<VkDynamicState> states{
       VK_DYNAMIC_STATE_VIEWPORT,
       VK_DYNAMIC_STATE_SCISSOR,
   };
 
+  if (dynamic_stencil_) {
+    states.emplace_back(VK_DYNAMIC_STATE_STENCIL_REFERENCE);
+    states.emplace_back(VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK);
+    states.emplace_back(VK_DYNAMIC_STATE_STENCIL_WRITE_MASK);
+  }
+
   return states;
 }
 
-VkVertexInputBindingDescription RenderPipeline::GetVertexInputBinding() {
+VkVertexInputBindingDescription RenderPipeline::GetVertexInputBinding(
+    bool compact) {
   VkVertexInputBindingDescription input_binding{};
   input_binding.binding = 0;
-  input_binding.stride = 5 * sizeof(float);
+  input_binding.stride = compact ? sizeof(HWCompactVertex) : sizeof(HWVertex);
 
   return input_binding;
 }
 
 std::array<VkVertexInputAttributeDescription, 2>
-RenderPipeline::GetVertexInputAttributes() {
+RenderPipeline::GetVertexInputAttributes(bool compact) {
   std::array<VkVertexInputAttributeDescription, 2> input_attr{};
 
   // location 0 vec2 [x, y]
   input_attr[0].binding = 0;
   input_attr[0].location = 0;
   input_attr[0].format = VK_FORMAT_R32G32_SFLOAT;
-  input_attr[0].offset = 0;
-  // location 1 vec3 [mix, u, v]
+  input_attr[0].offset =
+      compact ? offsetof(HWCompactVertex, x) : offsetof(HWVertex, x);
+  // location 1 vec3 [mix, u, v], compact layout reads padding as the unused
+  // fourth component since 3 component half float is optional for vertex
+  // buffers
   input_attr[1].binding = 0;
   input_attr[1].location = 1;
-  input_attr[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-  input_attr[1].offset = 2 * sizeof(float);
+  input_attr[1].format = compact ? VK_FORMAT_R16G16B16A16_SFLOAT
+                                 : VK_FORMAT_R32G32B32_SFLOAT;
+  input_attr[1].offset =
+      compact ? offsetof(HWCompactVertex, mix) : offsetof(HWVertex, mix);
 
   return input_attr;
 }
@@ -388,7 +448,7 @@ void ComputePipeline::Init(GPUVkContext* ctx, VkShaderModule vertex,
   auto pipeline_ci = VKUtils::ComputePipelineCreateInfo(pipeline_layout_);
   pipeline_ci.stage = shader_stage;
 
-  VK_CALL(vkCreateComputePipelines, ctx->GetDevice(), VK_NULL_HANDLE, 1,
+  VK_CALL(vkCreateComputePipelines, ctx->GetDevice(), GetPipelineCache(), 1,
           &pipeline_ci, nullptr, &pipeline_);
 }
 
@@ -461,22 +521,10 @@ void RenderPipelineFamily::OnInit(GPUVkContext* ctx) {
   fs_shader_ = GenerateFragmentShader(ctx);
   gs_shader_ = GenerateGeometryShader(ctx);
 
+  // pipelines used by almost every frame are created up front, the others are
+  // created on first use
   static_pipeline_ = CreateStaticPipeline(ctx);
   stencil_discard_pipeline_ = CreateStencilDiscardPipeline(ctx);
-  stencil_clip_pipeline_ = CreateStencilClipPipeline(ctx);
-  stencil_keep_pipeline_ = CreateStencilKeepPipeline(ctx);
-
-  if (OffScreenRenderPass()) {
-    os_static_pipeline_ = CreateOSStaticPipeline(ctx);
-    os_stencil_pipeline_ = CreateOSStencilPipeline(ctx);
-  }
-
-  VK_CALL(vkDestroyShaderModule, ctx->GetDevice(), vs_shader_, VK_NULL_HANDLE);
-  VK_CALL(vkDestroyShaderModule, ctx->GetDevice(), fs_shader_, VK_NULL_HANDLE);
-  if (UseGeometryShader()) {
-    VK_CALL(vkDestroyShaderModule, ctx->GetDevice(), gs_shader_,
-            VK_NULL_HANDLE);
-  }
 }
 
 void RenderPipelineFamily::OnDestroy(GPUVkContext* ctx) {
@@ -486,6 +534,13 @@ void RenderPipelineFamily::OnDestroy(GPUVkContext* ctx) {
   SAFE_DESTROY(stencil_keep_pipeline_, ctx);
   SAFE_DESTROY(os_static_pipeline_, ctx);
   SAFE_DESTROY(os_stencil_pipeline_, ctx);
+
+  VK_CALL(vkDestroyShaderModule, ctx->GetDevice(), vs_shader_, VK_NULL_HANDLE);
+  VK_CALL(vkDestroyShaderModule, ctx->GetDevice(), fs_shader_, VK_NULL_HANDLE);
+  if (UseGeometryShader()) {
+    VK_CALL(vkDestroyShaderModule, ctx->GetDevice(), gs_shader_,
+            VK_NULL_HANDLE);
+  }
 }
 
 AbsPipelineWrapper* RenderPipelineFamily::ChoosePipeline(bool enable_stencil,
@@ -509,9 +564,19 @@ VkShaderModule RenderPipelineFamily::GenerateGeometryShader(GPUVkContext* ctx) {
 
 AbsPipelineWrapper* RenderPipelineFamily::ChooseOffScreenPiepline(
     bool enable_stencil) {
+  if (!OffScreenRenderPass()) {
+    return nullptr;
+  }
+
   if (enable_stencil) {
+    if (!os_stencil_pipeline_) {
+      os_stencil_pipeline_ = CreateOSStencilPipeline(Context());
+    }
     return os_stencil_pipeline_.get();
   } else {
+    if (!os_static_pipeline_) {
+      os_static_pipeline_ = CreateOSStaticPipeline(Context());
+    }
     return os_static_pipeline_.get();
   }
 }
@@ -525,8 +590,14 @@ AbsPipelineWrapper* RenderPipelineFamily::ChooseRenderPipeline(
   if (StencilFunc() == HWStencilFunc::NOT_EQUAL) {
     return stencil_discard_pipeline_.get();
   } else if (StencilFunc() == HWStencilFunc::LESS) {
+    if (!stencil_clip_pipeline_) {
+      stencil_clip_pipeline_ = CreateStencilClipPipeline(Context());
+    }
     return stencil_clip_pipeline_.get();
   } else if (StencilFunc() == HWStencilFunc::EQUAL) {
+    if (!stencil_keep_pipeline_) {
+      stencil_keep_pipeline_ = CreateStencilKeepPipeline(Context());
+    }
     return stencil_keep_pipeline_.get();
   }
 
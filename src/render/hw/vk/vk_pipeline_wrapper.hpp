@@ -70,6 +70,15 @@ class AbsPipelineWrapper : public VkInterfaceClient {
 
   virtual bool HasColorSet() = 0;
 
+  void SetPipelineCache(VkPipelineCache pipeline_cache) {
+    pipeline_cache_ = pipeline_cache;
+  }
+
+  /**
+   * Vertex layout used by the next Bind, HWCompactVertex instead of HWVertex
+   */
+  void SetCompactVertex(bool compact) { compact_vertex_ = compact; }
+
   virtual void Init(GPUVkContext* ctx, VkShaderModule vertex,
                     VkShaderModule fragment, VkShaderModule geometry) = 0;
 
@@ -115,20 +124,28 @@ class AbsPipelineWrapper : public VkInterfaceClient {
                               VKMemoryAllocator* allocator) {}
 
   static std::unique_ptr<AbsPipelineWrapper> CreateStaticBlurPipeline(
-      VKInterface* vk_interface, GPUVkContext* ctx, bool use_gs);
+      VKInterface* vk_interface, GPUVkContext* ctx, bool use_gs,
+      VkPipelineCache pipeline_cache);
 
   static std::unique_ptr<AbsPipelineWrapper> CreateStaticBlurPipeline(
       VKInterface* vk_interface, GPUVkContext* ctx, bool use_gs,
-      VkRenderPass render_pass);
+      VkPipelineCache pipeline_cache, VkRenderPass render_pass);
 
   static std::unique_ptr<AbsPipelineWrapper> CreateComputeBlurPipeline(
-      VKInterface* vk_interface, GPUVkContext* ctx);
+      VKInterface* vk_interface, GPUVkContext* ctx,
+      VkPipelineCache pipeline_cache);
 
  protected:
   bool UseGeometryShader() const { return use_gs_; }
 
+  VkPipelineCache GetPipelineCache() const { return pipeline_cache_; }
+
+  bool CompactVertex() const { return compact_vertex_; }
+
  private:
   bool use_gs_;
+  bool compact_vertex_ = false;
+  VkPipelineCache pipeline_cache_ = VK_NULL_HANDLE;
 };
 
 class RenderPipeline : public AbsPipelineWrapper {
@@ -141,6 +158,12 @@ class RenderPipeline : public AbsPipelineWrapper {
     os_render_pass_ = render_pass;
   }
 
+  /**
+   * Destroy shader modules passed to Init in Destroy, for pipelines not
+   * created by a PipelineFamily
+   */
+  void OwnShaderModules() { own_shader_modules_ = true; }
+
   bool IsComputePipeline() override { return false; }
 
   void Init(GPUVkContext* ctx, VkShaderModule vertex, VkShaderModule fragment,
@@ -163,6 +186,11 @@ class RenderPipeline : public AbsPipelineWrapper {
 
   void UploadFontSet(VkDescriptorSet set, GPUVkContext* ctx) override;
 
+  // reference and masks of pipelines testing stencil are dynamic, since
+  // stencil clip levels and winding bits are encoded in them
+  void UpdateStencilInfo(uint32_t reference, uint32_t compare_mask,
+                         uint32_t write_mask, GPUVkContext* ctx) override;
+
   bool HasColorSet() override {
     return descriptor_set_layout_[2] != VK_NULL_HANDLE;
   }
@@ -197,12 +225,24 @@ class RenderPipeline : public AbsPipelineWrapper {
   static VkPipelineDepthStencilStateCreateInfo StencilKeepInfo();
 
  private:
-  VkVertexInputBindingDescription GetVertexInputBinding();
-  std::array<VkVertexInputAttributeDescription, 2> GetVertexInputAttributes();
+  /**
+   * @param compact use HWCompactVertex as vertex input instead of HWVertex
+   * @return        VK_NULL_HANDLE if failed
+   */
+  VkPipeline CreatePipeline(GPUVkContext* ctx, bool compact);
+
+  static VkVertexInputBindingDescription GetVertexInputBinding(bool compact);
+  static std::array<VkVertexInputAttributeDescription, 2>
+  GetVertexInputAttributes(bool compact);
 
  private:
   size_t push_const_size_;
+  GPUVkContext* ctx_ = {};
   VkRenderPass os_render_pass_ = VK_NULL_HANDLE;
+  // kept to create compact_pipeline_ later, shader modules live until
+  // Destroy of the pipeline family or of this pipeline if it owns them
+  std::vector<VkPipelineShaderStageCreateInfo> shader_stages_ = {};
+  bool own_shader_modules_ = false;
   /**
    * set 0: common transform matrix info
    * set 1: common fragment color info, [global alpha, stroke width]
@@ -212,7 +252,12 @@ class RenderPipeline : public AbsPipelineWrapper {
   std::array<VkDescriptorSetLayout, 4> descriptor_set_layout_ = {};
   VkPipelineLayout pipeline_layout_ = {};
   VkPipeline pipeline_ = {};
+  // same states as pipeline_, reading HWCompactVertex, created by the first
+  // Bind with compact vertex
+  VkPipeline compact_pipeline_ = {};
+  bool compact_pipeline_failed_ = false;
   VkCommandBuffer bind_cmd_ = {};
+  bool dynamic_stencil_ = false;
 };
 
 class ComputePipeline : public AbsPipelineWrapper {
@@ -301,8 +346,11 @@ class PipelineFamily : public VkInterfaceClient {
   virtual ~PipelineFamily() = default;
 
   void Init(GPUVkContext* ctx, bool use_geometry_shader,
+            VkPipelineCache pipeline_cache,
             VkRenderPass os_renderpass = VK_NULL_HANDLE) {
+    ctx_ = ctx;
     use_geometry_shader_ = use_geometry_shader;
+    pipeline_cache_ = pipeline_cache;
     os_render_pass_ = os_renderpass;
 
     OnInit(ctx);
@@ -336,6 +384,7 @@ class PipelineFamily : public VkInterfaceClient {
     auto pipeline =
         std::make_unique<T>(UseGeometryShader(), sizeof(GlobalPushConst));
     pipeline->SetInterface(GetInterface());
+    pipeline->SetPipelineCache(PipelineCache());
     pipeline->SetRenderPass(render_pass);
 
     pipeline->Init(ctx, vs_shader, fs_shader, gs_shader);
@@ -344,6 +393,11 @@ class PipelineFamily : public VkInterfaceClient {
   }
 
  protected:
+  // context passed to Init, used to create pipelines on first use
+  GPUVkContext* Context() const { return ctx_; }
+
+  VkPipelineCache PipelineCache() const { return pipeline_cache_; }
+
   VkRenderPass OffScreenRenderPass() const { return os_render_pass_; }
 
   bool UseGeometryShader() const { return use_geometry_shader_; }
@@ -359,7 +413,9 @@ class PipelineFamily : public VkInterfaceClient {
   virtual void OnDestroy(GPUVkContext* ctx) = 0;
 
  private:
+  GPUVkContext* ctx_ = {};
   bool use_geometry_shader_ = false;
+  VkPipelineCache pipeline_cache_ = VK_NULL_HANDLE;
   VkRenderPass os_render_pass_ = VK_NULL_HANDLE;
   HWStencilFunc stencil_func_ = HWStencilFunc::ALWAYS;
   HWStencilOp stencil_op_ = HWStencilOp::KEEP;
@@ -430,13 +486,14 @@ struct PipelineBuilder {
   const char* geometry_src;
   size_t geometry_size;
   GPUVkContext* ctx;
+  VkPipelineCache pipeline_cache;
   VkRenderPass render_pass;
 
   PipelineBuilder(VKInterface* interface, const char* vertex_src,
                   size_t vertex_size, const char* fragment_src,
                   size_t fragment_size, const char* geometry_src,
                   size_t geometry_size, GPUVkContext* ctx,
-                  VkRenderPass r = VK_NULL_HANDLE)
+                  VkPipelineCache cache, VkRenderPass r = VK_NULL_HANDLE)
       : vk_interface(interface),
         vertex_src(vertex_src),
         vertex_size(vertex_size),
@@ -445,6 +502,7 @@ struct PipelineBuilder {
         geometry_src(geometry_src),
         geometry_size(geometry_size),
         ctx(ctx),
+        pipeline_cache(cache),
         render_pass(r) {}
 
   std::unique_ptr<T> operator()() {
@@ -469,13 +527,11 @@ struct PipelineBuilder {
                                 (const char*)geometry_src, geometry_size);
     }
     pipeline->SetInterface(vk_interface);
+    pipeline->SetPipelineCache(pipeline_cache);
     pipeline->Init(ctx, vertex, fragment, geometry);
+    // compact vertex variant is created on first use with the same shaders
+    pipeline->OwnShaderModules();
 
-    VK_CALL_I(vkDestroyShaderModule, ctx->GetDevice(), vertex, nullptr);
-    VK_CALL_I(vkDestroyShaderModule, ctx->GetDevice(), fragment, nullptr);
-    if (geometry) {
-      VK_CALL_I(vkDestroyShaderModule, ctx->GetDevice(), geometry, nullptr);
-    }
     return pipeline;
   }
 };
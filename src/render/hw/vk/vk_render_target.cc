@@ -120,9 +120,11 @@ void VKRenderTarget::EndDraw() {
   barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
   barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 
+  // the frame command buffer samples the result without host wait
   VK_CALL(vkCmdPipelineBarrier, vk_cmd_, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1,
-          &barrier);
+          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+              VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+          0, 0, nullptr, 0, nullptr, 1, &barrier);
   renderer_->SubmitCMD(vk_cmd_);
 
   vk_cmd_ = VK_NULL_HANDLE;
@@ -132,7 +134,7 @@ void VKRenderTarget::EndDraw() {
 void VKRenderTarget::CreateStencilImage() {
   stencil_image_.reset(allocator_->AllocateImage(
       ctx_->GetDepthStencilFormat(), {Width(), Height(), 1},
-      VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT));
+      VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, 1));
 
   VkImageSubresourceRange range;
   range.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
@@ -4,6 +4,7 @@
 #undef SKITY_LOG
 #endif
 
+#include <cstdlib>
 #include <cstring>
 
 #include "src/logging.hpp"
@@ -12,8 +13,6 @@
 #include "src/render/hw/vk/vk_render_target.hpp"
 #include "src/render/hw/vk/vk_texture.hpp"
 
-#define SKITY_DEFAULT_BUFFER_SIZE 512
-
 namespace skity {
 
 VkRenderer::VkRenderer(GPUVkContext* ctx, bool use_gs)
@@ -29,9 +28,8 @@ void VkRenderer::Init() {
   vk_memory_allocator_->Init(ctx_);
   InitOffScreenRenderPass();
   InitFrameBuffers();
+  InitPipelineCache();
   InitPipelines();
-  InitCMDPool();
-  InitFence();
   InitSampler();
 
   empty_font_texture_ = std::make_unique<VKFontTexture>(
@@ -42,15 +40,14 @@ void VkRenderer::Init() {
 }
 
 void VkRenderer::Destroy() {
-  vk_memory_allocator_->FreeBuffer(vertex_buffer_.get());
-  vk_memory_allocator_->FreeBuffer(index_buffer_.get());
+  // pending uploads are dropped together with their command pool
+  upload_frame_ = nullptr;
 
   empty_font_texture_->Destroy();
 
   DestroySampler();
-  DestroyFence();
-  DestroyCMDPool();
   DestroyPipelines();
+  DestroyPipelineCache();
   DestroyFrameBuffers();
 
   VK_CALL(vkDestroyRenderPass, ctx_->GetDevice(), os_render_pass_, nullptr);
@@ -68,10 +65,7 @@ void VkRenderer::Bind() {
   used_font_and_set_.clear();
   empty_font_set_ = VK_NULL_HANDLE;
 
-  CurrentFrameBuffer()->FrameBegin(ctx_);
-
-  // reset previouse frame allocate command buffer
-  VK_CALL(vkResetCommandPool, ctx_->GetDevice(), vk_cmd_pool_, 0);
+  BeginFrameIfNeed();
 
   // view port
   VkViewport view_port{0,
@@ -84,6 +78,7 @@ void VkRenderer::Bind() {
   // scissor
   VkRect2D scissor{{0, 0}, ctx_->GetFrameExtent()};
   VK_CALL(vkCmdSetScissor, GetCurrentCMD(), 0, 1, &scissor);
+  scissor_ = scissor;
 
   // update empty_font_set_
   empty_font_set_ = CurrentFrameBuffer()->ObtainUniformBufferSet(
@@ -106,6 +101,12 @@ void VkRenderer::Bind() {
 void VkRenderer::UnBind() {
   LOG_DEBUG("vk_pipeline UnBind");
   prev_pipeline_ = nullptr;
+
+  // uploads must be submitted before the frame command buffer sampling them
+  FlushUploadCMD();
+  frame_done_ = true;
+
+  SavePipelineCacheIfNeed();
 }
 
 void VkRenderer::SetViewProjectionMatrix(const glm::mat4& mvp) {
@@ -166,37 +167,63 @@ void VkRenderer::SetGradientPositions(const std::vector<float>& pos) {
   gradient_info_set_.dirty = true;
 }
 
-void VkRenderer::UploadVertexBuffer(void* data, size_t data_size) {
-  LOG_DEBUG("vk_pipeline upload vertex buffer with size: {}", data_size);
+uint32_t VkRenderer::BeginBufferFrame() {
+  // mesh is uploaded before Bind, so a new frame begins here
+  BeginFrameIfNeed();
 
-  if (!vertex_buffer_ || vertex_buffer_->BufferSize() < data_size) {
-    size_t new_size = vertex_buffer_ ? vertex_buffer_->BufferSize() * 2
-                                     : SKITY_DEFAULT_BUFFER_SIZE;
-    new_size = std::max(new_size, data_size);
-    InitVertexBuffer(new_size);
-  }
+  return frame_index_;
+}
 
-  vk_memory_allocator_->UploadBuffer(vertex_buffer_.get(), data, data_size);
+uint32_t VkRenderer::BufferSetCount() const {
+  return static_cast<uint32_t>(frame_buffer_.size());
+}
+
+bool VkRenderer::SupportCompactVertex() const { return true; }
+
+void VkRenderer::SetMeshFormat(HWMeshFormat const& format) {
+  // vertex input layout is baked into pipelines, every render pipeline holds
+  // one variant per layout and picks it in Bind
+  index_type_ =
+      format.short_index ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+  compact_vertex_ = format.compact_vertex;
+}
+
+bool VkRenderer::ReserveVertexBuffer(size_t data_size) {
+  LOG_DEBUG("vk_pipeline reserve vertex buffer with size: {}", data_size);
+
+  auto frame_buffer = CurrentFrameBuffer();
+  bool kept = frame_buffer->ReserveVertexBuffer(data_size);
 
   uint64_t offset = 0;
-  VkBuffer buffer = vertex_buffer_->GetBuffer();
+  VkBuffer buffer = frame_buffer->GetVertexBuffer()->GetBuffer();
   VK_CALL(vkCmdBindVertexBuffers, GetCurrentCMD(), 0, 1, &buffer, &offset);
+
+  return kept;
 }
 
-void VkRenderer::UploadIndexBuffer(void* data, size_t data_size) {
-  LOG_DEBUG("vk_pipeline upload index buffer with size: {}", data_size);
+bool VkRenderer::ReserveIndexBuffer(size_t data_size) {
+  LOG_DEBUG("vk_pipeline reserve index buffer with size: {}", data_size);
 
-  if (!index_buffer_ || index_buffer_->BufferSize() < data_size) {
-    size_t new_size = index_buffer_ ? vertex_buffer_->BufferSize() * 2
-                                    : SKITY_DEFAULT_BUFFER_SIZE;
-    new_size = std::max(new_size, data_size);
-    InitIndexBuffer(new_size);
-  }
+  auto frame_buffer = CurrentFrameBuffer();
+  bool kept = frame_buffer->ReserveIndexBuffer(data_size);
+
+  VK_CALL(vkCmdBindIndexBuffer, GetCurrentCMD(),
+          frame_buffer->GetIndexBuffer()->GetBuffer(), 0, index_type_);
+
+  return kept;
+}
 
-  vk_memory_allocator_->UploadBuffer(index_buffer_.get(), data, data_size);
+void VkRenderer::UpdateVertexBuffer(void* data, size_t offset,
+                                    size_t data_size) {
+  // buffers are host visible, this writes straight into mapped memory
+  vk_memory_allocator_->UploadBuffer(CurrentFrameBuffer()->GetVertexBuffer(),
+                                     data, data_size, offset);
+}
 
-  VK_CALL(vkCmdBindIndexBuffer, GetCurrentCMD(), index_buffer_->GetBuffer(), 0,
-          VK_INDEX_TYPE_UINT32);
+void VkRenderer::UpdateIndexBuffer(void* data, size_t offset,
+                                   size_t data_size) {
+  vk_memory_allocator_->UploadBuffer(CurrentFrameBuffer()->GetIndexBuffer(),
+                                     data, data_size, offset);
 }
 
 void VkRenderer::SetGlobalAlpha(float alpha) {
@@ -245,6 +272,19 @@ void VkRenderer::UpdateStencilFunc(HWStencilFunc func, uint32_t value,
   stencil_compare_mask_ = compare_mask;
 }
 
+void VkRenderer::EnableScissorTest(Rect const& rect) {
+  VkExtent2D extent = CurrentExtent();
+  glm::ivec4 box = CalculateScissorBox(rect, extent.width, extent.height);
+
+  SetScissorIfNeed(VkRect2D{
+      {box.x, box.y},
+      {static_cast<uint32_t>(box.z), static_cast<uint32_t>(box.w)}});
+}
+
+void VkRenderer::DisableScissorTest() {
+  SetScissorIfNeed(VkRect2D{{0, 0}, CurrentExtent()});
+}
+
 void VkRenderer::DrawIndex(uint32_t start, uint32_t count) {
   LOG_DEBUG("vk_pipeline draw_index [ {} -> {} ]", start, count);
 
@@ -314,12 +354,17 @@ void VkRenderer::BindRenderTarget(HWRenderTarget* render_target) {
   // create internal vulkan cmd
   current_target_->StartDraw();
 
+  // render target starts with full scissor
+  saved_scissor_ = scissor_;
+  scissor_ = VkRect2D{{0, 0}, CurrentExtent()};
+
+  auto frame_buffer = CurrentFrameBuffer();
   uint64_t offset = 0;
-  VkBuffer buffer = vertex_buffer_->GetBuffer();
+  VkBuffer buffer = frame_buffer->GetVertexBuffer()->GetBuffer();
   VK_CALL(vkCmdBindVertexBuffers, GetCurrentCMD(), 0, 1, &buffer, &offset);
 
-  VK_CALL(vkCmdBindIndexBuffer, GetCurrentCMD(), index_buffer_->GetBuffer(), 0,
-          VK_INDEX_TYPE_UINT32);
+  VK_CALL(vkCmdBindIndexBuffer, GetCurrentCMD(),
+          frame_buffer->GetIndexBuffer()->GetBuffer(), 0, index_type_);
 
   ResetUniformDirty();
 }
@@ -329,78 +374,63 @@ void VkRenderer::UnBindRenderTarget(HWRenderTarget* render_target) {
   current_target_->EndDraw();
   current_target_ = nullptr;
   prev_pipeline_ = nullptr;
+  scissor_ = saved_scissor_;
   ResetUniformDirty();
 }
 
 VkCommandBuffer VkRenderer::ObtainInternalCMD() {
-  VkCommandBufferAllocateInfo buffer_info{
-      VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
-  buffer_info.commandBufferCount = 1;
-  buffer_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-  buffer_info.commandPool = vk_cmd_pool_;
-
-  VkCommandBuffer cmd;
-
-  if (VK_CALL(vkAllocateCommandBuffers, ctx_->GetDevice(), &buffer_info,
-              &cmd) != VK_SUCCESS) {
-    LOG_ERROR("Faled allocate internal command buffer!");
-    return VK_NULL_HANDLE;
-  }
-
-  VkCommandBufferBeginInfo begin_info{
-      VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
-  begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-  VK_CALL(vkBeginCommandBuffer, cmd, &begin_info);
-
-  return cmd;
+  return CurrentFrameBuffer()->ObtainInternalCMD(ctx_);
 }
 
 void VkRenderer::SubmitCMD(VkCommandBuffer cmd) {
-  VK_CALL(vkEndCommandBuffer, cmd);
+  FlushUploadCMD();
 
-  VkSubmitInfo submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO};
-  submit_info.commandBufferCount = 1;
-  submit_info.pCommandBuffers = &cmd;
+  CurrentFrameBuffer()->SubmitInternalCMD(ctx_, cmd);
+}
 
-  VK_CALL(vkQueueSubmit, ctx_->GetGraphicQueue(), 1, &submit_info, vk_fence_);
+VkCommandBuffer VkRenderer::ObtainUploadCMD() {
+  if (upload_frame_ == nullptr) {
+    upload_frame_ = CurrentFrameBuffer();
+  }
 
-  WaitForFence();
-  ResetFence();
+  return upload_frame_->ObtainUploadCMD(ctx_);
 }
 
-void VkRenderer::WaitForFence() {
-  VK_CALL(vkWaitForFences, ctx_->GetDevice(), 1, &vk_fence_, VK_TRUE,
-          1000000000);
-}
+AllocatedBuffer* VkRenderer::ObtainStageBuffer(size_t size, size_t alignment,
+                                               size_t* offset) {
+  if (upload_frame_ == nullptr) {
+    upload_frame_ = CurrentFrameBuffer();
+  }
 
-void VkRenderer::ResetFence() {
-  VK_CALL(vkResetFences, ctx_->GetDevice(), 1, &vk_fence_);
+  return upload_frame_->ObtainStageBuffer(size, alignment, offset);
 }
 
-void VkRenderer::InitCMDPool() {
-  // create a command pool for internal use
-  VkCommandPoolCreateInfo create_info{
-      VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
-  create_info.queueFamilyIndex = ctx_->GetGraphicQueueIndex();
-  create_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-
-  if (VK_CALL(vkCreateCommandPool, ctx_->GetDevice(), &create_info, nullptr,
-              &vk_cmd_pool_) != VK_SUCCESS) {
-    LOG_ERROR("Failed create internal command pool!");
+void VkRenderer::FlushUploadCMD() {
+  if (upload_frame_ == nullptr) {
+    return;
   }
+
+  upload_frame_->SubmitUploadCMD(ctx_);
+  upload_frame_ = nullptr;
 }
 
-void VkRenderer::InitFence() {
-  VkFenceCreateInfo create_info{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
-  create_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+void VkRenderer::RetireImage(VKTexture* texture, AllocatedImage* image,
+                             VkImageView view) {
+  // font set cached for this texture still points to the old view
+  used_font_and_set_.erase(texture);
 
-  if (VK_CALL(vkCreateFence, ctx_->GetDevice(), &create_info, nullptr,
-              &vk_fence_) != VK_SUCCESS) {
-    LOG_ERROR("Failed create internal fence object!");
-  }
+  CurrentFrameBuffer()->RetireImage(image, view);
+}
 
-  ResetFence();
+VkSampler VkRenderer::PipelineSampler(HWTexture::Filter filter) const {
+  switch (filter) {
+    case HWTexture::Filter::kNearest:
+      return vk_nearest_sampler_;
+    case HWTexture::Filter::kMipmap:
+      return vk_mipmap_sampler_;
+    default:
+      return vk_sampler_;
+  }
 }
 
 void VkRenderer::InitSampler() {
@@ -409,6 +439,19 @@ void VkRenderer::InitSampler() {
 
   VK_CALL(vkCreateSampler, ctx_->GetDevice(), &sampler_create_info, nullptr,
           &vk_sampler_);
+
+  auto nearest_create_info = VKUtils::SamplerCreateInfo();
+  nearest_create_info.magFilter = VK_FILTER_NEAREST;
+  nearest_create_info.minFilter = VK_FILTER_NEAREST;
+
+  VK_CALL(vkCreateSampler, ctx_->GetDevice(), &nearest_create_info, nullptr,
+          &vk_nearest_sampler_);
+
+  auto mipmap_create_info = VKUtils::SamplerCreateInfo();
+  mipmap_create_info.maxLod = VK_LOD_CLAMP_NONE;
+
+  VK_CALL(vkCreateSampler, ctx_->GetDevice(), &mipmap_create_info, nullptr,
+          &vk_mipmap_sampler_);
 }
 
 void VkRenderer::InitFrameBuffers() {
@@ -420,17 +463,10 @@ void VkRenderer::InitFrameBuffers() {
   }
 }
 
-void VkRenderer::DestroyCMDPool() {
-  VK_CALL(vkResetCommandPool, ctx_->GetDevice(), vk_cmd_pool_, 0);
-  VK_CALL(vkDestroyCommandPool, ctx_->GetDevice(), vk_cmd_pool_, nullptr);
-}
-
-void VkRenderer::DestroyFence() {
-  VK_CALL(vkDestroyFence, ctx_->GetDevice(), vk_fence_, nullptr);
-}
-
 void VkRenderer::DestroySampler() {
   VK_CALL(vkDestroySampler, ctx_->GetDevice(), vk_sampler_, nullptr);
+  VK_CALL(vkDestroySampler, ctx_->GetDevice(), vk_nearest_sampler_, nullptr);
+  VK_CALL(vkDestroySampler, ctx_->GetDevice(), vk_mipmap_sampler_, nullptr);
 }
 
 void VkRenderer::DestroyPipelines() {
@@ -439,9 +475,17 @@ void VkRenderer::DestroyPipelines() {
   image_pipeline_family_->Destroy(ctx_);
   stencil_pipeline_family_->Destroy(ctx_);
 
-  compute_blur_pipeline_->Destroy(ctx_);
-  static_blur_pipeline_->Destroy(ctx_);
-  os_static_blur_pipeline_->Destroy(ctx_);
+  SAFE_DESTROY(compute_blur_pipeline_, ctx_);
+  SAFE_DESTROY(static_blur_pipeline_, ctx_);
+  SAFE_DESTROY(os_static_blur_pipeline_, ctx_);
+}
+
+void VkRenderer::DestroyPipelineCache() {
+  SavePipelineCacheIfNeed();
+
+  VK_CALL(vkDestroyPipelineCache, ctx_->GetDevice(), vk_pipeline_cache_,
+          nullptr);
+  vk_pipeline_cache_ = VK_NULL_HANDLE;
 }
 
 void VkRenderer::DestroyFrameBuffers() {
@@ -458,45 +502,49 @@ VkCommandBuffer VkRenderer::GetCurrentCMD() {
   }
 }
 
+void VkRenderer::InitPipelineCache() {
+  auto data = ctx_->GetPipelineCacheData();
+
+  VkPipelineCacheCreateInfo create_info{
+      VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+  if (data && !data->IsEmpty()) {
+    // incompatible data is ignored by driver and the cache starts empty
+    create_info.initialDataSize = data->Size();
+    create_info.pInitialData = data->RawData();
+  }
+
+  if (VK_CALL(vkCreatePipelineCache, ctx_->GetDevice(), &create_info, nullptr,
+              &vk_pipeline_cache_) != VK_SUCCESS) {
+    LOG_ERROR("Failed create pipeline cache!");
+    vk_pipeline_cache_ = VK_NULL_HANDLE;
+  }
+
+  saved_pipeline_cache_size_ = create_info.initialDataSize;
+}
+
 void VkRenderer::InitPipelines() {
   color_pipeline_family_ = RenderPipelineFamily::CreateColorPipelineFamily();
   color_pipeline_family_->SetInterface(GetInterface());
-  color_pipeline_family_->Init(ctx_, use_gs_, os_render_pass_);
+  color_pipeline_family_->Init(ctx_, use_gs_, vk_pipeline_cache_,
+                               os_render_pass_);
 
   gradient_pipeline_family_ =
       RenderPipelineFamily::CreateGradientPipelineFamily();
   gradient_pipeline_family_->SetInterface(GetInterface());
-  gradient_pipeline_family_->Init(ctx_, use_gs_, os_render_pass_);
+  gradient_pipeline_family_->Init(ctx_, use_gs_, vk_pipeline_cache_,
+                                  os_render_pass_);
 
   image_pipeline_family_ = PipelineFamily::CreateImagePipelineFamily();
   image_pipeline_family_->SetInterface(GetInterface());
-  image_pipeline_family_->Init(ctx_, use_gs_, os_render_pass_);
+  image_pipeline_family_->Init(ctx_, use_gs_, vk_pipeline_cache_,
+                               os_render_pass_);
 
   stencil_pipeline_family_ = PipelineFamily::CreateStencilPipelineFamily();
   stencil_pipeline_family_->SetInterface(GetInterface());
-  stencil_pipeline_family_->Init(ctx_, use_gs_, os_render_pass_);
+  stencil_pipeline_family_->Init(ctx_, use_gs_, vk_pipeline_cache_,
+                                 os_render_pass_);
 
-  // effect pipelines
-  static_blur_pipeline_ = AbsPipelineWrapper::CreateStaticBlurPipeline(
-      GetInterface(), ctx_, use_gs_);
-  os_static_blur_pipeline_ = AbsPipelineWrapper::CreateStaticBlurPipeline(
-      GetInterface(), ctx_, use_gs_, os_render_pass_);
-  compute_blur_pipeline_ =
-      AbsPipelineWrapper::CreateComputeBlurPipeline(GetInterface(), ctx_);
-}
-
-void VkRenderer::InitVertexBuffer(size_t new_size) {
-  if (vertex_buffer_) {
-    vk_memory_allocator_->FreeBuffer(vertex_buffer_.get());
-  }
-  vertex_buffer_.reset(vk_memory_allocator_->AllocateVertexBuffer(new_size));
-}
-
-void VkRenderer::InitIndexBuffer(size_t new_size) {
-  if (index_buffer_) {
-    vk_memory_allocator_->FreeBuffer(index_buffer_.get());
-  }
-  index_buffer_.reset(vk_memory_allocator_->AllocateIndexBuffer(new_size));
+  // effect pipelines are created on first use in PickBlurPipeline
 }
 
 void VkRenderer::InitOffScreenRenderPass() {
@@ -536,32 +584,36 @@ void VkRenderer::InitOffScreenRenderPass() {
   subpass_desc.pColorAttachments = &color_ref;
   subpass_desc.pDepthStencilAttachment = &stencil_ref;
 
-  // Use subpass dependencies for layout transitions
+  // Use subpass dependencies for layout transitions, offscreen draws are not
+  // waited on host, so reads of previous frames and of the frame command
+  // buffer are ordered by these dependencies
   std::array<VkSubpassDependency, 2> dependencies;
 
   dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
   dependencies[0].dstSubpass = 0;
-  dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+  dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
   dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
   dependencies[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
   dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-  dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+  dependencies[0].dependencyFlags = 0;
 
   dependencies[1].srcSubpass = 0;
   dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
   dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-  dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+  dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
   dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
   dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-  dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+  dependencies[1].dependencyFlags = 0;
 
   VkRenderPassCreateInfo create_info{VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO};
   create_info.attachmentCount = 2;
   create_info.pAttachments = attachments.data();
   create_info.subpassCount = 1;
   create_info.pSubpasses = &subpass_desc;
-  // create_info.dependencyCount = 2;
-  // create_info.pDependencies = dependencies.data();
+  create_info.dependencyCount = 2;
+  create_info.pDependencies = dependencies.data();
 
   if (VK_CALL(vkCreateRenderPass, ctx_->GetDevice(), &create_info, nullptr,
               &os_render_pass_) != VK_SUCCESS) {
@@ -603,20 +655,58 @@ AbsPipelineWrapper* VkRenderer::PickBlurPipeline() {
   if (current_target_) {
     if (color_mode_ == HWPipelineColorMode::kHorizontalBlur ||
         color_mode_ == HWPipelineColorMode::kVerticalBlur) {
+      if (!compute_blur_pipeline_) {
+        compute_blur_pipeline_ = AbsPipelineWrapper::CreateComputeBlurPipeline(
+            GetInterface(), ctx_, vk_pipeline_cache_);
+      }
       return compute_blur_pipeline_.get();
     }
+
+    if (!os_static_blur_pipeline_) {
+      os_static_blur_pipeline_ = AbsPipelineWrapper::CreateStaticBlurPipeline(
+          GetInterface(), ctx_, use_gs_, vk_pipeline_cache_, os_render_pass_);
+    }
     return os_static_blur_pipeline_.get();
   }
 
+  if (!static_blur_pipeline_) {
+    static_blur_pipeline_ = AbsPipelineWrapper::CreateStaticBlurPipeline(
+        GetInterface(), ctx_, use_gs_, vk_pipeline_cache_);
+  }
   return static_blur_pipeline_.get();
 }
 
+void VkRenderer::SavePipelineCacheIfNeed() {
+  if (vk_pipeline_cache_ == VK_NULL_HANDLE) {
+    return;
+  }
+
+  // the cache only grows when new pipelines are created into it
+  size_t data_size = 0;
+  if (VK_CALL(vkGetPipelineCacheData, ctx_->GetDevice(), vk_pipeline_cache_,
+              &data_size, nullptr) != VK_SUCCESS ||
+      data_size == saved_pipeline_cache_size_) {
+    return;
+  }
+
+  void* data = std::malloc(data_size);
+  if (VK_CALL(vkGetPipelineCacheData, ctx_->GetDevice(), vk_pipeline_cache_,
+              &data_size, data) != VK_SUCCESS) {
+    std::free(data);
+    return;
+  }
+
+  saved_pipeline_cache_size_ = data_size;
+  ctx_->SavePipelineCacheData(Data::MakeFromMalloc(data, data_size));
+}
+
 void VkRenderer::BindPipelineIfNeed(AbsPipelineWrapper* pipeline) {
   if (pipeline == prev_pipeline_ && current_target_ == nullptr) {
     // no need to call bind pipeline
     return;
   }
 
+  pipeline->SetCompactVertex(compact_vertex_);
   pipeline->Bind(GetCurrentCMD());
   prev_pipeline_ = pipeline;
 }
@@ -659,6 +749,26 @@ void VkRenderer::UpdateCommonSetIfNeed(AbsPipelineWrapper* pipeline) {
                             CurrentFrameBuffer(), vk_memory_allocator_.get());
 }
 
+VkExtent2D VkRenderer::CurrentExtent() {
+  if (current_target_) {
+    return VkExtent2D{current_target_->Width(), current_target_->Height()};
+  }
+
+  return ctx_->GetFrameExtent();
+}
+
+void VkRenderer::SetScissorIfNeed(VkRect2D const& scissor) {
+  if (scissor.offset.x == scissor_.offset.x &&
+      scissor.offset.y == scissor_.offset.y &&
+      scissor.extent.width == scissor_.extent.width &&
+      scissor.extent.height == scissor_.extent.height) {
+    return;
+  }
+
+  VK_CALL(vkCmdSetScissor, GetCurrentCMD(), 0, 1, &scissor);
+  scissor_ = scissor;
+}
+
 void VkRenderer::UpdateStencilConfigIfNeed(AbsPipelineWrapper* pipeline) {
   pipeline->UpdateStencilInfo(stencil_value_, stencil_compare_mask_,
                               stencil_write_mask_, ctx_);
@@ -740,7 +850,32 @@ void VkRenderer::ResetUniformDirty() {
 }
 
 SKVkFrameBufferData* VkRenderer::CurrentFrameBuffer() {
-  return frame_buffer_[ctx_->GetCurrentBufferIndex()].get();
+  uint32_t index = ctx_->GetCurrentBufferIndex();
+
+  if (index != frame_index_) {
+    RecycleFrame(index);
+  }
+
+  return frame_buffer_[index].get();
+}
+
+void VkRenderer::BeginFrameIfNeed() {
+  uint32_t index = ctx_->GetCurrentBufferIndex();
+
+  // the same swapchain image drawn again after UnBind starts a new frame too
+  if (index != frame_index_ || frame_done_) {
+    RecycleFrame(index);
+  }
+}
+
+void VkRenderer::RecycleFrame(uint32_t index) {
+  // uploads recorded into previous frame go before anything of the new one
+  FlushUploadCMD();
+
+  frame_index_ = index;
+  frame_done_ = false;
+
+  frame_buffer_[index]->FrameBegin(ctx_);
 }
 
 }  // namespace skity
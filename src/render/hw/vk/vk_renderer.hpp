@@ -1,6 +1,7 @@
 #ifndef SKITY_SRC_RENDER_HW_VK_VK_PIPELINE_HPP
 #define SKITY_SRC_RENDER_HW_VK_VK_PIPELINE_HPP
 
+#include <cstdint>
 #include <map>
 #include <skity/gpu/gpu_vk_context.hpp>
 
@@ -53,9 +54,21 @@ class VkRenderer : public HWRenderer {
 
   void SetGradientPositions(std::vector<float> const& pos) override;
 
-  void UploadVertexBuffer(void* data, size_t data_size) override;
+  uint32_t BeginBufferFrame() override;
 
-  void UploadIndexBuffer(void* data, size_t data_size) override;
+  uint32_t BufferSetCount() const override;
+
+  void SetMeshFormat(HWMeshFormat const& format) override;
+
+  bool SupportCompactVertex() const override;
+
+  bool ReserveVertexBuffer(size_t data_size) override;
+
+  bool ReserveIndexBuffer(size_t data_size) override;
+
+  void UpdateVertexBuffer(void* data, size_t offset, size_t data_size) override;
+
+  void UpdateIndexBuffer(void* data, size_t offset, size_t data_size) override;
 
   void SetGlobalAlpha(float alpha) override;
 
@@ -74,6 +87,10 @@ class VkRenderer : public HWRenderer {
   void UpdateStencilFunc(HWStencilFunc func, uint32_t value,
                          uint32_t compare_mask) override;
 
+  void EnableScissorTest(Rect const& rect) override;
+
+  void DisableScissorTest() override;
+
   void DrawIndex(uint32_t start, uint32_t count) override;
 
   void BindTexture(HWTexture* texture, uint32_t slot) override;
@@ -89,12 +106,35 @@ class VkRenderer : public HWRenderer {
 
   void SubmitCMD(VkCommandBuffer cmd);
 
-  void WaitForFence();
-
-  void ResetFence();
-
-  VkFence PipelineFence() const { return vk_fence_; }
-  VkSampler PipelineSampler() const { return vk_sampler_; }
+  /**
+   * Command buffer collecting texture uploads of current frame. It is
+   * submitted before any other command of skity, at the latest when the
+   * canvas is flushed, and nothing waits for it on the render thread.
+   */
+  VkCommandBuffer ObtainUploadCMD();
+
+  /**
+   * Sub allocate staging memory from the ring of the frame owning the upload
+   * command buffer.
+   *
+   * @param size       bytes to upload
+   * @param alignment  required alignment of offset
+   * @param offset     receive offset of the range in returned buffer
+   */
+  AllocatedBuffer* ObtainStageBuffer(size_t size, size_t alignment,
+                                     size_t* offset);
+
+  void FlushUploadCMD();
+
+  /**
+   * Hand the image and view of a resized texture to current frame, they are
+   * freed once the gpu finished this frame instead of waiting for the queue
+   * to become idle.
+   */
+  void RetireImage(VKTexture* texture, AllocatedImage* image,
+                   VkImageView view);
+
+  VkSampler PipelineSampler(HWTexture::Filter filter) const;
 
   VkRenderPass OffScreenRenderPass() const { return os_render_pass_; }
   VkFormat OffScreenColorFormat() const { return os_color_format_; }
@@ -102,19 +142,15 @@ class VkRenderer : public HWRenderer {
   VKInterface* GetInterface() const { return vk_interface_; }
 
  private:
-  void InitCMDPool();
-  void InitFence();
   void InitSampler();
   void InitFrameBuffers();
+  void InitPipelineCache();
   void InitPipelines();
-  void InitVertexBuffer(size_t new_size);
-  void InitIndexBuffer(size_t new_size);
   void InitOffScreenRenderPass();
 
-  void DestroyCMDPool();
-  void DestroyFence();
   void DestroySampler();
   void DestroyPipelines();
+  void DestroyPipelineCache();
   void DestroyFrameBuffers();
 
   VkCommandBuffer GetCurrentCMD();
@@ -125,6 +161,12 @@ class VkRenderer : public HWRenderer {
   AbsPipelineWrapper* PickImagePipeline();
   AbsPipelineWrapper* PickBlurPipeline();
 
+  /**
+   * Hand the serialized pipeline cache to GPUVkContext if pipelines were
+   * created since it was last saved.
+   */
+  void SavePipelineCacheIfNeed();
+
   void BindPipelineIfNeed(AbsPipelineWrapper* pipeline);
 
   void UpdatePushConstantIfNeed(AbsPipelineWrapper* pipeline);
@@ -136,14 +178,31 @@ class VkRenderer : public HWRenderer {
 
   void ResetUniformDirty();
 
+  VkExtent2D CurrentExtent();
+
+  void SetScissorIfNeed(VkRect2D const& scissor);
+
+  /**
+   * @return frame data of current swapchain image, recycled first if the
+   *         renderer moves to this image
+   */
   SKVkFrameBufferData* CurrentFrameBuffer();
 
+  void BeginFrameIfNeed();
+
+  /**
+   * Start a new frame on frame data of index. The frame data is recycled
+   * without stalling, since the caller waited the previous frame using the
+   * same swapchain image before acquiring it again.
+   */
+  void RecycleFrame(uint32_t index);
+
  private:
   GPUVkContext* ctx_ = {};
   bool use_gs_ = {};
-  VkCommandPool vk_cmd_pool_ = {};
-  VkFence vk_fence_ = {};
   VkSampler vk_sampler_ = {};
+  VkSampler vk_nearest_sampler_ = {};
+  VkSampler vk_mipmap_sampler_ = {};
   HWPipelineColorMode color_mode_ = HWPipelineColorMode::kUniformColor;
   HWStencilFunc stencil_func_ = HWStencilFunc::ALWAYS;
   HWStencilOp stencil_op_ = HWStencilOp::KEEP;
@@ -152,10 +211,23 @@ class VkRenderer : public HWRenderer {
   uint8_t stencil_write_mask_ = 0xFF;
   uint8_t stencil_compare_mask_ = 0xFF;
   uint8_t stencil_value_ = 0;
+  // scissor set in current command buffer
+  VkRect2D scissor_ = {};
+  // scissor of root command buffer while drawing to render target
+  VkRect2D saved_scissor_ = {};
   std::unique_ptr<VKMemoryAllocator> vk_memory_allocator_ = {};
   std::vector<std::unique_ptr<SKVkFrameBufferData>> frame_buffer_ = {};
+  // swapchain image index of frame data in use
+  uint32_t frame_index_ = UINT32_MAX;
+  // set in UnBind, drawing into the same image again starts a new frame
+  bool frame_done_ = false;
+  // frame recording the pending upload command buffer
+  SKVkFrameBufferData* upload_frame_ = nullptr;
   // used to check if need to bind pipeline
   AbsPipelineWrapper* prev_pipeline_ = nullptr;
+  // shared by all pipelines, persisted through GPUVkContext
+  VkPipelineCache vk_pipeline_cache_ = VK_NULL_HANDLE;
+  size_t saved_pipeline_cache_size_ = 0;
 
   // color pipelines
   std::unique_ptr<PipelineFamily> color_pipeline_family_ = {};
@@ -174,8 +246,8 @@ class VkRenderer : public HWRenderer {
   VkRenderPass os_render_pass_ = {};
   VkFormat os_color_format_ = VK_FORMAT_R8G8B8A8_UNORM;
 
-  std::unique_ptr<AllocatedBuffer> vertex_buffer_ = {};
-  std::unique_ptr<AllocatedBuffer> index_buffer_ = {};
+  VkIndexType index_type_ = VK_INDEX_TYPE_UINT32;
+  bool compact_vertex_ = false;
   DirtyValueHolder<GlobalPushConst> global_push_const_ = {};
   DirtyValueHolder<glm::mat4> model_matrix_ = {};
   DirtyValueHolder<CommonFragmentSet> common_fragment_set_ = {};
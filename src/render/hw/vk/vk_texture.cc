@@ -1,5 +1,7 @@
 #include "src/render/hw/vk/vk_texture.hpp"
 
+#include <algorithm>
+
 #include "src/logging.hpp"
 #include "src/render/hw/vk/vk_memory.hpp"
 #include "src/render/hw/vk/vk_renderer.hpp"
@@ -93,12 +95,11 @@ void VKTexture::Resize(uint32_t width, uint32_t height) {
   height_ = height;
 
   if (need_create) {
-    if (image_) {
-      allocator_->FreeImage(image_.get());
-    }
-
-    if (vk_image_view_) {
-      VK_CALL(vkDestroyImageView, ctx_->GetDevice(), vk_image_view_, nullptr);
+    // uploads recorded for the old image and draws of this frame may still use
+    // it, the upload command buffer orders writes into the new image after
+    // them with its own barriers
+    if (image_ || vk_image_view_) {
+      renderer_->RetireImage(this, image_.release(), vk_image_view_);
       vk_image_view_ = VK_NULL_HANDLE;
     }
 
@@ -113,13 +114,20 @@ void VKTexture::UploadData(uint32_t offset_x, uint32_t offset_y, uint32_t width,
     LOG_WARN("VkTexture try upload zero buffer data");
     return;
   }
-  // step 1 upload data to stage buffer
-  std::unique_ptr<AllocatedBuffer> stage_buffer{
-      allocator_->AllocateStageBuffer(buffer_size)};
+  // step 1 upload data to the staging ring of current frame, buffer offset of
+  // copy must be a multiple of both texel size and 4
+  VkCommandBuffer cmd = renderer_->ObtainUploadCMD();
+  size_t stage_offset = 0;
+  AllocatedBuffer* stage_buffer =
+      renderer_->ObtainStageBuffer(buffer_size, bpp_ * 4, &stage_offset);
+
+  if (cmd == VK_NULL_HANDLE || stage_buffer == nullptr) {
+    LOG_ERROR("VkTexture failed to obtain stage buffer for upload");
+    return;
+  }
 
-  allocator_->UploadBuffer(stage_buffer.get(), data, buffer_size);
+  allocator_->UploadBuffer(stage_buffer, data, buffer_size, stage_offset);
 
-  VkCommandBuffer cmd = renderer_->ObtainInternalCMD();
   // step 2 set vk_image layout for
   if (image_->GetCurrentLayout() != VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
     allocator_->TransferImageLayout(cmd, image_.get(), range_,
@@ -128,7 +136,7 @@ void VKTexture::UploadData(uint32_t offset_x, uint32_t offset_y, uint32_t width,
   }
   // step 3 transfer image data from stage buffer to image buffer
   VkBufferImageCopy copy_region = {};
-  copy_region.bufferOffset = 0;
+  copy_region.bufferOffset = stage_offset;
   copy_region.bufferRowLength = 0;
   copy_region.bufferImageHeight = 0;
 
@@ -140,12 +148,91 @@ void VKTexture::UploadData(uint32_t offset_x, uint32_t offset_y, uint32_t width,
   copy_region.imageExtent = {width, height, 1};
 
   // copy the buffer into the image
-  allocator_->CopyBufferToImage(cmd, stage_buffer.get(), image_.get(),
-                                copy_region);
+  allocator_->CopyBufferToImage(cmd, stage_buffer, image_.get(), copy_region);
 
-  renderer_->SubmitCMD(cmd);
+  // step 4 leave image ready for sampling, the upload command buffer is
+  // submitted before any draw using it, so PrepareForDraw has nothing to
+  // submit. Mipmap textures are left to GenerateMipmaps
+  if ((flags_ & VK_IMAGE_USAGE_SAMPLED_BIT) && filter_ != Filter::kMipmap) {
+    allocator_->TransferImageLayout(cmd, image_.get(), range_,
+                                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  }
+}
 
-  allocator_->FreeBuffer(stage_buffer.get());
+void VKTexture::GenerateMipmaps() {
+  if (filter_ != Filter::kMipmap || image_ == nullptr ||
+      range_.levelCount <= 1) {
+    return;
+  }
+
+  VkCommandBuffer cmd = renderer_->ObtainUploadCMD();
+  if (cmd == VK_NULL_HANDLE) {
+    LOG_ERROR("VkTexture failed to obtain command buffer for mipmaps");
+    return;
+  }
+
+  // all levels are written by transfer, each level turns into the source of
+  // the next one once it is written
+  if (image_->GetCurrentLayout() != VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
+    allocator_->TransferImageLayout(cmd, image_.get(), range_,
+                                    image_->GetCurrentLayout(),
+                                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+  }
+
+  VkImageSubresourceRange level_range = range_;
+  level_range.levelCount = 1;
+
+  int32_t width = static_cast<int32_t>(width_);
+  int32_t height = static_cast<int32_t>(height_);
+
+  for (uint32_t level = 1; level < range_.levelCount; level++) {
+    level_range.baseMipLevel = level - 1;
+    VKUtils::SetImageLayout(GetInterface(), cmd, GetImage(),
+                            range_.aspectMask,
+                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, level_range,
+                            VK_PIPELINE_STAGE_TRANSFER_BIT,
+                            VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    VkImageBlit blit{};
+    blit.srcSubresource.aspectMask = range_.aspectMask;
+    blit.srcSubresource.mipLevel = level - 1;
+    blit.srcSubresource.baseArrayLayer = 0;
+    blit.srcSubresource.layerCount = 1;
+    blit.srcOffsets[1] = {width, height, 1};
+
+    width = std::max(width / 2, 1);
+    height = std::max(height / 2, 1);
+
+    blit.dstSubresource.aspectMask = range_.aspectMask;
+    blit.dstSubresource.mipLevel = level;
+    blit.dstSubresource.baseArrayLayer = 0;
+    blit.dstSubresource.layerCount = 1;
+    blit.dstOffsets[1] = {width, height, 1};
+
+    VK_CALL(vkCmdBlitImage, cmd, GetImage(),
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, GetImage(),
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+  }
+
+  // every level but the last one is a transfer source now
+  level_range.baseMipLevel = 0;
+  level_range.levelCount = range_.levelCount - 1;
+  VKUtils::SetImageLayout(GetInterface(), cmd, GetImage(), range_.aspectMask,
+                          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                          level_range);
+
+  level_range.baseMipLevel = range_.levelCount - 1;
+  level_range.levelCount = 1;
+  VKUtils::SetImageLayout(GetInterface(), cmd, GetImage(), range_.aspectMask,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                          level_range);
+
+  allocator_->TransferImageLayout(image_.get(),
+                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 }
 
 void VKTexture::PrepareForDraw() {
@@ -177,7 +264,9 @@ void VKTexture::ChangeImageLayoutWithoutSumbit(VkImageLayout target_layout) {
   allocator_->TransferImageLayout(image_.get(), target_layout);
 }
 
-VkSampler VKTexture::GetSampler() const { return renderer_->PipelineSampler(); }
+VkSampler VKTexture::GetSampler() const {
+  return renderer_->PipelineSampler(filter_);
+}
 
 VkImageLayout VKTexture::GetImageLayout() const {
   return image_->GetCurrentLayout();
@@ -193,8 +282,16 @@ void VKTexture::CreateBufferAndImage() {
     return;
   }
 
-  image_.reset(
-      allocator_->AllocateImage(format_, {width_, height_, 1}, flags_));
+  // mip levels are blitted from level 0
+  VkImageUsageFlags flags = flags_;
+  range_.levelCount = 1;
+  if (filter_ == Filter::kMipmap) {
+    flags |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    range_.levelCount = MipLevelCount(width_, height_);
+  }
+
+  image_.reset(allocator_->AllocateImage(format_, {width_, height_, 1}, flags,
+                                         range_.levelCount));
 
   // create image view
   if (!vk_image_view_) {
@@ -41,6 +41,8 @@ class VKTexture : public HWTexture, public VkInterfaceClient {
   void UploadData(uint32_t offset_x, uint32_t offset_y, uint32_t width,
                   uint32_t height, void* data) override;
 
+  void GenerateMipmaps() override;
+
   virtual void PrepareForDraw();
 
   void ChangeImageLayout(VkImageLayout target_layout);
@@ -288,12 +288,13 @@ VkSamplerCreateInfo VKUtils::SamplerCreateInfo() {
 
 VkImageCreateInfo VKUtils::ImageCreateInfo(VkFormat format,
                                            VkImageUsageFlags flags,
-                                           VkExtent3D extent) {
+                                           VkExtent3D extent,
+                                           uint32_t mip_levels) {
   VkImageCreateInfo create_info{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
 
   create_info.imageType = VK_IMAGE_TYPE_2D;
   create_info.extent = extent;
-  create_info.mipLevels = 1;
+  create_info.mipLevels = mip_levels;
   create_info.arrayLayers = 1;
   create_info.samples = VK_SAMPLE_COUNT_1_BIT;
   create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
@@ -365,6 +366,7 @@ void VKUtils::SetImageLayout(VKInterface *vk_interface, VkCommandBuffer cmd,
     case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
       // Image is a transfer destination
       // Make sure any writes to the image have been finished
+      image_memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
       break;
     case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
       // Image is read by a shader
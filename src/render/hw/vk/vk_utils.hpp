@@ -96,7 +96,8 @@ class VKUtils final {
 
   static VkImageCreateInfo ImageCreateInfo(VkFormat format,
                                            VkImageUsageFlags flags,
-                                           VkExtent3D extent);
+                                           VkExtent3D extent,
+                                           uint32_t mip_levels = 1);
 
   static VkImageViewCreateInfo ImageViewCreateInfo(
       VkFormat format, VkImage image, VkImageSubresourceRange const& range);
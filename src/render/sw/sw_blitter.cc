@@ -0,0 +1,350 @@
+#include "src/render/sw/sw_blitter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SW_BLIT_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(SW_BLIT_SSE2) && (defined(__GNUC__) || defined(__clang__)) && \
+    !defined(__EMSCRIPTEN__)
+// AVX2 kernels are compiled with target attribute and only used after runtime
+// check, so the library still runs on machines without AVX2
+#define SW_BLIT_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SW_BLIT_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace skity {
+
+using BlitSolidProc = void (*)(uint32_t* dst, uint32_t color, int32_t count);
+using BlitRowProc = void (*)(uint32_t* dst, uint32_t const* src,
+                             uint8_t coverage, int32_t count);
+
+struct BlitProcs {
+  const char* name;
+  // color is already scaled by coverage
+  BlitSolidProc solid;
+  BlitRowProc row;
+};
+
+// (x + 127.5) / 255 for x in [0, 255 * 255]
+static inline uint32_t div255(uint32_t x) {
+  x += 128;
+  return (x + (x >> 8)) >> 8;
+}
+
+// multiply each channel of pixel by scale / 255, two channels at a time
+static inline uint32_t scale_pixel(uint32_t c, uint32_t scale) {
+  uint32_t rb = (c & 0x00FF00FF) * scale + 0x00800080;
+  rb = ((rb + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+
+  uint32_t ag = ((c >> 8) & 0x00FF00FF) * scale + 0x00800080;
+  ag = (ag + ((ag >> 8) & 0x00FF00FF)) & 0xFF00FF00;
+
+  return rb | ag;
+}
+
+static inline uint32_t blend_pixel(uint32_t src, uint32_t dst) {
+  return src + scale_pixel(dst, 255 - (src >> 24));
+}
+
+static void blit_solid_portable(uint32_t* dst, uint32_t color, int32_t count) {
+  uint32_t inv_alpha = 255 - (color >> 24);
+
+  for (int32_t i = 0; i < count; i++) {
+    dst[i] = color + scale_pixel(dst[i], inv_alpha);
+  }
+}
+
+static void blit_row_portable(uint32_t* dst, uint32_t const* src,
+                              uint8_t coverage, int32_t count) {
+  for (int32_t i = 0; i < count; i++) {
+    uint32_t s = coverage == 255 ? src[i] : scale_pixel(src[i], coverage);
+    dst[i] = blend_pixel(s, dst[i]);
+  }
+}
+
+#ifdef SW_BLIT_SSE2
+
+// rounding x / 255 in each 16 bits lane
+static inline __m128i div255_sse2(__m128i x) {
+  x = _mm_add_epi16(x, _mm_set1_epi16(128));
+  return _mm_mulhi_epu16(x, _mm_set1_epi16(257));
+}
+
+// multiply 4 pixels by scale / 255, scale_lo and scale_hi are 16 bits lanes
+// for pixel [0, 1] and [2, 3]
+static inline __m128i scale_sse2(__m128i px, __m128i scale_lo,
+                                 __m128i scale_hi) {
+  __m128i zero = _mm_setzero_si128();
+  __m128i lo = _mm_unpacklo_epi8(px, zero);
+  __m128i hi = _mm_unpackhi_epi8(px, zero);
+
+  lo = div255_sse2(_mm_mullo_epi16(lo, scale_lo));
+  hi = div255_sse2(_mm_mullo_epi16(hi, scale_hi));
+
+  return _mm_packus_epi16(lo, hi);
+}
+
+// broadcast alpha of each pixel to its 4 channels, returns 255 - alpha
+static inline __m128i inv_alpha_sse2(__m128i px16) {
+  __m128i alpha = _mm_shufflelo_epi16(px16, _MM_SHUFFLE(3, 3, 3, 3));
+  alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+  return _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+}
+
+static void blit_solid_sse2(uint32_t* dst, uint32_t color, int32_t count) {
+  __m128i src = _mm_set1_epi32(static_cast<int32_t>(color));
+  __m128i inv_alpha = _mm_set1_epi16(static_cast<int16_t>(255 - (color >> 24)));
+
+  for (; count >= 4; count -= 4, dst += 4) {
+    __m128i d = _mm_loadu_si128(reinterpret_cast<__m128i*>(dst));
+    d = scale_sse2(d, inv_alpha, inv_alpha);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_adds_epu8(src, d));
+  }
+
+  blit_solid_portable(dst, color, count);
+}
+
+static void blit_row_sse2(uint32_t* dst, uint32_t const* src, uint8_t coverage,
+                          int32_t count) {
+  __m128i zero = _mm_setzero_si128();
+  __m128i cover = _mm_set1_epi16(coverage);
+  __m128i alpha_mask = _mm_set1_epi32(static_cast<int32_t>(0xFF000000));
+
+  for (; count >= 4; count -= 4, dst += 4, src += 4) {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src));
+
+    if (coverage != 255) {
+      s = scale_sse2(s, cover, cover);
+    } else if (_mm_movemask_epi8(_mm_cmpeq_epi8(
+                   _mm_and_si128(s, alpha_mask), alpha_mask)) == 0xFFFF) {
+      // all source pixels are opaque
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), s);
+      continue;
+    }
+
+    __m128i inv_lo = inv_alpha_sse2(_mm_unpacklo_epi8(s, zero));
+    __m128i inv_hi = inv_alpha_sse2(_mm_unpackhi_epi8(s, zero));
+
+    __m128i d = _mm_loadu_si128(reinterpret_cast<__m128i*>(dst));
+    d = scale_sse2(d, inv_lo, inv_hi);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_adds_epu8(s, d));
+  }
+
+  blit_row_portable(dst, src, coverage, count);
+}
+
+#endif  // SW_BLIT_SSE2
+
+#ifdef SW_BLIT_AVX2
+
+#define SW_AVX2_TARGET __attribute__((target("avx2")))
+
+SW_AVX2_TARGET static inline __m256i div255_avx2(__m256i x) {
+  x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+  return _mm256_mulhi_epu16(x, _mm256_set1_epi16(257));
+}
+
+// unpack and pack both work inside 128 bits lanes, so pixel order is kept
+SW_AVX2_TARGET static inline __m256i scale_avx2(__m256i px, __m256i scale_lo,
+                                                __m256i scale_hi) {
+  __m256i zero = _mm256_setzero_si256();
+  __m256i lo = _mm256_unpacklo_epi8(px, zero);
+  __m256i hi = _mm256_unpackhi_epi8(px, zero);
+
+  lo = div255_avx2(_mm256_mullo_epi16(lo, scale_lo));
+  hi = div255_avx2(_mm256_mullo_epi16(hi, scale_hi));
+
+  return _mm256_packus_epi16(lo, hi);
+}
+
+SW_AVX2_TARGET static inline __m256i inv_alpha_avx2(__m256i px16) {
+  __m256i alpha = _mm256_shufflelo_epi16(px16, _MM_SHUFFLE(3, 3, 3, 3));
+  alpha = _mm256_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+  return _mm256_sub_epi16(_mm256_set1_epi16(255), alpha);
+}
+
+SW_AVX2_TARGET static void blit_solid_avx2(uint32_t* dst, uint32_t color,
+                                           int32_t count) {
+  __m256i src = _mm256_set1_epi32(static_cast<int32_t>(color));
+  __m256i inv_alpha =
+      _mm256_set1_epi16(static_cast<int16_t>(255 - (color >> 24)));
+
+  for (; count >= 8; count -= 8, dst += 8) {
+    __m256i d = _mm256_loadu_si256(reinterpret_cast<__m256i*>(dst));
+    d = scale_avx2(d, inv_alpha, inv_alpha);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),
+                        _mm256_adds_epu8(src, d));
+  }
+
+  blit_solid_sse2(dst, color, count);
+}
+
+SW_AVX2_TARGET static void blit_row_avx2(uint32_t* dst, uint32_t const* src,
+                                         uint8_t coverage, int32_t count) {
+  __m256i zero = _mm256_setzero_si256();
+  __m256i cover = _mm256_set1_epi16(coverage);
+  __m256i alpha_mask = _mm256_set1_epi32(static_cast<int32_t>(0xFF000000));
+
+  for (; count >= 8; count -= 8, dst += 8, src += 8) {
+    __m256i s = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src));
+
+    if (coverage != 255) {
+      s = scale_avx2(s, cover, cover);
+    } else if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                   _mm256_and_si256(s, alpha_mask), alpha_mask)) == -1) {
+      // all source pixels are opaque
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), s);
+      continue;
+    }
+
+    __m256i inv_lo = inv_alpha_avx2(_mm256_unpacklo_epi8(s, zero));
+    __m256i inv_hi = inv_alpha_avx2(_mm256_unpackhi_epi8(s, zero));
+
+    __m256i d = _mm256_loadu_si256(reinterpret_cast<__m256i*>(dst));
+    d = scale_avx2(d, inv_lo, inv_hi);
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),
+                        _mm256_adds_epu8(s, d));
+  }
+
+  blit_row_sse2(dst, src, coverage, count);
+}
+
+#undef SW_AVX2_TARGET
+
+#endif  // SW_BLIT_AVX2
+
+#ifdef SW_BLIT_NEON
+
+// rounding x / 255 and narrow to 8 bits
+static inline uint8x8_t div255_neon(uint16x8_t x) {
+  return vraddhn_u16(x, vrshrq_n_u16(x, 8));
+}
+
+static void blit_solid_neon(uint32_t* dst, uint32_t color, int32_t count) {
+  uint8x8_t inv_alpha = vdup_n_u8(static_cast<uint8_t>(255 - (color >> 24)));
+  uint8x8_t src[4];
+  for (int32_t i = 0; i < 4; i++) {
+    src[i] = vdup_n_u8(static_cast<uint8_t>(color >> (i * 8)));
+  }
+
+  for (; count >= 8; count -= 8, dst += 8) {
+    // load 8 pixels with channels deinterleaved
+    uint8x8x4_t d = vld4_u8(reinterpret_cast<uint8_t*>(dst));
+    for (int32_t i = 0; i < 4; i++) {
+      d.val[i] = vqadd_u8(src[i], div255_neon(vmull_u8(d.val[i], inv_alpha)));
+    }
+    vst4_u8(reinterpret_cast<uint8_t*>(dst), d);
+  }
+
+  blit_solid_portable(dst, color, count);
+}
+
+static void blit_row_neon(uint32_t* dst, uint32_t const* src, uint8_t coverage,
+                          int32_t count) {
+  uint8x8_t cover = vdup_n_u8(coverage);
+
+  for (; count >= 8; count -= 8, dst += 8, src += 8) {
+    uint8x8x4_t s = vld4_u8(reinterpret_cast<uint8_t const*>(src));
+    if (coverage != 255) {
+      for (int32_t i = 0; i < 4; i++) {
+        s.val[i] = div255_neon(vmull_u8(s.val[i], cover));
+      }
+    }
+
+    // alpha is the highest byte of each pixel
+    uint8x8_t inv_alpha = vmvn_u8(s.val[3]);
+
+    uint8x8x4_t d = vld4_u8(reinterpret_cast<uint8_t*>(dst));
+    for (int32_t i = 0; i < 4; i++) {
+      d.val[i] = vqadd_u8(s.val[i], div255_neon(vmull_u8(d.val[i], inv_alpha)));
+    }
+    vst4_u8(reinterpret_cast<uint8_t*>(dst), d);
+  }
+
+  blit_row_portable(dst, src, coverage, count);
+}
+
+#endif  // SW_BLIT_NEON
+
+static BlitProcs ChooseBlitProcs() {
+#ifdef SW_BLIT_AVX2
+  if (__builtin_cpu_supports("avx2")) {
+    return BlitProcs{"AVX2", blit_solid_avx2, blit_row_avx2};
+  }
+#endif
+
+#if defined(SW_BLIT_SSE2)
+  return BlitProcs{"SSE2", blit_solid_sse2, blit_row_sse2};
+#elif defined(SW_BLIT_NEON)
+  return BlitProcs{"NEON", blit_solid_neon, blit_row_neon};
+#else
+  return BlitProcs{"Portable", blit_solid_portable, blit_row_portable};
+#endif
+}
+
+static BlitProcs const& GetBlitProcs() {
+  static const BlitProcs procs = ChooseBlitProcs();
+  return procs;
+}
+
+void SWBlitter::BlitSolid(uint32_t* dst, uint32_t color, uint8_t coverage,
+                          int32_t count) {
+  if (count <= 0 || coverage == 0) {
+    return;
+  }
+
+  if (coverage != 255) {
+    color = scale_pixel(color, coverage);
+  }
+
+  uint32_t alpha = color >> 24;
+  if (alpha == 255) {
+    // opaque, no need to read dst
+    std::fill_n(dst, count, color);
+    return;
+  }
+
+  if (color == 0) {
+    return;
+  }
+
+  GetBlitProcs().solid(dst, color, count);
+}
+
+void SWBlitter::BlitRow(uint32_t* dst, uint32_t const* src, uint8_t coverage,
+                        int32_t count) {
+  if (count <= 0 || coverage == 0) {
+    return;
+  }
+
+  GetBlitProcs().row(dst, src, coverage, count);
+}
+
+const char* SWBlitter::ISAName() { return GetBlitProcs().name; }
+
+uint32_t SWBlitter::PremulColor(Color4f const& color) {
+  float a = glm::clamp(color.a, 0.f, 1.f);
+  float r = glm::clamp(color.r, 0.f, 1.f) * a;
+  float g = glm::clamp(color.g, 0.f, 1.f) * a;
+  float b = glm::clamp(color.b, 0.f, 1.f) * a;
+
+  return ColorSetARGB(static_cast<uint8_t>(std::round(a * 255.f)),
+                      static_cast<uint8_t>(std::round(r * 255.f)),
+                      static_cast<uint8_t>(std::round(g * 255.f)),
+                      static_cast<uint8_t>(std::round(b * 255.f)));
+}
+
+}  // namespace skity
@@ -0,0 +1,56 @@
+#ifndef SKITY_SRC_RENDER_SW_SW_BLITTER_HPP
+#define SKITY_SRC_RENDER_SW_SW_BLITTER_HPP
+
+#include <cstdint>
+#include <skity/graphic/color.hpp>
+
+namespace skity {
+
+/**
+ * Row oriented pixel blending for software backend.
+ *
+ * All colors are premultiplied 32 bits pixels in the same layout as Bitmap
+ * ( ColorSetARGB ). Blending is SrcOver: dst = src + dst * (1 - src_alpha).
+ * Kernels are selected at runtime from the widest instruction set available:
+ * AVX2 or SSE2 on x86, NEON on arm, and a portable fallback otherwise.
+ */
+class SWBlitter final {
+ public:
+  SWBlitter() = delete;
+
+  /**
+   * Blend a single color into count pixels.
+   *
+   * @param dst       first pixel of the row
+   * @param color     premultiplied source color
+   * @param coverage  [0, 255] coverage applied to source color
+   * @param count     pixel count
+   */
+  static void BlitSolid(uint32_t* dst, uint32_t color, uint8_t coverage,
+                        int32_t count);
+
+  /**
+   * Blend a row of colors into count pixels.
+   *
+   * @param dst       first pixel of the row
+   * @param src       premultiplied source colors, count pixels
+   * @param coverage  [0, 255] coverage applied to all source colors
+   * @param count     pixel count
+   */
+  static void BlitRow(uint32_t* dst, uint32_t const* src, uint8_t coverage,
+                      int32_t count);
+
+  /**
+   * @return name of the instruction set used by current kernels
+   */
+  static const char* ISAName();
+
+  /**
+   * Convert unpremultiplied float color into premultiplied 32 bits pixel
+   */
+  static uint32_t PremulColor(Color4f const& color);
+};
+
+}  // namespace skity
+
+#endif  // SKITY_SRC_RENDER_SW_SW_BLITTER_HPP
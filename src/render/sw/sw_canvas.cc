@@ -1,12 +1,24 @@
 #include "src/render/sw/sw_canvas.hpp"
 
+#include <algorithm>
+#include <limits>
+#include <skity/effect/path_effect.hpp>
+#include <skity/effect/shader.hpp>
 #include <skity/graphic/bitmap.hpp>
+#include <skity/text/text_blob.hpp>
+#include <skity/text/typeface.hpp>
 
-#include "src/render/sw/sw_raster.hpp"
+#include "src/geometry/geometry.hpp"
+#include "src/geometry/math.hpp"
 #include "src/render/sw/sw_span_brush.hpp"
+#include "src/render/sw/sw_stroke.hpp"
+#include "src/render/sw/sw_task_pool.hpp"
 
 namespace skity {
 
+// draws are binned into square tiles, each tile is brushed by one thread
+static constexpr int32_t SW_TILE_SIZE = 256;
+
 std::unique_ptr<Canvas> Canvas::MakeSoftwareCanvas(Bitmap* bitmap) {
   if (bitmap == nullptr) {
     return {};
@@ -21,47 +33,214 @@ std::unique_ptr<Canvas> Canvas::MakeSoftwareCanvas(Bitmap* bitmap) {
 
 SWCanvas::SWCanvas(Bitmap* bitmap) : Canvas(), bitmap_(bitmap) {}
 
+SWCanvas::~SWCanvas() {
+  // make sure nothing recorded is lost
+  onFlush();
+}
+
 void SWCanvas::onDrawLine(float x0, float y0, float x1, float y1,
-                          Paint const& paint) {}
+                          Paint const& paint) {
+  Paint work_paint{paint};
+  work_paint.setStyle(Paint::kStroke_Style);
+
+  Path path;
+  path.moveTo(x0, y0);
+  path.lineTo(x1, y1);
+
+  onDrawPath(path, work_paint);
+}
+
+void SWCanvas::onClipPath(const Path& path, ClipOp op) {
+  raster_.RastePath(path.copyWithMatrix(state_.CurrentMatrix()));
+
+  int32_t width = static_cast<int32_t>(bitmap_->width());
+  int32_t height = static_cast<int32_t>(bitmap_->height());
+
+  auto prev_mask = state_.CurrentClipMask();
+  auto mask = std::make_shared<SWClipMask>();
+
+  if (op == ClipOp::kDifference) {
+    if (prev_mask) {
+      *mask = *prev_mask;
+    } else {
+      mask->assign(width * height, 255);
+    }
+  } else {
+    mask->assign(width * height, 0);
+  }
+
+  for (auto const& span : raster_.CurrentSpans()) {
+    if (span.y < 0 || span.y >= height) {
+      continue;
+    }
 
-void SWCanvas::onClipPath(const Path& path, ClipOp op) {}
+    int32_t left = std::max(span.x, 0);
+    int32_t right = std::min(span.x + span.len, width);
+    uint8_t* row = mask->data() + span.y * width;
+
+    for (int32_t x = left; x < right; x++) {
+      if (op == ClipOp::kDifference) {
+        row[x] = row[x] * (255 - span.cover) / 255;
+      } else if (prev_mask) {
+        row[x] = (*prev_mask)[span.y * width + x] * span.cover / 255;
+      } else {
+        row[x] = span.cover;
+      }
+    }
+  }
+
+  state_.SetClipMask(std::move(mask));
+}
 
 void SWCanvas::onDrawPath(const Path& path, const Paint& paint) {
   bool need_fill = paint.getStyle() != Paint::kStroke_Style;
   bool need_stroke = paint.getStyle() != Paint::kFill_Style;
 
+  if (FloatNearlyZero(paint.getAlphaF())) {
+    return;
+  }
+
+  Paint working_paint{paint};
+
   // Fill first
   if (need_fill) {
-    SWRaster raster;
+    working_paint.setStyle(Paint::kFill_Style);
 
-    raster.RastePath(path);
+    Path dst;
+    if (paint.getPathEffect() &&
+        paint.getPathEffect()->filterPath(&dst, path, false, working_paint)) {
+      RecordDraw(dst, working_paint, false);
+    } else {
+      RecordDraw(path, working_paint, false);
+    }
+  }
 
-    auto brush = GenerateBrush(raster.CurrentSpans(), paint, false);
+  if (need_stroke) {
+    working_paint.setStyle(Paint::kStroke_Style);
 
-    brush->Brush();
+    Path dst;
+    if (paint.getPathEffect() &&
+        paint.getPathEffect()->filterPath(&dst, path, true, working_paint)) {
+      RecordDraw(dst, working_paint, true);
+    } else {
+      RecordDraw(path, working_paint, true);
+    }
   }
 }
 
 void SWCanvas::onDrawBlob(const TextBlob* blob, float x, float y,
-                          Paint const& paint) {}
+                          Paint const& paint) {
+  Path text_path;
+
+  float offset_x = x;
+  for (auto const& run : blob->getTextRun()) {
+    auto typeface = run.lockTypeface();
 
-void SWCanvas::onSave() {}
+    if (typeface == nullptr) {
+      continue;
+    }
 
-void SWCanvas::onRestore() {}
+    for (auto const& info : run.getGlyphInfo()) {
+      if (info.path.isEmpty() || info.path_font_size != paint.getTextSize()) {
+        // Solve reused TextBlob without path info
+        text_path.addPath(
+            typeface->getGlyphInfo(info.id, paint.getTextSize(), true).path,
+            offset_x, y);
+      } else {
+        text_path.addPath(info.path, offset_x, y);
+      }
 
-void SWCanvas::onRestoreToCount(int saveCount) {}
+      offset_x += info.advance_x;
+    }
+  }
 
-void SWCanvas::onTranslate(float dx, float dy) {}
+  // path effect is not applied to text, same as hw backend
+  Paint working_paint{paint};
+  working_paint.setPathEffect(nullptr);
 
-void SWCanvas::onScale(float sx, float sy) {}
+  onDrawPath(text_path, working_paint);
+}
 
-void SWCanvas::onRotate(float degree) {}
+void SWCanvas::onSave() { state_.Save(); }
 
-void SWCanvas::onRotate(float degree, float px, float py) {}
+void SWCanvas::onRestore() { state_.Restore(); }
 
-void SWCanvas::onConcat(const Matrix& matrix) {}
+void SWCanvas::onRestoreToCount(int saveCount) {
+  state_.RestoreToCount(saveCount + 1);
+}
 
-void SWCanvas::onFlush() {}
+void SWCanvas::onTranslate(float dx, float dy) { state_.Translate(dx, dy); }
+
+void SWCanvas::onScale(float sx, float sy) { state_.Scale(sx, sy); }
+
+void SWCanvas::onRotate(float degree) { state_.Rotate(degree); }
+
+void SWCanvas::onRotate(float degree, float px, float py) {
+  state_.Rotate(degree, px, py);
+}
+
+void SWCanvas::onConcat(const Matrix& matrix) { state_.Concat(matrix); }
+
+void SWCanvas::onFlush() {
+  if (commands_.empty()) {
+    return;
+  }
+
+  SWTaskPool* pool = SWTaskPool::GetDefault();
+
+  if (flush_rasters_.size() < pool->SlotCount()) {
+    flush_rasters_.resize(pool->SlotCount());
+  }
+
+  // step 1 raster all commands in parallel
+  pool->ParallelFor(commands_.size(), [this](size_t task, size_t slot) {
+    RasterCommand(&commands_[task], &flush_rasters_[slot]);
+  });
+
+  // step 2 bin commands into tiles they touch
+  int32_t width = static_cast<int32_t>(bitmap_->width());
+  int32_t height = static_cast<int32_t>(bitmap_->height());
+
+  tile_count_x_ = (width + SW_TILE_SIZE - 1) / SW_TILE_SIZE;
+  int32_t tile_count_y = (height + SW_TILE_SIZE - 1) / SW_TILE_SIZE;
+
+  tile_bins_.resize(tile_count_x_ * tile_count_y);
+  for (auto& bin : tile_bins_) {
+    bin.clear();
+  }
+
+  for (size_t i = 0; i < commands_.size(); i++) {
+    auto const& command = commands_[i];
+
+    if (command.spans.empty()) {
+      continue;
+    }
+
+    for (int32_t ty = command.top / SW_TILE_SIZE;
+         ty <= (command.bottom - 1) / SW_TILE_SIZE; ty++) {
+      for (int32_t tx = command.left / SW_TILE_SIZE;
+           tx <= (command.right - 1) / SW_TILE_SIZE; tx++) {
+        tile_bins_[ty * tile_count_x_ + tx].emplace_back(i);
+      }
+    }
+  }
+
+  active_tiles_.clear();
+  for (size_t i = 0; i < tile_bins_.size(); i++) {
+    if (!tile_bins_[i].empty()) {
+      active_tiles_.emplace_back(i);
+    }
+  }
+
+  // step 3 brush tiles in parallel, every pixel belongs to exactly one tile
+  // and commands in a tile keep record order, so result is the same as
+  // drawing one by one
+  pool->ParallelFor(active_tiles_.size(), [this](size_t task, size_t slot) {
+    BrushTile(active_tiles_[task]);
+  });
+
+  commands_.clear();
+}
 
 uint32_t SWCanvas::onGetWidth() const { return bitmap_->width(); }
 
@@ -69,13 +248,159 @@ uint32_t SWCanvas::onGetHeight() const { return bitmap_->height(); }
 
 void SWCanvas::onUpdateViewport(uint32_t width, uint32_t height) {}
 
+void SWCanvas::RecordDraw(Path const& path, Paint const& paint,
+                          bool stroke) {
+  if (path.isEmpty()) {
+    return;
+  }
+
+  DrawCommand command;
+  command.path = path;
+  command.paint = paint;
+  command.matrix = state_.CurrentMatrix();
+  command.clip_mask = state_.CurrentClipMask();
+  command.stroke = stroke;
+
+  commands_.emplace_back(std::move(command));
+}
+
+void SWCanvas::RasterCommand(DrawCommand* command, SWRaster* raster) {
+  if (command->stroke) {
+    Path outline;
+    SWStroke stroke{command->paint, CalculateTolerance(command->matrix)};
+    stroke.StrokePath(command->path, &outline);
+
+    // handle hairline
+    float stroke_width = command->paint.getStrokeWidth();
+    if (stroke_width < 0.5f) {
+      command->paint.setAlphaF(stroke_width / 0.5f *
+                               command->paint.getAlphaF());
+    }
+
+    command->path = std::move(outline);
+  }
+
+  command->bounds = command->path.getBounds();
+
+  raster->RastePath(command->path.copyWithMatrix(command->matrix));
+
+  ApplyClip(raster->CurrentSpans(), command->clip_mask.get(),
+            &command->spans);
+
+  if (command->spans.empty()) {
+    return;
+  }
+
+  // spans are sorted by row
+  command->top = command->spans.front().y;
+  command->bottom = command->spans.back().y + 1;
+  command->left = std::numeric_limits<int32_t>::max();
+  command->right = std::numeric_limits<int32_t>::min();
+
+  for (auto const& span : command->spans) {
+    command->left = std::min(command->left, span.x);
+    command->right = std::max(command->right, span.x + span.len);
+  }
+}
+
+void SWCanvas::BrushTile(size_t tile) {
+  int32_t left = static_cast<int32_t>(tile % tile_count_x_) * SW_TILE_SIZE;
+  int32_t top = static_cast<int32_t>(tile / tile_count_x_) * SW_TILE_SIZE;
+
+  for (auto index : tile_bins_[tile]) {
+    auto const& command = commands_[index];
+
+    auto brush = GenerateBrush(command.spans, command.paint, command.stroke,
+                               command.bounds, command.matrix);
+
+    brush->Brush(left, top, left + SW_TILE_SIZE, top + SW_TILE_SIZE);
+  }
+}
+
+void SWCanvas::ApplyClip(std::vector<Span> const& spans,
+                         SWClipMask const* mask, std::vector<Span>* result) {
+  int32_t width = static_cast<int32_t>(bitmap_->width());
+  int32_t height = static_cast<int32_t>(bitmap_->height());
+
+  result->clear();
+
+  for (auto const& span : spans) {
+    if (span.y < 0 || span.y >= height) {
+      continue;
+    }
+
+    int32_t left = std::max(span.x, 0);
+    int32_t right = std::min(span.x + span.len, width);
+
+    if (right <= left) {
+      continue;
+    }
+
+    if (mask == nullptr) {
+      result->emplace_back(Span{left, span.y, right - left, span.cover});
+      continue;
+    }
+
+    const uint8_t* row = mask->data() + span.y * width;
+
+    // split span into runs with the same clip coverage
+    int32_t x = left;
+    while (x < right) {
+      int32_t start = x;
+      uint8_t value = row[x];
+
+      while (x < right && row[x] == value) {
+        x++;
+      }
+
+      int32_t cover = span.cover * value / 255;
+      if (cover == 0) {
+        continue;
+      }
+
+      result->emplace_back(Span{start, span.y, x - start, cover});
+    }
+  }
+}
+
+float SWCanvas::CalculateTolerance(Matrix const& matrix) {
+  float scale = MatrixMaxScale(matrix);
+
+  if (FloatNearlyZero(scale)) {
+    return 0.25f;
+  }
+
+  return 0.25f / scale;
+}
+
 std::unique_ptr<SWSpanBrush> SWCanvas::GenerateBrush(
-    std::vector<Span> const& spans, skity::Paint const& paint, bool stroke) {
-  // TODO handle gradient and image
+    std::vector<Span> const& spans, skity::Paint const& paint, bool stroke,
+    Rect const& bounds, Matrix const& matrix) {
+  auto shader = paint.getShader();
+
+  if (shader) {
+    auto pixmap = shader->asImage();
+    Shader::GradientInfo gradient_info{};
+    Shader::GradientType gradient_type = shader->asGradient(&gradient_info);
+
+    if (gradient_type == Shader::kLinear) {
+      return std::make_unique<LinearGradientBrush>(
+          spans, bitmap_, gradient_info, matrix, paint.getAlphaF());
+    } else if (gradient_type == Shader::kRadial) {
+      return std::make_unique<RadialGradientBrush>(
+          spans, bitmap_, gradient_info, matrix, paint.getAlphaF());
+    } else if (pixmap) {
+      return std::make_unique<PixmapBrush>(spans, bitmap_, pixmap,
+                                           shader->GetSamplingMode(), bounds,
+                                           matrix, paint.getAlphaF());
+    }
+    // unsupport shader type, fallback to paint color
+  }
 
   Color4f color = stroke ? paint.getStrokeColor() : paint.getFillColor();
+  color.a *= paint.getAlphaF();
 
   return std::make_unique<SolidColorBrush>(spans, bitmap_, color);
 }
 
-}  // namespace skity
\ No newline at end of file
+}  // namespace skity
@@ -4,6 +4,8 @@
 #include <skity/config.hpp>
 #include <skity/render/canvas.hpp>
 
+#include "src/render/sw/sw_canvas_state.hpp"
+#include "src/render/sw/sw_raster.hpp"
 #include "src/render/sw/sw_subpixel.hpp"
 
 #ifndef SKITY_CPU
@@ -19,7 +21,7 @@ class SWSpanBrush;
 class SWCanvas : public Canvas {
  public:
   SWCanvas(Bitmap* bitmap);
-  ~SWCanvas() override = default;
+  ~SWCanvas() override;
 
  protected:
   void onDrawLine(float x0, float y0, float x1, float y1,
@@ -57,12 +59,64 @@ class SWCanvas : public Canvas {
   void onUpdateViewport(uint32_t width, uint32_t height) override;
 
  private:
+  /**
+   * Draw recorded by canvas, executed in onFlush.
+   */
+  struct DrawCommand {
+    // path in local space, path effect is already applied
+    Path path = {};
+    Paint paint = {};
+    Matrix matrix = {};
+    std::shared_ptr<SWClipMask> clip_mask = {};
+    bool stroke = false;
+
+    // generated when flush
+    // bounds of path in local space, used to map image shader
+    Rect bounds = {};
+    std::vector<Span> spans = {};
+    // [left, right) x [top, bottom) device pixels touched by spans
+    int32_t left = 0;
+    int32_t top = 0;
+    int32_t right = 0;
+    int32_t bottom = 0;
+  };
+
+  void RecordDraw(Path const& path, Paint const& paint, bool stroke);
+
+  /**
+   * Stroke if needed, raster and clip the command into its spans, can be
+   * called from any thread.
+   */
+  void RasterCommand(DrawCommand* command, SWRaster* raster);
+
+  /**
+   * Brush all commands binned into tile, in record order.
+   */
+  void BrushTile(size_t tile);
+
+  void ApplyClip(std::vector<Span> const& spans, SWClipMask const* mask,
+                 std::vector<Span>* result);
+
+  // max flatten error in local space, which is 1/4 pixel in device space
+  static float CalculateTolerance(Matrix const& matrix);
+
   std::unique_ptr<SWSpanBrush> GenerateBrush(std::vector<Span> const& spans,
                                              skity::Paint const& paint,
-                                             bool stroke);
+                                             bool stroke, Rect const& bounds,
+                                             Matrix const& matrix);
 
  private:
   Bitmap* bitmap_;
+  SWCanvasState state_ = {};
+  // used by clip path
+  SWRaster raster_ = {};
+  std::vector<DrawCommand> commands_ = {};
+  // one raster for each thread in task pool
+  std::vector<SWRaster> flush_rasters_ = {};
+  // command index of each tile
+  std::vector<std::vector<uint32_t>> tile_bins_ = {};
+  std::vector<size_t> active_tiles_ = {};
+  int32_t tile_count_x_ = 0;
 };
 
 }  // namespace skity
@@ -0,0 +1,73 @@
+#include "src/render/sw/sw_canvas_state.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace skity {
+
+SWCanvasState::SWCanvasState() {
+  // init first stack state
+  state_stack_.emplace_back(State{glm::identity<Matrix>(), nullptr});
+}
+
+void SWCanvasState::Save() { state_stack_.emplace_back(state_stack_.back()); }
+
+void SWCanvasState::Restore() {
+  if (state_stack_.size() > 1) {
+    state_stack_.pop_back();
+  }
+}
+
+void SWCanvasState::RestoreToCount(int save_count) {
+  if (save_count < 1 ||
+      static_cast<size_t>(save_count) >= state_stack_.size()) {
+    return;
+  }
+
+  state_stack_.erase(state_stack_.begin() + save_count, state_stack_.end());
+}
+
+void SWCanvasState::Translate(float dx, float dy) {
+  Matrix translate = glm::translate(glm::identity<Matrix>(), {dx, dy, 0.f});
+
+  state_stack_.back().matrix = CurrentMatrix() * translate;
+}
+
+void SWCanvasState::Scale(float dx, float dy) {
+  Matrix scale = glm::scale(glm::identity<Matrix>(), {dx, dy, 1.f});
+
+  state_stack_.back().matrix = CurrentMatrix() * scale;
+}
+
+void SWCanvasState::Rotate(float degree) {
+  Matrix rotate = glm::rotate(glm::identity<Matrix>(), glm::radians(degree),
+                              {0.f, 0.f, 1.f});
+
+  state_stack_.back().matrix = CurrentMatrix() * rotate;
+}
+
+void SWCanvasState::Rotate(float degree, float px, float py) {
+  Matrix rotate = glm::rotate(glm::identity<Matrix>(), glm::radians(degree),
+                              {0.f, 0.f, 1.f});
+  Matrix pre = glm::translate(glm::identity<Matrix>(), {-px, -py, 0.f});
+  Matrix post = glm::translate(glm::identity<Matrix>(), {px, py, 0.f});
+
+  state_stack_.back().matrix = CurrentMatrix() * post * rotate * pre;
+}
+
+void SWCanvasState::Concat(const Matrix& matrix) {
+  state_stack_.back().matrix = CurrentMatrix() * matrix;
+}
+
+Matrix SWCanvasState::CurrentMatrix() const {
+  return state_stack_.back().matrix;
+}
+
+std::shared_ptr<SWClipMask> SWCanvasState::CurrentClipMask() const {
+  return state_stack_.back().clip_mask;
+}
+
+void SWCanvasState::SetClipMask(std::shared_ptr<SWClipMask> clip_mask) {
+  state_stack_.back().clip_mask = std::move(clip_mask);
+}
+
+}  // namespace skity
@@ -0,0 +1,54 @@
+#ifndef SKITY_SRC_RENDER_SW_SW_CANVAS_STATE_HPP
+#define SKITY_SRC_RENDER_SW_SW_CANVAS_STATE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <skity/geometry/point.hpp>
+#include <vector>
+
+namespace skity {
+
+/**
+ * Per pixel coverage of current clip, one byte for each pixel in bitmap.
+ */
+using SWClipMask = std::vector<uint8_t>;
+
+class SWCanvasState {
+  struct State {
+    Matrix matrix = {};
+    // nullptr means no clip, mask is shared with previous state until a new
+    // clip is applied
+    std::shared_ptr<SWClipMask> clip_mask = {};
+  };
+
+ public:
+  SWCanvasState();
+  ~SWCanvasState() = default;
+
+  void Save();
+  void Restore();
+  void RestoreToCount(int save_count);
+  void Translate(float dx, float dy);
+  void Scale(float dx, float dy);
+  void Rotate(float degree);
+  void Rotate(float degree, float px, float py);
+  void Concat(Matrix const& matrix);
+
+  Matrix CurrentMatrix() const;
+
+  /**
+   * @return clip mask of current state, nullptr if nothing is clipped. Mask
+   *         is never modified after set, it is safe to hold it after state
+   *         changes.
+   */
+  std::shared_ptr<SWClipMask> CurrentClipMask() const;
+
+  void SetClipMask(std::shared_ptr<SWClipMask> clip_mask);
+
+ private:
+  std::vector<State> state_stack_ = {};
+};
+
+}  // namespace skity
+
+#endif  // SKITY_SRC_RENDER_SW_SW_CANVAS_STATE_HPP
@@ -1,13 +1,70 @@
 #include "src/render/sw/sw_raster.hpp"
 
 #include <algorithm>
+#include <cstdlib>
+
+#include "src/geometry/conic.hpp"
 
 namespace skity {
 
+// max distance in pixels between a conic and the quads it is chopped into, the
+// quads themselves are flattened to a quarter pixel of deviation
+static constexpr float SW_CONIC_TOLERANCE = 0.125f;
+
+static void split_quad(glm::ivec2* base) {
+  int32_t a, b;
+
+  base[4].x = base[2].x;
+  a = base[0].x + base[1].x;
+  b = base[1].x + base[2].x;
+  base[3].x = b >> 1;
+  base[2].x = (a + b) >> 2;
+  base[1].x = a >> 1;
+
+  base[4].y = base[2].y;
+  a = base[0].y + base[1].y;
+  b = base[1].y + base[2].y;
+  base[3].y = b >> 1;
+  base[2].y = (a + b) >> 2;
+  base[1].y = a >> 1;
+}
+
+static void split_cubic(glm::ivec2* base) {
+  int32_t a, b, c;
+
+  base[6].x = base[3].x;
+  a = base[0].x + base[1].x;
+  b = base[1].x + base[2].x;
+  c = base[2].x + base[3].x;
+  base[5].x = c >> 1;
+  c += b;
+  base[4].x = c >> 2;
+  base[1].x = a >> 1;
+  a += b;
+  base[2].x = a >> 2;
+  base[3].x = (a + c) >> 3;
+
+  base[6].y = base[3].y;
+  a = base[0].y + base[1].y;
+  b = base[1].y + base[2].y;
+  c = base[2].y + base[3].y;
+  base[5].y = c >> 1;
+  c += b;
+  base[4].y = c >> 2;
+  base[1].y = a >> 1;
+  a += b;
+  base[2].y = a >> 2;
+  base[3].y = (a + c) >> 3;
+}
+
 void SWRaster::RastePath(Path const& path) {
+  Reset();
+
   Path::Iter iter{path, true};
   std::array<Point, 4> pts = {};
 
+  even_odd_ = path.getFillType() == Path::PathFillType::kEvenOdd;
+
   for (;;) {
     Path::Verb verb = iter.next(pts.data());
     switch (verb) {
@@ -18,9 +75,26 @@ void SWRaster::RastePath(Path const& path) {
         LineTo(pts[1].x, pts[1].y);
         break;
       case Path::Verb::kQuad:
-      case Path::Verb::kConic:
+        QuadTo(pts[1].x, pts[1].y, pts[2].x, pts[2].y);
+        break;
+      case Path::Verb::kConic: {
+        // path is already in device space
+        std::array<Point, 2 * (1 << Conic::kMaxConicToQuadPOW2) + 1> quads{};
+        Conic conic{pts[0], pts[1], pts[2], iter.conicWeight()};
+        uint32_t count = conic.chopIntoQuadsPOW2(
+            quads.data(), conic.computeQuadPOW2(SW_CONIC_TOLERANCE));
+
+        for (uint32_t i = 0; i < count; i++) {
+          QuadTo(quads[2 * i + 1].x, quads[2 * i + 1].y, quads[2 * i + 2].x,
+                 quads[2 * i + 2].y);
+        }
+      } break;
       case Path::Verb::kCubic:
+        CubicTo(pts[1].x, pts[1].y, pts[2].x, pts[2].y, pts[3].x, pts[3].y);
+        break;
       case Path::Verb::kClose:
+        // Iter is created with force close, the closing line is already
+        // emitted as kLine
         break;
       case Path::Verb::kDone:
         goto DONE;
@@ -52,6 +126,104 @@ void SWRaster::LineTo(float x, float y) {
   RenderLine(sw_up_scale(x), sw_up_scale(y));
 }
 
+void SWRaster::QuadTo(float cx, float cy, float x, float y) {
+  glm::ivec2* arc = bez_stack_.data();
+
+  arc[0].x = sw_up_scale(x);
+  arc[0].y = sw_up_scale(y);
+  arc[1].x = sw_up_scale(cx);
+  arc[1].y = sw_up_scale(cy);
+  arc[2].x = this->x_;
+  arc[2].y = this->y_;
+
+  // the deviation of the control point from the chord tells how many
+  // segments are needed, every split reduces it by a factor of 4
+  int32_t dx = std::abs(arc[2].x + arc[0].x - 2 * arc[1].x);
+  int32_t dy = std::abs(arc[2].y + arc[0].y - 2 * arc[1].y);
+  if (dx < dy) {
+    dx = dy;
+  }
+
+  int32_t draw = 1;
+  while (dx > SW_ONE_PIXEL / 4 && draw < (1 << 16)) {
+    dx >>= 2;
+    draw <<= 1;
+  }
+
+  // draw is a power of 2, the trailing zero bits of the current index tell
+  // how many times the top arc on the stack needs to be split
+  for (;;) {
+    int32_t split = draw & (-draw);
+    while ((split >>= 1)) {
+      split_quad(arc);
+      arc += 2;
+    }
+
+    RenderLine(arc[0].x, arc[0].y);
+
+    if (--draw == 0) {
+      return;
+    }
+
+    arc -= 2;
+  }
+}
+
+void SWRaster::CubicTo(float cx1, float cy1, float cx2, float cy2, float x,
+                       float y) {
+  glm::ivec2* arc = bez_stack_.data();
+  glm::ivec2* limit = bez_stack_.data() + bez_stack_.size() - 7;
+
+  arc[0].x = sw_up_scale(x);
+  arc[0].y = sw_up_scale(y);
+  arc[1].x = sw_up_scale(cx2);
+  arc[1].y = sw_up_scale(cy2);
+  arc[2].x = sw_up_scale(cx1);
+  arc[2].y = sw_up_scale(cy1);
+  arc[3].x = this->x_;
+  arc[3].y = this->y_;
+
+  for (;;) {
+    // split while control points are too far from the chord, stop splitting
+    // when there is no space left in the stack
+    if (arc <= limit &&
+        (std::abs(2 * arc[0].x - 3 * arc[1].x + arc[3].x) > SW_ONE_PIXEL / 2 ||
+         std::abs(2 * arc[0].y - 3 * arc[1].y + arc[3].y) > SW_ONE_PIXEL / 2 ||
+         std::abs(arc[0].x - 3 * arc[2].x + 2 * arc[3].x) > SW_ONE_PIXEL / 2 ||
+         std::abs(arc[0].y - 3 * arc[2].y + 2 * arc[3].y) > SW_ONE_PIXEL / 2)) {
+      split_cubic(arc);
+      arc += 3;
+      continue;
+    }
+
+    RenderLine(arc[0].x, arc[0].y);
+
+    if (arc == bez_stack_.data()) {
+      return;
+    }
+
+    arc -= 3;
+  }
+}
+
+void SWRaster::Reset() {
+  cells_.clear();
+  sorted_cells_.clear();
+  spans_.clear();
+
+  curr_cel_ = {};
+  curr_cell_invalid = true;
+  even_odd_ = false;
+  x_ = -1;
+  y_ = -1;
+  ex_ = -1;
+  ey_ = -1;
+  min_ex_ = std::numeric_limits<int32_t>::max();
+  min_ey_ = std::numeric_limits<int32_t>::max();
+  max_ex_ = std::numeric_limits<int32_t>::min();
+  max_ey_ = std::numeric_limits<int32_t>::min();
+}
+
 void SWRaster::DoRasteration() {
   if (!curr_cell_invalid) {
     RecordCell();
@@ -59,21 +231,32 @@ void SWRaster::DoRasteration() {
 
   spans_.clear();
 
-  if (cells_y_.empty()) {
+  if (cells_.empty()) {
     return;
   }
 
-  for (int32_t current_y = min_ey_; current_y <= max_ey_; current_y++) {
-    if (cells_y_.count(current_y) == 0) {
-      continue;
-    }
+  SortCells();
+
+  size_t index = 0;
+  size_t count = sorted_cells_.size();
 
-    auto const& list = cells_y_[current_y];
+  while (index < count) {
+    int32_t current_y = sorted_cells_[index].y;
 
     int32_t cover = 0;
     int32_t x = min_ex_;
 
-    for (auto const& cell : list) {
+    while (index < count && sorted_cells_[index].y == current_y) {
+      Cell cell = sorted_cells_[index++];
+
+      // merge cells which are recorded more than once
+      while (index < count && sorted_cells_[index].y == current_y &&
+             sorted_cells_[index].x == cell.x) {
+        cell.cover += sorted_cells_[index].cover;
+        cell.area += sorted_cells_[index].area;
+        index++;
+      }
+
       if (cell.x > x && cover != 0) {
         // inner solid
         Sweepline(x, current_y, cover * (SW_ONE_PIXEL * 2), cell.x - x);
@@ -92,6 +275,46 @@ void SWRaster::DoRasteration() {
   }
 }
 
+void SWRaster::SortCells() {
+  auto less_x = [](Cell const& a, Cell const& b) { return a.x < b.x; };
+
+  int64_t rows = static_cast<int64_t>(max_ey_) - min_ey_ + 1;
+
+  if (rows > static_cast<int64_t>(cells_.size()) * 4 + 1024) {
+    // cells are sparse in a huge range, bucketing costs more than sorting
+    sorted_cells_.assign(cells_.begin(), cells_.end());
+    std::sort(sorted_cells_.begin(), sorted_cells_.end(),
+              [](Cell const& a, Cell const& b) {
+                return a.y < b.y || (a.y == b.y && a.x < b.x);
+              });
+    return;
+  }
+
+  // counting sort by row, row r is [row_offsets_[r], row_offsets_[r + 1])
+  row_offsets_.assign(rows + 2, 0);
+  for (auto const& cell : cells_) {
+    row_offsets_[cell.y - min_ey_ + 2]++;
+  }
+
+  for (size_t i = 2; i < row_offsets_.size(); i++) {
+    row_offsets_[i] += row_offsets_[i - 1];
+  }
+
+  sorted_cells_.resize(cells_.size());
+  for (auto const& cell : cells_) {
+    sorted_cells_[row_offsets_[cell.y - min_ey_ + 1]++] = cell;
+  }
+
+  for (int64_t r = 0; r < rows; r++) {
+    auto begin = sorted_cells_.begin() + row_offsets_[r];
+    auto end = sorted_cells_.begin() + row_offsets_[r + 1];
+
+    if (end - begin > 1) {
+      std::sort(begin, end, less_x);
+    }
+  }
+}
+
 void SWRaster::StartCell(int32_t ex, int32_t ey) {
   this->curr_cel_.area = 0;
   this->curr_cel_.cover = 0;
@@ -228,54 +451,9 @@ void SWRaster::RenderLine(int32_t to_x, int32_t to_y) {
 
 void SWRaster::RecordCell() {
   if (this->curr_cel_.area | this->curr_cel_.cover) {
-    auto cell = FindCell();
-    cell->area += this->curr_cel_.area;
-    cell->cover += this->curr_cel_.cover;
-  }
-}
-
-SWRaster::Cell* SWRaster::FindCell() {
-  if (cells_y_.count(ey_) == 0) {
-    std::vector<Cell> list(1);
-    cells_y_[ey_] = list;
-
-    auto cell = &cells_y_[ey_][0];
-    cell->x = ex_;
-    cell->area = 0;
-    cell->cover = 0;
-
-    return cell;
+    cells_.emplace_back(
+        Cell{ex_, ey_, this->curr_cel_.cover, this->curr_cel_.area});
   }
-
-  auto& list = cells_y_[ey_];
-
-  int32_t index = -1;
-  for (size_t i = 0; i < list.size(); i++) {
-    if (list[i].x == ex_) {
-      return &list[i];
-    }
-
-    if (list[i].x > ex_) {
-      index = i;
-      break;
-    }
-  }
-
-  Cell* cell = nullptr;
-  if (index != -1) {
-    // insert new cell in index
-    list.insert(list.begin() + index, Cell{});
-    cell = &list[index];
-  } else {
-    list.emplace_back(Cell{});
-    cell = &list.back();
-  }
-
-  cell->x = ex_;
-  cell->area = 0;
-  cell->cover = 0;
-
-  return cell;
 }
 
 void SWRaster::UpdateXY(int32_t ex, int32_t ey) {
@@ -5,16 +5,24 @@
 #include <glm/glm.hpp>
 #include <limits>
 #include <skity/graphic/path.hpp>
-#include <unordered_map>
 #include <vector>
 
 #include "src/render/sw/sw_subpixel.hpp"
 
 namespace skity {
 
+/**
+ * Scanline rasterizer based on FreeType's gray raster.
+ *
+ * Cells are appended into a pool while walking the path and bucketed by row
+ * and sorted by x at the end, so recording a cell is O(1). All buffers keep
+ * their capacity, one instance can be reused for many paths without heap
+ * allocation after warm up.
+ */
 class SWRaster final {
   struct Cell {
     int32_t x;
+    int32_t y;
     int32_t cover;
     int32_t area;
   };
@@ -23,8 +31,16 @@ class SWRaster final {
   SWRaster() = default;
   ~SWRaster() = default;
 
+  /**
+   * Raster path into spans, previous result is discarded.
+   */
   void RastePath(Path const& path);
 
+  /**
+   * Clear all cells and spans, memory is kept for next raster.
+   */
+  void Reset();
+
   std::vector<Span> const& CurrentSpans() const { return spans_; }
 
  private:
@@ -32,6 +48,10 @@ class SWRaster final {
 
   void LineTo(float x, float y);
 
+  void QuadTo(float cx, float cy, float x, float y);
+
+  void CubicTo(float cx1, float cy1, float cx2, float cy2, float x, float y);
+
   void DoRasteration();
 
   void StartCell(int32_t ex, int32_t ey);
@@ -42,7 +62,7 @@ class SWRaster final {
 
   void RecordCell();
 
-  Cell* FindCell();
+  void SortCells();
 
   void UpdateXY(int32_t ex, int32_t ey);
 
@@ -50,7 +70,11 @@ class SWRaster final {
 
  private:
   Cell curr_cel_ = {};
-  std::unordered_map<int32_t, std::vector<Cell>> cells_y_ = {};
+  // cells in record order, the same cell can appear more than once
+  std::vector<Cell> cells_ = {};
+  // cells sorted by row and x, rows are indexed by row_offsets_
+  std::vector<Cell> sorted_cells_ = {};
+  std::vector<int32_t> row_offsets_ = {};
   std::vector<Span> spans_ = {};
   std::array<glm::ivec2, 32 * 3 + 1> bez_stack_ = {};
   std::array<size_t, 32> lev_stack_ = {};
@@ -1,21 +1,230 @@
 #include "src/render/sw/sw_span_brush.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <skity/graphic/bitmap.hpp>
+#include <skity/io/pixmap.hpp>
+
+#include "src/render/sw/sw_blitter.hpp"
 
 namespace skity {
 
 void SWSpanBrush::Brush() {
-  for (size_t i = 0; i < spans_size_; i++) {
-    Span const& span = p_spans_[i];
-    Color4f color = CalculateColor(span.x, span.y);
+  Brush(0, 0, static_cast<int32_t>(bitmap_->width()),
+        static_cast<int32_t>(bitmap_->height()));
+}
+
+void SWSpanBrush::Brush(int32_t left, int32_t top, int32_t right,
+                        int32_t bottom) {
+  uint32_t* pixels = bitmap_->getPixelAddr();
+
+  if (pixels == nullptr) {
+    return;
+  }
+
+  int32_t width = static_cast<int32_t>(bitmap_->width());
+
+  left = std::max(left, 0);
+  top = std::max(top, 0);
+  right = std::min(right, width);
+  bottom = std::min(bottom, static_cast<int32_t>(bitmap_->height()));
+
+  const Span* end = p_spans_ + spans_size_;
+  const Span* span = std::lower_bound(
+      p_spans_, end, top,
+      [](Span const& span, int32_t y) { return span.y < y; });
+
+  for (; span != end && span->y < bottom; span++) {
+    int32_t x0 = std::max(span->x, left);
+    int32_t x1 = std::min(span->x + span->len, right);
 
-    color.a *= (span.cover / 255.f);
-    for (size_t l = 0; l < span.len; l++) {
-      bitmap_->blendPixel(span.x + l, span.y, color);
+    if (x1 <= x0) {
+      continue;
     }
+
+    BrushSpan(pixels + span->y * width + x0, x0, span->y, x1 - x0,
+              static_cast<uint8_t>(span->cover));
+  }
+}
+
+void SWSpanBrush::BrushSpan(uint32_t* dst, int32_t x, int32_t y, int32_t len,
+                            uint8_t cover) {
+  span_colors_.resize(len);
+
+  for (int32_t i = 0; i < len; i++) {
+    span_colors_[i] = SWBlitter::PremulColor(CalculateColor(x + i, y));
   }
+
+  SWBlitter::BlitRow(dst, span_colors_.data(), cover, len);
 }
 
+SolidColorBrush::SolidColorBrush(std::vector<Span> const& spans,
+                                 Bitmap* bitmap, Color4f color)
+    : SWSpanBrush(spans, bitmap),
+      color_(std::move(color)),
+      premul_color_(SWBlitter::PremulColor(color_)) {}
+
 Color4f SolidColorBrush::CalculateColor(int32_t x, int32_t y) { return color_; }
 
-}  // namespace skity
\ No newline at end of file
+void SolidColorBrush::BrushSpan(uint32_t* dst, int32_t x, int32_t y,
+                                int32_t len, uint8_t cover) {
+  SWBlitter::BlitSolid(dst, premul_color_, cover, len);
+}
+
+GradientColorBrush::GradientColorBrush(std::vector<Span> const& spans,
+                                       Bitmap* bitmap,
+                                       Shader::GradientInfo const& info,
+                                       float alpha)
+    : SWSpanBrush(spans, bitmap),
+      colors_(info.colors.begin(),
+              info.colors.begin() + std::min<size_t>(info.color_count,
+                                                     info.colors.size())),
+      stops_(info.color_offsets) {
+  // global alpha is linear in the interpolation, so apply it to stops once
+  for (auto& color : colors_) {
+    color.a *= alpha;
+  }
+
+  if (stops_.size() != colors_.size()) {
+    stops_.clear();
+  }
+}
+
+Color4f GradientColorBrush::LerpColor(float value) const {
+  if (colors_.empty()) {
+    return Color4f{0.f, 0.f, 0.f, 0.f};
+  }
+
+  size_t count = colors_.size();
+  if (count == 1) {
+    return colors_.front();
+  }
+
+  value = glm::clamp(value, 0.f, 1.f);
+
+  float step = 1.f / static_cast<float>(count - 1);
+  for (size_t i = 0; i < count - 1; i++) {
+    float start = stops_.empty() ? step * i : stops_[i];
+    float end = stops_.empty() ? step * (i + 1) : stops_[i + 1];
+
+    if (value <= start && i == 0) {
+      return colors_.front();
+    }
+
+    if (value >= start && value <= end) {
+      float total = end - start;
+      float mix_value = total > 0.f ? (value - start) / total : 0.5f;
+
+      return glm::mix(colors_[i], colors_[i + 1], mix_value);
+    }
+  }
+
+  return colors_.back();
+}
+
+LinearGradientBrush::LinearGradientBrush(std::vector<Span> const& spans,
+                                         Bitmap* bitmap,
+                                         Shader::GradientInfo const& info,
+                                         Matrix const& matrix, float alpha)
+    : GradientColorBrush(spans, bitmap, info, alpha),
+      start_(matrix * Point{info.point[0].x, info.point[0].y, 0.f, 1.f}),
+      end_(matrix * Point{info.point[1].x, info.point[1].y, 0.f, 1.f}) {}
+
+Color4f LinearGradientBrush::CalculateColor(int32_t x, int32_t y) {
+  glm::vec2 current{x + 0.5f, y + 0.5f};
+
+  glm::vec2 sc = current - start_;
+  glm::vec2 se = end_ - start_;
+
+  float total = glm::dot(se, se);
+  if (total <= 0.f) {
+    return LerpColor(0.f);
+  }
+
+  return LerpColor(glm::dot(sc, se) / total);
+}
+
+RadialGradientBrush::RadialGradientBrush(std::vector<Span> const& spans,
+                                         Bitmap* bitmap,
+                                         Shader::GradientInfo const& info,
+                                         Matrix const& matrix, float alpha)
+    : GradientColorBrush(spans, bitmap, info, alpha),
+      center_(matrix * Point{info.point[0].x, info.point[0].y, 0.f, 1.f}),
+      radius_(info.radius[0]) {}
+
+Color4f RadialGradientBrush::CalculateColor(int32_t x, int32_t y) {
+  glm::vec2 current{x + 0.5f, y + 0.5f};
+
+  if (radius_ <= 0.f) {
+    return LerpColor(1.f);
+  }
+
+  return LerpColor(glm::distance(current, center_) / radius_);
+}
+
+PixmapBrush::PixmapBrush(std::vector<Span> const& spans, Bitmap* bitmap,
+                         std::shared_ptr<Pixmap> pixmap,
+                         Shader::SamplingMode sampling, Rect const& bounds,
+                         Matrix const& matrix, float alpha)
+    : SWSpanBrush(spans, bitmap),
+      pixmap_(std::move(pixmap)),
+      sampling_(sampling),
+      bounds_(bounds),
+      inverse_matrix_(glm::inverse(matrix)),
+      alpha_(alpha) {}
+
+Color4f PixmapBrush::CalculateColor(int32_t x, int32_t y) {
+  if (pixmap_->Width() == 0 || pixmap_->Height() == 0 ||
+      bounds_.width() <= 0.f || bounds_.height() <= 0.f) {
+    return Color4f{0.f, 0.f, 0.f, 0.f};
+  }
+
+  Point local = inverse_matrix_ * Point{x + 0.5f, y + 0.5f, 0.f, 1.f};
+
+  float u = glm::clamp((local.x - bounds_.left()) / bounds_.width(), 0.f, 1.f);
+  float v = glm::clamp((local.y - bounds_.top()) / bounds_.height(), 0.f, 1.f);
+
+  Color4f color;
+  if (sampling_ == Shader::SamplingMode::kNearest) {
+    color = FetchTexel(static_cast<int32_t>(u * pixmap_->Width()),
+                       static_cast<int32_t>(v * pixmap_->Height()));
+  } else {
+    // texel centers are at half integer positions, same as GL_LINEAR
+    float tx = u * pixmap_->Width() - 0.5f;
+    float ty = v * pixmap_->Height() - 0.5f;
+
+    int32_t x0 = static_cast<int32_t>(std::floor(tx));
+    int32_t y0 = static_cast<int32_t>(std::floor(ty));
+    float fx = tx - x0;
+    float fy = ty - y0;
+
+    Color4f top = glm::mix(FetchTexel(x0, y0), FetchTexel(x0 + 1, y0), fx);
+    Color4f bottom =
+        glm::mix(FetchTexel(x0, y0 + 1), FetchTexel(x0 + 1, y0 + 1), fx);
+    color = glm::mix(top, bottom, fy);
+  }
+
+  // image pixels are premultiplied, but blend works on unpremultiplied color
+  if (color.a > 0.f) {
+    color.r /= color.a;
+    color.g /= color.a;
+    color.b /= color.a;
+  }
+
+  color.a *= alpha_;
+
+  return color;
+}
+
+Color4f PixmapBrush::FetchTexel(int32_t x, int32_t y) const {
+  x = glm::clamp<int32_t>(x, 0, pixmap_->Width() - 1);
+  y = glm::clamp<int32_t>(y, 0, pixmap_->Height() - 1);
+
+  const uint8_t* row = reinterpret_cast<const uint8_t*>(pixmap_->Addr()) +
+                       y * pixmap_->RowBytes();
+  const uint8_t* texel = row + x * 4;
+
+  return Color4f{texel[0], texel[1], texel[2], texel[3]} / 255.f;
+}
+
+}  // namespace skity
@@ -1,6 +1,9 @@
 #ifndef SKITY_SRC_RENDER_SW_SW_SPAN_BRUSH_HPP
 #define SKITY_SRC_RENDER_SW_SW_SPAN_BRUSH_HPP
 
+#include <memory>
+#include <skity/effect/shader.hpp>
+#include <skity/geometry/rect.hpp>
 #include <skity/graphic/color.hpp>
 #include <vector>
 
@@ -9,6 +12,7 @@
 namespace skity {
 
 class Bitmap;
+class Pixmap;
 
 class SWSpanBrush {
  public:
@@ -19,9 +23,32 @@ class SWSpanBrush {
 
   void Brush();
 
+  /**
+   * Only brush pixels inside [left, right) x [top, bottom), spans must be
+   * sorted by row.
+   */
+  void Brush(int32_t left, int32_t top, int32_t right, int32_t bottom);
+
  protected:
+  /**
+   * Calculate the unpremultiplied color of the given pixel
+   */
   virtual Color4f CalculateColor(int32_t x, int32_t y) = 0;
 
+  /**
+   * Blend one span which is already clipped into bitmap bounds. Default
+   * implementation calculates colors of the whole span and blends them as one
+   * row.
+   *
+   * @param dst   address of the first pixel
+   * @param x     x of the first pixel
+   * @param y     row of the span
+   * @param len   pixel count
+   * @param cover span coverage
+   */
+  virtual void BrushSpan(uint32_t* dst, int32_t x, int32_t y, int32_t len,
+                         uint8_t cover);
+
   const Span* GetSpans() const { return p_spans_; }
 
   size_t GetSpanSize() const { return spans_size_; }
@@ -32,22 +59,104 @@ class SWSpanBrush {
   const Span* p_spans_;
   size_t spans_size_;
   Bitmap* bitmap_;
+  std::vector<uint32_t> span_colors_ = {};
 };
 
 class SolidColorBrush : public SWSpanBrush {
  public:
-  SolidColorBrush(std::vector<Span> const& spans, Bitmap* bitmap, Color4f color)
-      : SWSpanBrush(spans, bitmap), color_(std::move(color)) {}
+  SolidColorBrush(std::vector<Span> const& spans, Bitmap* bitmap,
+                  Color4f color);
 
   ~SolidColorBrush() override = default;
 
  protected:
   Color4f CalculateColor(int32_t x, int32_t y) override;
 
+  void BrushSpan(uint32_t* dst, int32_t x, int32_t y, int32_t len,
+                 uint8_t cover) override;
+
  private:
   Color4f color_;
+  uint32_t premul_color_;
+};
+
+/**
+ * Base class for gradient brushes, gradient points are mapped into device
+ * space, the same as hw backend does in fragment shader.
+ */
+class GradientColorBrush : public SWSpanBrush {
+ public:
+  GradientColorBrush(std::vector<Span> const& spans, Bitmap* bitmap,
+                     Shader::GradientInfo const& info, float alpha);
+
+  ~GradientColorBrush() override = default;
+
+ protected:
+  Color4f LerpColor(float value) const;
+
+ private:
+  std::vector<Color4f> colors_;
+  std::vector<float> stops_;
+};
+
+class LinearGradientBrush : public GradientColorBrush {
+ public:
+  LinearGradientBrush(std::vector<Span> const& spans, Bitmap* bitmap,
+                      Shader::GradientInfo const& info, Matrix const& matrix,
+                      float alpha);
+
+  ~LinearGradientBrush() override = default;
+
+ protected:
+  Color4f CalculateColor(int32_t x, int32_t y) override;
+
+ private:
+  glm::vec2 start_;
+  glm::vec2 end_;
+};
+
+class RadialGradientBrush : public GradientColorBrush {
+ public:
+  RadialGradientBrush(std::vector<Span> const& spans, Bitmap* bitmap,
+                      Shader::GradientInfo const& info, Matrix const& matrix,
+                      float alpha);
+
+  ~RadialGradientBrush() override = default;
+
+ protected:
+  Color4f CalculateColor(int32_t x, int32_t y) override;
+
+ private:
+  glm::vec2 center_;
+  float radius_;
+};
+
+/**
+ * Sample image with bilinear filter, or nearest pixel for kNearest sampling,
+ * the image is stretched to fill the draw bounds in local space.
+ */
+class PixmapBrush : public SWSpanBrush {
+ public:
+  PixmapBrush(std::vector<Span> const& spans, Bitmap* bitmap,
+              std::shared_ptr<Pixmap> pixmap, Shader::SamplingMode sampling,
+              Rect const& bounds, Matrix const& matrix, float alpha);
+
+  ~PixmapBrush() override = default;
+
+ protected:
+  Color4f CalculateColor(int32_t x, int32_t y) override;
+
+ private:
+  Color4f FetchTexel(int32_t x, int32_t y) const;
+
+ private:
+  std::shared_ptr<Pixmap> pixmap_;
+  Shader::SamplingMode sampling_;
+  Rect bounds_;
+  Matrix inverse_matrix_;
+  float alpha_;
 };
 
 }  // namespace skity
 
-#endif  // SKITY_SRC_RENDER_SW_SW_SPAN_BRUSH_HPP
\ No newline at end of file
+#endif  // SKITY_SRC_RENDER_SW_SW_SPAN_BRUSH_HPP
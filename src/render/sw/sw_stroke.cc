@@ -0,0 +1,310 @@
+#include "src/render/sw/sw_stroke.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "src/geometry/conic.hpp"
+#include "src/geometry/geometry.hpp"
+
+namespace skity {
+
+// upper bound of segments a single curve can be flattened into
+static constexpr int32_t SW_MAX_CURVE_SEGMENTS = 128;
+
+static float cross_vec2(glm::vec2 const& a, glm::vec2 const& b) {
+  return a.x * b.y - a.y * b.x;
+}
+
+SWStroke::SWStroke(Paint const& paint, float tolerance)
+    : radius_(std::max(0.5f, paint.getStrokeWidth()) * 0.5f),
+      tolerance_(tolerance),
+      miter_limit_(paint.getStrokeMiter()),
+      cap_(paint.getStrokeCap()),
+      join_(paint.getStrokeJoin()) {}
+
+void SWStroke::StrokePath(Path const& src, Path* dst) {
+  contours_.clear();
+
+  FlattenPath(src);
+
+  dst->reset();
+  dst->setFillType(Path::PathFillType::kWinding);
+
+  for (auto const& contour : contours_) {
+    StrokeContour(contour, dst);
+  }
+}
+
+void SWStroke::FlattenPath(Path const& path) {
+  Path::Iter iter{path, false};
+  std::array<Point, 4> pts = {};
+
+  for (;;) {
+    Path::Verb verb = iter.next(pts.data());
+    switch (verb) {
+      case Path::Verb::kMove:
+        contours_.emplace_back(Contour{});
+        AppendPoint(pts[0], false);
+        break;
+      case Path::Verb::kLine:
+        AppendPoint(pts[1], false);
+        contours_.back().has_segment = true;
+        break;
+      case Path::Verb::kQuad:
+        FlattenQuad(pts[0], pts[1], pts[2], tolerance_);
+        contours_.back().has_segment = true;
+        break;
+      case Path::Verb::kConic: {
+        // half of the tolerance goes to approximating the conic with quads,
+        // the other half to flattening those quads
+        float tolerance = tolerance_ * 0.5f;
+
+        std::array<Point, 2 * (1 << Conic::kMaxConicToQuadPOW2) + 1> quads{};
+        Conic conic{pts[0], pts[1], pts[2], iter.conicWeight()};
+        uint32_t count = conic.chopIntoQuadsPOW2(
+            quads.data(), conic.computeQuadPOW2(tolerance));
+        quads[0] = pts[0];
+
+        for (uint32_t i = 0; i < count; i++) {
+          FlattenQuad(quads[2 * i], quads[2 * i + 1], quads[2 * i + 2],
+                      tolerance);
+        }
+        contours_.back().has_segment = true;
+      } break;
+      case Path::Verb::kCubic:
+        FlattenCubic(pts[0], pts[1], pts[2], pts[3]);
+        contours_.back().has_segment = true;
+        break;
+      case Path::Verb::kClose:
+        contours_.back().closed = true;
+        break;
+      case Path::Verb::kDone:
+        return;
+    }
+  }
+}
+
+void SWStroke::FlattenQuad(glm::vec2 const& p0, glm::vec2 const& p1,
+                           glm::vec2 const& p2, float tolerance) {
+  int32_t count =
+      WangsFormulaQuad(p0, p1, p2, tolerance, SW_MAX_CURVE_SEGMENTS);
+
+  QuadCoeff coeff{p2 - 2.f * p1 + p0, 2.f * (p1 - p0), p0};
+  for (int32_t i = 1; i <= count; i++) {
+    float t = static_cast<float>(i) / count;
+    AppendPoint(coeff.eval(t), i != count);
+  }
+}
+
+void SWStroke::FlattenCubic(glm::vec2 const& p0, glm::vec2 const& p1,
+                            glm::vec2 const& p2, glm::vec2 const& p3) {
+  int32_t count =
+      WangsFormulaCubic(p0, p1, p2, p3, tolerance_, SW_MAX_CURVE_SEGMENTS);
+
+  std::array<Point, 4> src{Point{p0, 0.f, 1.f}, Point{p1, 0.f, 1.f},
+                           Point{p2, 0.f, 1.f}, Point{p3, 0.f, 1.f}};
+  CubicCoeff coeff{src};
+  for (int32_t i = 1; i <= count; i++) {
+    float t = static_cast<float>(i) / count;
+    AppendPoint(coeff.eval(t), i != count);
+  }
+}
+
+void SWStroke::AppendPoint(glm::vec2 const& p, bool smooth) {
+  auto& contour = contours_.back();
+
+  if (!contour.pts.empty() &&
+      glm::length(p - contour.pts.back()) <= tolerance_ * 0.01f) {
+    // keep the corner if a sharp point collapses into a curve point
+    contour.smooth.back() = contour.smooth.back() && smooth;
+    return;
+  }
+
+  contour.pts.emplace_back(p);
+  contour.smooth.emplace_back(smooth);
+}
+
+void SWStroke::StrokeContour(Contour const& contour, Path* dst) {
+  std::vector<glm::vec2> const& pts = contour.pts;
+  size_t count = pts.size();
+
+  bool closed = contour.closed;
+  if (closed && count > 2 &&
+      glm::length(pts.front() - pts.back()) <= tolerance_ * 0.01f) {
+    count -= 1;
+  }
+
+  if (count == 0) {
+    return;
+  }
+
+  if (count == 1) {
+    // zero length contour only draws something with round or square cap
+    if (contour.has_segment) {
+      StrokeCap(pts[0], {1.f, 0.f}, dst);
+      StrokeCap(pts[0], {-1.f, 0.f}, dst);
+    }
+    return;
+  }
+
+  std::vector<glm::vec2> polygon;
+
+  size_t segment_count = closed ? count : count - 1;
+  for (size_t i = 0; i < segment_count; i++) {
+    glm::vec2 const& p0 = pts[i];
+    glm::vec2 const& p1 = pts[(i + 1) % count];
+
+    glm::vec2 dir = glm::normalize(p1 - p0);
+    glm::vec2 normal = glm::vec2{-dir.y, dir.x} * radius_;
+
+    polygon.clear();
+    polygon.emplace_back(p0 + normal);
+    polygon.emplace_back(p1 + normal);
+    polygon.emplace_back(p1 - normal);
+    polygon.emplace_back(p0 - normal);
+
+    AddPolygon(polygon, dst);
+  }
+
+  for (size_t i = 1; i < count - 1; i++) {
+    StrokeJoin(pts[i], glm::normalize(pts[i] - pts[i - 1]),
+               glm::normalize(pts[i + 1] - pts[i]), contour.smooth[i], dst);
+  }
+
+  glm::vec2 first_dir = glm::normalize(pts[1] - pts[0]);
+  glm::vec2 last_dir = glm::normalize(pts[count - 1] - pts[count - 2]);
+
+  if (closed) {
+    glm::vec2 close_dir = glm::normalize(pts[0] - pts[count - 1]);
+
+    StrokeJoin(pts[count - 1], last_dir, close_dir, contour.smooth[count - 1],
+               dst);
+    StrokeJoin(pts[0], close_dir, first_dir, false, dst);
+  } else {
+    StrokeCap(pts[0], -first_dir, dst);
+    StrokeCap(pts[count - 1], last_dir, dst);
+  }
+}
+
+void SWStroke::StrokeJoin(glm::vec2 const& p, glm::vec2 const& d0,
+                          glm::vec2 const& d1, bool smooth, Path* dst) {
+  float cross = cross_vec2(d0, d1);
+  float dot = glm::dot(d0, d1);
+
+  if (std::abs(cross) <= 1e-6f && dot > 0.f) {
+    // no turn, segments are already connected
+    return;
+  }
+
+  // the join is on the outer side of the turn
+  float side = cross > 0.f ? -1.f : 1.f;
+  glm::vec2 n0 = glm::vec2{-d0.y, d0.x} * (side * radius_);
+  glm::vec2 n1 = glm::vec2{-d1.y, d1.x} * (side * radius_);
+
+  std::vector<glm::vec2> polygon;
+  polygon.emplace_back(p);
+  polygon.emplace_back(p + n0);
+
+  Paint::Join join = smooth ? Paint::kBevel_Join : join_;
+
+  if (join == Paint::kMiter_Join) {
+    glm::vec2 out_dir = n0 + n1;
+    float len2 = glm::dot(out_dir, out_dir);
+
+    if (len2 > 1e-12f) {
+      glm::vec2 pe = out_dir * (2.f * radius_ * radius_ / len2);
+
+      if (glm::length(pe) < miter_limit_) {
+        polygon.emplace_back(p + pe);
+      }
+    }
+  } else if (join == Paint::kRound_Join) {
+    float sweep = std::atan2(cross_vec2(n0, n1), glm::dot(n0, n1));
+    AppendArc(p, n0, sweep, polygon);
+
+    AddPolygon(polygon, dst);
+    return;
+  }
+
+  polygon.emplace_back(p + n1);
+
+  AddPolygon(polygon, dst);
+}
+
+void SWStroke::StrokeCap(glm::vec2 const& p, glm::vec2 const& dir, Path* dst) {
+  if (cap_ == Paint::kButt_Cap) {
+    return;
+  }
+
+  glm::vec2 normal = glm::vec2{-dir.y, dir.x} * radius_;
+
+  std::vector<glm::vec2> polygon;
+  polygon.emplace_back(p + normal);
+
+  if (cap_ == Paint::kSquare_Cap) {
+    polygon.emplace_back(p + normal + dir * radius_);
+    polygon.emplace_back(p - normal + dir * radius_);
+    polygon.emplace_back(p - normal);
+  } else {
+    float sweep = cross_vec2(normal, dir) > 0.f ? glm::pi<float>()
+                                                : -glm::pi<float>();
+    AppendArc(p, normal, sweep, polygon);
+  }
+
+  AddPolygon(polygon, dst);
+}
+
+void SWStroke::AppendArc(glm::vec2 const& center, glm::vec2 const& from,
+                         float sweep, std::vector<glm::vec2>& polygon) {
+  // max angle step which keeps the chord inside tolerance
+  float max_step = glm::pi<float>() * 0.5f;
+  if (radius_ > tolerance_) {
+    max_step = std::min(max_step, 2.f * std::acos(1.f - tolerance_ / radius_));
+  }
+
+  int32_t steps = static_cast<int32_t>(std::ceil(std::abs(sweep) / max_step));
+  steps = std::min(std::max(steps, 1), SW_MAX_CURVE_SEGMENTS);
+
+  for (int32_t i = 1; i <= steps; i++) {
+    float angle = sweep * i / steps;
+    float c = std::cos(angle);
+    float s = std::sin(angle);
+
+    polygon.emplace_back(center.x + from.x * c - from.y * s,
+                         center.y + from.x * s + from.y * c);
+  }
+}
+
+void SWStroke::AddPolygon(std::vector<glm::vec2> const& polygon, Path* dst) {
+  if (polygon.size() < 3) {
+    return;
+  }
+
+  float area = 0.f;
+  for (size_t i = 0; i < polygon.size(); i++) {
+    area += cross_vec2(polygon[i], polygon[(i + 1) % polygon.size()]);
+  }
+
+  if (area == 0.f) {
+    return;
+  }
+
+  // all polygons share the same orientation so the union can be filled with
+  // winding rule
+  if (area > 0.f) {
+    dst->moveTo(polygon.front().x, polygon.front().y);
+    for (size_t i = 1; i < polygon.size(); i++) {
+      dst->lineTo(polygon[i].x, polygon[i].y);
+    }
+  } else {
+    dst->moveTo(polygon.back().x, polygon.back().y);
+    for (size_t i = polygon.size() - 1; i > 0; i--) {
+      dst->lineTo(polygon[i - 1].x, polygon[i - 1].y);
+    }
+  }
+
+  dst->close();
+}
+
+}  // namespace skity
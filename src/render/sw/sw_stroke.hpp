@@ -0,0 +1,73 @@
+#ifndef SKITY_SRC_RENDER_SW_SW_STROKE_HPP
+#define SKITY_SRC_RENDER_SW_SW_STROKE_HPP
+
+#include <glm/glm.hpp>
+#include <skity/graphic/paint.hpp>
+#include <skity/graphic/path.hpp>
+#include <vector>
+
+namespace skity {
+
+/**
+ * Convert a path into the outline of its stroke.
+ *
+ * Curves are flattened into polylines first, then every segment, join and cap
+ * is emitted as a positive oriented polygon. The result path needs to be
+ * filled with the winding rule.
+ */
+class SWStroke final {
+  struct Contour {
+    std::vector<glm::vec2> pts = {};
+    // true if the point is inside a flattened curve, joins on these points
+    // are always bevel since the angle between segments is small
+    std::vector<bool> smooth = {};
+    bool has_segment = false;
+    bool closed = false;
+  };
+
+ public:
+  /**
+   * @param paint     stroke paint
+   * @param tolerance max allowed distance between curve and flattened
+   *                  polyline, in path space
+   */
+  SWStroke(Paint const& paint, float tolerance);
+  ~SWStroke() = default;
+
+  void StrokePath(Path const& src, Path* dst);
+
+ private:
+  void FlattenPath(Path const& path);
+
+  void FlattenQuad(glm::vec2 const& p0, glm::vec2 const& p1,
+                   glm::vec2 const& p2, float tolerance);
+
+  void FlattenCubic(glm::vec2 const& p0, glm::vec2 const& p1,
+                    glm::vec2 const& p2, glm::vec2 const& p3);
+
+  void AppendPoint(glm::vec2 const& p, bool smooth);
+
+  void StrokeContour(Contour const& contour, Path* dst);
+
+  void StrokeJoin(glm::vec2 const& p, glm::vec2 const& d0,
+                  glm::vec2 const& d1, bool smooth, Path* dst);
+
+  void StrokeCap(glm::vec2 const& p, glm::vec2 const& dir, Path* dst);
+
+  void AppendArc(glm::vec2 const& center, glm::vec2 const& from, float sweep,
+                 std::vector<glm::vec2>& polygon);
+
+  static void AddPolygon(std::vector<glm::vec2> const& polygon, Path* dst);
+
+ private:
+  float radius_;
+  float tolerance_;
+  float miter_limit_;
+  Paint::Cap cap_;
+  Paint::Join join_;
+  std::vector<Contour> contours_ = {};
+};
+
+}  // namespace skity
+
+#endif  // SKITY_SRC_RENDER_SW_SW_STROKE_HPP
@@ -0,0 +1,111 @@
+#include "src/render/sw/sw_task_pool.hpp"
+
+#include <algorithm>
+
+namespace skity {
+
+SWTaskPool::SWTaskPool(size_t thread_count) {
+  threads_.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; i++) {
+    // slot 0 is the thread calling ParallelFor
+    threads_.emplace_back(&SWTaskPool::WorkerLoop, this, i + 1);
+  }
+}
+
+SWTaskPool::~SWTaskPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    quit_ = true;
+  }
+
+  start_cv_.notify_all();
+
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void SWTaskPool::ParallelFor(size_t count, Task const& task) {
+  if (count == 0) {
+    return;
+  }
+
+  if (count == 1 || threads_.empty()) {
+    for (size_t i = 0; i < count; i++) {
+      task(i, 0);
+    }
+    return;
+  }
+
+  std::lock_guard<std::mutex> run_lock(run_mutex_);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    task_count_ = count;
+    next_task_.store(0);
+    running_workers_ = threads_.size();
+    generation_++;
+  }
+
+  start_cv_.notify_all();
+
+  RunTasks(0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this]() { return running_workers_ == 0; });
+  task_ = nullptr;
+}
+
+SWTaskPool* SWTaskPool::GetDefault() {
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+  static SWTaskPool pool{0};
+#else
+  static SWTaskPool pool{
+      std::max<size_t>(std::thread::hardware_concurrency(), 1) - 1};
+#endif
+
+  return &pool;
+}
+
+void SWTaskPool::WorkerLoop(size_t slot) {
+  uint64_t generation = 0;
+
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_cv_.wait(lock, [this, generation]() {
+        return quit_ || generation_ != generation;
+      });
+
+      if (quit_) {
+        return;
+      }
+
+      generation = generation_;
+    }
+
+    RunTasks(slot);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      running_workers_--;
+    }
+
+    done_cv_.notify_one();
+  }
+}
+
+void SWTaskPool::RunTasks(size_t slot) {
+  for (;;) {
+    size_t index = next_task_.fetch_add(1);
+
+    if (index >= task_count_) {
+      return;
+    }
+
+    (*task_)(index, slot);
+  }
+}
+
+}  // namespace skity
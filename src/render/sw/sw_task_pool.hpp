@@ -0,0 +1,76 @@
+#ifndef SKITY_SRC_RENDER_SW_SW_TASK_POOL_HPP
+#define SKITY_SRC_RENDER_SW_SW_TASK_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace skity {
+
+/**
+ * Fixed size worker pool used by software backend to run raster and blit
+ * tasks in parallel.
+ *
+ * Tasks are claimed one by one from a shared atomic counter, so threads which
+ * finish early keep taking the remaining tasks and load is balanced without a
+ * central scheduler.
+ */
+class SWTaskPool final {
+ public:
+  /**
+   * @param task  task index in [0, count)
+   * @param slot  index of the thread running this task, in [0, SlotCount()),
+   *              can be used to access per thread scratch data
+   */
+  using Task = std::function<void(size_t task, size_t slot)>;
+
+  explicit SWTaskPool(size_t thread_count);
+  ~SWTaskPool();
+
+  SWTaskPool(SWTaskPool const&) = delete;
+  SWTaskPool& operator=(SWTaskPool const&) = delete;
+
+  /**
+   * Run task for every index in [0, count) and wait until all finished. The
+   * calling thread also runs tasks.
+   */
+  void ParallelFor(size_t count, Task const& task);
+
+  /**
+   * @return max number of threads running tasks at the same time, including
+   *         the calling thread
+   */
+  size_t SlotCount() const { return threads_.size() + 1; }
+
+  /**
+   * Process wide pool sized by hardware concurrency, created on first use.
+   */
+  static SWTaskPool* GetDefault();
+
+ private:
+  void WorkerLoop(size_t slot);
+
+  void RunTasks(size_t slot);
+
+ private:
+  std::vector<std::thread> threads_ = {};
+  // only one ParallelFor can run at the same time
+  std::mutex run_mutex_ = {};
+  std::mutex mutex_ = {};
+  std::condition_variable start_cv_ = {};
+  std::condition_variable done_cv_ = {};
+  Task const* task_ = nullptr;
+  size_t task_count_ = 0;
+  std::atomic<size_t> next_task_ = {0};
+  size_t running_workers_ = 0;
+  uint64_t generation_ = 0;
+  bool quit_ = false;
+};
+
+}  // namespace skity
+
+#endif  // SKITY_SRC_RENDER_SW_SW_TASK_POOL_HPP
@@ -1,5 +1,6 @@
 #include "src/render/text/font_texture.hpp"
 
+#include <cmath>
 #include <functional>
 
 #include "src/geometry/math.hpp"
@@ -7,45 +8,154 @@
 namespace skity {
 
 FontTexture::FontTexture(Typeface* typeface)
-    : TextureAtlas(DEFAULT_SIZE, DEFAULT_SIZE, 1), typeface_(typeface) {}
+    : TextureAtlas(DEFAULT_SIZE, DEFAULT_SIZE, 1, PAGE_SIZE),
+      typeface_(typeface),
+      page_ages_(PageCount(), 0) {}
 
 glm::ivec4 FontTexture::GetGlyphRegion(GlyphID glyph_id, float font_size) {
-  GlyphKey key{glyph_id, font_size};
+  GlyphKey key{glyph_id, QuantizeFontSize(font_size)};
 
-  if (glyph_regions_.count(key) != 0) {
-    return glyph_regions_[key];
+  auto it = glyph_regions_.find(key);
+  if (it != glyph_regions_.end()) {
+    TouchPage(it->second.page);
+    return it->second.region;
   }
 
   return GenerateGlyphRegion(key);
 }
 
+float FontTexture::QuantizeFontSize(float font_size) {
+  if (!(font_size > 0.f)) {
+    return font_size;
+  }
+
+  // SIZE_BUCKETS evenly spaced sizes in every [2^n, 2^(n+1))
+  int32_t exponent = static_cast<int32_t>(std::floor(std::log2(font_size)));
+  float step = std::ldexp(1.f, exponent) / SIZE_BUCKETS;
+
+  return std::round(font_size / step) * step;
+}
+
+void FontTexture::EndFrame() {
+  if (grow_requested_ && Width() < MAX_SIZE) {
+    CountUpload(Width(), Height());
+    Resize(Width() * 2, Height() * 2);
+    page_ages_.resize(PageCount(), 0);
+  }
+  grow_requested_ = false;
+
+  current_stats_.page_count = PageCount();
+  current_stats_.glyph_count = glyph_regions_.size();
+  current_stats_.occupancy =
+      static_cast<float>(Used()) / static_cast<float>(Width() * Height());
+
+  frame_stats_ = current_stats_;
+  current_stats_ = {};
+  current_age_++;
+}
+
 glm::ivec4 FontTexture::GenerateGlyphRegion(GlyphKey const& key) {
   // generate text bitmap fron typeface
   auto bitmap_info = typeface_->getGlyphBitmapInfo(key.id, key.font_size);
-  // allocate texture region
-  glm::ivec4 region = AllocateRegion(bitmap_info.width, bitmap_info.height);
 
-  if (region.x < 0) {
-    // allocation falied need resize
-    uint32_t width = Width();
-    uint32_t height = Height();
+  GlyphEntry entry{};
+  if (bitmap_info.width == 0 || bitmap_info.height == 0) {
+    // nothing to draw, no need to take atlas space
+    glyph_regions_.insert(std::make_pair(key, entry));
+    return entry.region;
+  }
 
-    Resize(width * 2.f, height * 2.f);
+  // allocate texture region
+  glm::ivec4 region =
+      AllocateGlyphRegion(bitmap_info.width, bitmap_info.height);
 
-    region = AllocateRegion(bitmap_info.width, bitmap_info.height);
+  if (region.x < 0) {
+    current_stats_.failed_glyphs++;
+    return region;
   }
 
   // upload text bitmap
   UploadRegion(region.x, region.y, bitmap_info.width, bitmap_info.height,
                bitmap_info.buffer);
+  CountUpload(bitmap_info.width, bitmap_info.height);
 
   // Fixme to solve black edge for single char
   region.z = bitmap_info.width;
   region.w = bitmap_info.height;
   // save region info
-  glyph_regions_.insert(std::make_pair(key, region));
+  entry.region = region;
+  entry.page = PageOf(region.x, region.y);
+  glyph_regions_.insert(std::make_pair(key, entry));
+
+  TouchPage(entry.page);
 
   return region;
 }
 
+glm::ivec4 FontTexture::AllocateGlyphRegion(uint32_t width, uint32_t height) {
+  glm::ivec4 failed = {-1, -1, 0, 0};
+
+  // pages keep one pixel border
+  if (width > PAGE_SIZE - 2 || height > PAGE_SIZE - 2) {
+    return failed;
+  }
+
+  glm::ivec4 region = AllocateRegion(width, height);
+  if (region.x >= 0) {
+    return region;
+  }
+
+  if (Width() < MAX_SIZE) {
+    grow_requested_ = true;
+    return failed;
+  }
+
+  // evict the page least recently used, regions used in current frame are
+  // still referenced by pending draws
+  int32_t victim = -1;
+  for (uint32_t i = 0; i < page_ages_.size(); i++) {
+    if (page_ages_[i] >= current_age_) {
+      continue;
+    }
+
+    if (victim < 0 || page_ages_[i] < page_ages_[victim]) {
+      victim = i;
+    }
+  }
+
+  if (victim < 0) {
+    return failed;
+  }
+
+  EvictPage(victim);
+
+  return AllocateRegion(victim, width, height);
+}
+
+void FontTexture::EvictPage(uint32_t page) {
+  for (auto it = glyph_regions_.begin(); it != glyph_regions_.end();) {
+    if (it->second.page == static_cast<int32_t>(page)) {
+      it = glyph_regions_.erase(it);
+    } else {
+      it++;
+    }
+  }
+
+  ClearPage(page);
+  CountUpload(PAGE_SIZE, PAGE_SIZE);
+
+  current_stats_.evicted_pages++;
+}
+
+void FontTexture::TouchPage(int32_t page) {
+  if (page >= 0) {
+    page_ages_[page] = current_age_;
+  }
+}
+
+void FontTexture::CountUpload(uint32_t width, uint32_t height) {
+  current_stats_.upload_count++;
+  current_stats_.upload_bytes += width * height;
+}
+
 }  // namespace skity
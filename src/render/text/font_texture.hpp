@@ -4,15 +4,29 @@
 #include <glm/glm.hpp>
 #include <map>
 #include <memory>
+#include <skity/render/canvas.hpp>
 #include <skity/text/typeface.hpp>
+#include <vector>
 
 #include "src/render/texture_atlas.hpp"
 
 namespace skity {
 
+/**
+ * Glyph bitmap atlas of one typeface.
+ *
+ * The atlas is split into fixed size pages and grows by doubling until
+ * MAX_SIZE. After that, the page least recently used is cleared to make room
+ * for new glyphs, pages used in current frame are never evicted. Font sizes
+ * are quantized so animated text sizes reuse a bounded set of glyph bitmaps.
+ */
 class FontTexture : public TextureAtlas {
   enum {
     DEFAULT_SIZE = 512,
+    PAGE_SIZE = 256,
+    MAX_SIZE = 2048,
+    // quantized font sizes per octave
+    SIZE_BUCKETS = 16,
   };
 
   struct GlyphKey {
@@ -39,20 +53,65 @@ class FontTexture : public TextureAtlas {
     }
   };
 
+  struct GlyphEntry {
+    glm::ivec4 region = {};
+    // glyphs without pixels are not stored in any page
+    int32_t page = -1;
+  };
+
  public:
   FontTexture(Typeface* typeface);
   ~FontTexture() override = default;
 
+  /**
+   * @param glyph_id  glyph to query
+   * @param font_size font size in pixels, it is quantized by QuantizeFontSize
+   * @return          region of glyph bitmap rastered with quantized font size,
+   *                  x and y are negative if glyph can not be put into atlas
+   */
   glm::ivec4 GetGlyphRegion(GlyphID glyph_id, float font_size);
 
+  /**
+   * @return font size actually used to raster glyphs of font_size
+   */
+  static float QuantizeFontSize(float font_size);
+
+  /**
+   * Finish current frame, regions returned before are allowed to be evicted
+   * after this call.
+   */
+  void EndFrame();
+
+  /**
+   * @return statistics of the last finished frame, reported by
+   *         Canvas::getGlyphAtlasStats
+   */
+  Canvas::GlyphAtlasStats const& GetFrameStats() const { return frame_stats_; }
+
  private:
   glm::ivec4 GenerateGlyphRegion(GlyphKey const& key);
 
+  glm::ivec4 AllocateGlyphRegion(uint32_t width, uint32_t height);
+
+  void EvictPage(uint32_t page);
+
+  void TouchPage(int32_t page);
+
+  void CountUpload(uint32_t width, uint32_t height);
+
  private:
   Typeface* typeface_;
-  std::map<GlyphKey, glm::ivec4, GlyphKeyCompare> glyph_regions_ = {};
+  std::map<GlyphKey, GlyphEntry, GlyphKeyCompare> glyph_regions_ = {};
+  // last age each page is used
+  std::vector<size_t> page_ages_ = {};
+  size_t current_age_ = 1;
+  // atlas is only resized between frames, since uv of glyphs already drawn
+  // in current frame depend on atlas size
+  bool grow_requested_ = false;
+  Canvas::GlyphAtlasStats current_stats_ = {};
+  Canvas::GlyphAtlasStats frame_stats_ = {};
 };
 
 }  // namespace skity
 
-#endif  // SKITY_SRC_RENDER_TEXT_FONT_TEXTURE_HPP
\ No newline at end of file
+#endif  // SKITY_SRC_RENDER_TEXT_FONT_TEXTURE_HPP
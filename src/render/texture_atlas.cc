@@ -7,12 +7,19 @@
 
 namespace skity {
 
-TextureAtlas::TextureAtlas(uint32_t width, uint32_t height, uint32_t depth)
-    : width_(width), height_(height), depth_(depth) {
-  // one pixel border for sampling texture
-  glm::ivec3 node = {1, 1, width - 2};
+TextureAtlas::TextureAtlas(uint32_t width, uint32_t height, uint32_t depth,
+                           uint32_t page_size)
+    : width_(width), height_(height), depth_(depth), page_size_(page_size) {
+  if (page_size_ == 0) {
+    AddPage({0, 0, width, height});
+  } else {
+    for (uint32_t y = 0; y < height; y += page_size_) {
+      for (uint32_t x = 0; x < width; x += page_size_) {
+        AddPage({x, y, page_size_, page_size_});
+      }
+    }
+  }
 
-  nodes_.emplace_back(node);
   modified_ = true;
   data_ = (uint8_t *)std::malloc(width * height * depth * sizeof(uint8_t));
   std::memset(data_, 0, width * height * depth * sizeof(uint8_t));
@@ -25,6 +32,21 @@ TextureAtlas::~TextureAtlas() {
 }
 
 glm::ivec4 TextureAtlas::AllocateRegion(uint32_t width, uint32_t height) {
+  for (uint32_t i = 0; i < pages_.size(); i++) {
+    glm::ivec4 region = AllocateRegion(i, width, height);
+    if (region.x >= 0) {
+      return region;
+    }
+  }
+
+  return {-1, -1, 0, 0};
+}
+
+glm::ivec4 TextureAtlas::AllocateRegion(uint32_t page_index, uint32_t width,
+                                        uint32_t height) {
+  Page &page = pages_[page_index];
+  auto &nodes = page.nodes;
+
   glm::ivec4 region = {0, 0, (int32_t)width, (int32_t)height};
 
   int32_t best_index = -1;
@@ -32,10 +54,10 @@ glm::ivec4 TextureAtlas::AllocateRegion(uint32_t width, uint32_t height) {
   int32_t best_width = std::numeric_limits<int32_t>::max();
 
   int32_t y = -1;
-  for (int32_t i = 0; i < nodes_.size(); i++) {
-    y = QueryFitY(i, width, height);
+  for (int32_t i = 0; i < nodes.size(); i++) {
+    y = QueryFitY(page, i, width, height);
     if (y > 0) {
-      glm::ivec3 node = nodes_[i];
+      glm::ivec3 node = nodes[i];
       if ((y + height) < best_height || (((y + height) == best_height) &&
                                          (node.z > 0 && node.z < best_width))) {
         best_index = i;
@@ -57,9 +79,9 @@ glm::ivec4 TextureAtlas::AllocateRegion(uint32_t width, uint32_t height) {
 
   glm::ivec3 node = {region.x, region.y + height, width};
 
-  nodes_.insert(nodes_.begin() + best_index, node);
+  nodes.insert(nodes.begin() + best_index, node);
 
-  for (auto i = nodes_.begin() + best_index + 1; i != nodes_.end(); i++) {
+  for (auto i = nodes.begin() + best_index + 1; i != nodes.end(); i++) {
     auto i_node = i;
     auto p_node = i - 1;
 
@@ -69,7 +91,7 @@ glm::ivec4 TextureAtlas::AllocateRegion(uint32_t width, uint32_t height) {
       i_node->z -= shrink;
 
       if (i_node->z <= 0) {
-        i = nodes_.erase(i_node);
+        i = nodes.erase(i_node);
         i--;
       } else {
         break;
@@ -78,24 +100,70 @@ glm::ivec4 TextureAtlas::AllocateRegion(uint32_t width, uint32_t height) {
       break;
     }
   }
-  MergeNodes();
+  MergeNodes(page);
+  page.used += width * height;
   used_ += width * height;
   modified_ = true;
   return region;
 }
 
+void TextureAtlas::ClearPage(uint32_t page_index) {
+  Page &page = pages_[page_index];
+
+  used_ -= page.used;
+  ResetPage(page);
+
+  glm::ivec4 bounds = page.bounds;
+  std::vector<uint8_t> zero(bounds.z * bounds.w * depth_, 0);
+
+  UploadRegion(bounds.x, bounds.y, bounds.z, bounds.w, zero.data());
+}
+
+uint32_t TextureAtlas::PageOf(uint32_t x, uint32_t y) const {
+  for (uint32_t i = 0; i < pages_.size(); i++) {
+    glm::ivec4 const &b = pages_[i].bounds;
+    if ((int32_t)x >= b.x && (int32_t)x < b.x + b.z && (int32_t)y >= b.y &&
+        (int32_t)y < b.y + b.w) {
+      return i;
+    }
+  }
+
+  return 0;
+}
+
 void TextureAtlas::UploadRegion(uint32_t x, uint32_t y, uint32_t width,
                                 uint32_t height, uint8_t *data) {
-  std::memcpy(data_ + (y * this->width_ + x) * depth_, data,
-              width * height * depth_);
+  size_t row_size = width * depth_;
+  for (uint32_t row = 0; row < height; row++) {
+    std::memcpy(data_ + ((y + row) * this->width_ + x) * depth_,
+                data + row * row_size, row_size);
+  }
 
   this->modified_ = true;
   this->OnUploadRegion(x, y, width, height, data);
 }
 
-int32_t TextureAtlas::QueryFitY(int32_t index, uint32_t width,
-                                uint32_t height) {
-  glm::ivec3 node = nodes_[index];
+void TextureAtlas::AddPage(glm::ivec4 const &bounds) {
+  Page page;
+  page.bounds = bounds;
+  ResetPage(page);
+
+  pages_.emplace_back(std::move(page));
+}
+
+void TextureAtlas::ResetPage(Page &page) {
+  // one pixel border for sampling texture
+  glm::ivec3 node = {page.bounds.x + 1, page.bounds.y + 1, page.bounds.z - 2};
+
+  page.nodes.clear();
+  page.nodes.emplace_back(node);
+  page.used = 0;
+}
+
+int32_t TextureAtlas::QueryFitY(Page const &page, int32_t index,
+                                uint32_t width, uint32_t height) {
+  auto const &nodes = page.nodes;
+  glm::ivec3 node = nodes[index];
 
   int32_t x = node.x;
   int32_t y = node.y;
@@ -103,17 +171,17 @@ int32_t TextureAtlas::QueryFitY(int32_t index, uint32_t width,
   int32_t width_left = width;
   int32_t i = index;
 
-  if (x + width > this->width_ - 1) {
+  if (x + width > page.bounds.x + page.bounds.z - 1) {
     return -1;
   }
 
   y = node.y;
   while (width_left > 0) {
-    node = nodes_[i];
+    node = nodes[i];
     if (node.y > y) {
       y = node.y;
     }
-    if (y + height > this->height_ - 1) {
+    if (y + height > page.bounds.y + page.bounds.w - 1) {
       return -1;
     }
 
@@ -125,8 +193,9 @@ int32_t TextureAtlas::QueryFitY(int32_t index, uint32_t width,
 }
 
 void TextureAtlas::Clear() {
-  nodes_.clear();
-  nodes_.emplace_back(glm::ivec3{1, 1, width_ - 2});
+  for (auto &page : pages_) {
+    ResetPage(page);
+  }
   used_ = 0;
   std::memset(data_, 0, width_ * height_ * depth_);
 }
@@ -139,23 +208,42 @@ void TextureAtlas::Resize(uint32_t new_width, uint32_t new_height) {
   uint32_t old_height = height_;
   uint8_t *old_data = data_;
 
+  size_t pixel_size = depth_;
+  size_t old_row_size = old_width * pixel_size;
+  size_t new_row_size = new_width * pixel_size;
+
   this->data_ = (uint8_t *)std::malloc(new_width * new_height * depth_);
+  std::memset(data_, 0, new_width * new_height * depth_);
+  for (uint32_t row = 0; row < old_height; row++) {
+    std::memcpy(data_ + row * new_row_size, old_data + row * old_row_size,
+                old_row_size);
+  }
 
   this->width_ = new_width;
   this->height_ = new_height;
 
-  if (new_width > old_width) {
-    glm::ivec3 node = {old_width - 1, 1, new_width - old_width};
-    nodes_.emplace_back(node);
+  if (page_size_ == 0) {
+    Page &page = pages_.front();
+    page.bounds = {0, 0, new_width, new_height};
+    if (new_width > old_width) {
+      glm::ivec3 node = {old_width - 1, 1, new_width - old_width};
+      page.nodes.emplace_back(node);
+    }
+  } else {
+    // pages already in atlas keep their position
+    for (uint32_t y = 0; y < new_height; y += page_size_) {
+      for (uint32_t x = 0; x < new_width; x += page_size_) {
+        if (x >= old_width || y >= old_height) {
+          AddPage({x, y, page_size_, page_size_});
+        }
+      }
+    }
   }
 
-  size_t pixel_size = depth_;
-  size_t old_row_size = old_width * pixel_size;
-
   this->OnResize(new_width, new_height);
 
-  UploadRegion(1, 1, old_width - 2, old_height - 2,
-               old_data + old_row_size + pixel_size);
+  this->modified_ = true;
+  this->OnUploadRegion(0, 0, old_width, old_height, old_data);
 
   std::free(old_data);
 }
@@ -167,14 +255,15 @@ glm::vec2 TextureAtlas::CalculateUV(uint32_t x, uint32_t y) {
   return {u, v};
 }
 
-void TextureAtlas::MergeNodes() {
-  for (auto node = nodes_.begin(); node < nodes_.end() - 1; node++) {
+void TextureAtlas::MergeNodes(Page &page) {
+  auto &nodes = page.nodes;
+  for (auto node = nodes.begin(); node < nodes.end() - 1; node++) {
     auto next = node + 1;
     if (node->y == next->y) {
       node->z += next->z;
-      nodes_.erase(next);
+      nodes.erase(next);
     }
   }
 }
 
-}  // namespace skity
\ No newline at end of file
+}  // namespace skity
@@ -13,10 +13,20 @@ namespace skity {
  * The actual implementation is based on the article by Jukka Jylänki :
  * "A Thousand Ways to Pack the Bin - A Practical Approach to Two-Dimensional
  * Rectangle Bin Packing", February 27, 2010.
+ *
+ * The atlas can be split into fixed size square pages, each page packs its
+ * regions independently, so a single page can be cleared and reused without
+ * touching regions in other pages.
  */
 class TextureAtlas {
  public:
-  TextureAtlas(uint32_t width, uint32_t height, uint32_t depth);
+  /**
+   * @param page_size   size of pages in pixels, 0 means the whole atlas is a
+   *                    single page. width and height need to be multiple of
+   *                    page_size
+   */
+  TextureAtlas(uint32_t width, uint32_t height, uint32_t depth,
+               uint32_t page_size = 0);
   virtual ~TextureAtlas();
 
   /**
@@ -28,6 +38,35 @@ class TextureAtlas {
    */
   glm::ivec4 AllocateRegion(uint32_t width, uint32_t height);
 
+  /**
+   * @brief               Allocate a new region in the specified page.
+   *
+   * @param page          page index in [0, PageCount())
+   * @param width         width of region to allocate
+   * @param height        height of region to allocate
+   * @return glm::ivec4   allocated region, x and y are negative if failed
+   */
+  glm::ivec4 AllocateRegion(uint32_t page, uint32_t width, uint32_t height);
+
+  /**
+   * @brief       Remove all allocated regions in page and clear its pixels.
+   *
+   * @param page  page index in [0, PageCount())
+   */
+  void ClearPage(uint32_t page);
+
+  uint32_t PageCount() const { return pages_.size(); }
+
+  /**
+   * @return page index containing pixel (x, y)
+   */
+  uint32_t PageOf(uint32_t x, uint32_t y) const;
+
+  /**
+   * @return allocated pixels in page
+   */
+  uint32_t PageUsed(uint32_t page) const { return pages_[page].used; }
+
   /**
    * @brief         Upload data to the specified atlas region
    *
@@ -66,6 +105,11 @@ class TextureAtlas {
   uint32_t Width() const { return width_; }
   uint32_t Height() const { return height_; }
 
+  /**
+   * @return allocated pixels in all pages
+   */
+  uint32_t Used() const { return used_; }
+
  protected:
   virtual void OnUploadRegion(uint32_t x, uint32_t y, uint32_t width,
                               uint32_t height, uint8_t* data) {}
@@ -73,8 +117,20 @@ class TextureAtlas {
   virtual void OnResize(uint32_t new_width, uint32_t new_height) {}
 
  private:
-  int32_t QueryFitY(int32_t index, uint32_t width, uint32_t height);
-  void MergeNodes();
+  struct Page {
+    // [x, y, width, height] of page in atlas
+    glm::ivec4 bounds = {};
+    // Allocated nodes, [x, y, width]
+    std::vector<glm::ivec3> nodes = {};
+    // allocated surface size
+    uint32_t used = {};
+  };
+
+  void AddPage(glm::ivec4 const& bounds);
+  void ResetPage(Page& page);
+  int32_t QueryFitY(Page const& page, int32_t index, uint32_t width,
+                    uint32_t height);
+  void MergeNodes(Page& page);
 
  private:
   // Width (in pixels) of the underlying texture
@@ -82,14 +138,14 @@ class TextureAtlas {
   // Height(in pixels) of the underlying texture
   uint32_t height_ = {};
   uint32_t depth_ = {};
+  uint32_t page_size_ = {};
   // allocated surface size
   uint32_t used_ = {};
   // Atlas data
   uint8_t* data_ = nullptr;
   // Atlas has been modified
   bool modified_ = false;
-  // Allocated nodes, [x, y, width]
-  std::vector<glm::ivec3> nodes_ = {};
+  std::vector<Page> pages_ = {};
 };
 
 }  // namespace skity
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <skity/io/data.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <csignal>
+#include <unistd.h>
+#endif
+
+static std::vector<uint8_t> MakeContent(size_t size) {
+  std::vector<uint8_t> content(size);
+  for (size_t i = 0; i < size; i++) {
+    content[i] = static_cast<uint8_t>(i * 31 + i / 251);
+  }
+  return content;
+}
+
+static bool SameContent(skity::Data const& data,
+                        std::vector<uint8_t> const& content) {
+  return data.Size() == content.size() &&
+         std::equal(content.begin(), content.end(), data.Bytes());
+}
+
+TEST(Data, read_regular_file) {
+  std::string path = ::testing::TempDir() + "skity_data_test.bin";
+  auto content = MakeContent(100000);
+
+  auto source = skity::Data::MakeWithCopy(content.data(), content.size());
+  ASSERT_TRUE(source->WriteToFile(path.c_str()));
+
+  for (bool map_file : {false, true}) {
+    auto data = skity::Data::MakeFromFileName(path.c_str(), map_file);
+    ASSERT_TRUE(data);
+    EXPECT_TRUE(SameContent(*data, content));
+  }
+
+  std::remove(path.c_str());
+}
+
+TEST(Data, read_missing_file) {
+  std::string path = ::testing::TempDir() + "skity_data_test_missing.bin";
+  std::remove(path.c_str());
+
+  auto data = skity::Data::MakeFromFileName(path.c_str());
+  ASSERT_TRUE(data);
+  EXPECT_TRUE(data->IsEmpty());
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST(Data, read_pipe) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  // writer fails instead of being killed if nothing is read
+  std::signal(SIGPIPE, SIG_IGN);
+
+  // larger than one read chunk and than the pipe buffer
+  auto content = MakeContent(300000);
+
+  std::thread writer([&] {
+    size_t offset = 0;
+    while (offset < content.size()) {
+      ssize_t count =
+          write(fds[1], content.data() + offset, content.size() - offset);
+      if (count <= 0) {
+        break;
+      }
+      offset += static_cast<size_t>(count);
+    }
+    close(fds[1]);
+  });
+
+  // pipes can not seek, so the size is unknown until end of file
+  std::string path = "/dev/fd/" + std::to_string(fds[0]);
+  auto data = skity::Data::MakeFromFileName(path.c_str(), true);
+
+  close(fds[0]);
+  writer.join();
+
+  ASSERT_TRUE(data);
+  EXPECT_TRUE(SameContent(*data, content));
+}
+#endif
+
+int main(int argc, const char** argv) {
+  testing::InitGoogleTest();
+  return RUN_ALL_TESTS();
+}
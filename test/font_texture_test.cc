@@ -1,68 +1,246 @@
 #include "src/render/text/font_texture.hpp"
 
+#include <gtest/gtest.h>
+
 #include <glm/glm.hpp>
-#include <iostream>
 #include <skity/text/utf.hpp>
 #include <string>
 #include <vector>
 
 #include "test_config.hpp"
 
-template <class T>
-void print_region(T const& region) {
-  std::cout << "region = {" << region.x << ", " << region.y << " ," << region.z
-            << ", " << region.w << "}" << std::endl;
-}
+// Every glyph below rastered at every size below is larger than half a page
+// in both directions, so it fills an atlas page on its own.
+static const char kBigGlyphs[] = "ABCDEGHKMNOPQRSTUVXYZ";
+static constexpr float kBigSizes[] = {224.f, 232.f, 240.f, 248.f};
 
-int main(int argc, const char** argv) {
-  auto typeface = skity::Typeface::MakeFromFile(TEST_BUILD_IN_FONT);
+struct BigGlyph {
+  skity::GlyphID id;
+  float font_size;
+};
 
-  skity::FontTexture font_texture{typeface.get()};
+static BigGlyph GetBigGlyph(size_t index) {
+  size_t glyph_count = sizeof(kBigGlyphs) - 1;
 
-  std::vector<skity::GlyphID> glyphs{};
+  return BigGlyph{static_cast<skity::GlyphID>(kBigGlyphs[index % glyph_count]),
+                  kBigSizes[index / glyph_count]};
+}
 
-  std::string str = "Hello World";
+static glm::ivec4 RequestBigGlyph(skity::FontTexture* font_texture,
+                                  size_t index) {
+  BigGlyph glyph = GetBigGlyph(index);
 
-  skity::UTF::UTF8ToCodePoint(str.c_str(), str.size(), glyphs);
+  return font_texture->GetGlyphRegion(glyph.id, glyph.font_size);
+}
 
-  std::vector<glm::ivec4> regions{};
+// pages of a 2048 x 2048 atlas
+static constexpr size_t kMaxPageCount = 64;
+
+// grows the atlas to its max size with one big glyph in every page, without
+// evicting any of them
+static void FillAtlas(skity::FontTexture* font_texture) {
+  size_t index = 0;
+  while (index < kMaxPageCount) {
+    glm::ivec4 region = RequestBigGlyph(font_texture, index);
+    if (region.x >= 0) {
+      index++;
+    } else {
+      font_texture->EndFrame();
+    }
+  }
 
-  float font_size = 14.f;
+  font_texture->EndFrame();
+}
 
-  for (auto id : glyphs) {
-    regions.emplace_back(font_texture.GetGlyphRegion(id, font_size));
+class FontTextureTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    typeface_ = skity::Typeface::MakeFromFile(TEST_BUILD_IN_FONT);
+    ASSERT_TRUE(typeface_);
   }
 
-  for (auto const& region : regions) {
-    print_region(region);
+  std::shared_ptr<skity::Typeface> typeface_;
+};
+
+TEST_F(FontTextureTest, small_text) {
+  skity::FontTexture font_texture{typeface_.get()};
+
+  std::vector<skity::GlyphID> glyphs{};
+  std::string str = "Hello World";
+  skity::UTF::UTF8ToCodePoint(str.c_str(), str.size(), glyphs);
+
+  for (float font_size : {14.f, 30.f}) {
+    for (auto id : glyphs) {
+      glm::ivec4 region = font_texture.GetGlyphRegion(id, font_size);
+      ASSERT_GE(region.x, 0);
+      ASSERT_GE(region.y, 0);
+
+      glm::vec2 uv_lt = font_texture.CalculateUV(region.x, region.y);
+      glm::vec2 uv_rb = font_texture.CalculateUV(region.x + region.z,
+                                                 region.y + region.w);
+      EXPECT_LE(uv_lt.x, uv_rb.x);
+      EXPECT_LE(uv_lt.y, uv_rb.y);
+      EXPECT_LE(uv_rb.x, 1.f);
+      EXPECT_LE(uv_rb.y, 1.f);
+    }
   }
 
-  std::vector<glm::vec4> regions_uv{};
-  for (auto const& region : regions) {
-    glm::vec4 uv = {
-        font_texture.CalculateUV(region.x, region.y),
-        font_texture.CalculateUV(region.x + region.z, region.y + region.w),
-    };
+  font_texture.EndFrame();
+
+  auto const& stats = font_texture.GetFrameStats();
+  EXPECT_EQ(stats.page_count, 4u);
+  EXPECT_EQ(stats.failed_glyphs, 0u);
+  EXPECT_EQ(stats.evicted_pages, 0u);
+  EXPECT_GT(stats.occupancy, 0.f);
+  EXPECT_LT(stats.occupancy, 1.f);
+}
+
+TEST_F(FontTextureTest, quantized_font_size) {
+  EXPECT_FLOAT_EQ(skity::FontTexture::QuantizeFontSize(200.f), 200.f);
+  EXPECT_FLOAT_EQ(skity::FontTexture::QuantizeFontSize(201.f), 200.f);
+  EXPECT_FLOAT_EQ(skity::FontTexture::QuantizeFontSize(205.f), 208.f);
+  EXPECT_FLOAT_EQ(skity::FontTexture::QuantizeFontSize(14.3f), 14.5f);
+  EXPECT_FLOAT_EQ(skity::FontTexture::QuantizeFontSize(0.f), 0.f);
+
+  skity::FontTexture font_texture{typeface_.get()};
+
+  glm::ivec4 region = font_texture.GetGlyphRegion('A', 200.f);
+  glm::ivec4 region2 = font_texture.GetGlyphRegion('A', 201.f);
+  EXPECT_EQ(region, region2);
+
+  font_texture.EndFrame();
+
+  auto const& stats = font_texture.GetFrameStats();
+  EXPECT_EQ(stats.glyph_count, 1u);
+  EXPECT_EQ(stats.upload_count, 1u);
+}
+
+TEST_F(FontTextureTest, grow_between_frames) {
+  skity::FontTexture font_texture{typeface_.get()};
+  ASSERT_EQ(font_texture.PageCount(), 4u);
 
-    regions_uv.emplace_back(uv);
+  for (size_t i = 0; i < 4; i++) {
+    EXPECT_GE(RequestBigGlyph(&font_texture, i).x, 0);
   }
 
-  std::cout << "------- UV -------" << std::endl;
+  // uv of glyphs in this frame depends on atlas size, growing waits for
+  // EndFrame
+  EXPECT_LT(RequestBigGlyph(&font_texture, 4).x, 0);
+  EXPECT_EQ(font_texture.Width(), 512u);
+
+  font_texture.EndFrame();
+
+  EXPECT_EQ(font_texture.Width(), 1024u);
+
+  auto const& stats = font_texture.GetFrameStats();
+  EXPECT_EQ(stats.page_count, 16u);
+  EXPECT_EQ(stats.glyph_count, 4u);
+  EXPECT_EQ(stats.failed_glyphs, 1u);
+  EXPECT_EQ(stats.evicted_pages, 0u);
+  // four glyphs and the whole old atlas after resize
+  EXPECT_EQ(stats.upload_count, 5u);
+
+  EXPECT_GE(RequestBigGlyph(&font_texture, 4).x, 0);
+}
+
+TEST_F(FontTextureTest, oversized_glyph) {
+  skity::FontTexture font_texture{typeface_.get()};
+
+  // larger than a page, drawn as path instead of growing the atlas
+  EXPECT_LT(font_texture.GetGlyphRegion('W', 400.f).x, 0);
+
+  font_texture.EndFrame();
+
+  EXPECT_EQ(font_texture.Width(), 512u);
+  EXPECT_EQ(font_texture.GetFrameStats().failed_glyphs, 1u);
+}
+
+TEST_F(FontTextureTest, evict_least_recently_used_page) {
+  skity::FontTexture font_texture{typeface_.get()};
 
-  for (auto const& uv : regions_uv) {
-    print_region(uv);
+  FillAtlas(&font_texture);
+  ASSERT_EQ(font_texture.Width(), 2048u);
+
+  uint32_t page_count = font_texture.PageCount();
+  ASSERT_EQ(page_count, kMaxPageCount);
+
+  for (size_t i = 0; i < page_count; i++) {
+    ASSERT_GE(RequestBigGlyph(&font_texture, i).x, 0);
+  }
+  font_texture.EndFrame();
+  ASSERT_EQ(font_texture.GetFrameStats().glyph_count, page_count);
+
+  glm::ivec4 region0 = RequestBigGlyph(&font_texture, 0);
+  glm::ivec4 region1 = RequestBigGlyph(&font_texture, 1);
+  uint32_t page0 = font_texture.PageOf(region0.x, region0.y);
+  uint32_t page1 = font_texture.PageOf(region1.x, region1.y);
+  ASSERT_NE(page0, page1);
+
+  // glyph 1 is used one frame after glyph 0
+  for (size_t i = 1; i < page_count; i++) {
+    RequestBigGlyph(&font_texture, i);
   }
+  font_texture.EndFrame();
 
-  std::vector<glm::ivec4> regions2 = {};
-  for (auto id : glyphs) {
-    regions2.emplace_back(font_texture.GetGlyphRegion(id, 30.f));
+  for (size_t i = 2; i < page_count; i++) {
+    RequestBigGlyph(&font_texture, i);
   }
+  font_texture.EndFrame();
+
+  glm::ivec4 region = RequestBigGlyph(&font_texture, page_count);
+  ASSERT_GE(region.x, 0);
+  EXPECT_EQ(font_texture.PageOf(region.x, region.y), page0);
+
+  // page of the glyph above is used in this frame, so page1 is the next
+  region = RequestBigGlyph(&font_texture, page_count + 1);
+  ASSERT_GE(region.x, 0);
+  EXPECT_EQ(font_texture.PageOf(region.x, region.y), page1);
+
+  font_texture.EndFrame();
+
+  auto const& stats = font_texture.GetFrameStats();
+  EXPECT_EQ(stats.evicted_pages, 2u);
+  EXPECT_EQ(stats.failed_glyphs, 0u);
+  EXPECT_EQ(stats.glyph_count, page_count);
+  // each eviction clears the page and uploads the new glyph
+  EXPECT_EQ(stats.upload_count, 4u);
+  EXPECT_EQ(stats.page_count, page_count);
+
+  // evicted glyph is rastered again
+  region = RequestBigGlyph(&font_texture, 0);
+  EXPECT_GE(region.x, 0);
+  font_texture.EndFrame();
+  EXPECT_EQ(font_texture.GetFrameStats().evicted_pages, 1u);
+}
+
+TEST_F(FontTextureTest, pages_of_current_frame_are_not_evicted) {
+  skity::FontTexture font_texture{typeface_.get()};
 
-  std::cout << "--------- big size ------------" << std::endl;
+  FillAtlas(&font_texture);
+  ASSERT_EQ(font_texture.GetFrameStats().evicted_pages, 0u);
 
-  for (auto const& reg : regions2) {
-    print_region(reg);
+  uint32_t page_count = font_texture.PageCount();
+  for (size_t i = 0; i < page_count; i++) {
+    ASSERT_GE(RequestBigGlyph(&font_texture, i).x, 0);
   }
 
-  return 0;
-}
\ No newline at end of file
+  // every page is used by this frame, the glyph falls back to path
+  EXPECT_LT(RequestBigGlyph(&font_texture, page_count).x, 0);
+
+  font_texture.EndFrame();
+
+  auto const& stats = font_texture.GetFrameStats();
+  EXPECT_EQ(stats.failed_glyphs, 1u);
+  EXPECT_EQ(stats.evicted_pages, 0u);
+  EXPECT_EQ(stats.glyph_count, page_count);
+  EXPECT_FLOAT_EQ(stats.occupancy,
+                  static_cast<float>(font_texture.Used()) / (2048.f * 2048.f));
+
+  // once the frame is finished the least recently used page can be reused
+  EXPECT_GE(RequestBigGlyph(&font_texture, page_count).x, 0);
+}
+
+int main(int argc, const char** argv) {
+  testing::InitGoogleTest();
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,295 @@
+#include "src/render/hw/hw_draw.hpp"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <skity/effect/mask_filter.hpp>
+#include <vector>
+
+#include "src/render/hw/hw_renderer.hpp"
+
+// shaders compute sigma as kernel size + 2, in texels of the render target
+static float BlurSigma(float radius, float scale) {
+  return (skity::PostProcessDraw::BlurKernelSize(radius, scale) + 2.f) / scale;
+}
+
+TEST(PostProcessDraw, full_resolution_kernel) {
+  EXPECT_FLOAT_EQ(skity::PostProcessDraw::BlurKernelSize(5.f, 1.f), 5.f);
+  EXPECT_FLOAT_EQ(BlurSigma(5.f, 1.f), 7.f);
+}
+
+TEST(PostProcessDraw, downsampled_kernel_matches_full_resolution) {
+  for (float radius : {9.f, 17.f, 40.f, 100.f, 300.f}) {
+    auto filter =
+        skity::MaskFilter::MakeBlur(skity::BlurStyle::kNormal, radius);
+    float scale = filter->blurScale();
+    ASSERT_LT(scale, 1.f);
+
+    // sigma in canvas pixels is the same as if the blur ran at full resolution
+    EXPECT_NEAR(BlurSigma(radius, scale), BlurSigma(radius, 1.f), 1e-3f);
+  }
+}
+
+namespace {
+
+// Renderer simulating stencil test and writes of a few pixels with GL
+// semantics. A draw range covers every pixel listed for its start index, a
+// pixel listed several times is covered by as many overlapping triangles.
+class StencilRecordRenderer : public skity::HWRenderer {
+ public:
+  explicit StencilRecordRenderer(size_t pixel_count)
+      : stencil(pixel_count), painted(pixel_count) {}
+
+  void SetCover(uint32_t start, std::vector<uint32_t> pixels) {
+    covers_[start] = std::move(pixels);
+  }
+
+  void Init() override {}
+  void Destroy() override {}
+  void Bind() override {}
+  void UnBind() override {}
+  void SetPipelineColorMode(skity::HWPipelineColorMode mode) override {}
+  void SetStrokeWidth(float width) override {}
+  void SetUniformColor(glm::vec4 const& color) override {}
+  void SetGradientBoundInfo(glm::vec4 const& info) override {}
+  void SetGradientCountInfo(int32_t color_count, int32_t pos_count) override {}
+  void SetGradientColors(std::vector<skity::Color4f> const& colors) override {}
+  void SetGradientPositions(std::vector<float> const& pos) override {}
+  void SetMeshFormat(skity::HWMeshFormat const& format) override {}
+  bool ReserveVertexBuffer(size_t data_size) override { return true; }
+  bool ReserveIndexBuffer(size_t data_size) override { return true; }
+  void UpdateVertexBuffer(void* data, size_t offset,
+                          size_t data_size) override {}
+  void UpdateIndexBuffer(void* data, size_t offset, size_t data_size) override {
+  }
+  void SetGlobalAlpha(float alpha) override {}
+  void EnableStencilTest() override { stencil_test_ = true; }
+  void DisableStencilTest() override { stencil_test_ = false; }
+  void EnableColorOutput() override { color_output_ = true; }
+  void DisableColorOutput() override { color_output_ = false; }
+  void UpdateStencilMask(uint8_t write_mask) override {
+    write_mask_ = write_mask;
+  }
+  void UpdateStencilOp(skity::HWStencilOp op) override { op_ = op; }
+  void UpdateStencilFunc(skity::HWStencilFunc func, uint32_t value,
+                         uint32_t compare_mask) override {
+    func_ = func;
+    reference_ = value;
+    compare_mask_ = compare_mask;
+  }
+  void EnableScissorTest(skity::Rect const& rect) override {}
+  void DisableScissorTest() override {}
+  void BindTexture(skity::HWTexture* texture, uint32_t slot) override {}
+  void BindRenderTarget(skity::HWRenderTarget* render_target) override {}
+  void UnBindRenderTarget(skity::HWRenderTarget* render_target) override {}
+
+  void DrawIndex(uint32_t start, uint32_t count) override {
+    for (uint32_t pixel : covers_[start]) {
+      Fragment(pixel);
+    }
+  }
+
+  std::vector<uint8_t> stencil;
+  std::vector<uint32_t> painted;
+
+ private:
+  bool StencilPass(uint8_t value) const {
+    uint32_t ref = reference_ & compare_mask_;
+    uint32_t val = value & compare_mask_;
+
+    switch (func_) {
+      case skity::HWStencilFunc::EQUAL:
+        return ref == val;
+      case skity::HWStencilFunc::NOT_EQUAL:
+        return ref != val;
+      case skity::HWStencilFunc::LESS:
+        return ref < val;
+      case skity::HWStencilFunc::GREAT:
+        return ref > val;
+      case skity::HWStencilFunc::LESS_OR_EQUAL:
+        return ref <= val;
+      case skity::HWStencilFunc::GREAT_OR_EQUAL:
+        return ref >= val;
+      case skity::HWStencilFunc::ALWAYS:
+        return true;
+    }
+
+    return true;
+  }
+
+  void Fragment(uint32_t pixel) {
+    uint8_t value = stencil[pixel];
+
+    if (stencil_test_) {
+      // failing fragments keep stencil value, same as GLRenderer
+      if (!StencilPass(value)) {
+        return;
+      }
+
+      uint8_t result = value;
+      if (op_ == skity::HWStencilOp::INCR_WRAP) {
+        result = static_cast<uint8_t>(value + 1);
+      } else if (op_ == skity::HWStencilOp::DECR_WRAP) {
+        result = static_cast<uint8_t>(value - 1);
+      } else if (op_ == skity::HWStencilOp::REPLACE) {
+        result = static_cast<uint8_t>(reference_);
+      }
+
+      stencil[pixel] = (value & ~write_mask_) | (result & write_mask_);
+    }
+
+    if (color_output_) {
+      painted[pixel]++;
+    }
+  }
+
+  std::map<uint32_t, std::vector<uint32_t>> covers_ = {};
+  bool stencil_test_ = false;
+  bool color_output_ = true;
+  uint8_t write_mask_ = 0xFF;
+  skity::HWStencilOp op_ = skity::HWStencilOp::KEEP;
+  skity::HWStencilFunc func_ = skity::HWStencilFunc::ALWAYS;
+  uint32_t reference_ = 0;
+  uint32_t compare_mask_ = 0xFF;
+};
+
+// draw ranges of the scene, pixel 0 is inside all clips, pixel 1 only inside
+// the first clip and pixel 2 outside all clips
+enum {
+  kOuterClip = 10,
+  kInnerClip = 20,
+  kClipBounds = 30,
+  kFillFront = 40,
+  kFillBack = 50,
+  kFillCover = 60,
+};
+
+std::vector<uint32_t> Repeat(std::vector<uint32_t> const& pixels,
+                             uint32_t times) {
+  std::vector<uint32_t> result;
+  for (uint32_t i = 0; i < times; i++) {
+    result.insert(result.end(), pixels.begin(), pixels.end());
+  }
+  return result;
+}
+
+void PushClip(StencilRecordRenderer* renderer, uint32_t clip_range,
+              uint32_t level) {
+  skity::HWDraw draw(renderer, level > 0, true);
+  draw.SetClipLevel(level);
+  draw.SetClipTargetLevel(level + 1);
+  draw.SetStencilRange({clip_range, 3}, {});
+  draw.SetColorRange({kClipBounds, 3});
+  draw.Draw();
+}
+
+void PopClips(StencilRecordRenderer* renderer, uint32_t level) {
+  skity::HWDraw draw(renderer, false, true);
+  draw.SetClipLevel(level);
+  draw.SetClipTargetLevel(0);
+  draw.SetColorRange({kClipBounds, 3});
+  draw.Draw();
+}
+
+void Fill(StencilRecordRenderer* renderer, uint32_t level, bool even_odd,
+          bool has_back) {
+  skity::HWDraw draw(renderer, level > 0);
+  draw.SetClipLevel(level);
+  draw.SetPipelineColorMode(skity::HWPipelineColorMode::kUniformColor);
+  draw.SetUniformColor({1.f, 0.f, 0.f, 1.f});
+  draw.SetEvenOddFill(even_odd);
+  draw.SetStencilRange({kFillFront, 3}, {kFillBack, has_back ? 3u : 0u});
+  draw.SetColorRange({kFillCover, 3});
+  draw.Draw();
+}
+
+// scene of two nested clips and a fill of contours stacked windings times
+// on all pixels
+StencilRecordRenderer MakeScene(uint32_t windings) {
+  StencilRecordRenderer renderer(3);
+  renderer.SetCover(kOuterClip, {0, 1});
+  renderer.SetCover(kInnerClip, {0});
+  renderer.SetCover(kClipBounds, {0, 1, 2});
+  renderer.SetCover(kFillFront, Repeat({0, 1, 2}, windings));
+  renderer.SetCover(kFillCover, {0, 1, 2});
+  return renderer;
+}
+
+}  // namespace
+
+TEST(HWDraw, overlapping_contours_under_nested_clip) {
+  for (uint32_t windings : {1u, 15u, 16u, 17u, 31u}) {
+    auto renderer = MakeScene(windings);
+
+    PushClip(&renderer, kOuterClip, 0);
+    PushClip(&renderer, kInnerClip, 1);
+    Fill(&renderer, 2, false, false);
+
+    EXPECT_EQ(renderer.painted, (std::vector<uint32_t>{1, 0, 0}))
+        << "windings " << windings;
+
+    // winding bits are cleared, clip levels are kept
+    EXPECT_EQ(renderer.stencil,
+              (std::vector<uint8_t>{2 << skity::HWDraw::CLIP_LEVEL_SHIFT,
+                                    1 << skity::HWDraw::CLIP_LEVEL_SHIFT, 0}));
+
+    PopClips(&renderer, 2);
+    EXPECT_EQ(renderer.stencil, (std::vector<uint8_t>{0, 0, 0}));
+  }
+}
+
+TEST(HWDraw, cancelled_windings_under_nested_clip) {
+  auto renderer = MakeScene(16);
+  renderer.SetCover(kFillBack, Repeat({0, 1, 2}, 16));
+
+  PushClip(&renderer, kOuterClip, 0);
+  PushClip(&renderer, kInnerClip, 1);
+  Fill(&renderer, 2, false, true);
+
+  EXPECT_EQ(renderer.painted, (std::vector<uint32_t>{0, 0, 0}));
+}
+
+TEST(HWDraw, even_odd_windings_under_nested_clip) {
+  for (uint32_t windings : {16u, 17u}) {
+    auto renderer = MakeScene(windings);
+
+    PushClip(&renderer, kOuterClip, 0);
+    PushClip(&renderer, kInnerClip, 1);
+    Fill(&renderer, 2, true, false);
+
+    EXPECT_EQ(renderer.painted[0], windings % 2);
+    EXPECT_EQ(renderer.painted[1], 0u);
+    EXPECT_EQ(renderer.painted[2], 0u);
+    EXPECT_EQ(renderer.stencil[0], 2 << skity::HWDraw::CLIP_LEVEL_SHIFT);
+  }
+}
+
+TEST(HWDraw, overlapping_contours_at_max_clip_level) {
+  auto renderer = MakeScene(31);
+
+  for (uint32_t level = 0; level < skity::HWDraw::MAX_CLIP_LEVEL; level++) {
+    PushClip(&renderer, kInnerClip, level);
+  }
+  Fill(&renderer, skity::HWDraw::MAX_CLIP_LEVEL, false, false);
+
+  EXPECT_EQ(renderer.painted, (std::vector<uint32_t>{1, 0, 0}));
+  EXPECT_EQ(renderer.stencil[0], skity::HWDraw::MAX_CLIP_LEVEL
+                                     << skity::HWDraw::CLIP_LEVEL_SHIFT);
+}
+
+TEST(HWDraw, overlapping_contours_without_clip) {
+  for (uint32_t windings : {16u, 32u, 200u}) {
+    auto renderer = MakeScene(windings);
+
+    Fill(&renderer, 0, false, false);
+
+    EXPECT_EQ(renderer.painted, (std::vector<uint32_t>{1, 1, 1}))
+        << "windings " << windings;
+    EXPECT_EQ(renderer.stencil, (std::vector<uint8_t>{0, 0, 0}));
+  }
+}
+
+int main(int argc, const char** argv) {
+  testing::InitGoogleTest();
+  return RUN_ALL_TESTS();
+}
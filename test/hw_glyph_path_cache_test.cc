@@ -0,0 +1,68 @@
+#include "src/render/hw/hw_glyph_path_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <skity/text/typeface.hpp>
+
+#include "test_config.hpp"
+
+static constexpr float kFontSize = 40.f;
+
+static skity::GlyphInfo MakeGlyph(skity::Rect const& bounds) {
+  skity::GlyphInfo info{};
+  info.id = 36;
+  info.path.addRect(bounds);
+  info.path_font_size = kFontSize;
+  return info;
+}
+
+// shared pointer to typeface with its own lifetime, so a released typeface and
+// a new one at the same address can be simulated deterministically
+static std::shared_ptr<skity::Typeface> MakeAlias(
+    std::shared_ptr<skity::Typeface> const& typeface) {
+  return std::shared_ptr<skity::Typeface>(std::make_shared<int>(0),
+                                          typeface.get());
+}
+
+TEST(HWGlyphPathCache, released_typeface_never_hits) {
+  auto typeface = skity::Typeface::MakeFromFile(TEST_BUILD_IN_FONT);
+  ASSERT_TRUE(typeface);
+
+  skity::HWGlyphPathCache cache;
+
+  skity::Rect first_bounds = skity::Rect::MakeXYWH(0, 0, 10, 20);
+  auto first = MakeAlias(typeface);
+  EXPECT_TRUE(cache.QueryPath(first, MakeGlyph(first_bounds), kFontSize)
+                  .getBounds() == first_bounds);
+  first.reset();
+
+  // same address, but the typeface the outline came from is gone
+  skity::Rect second_bounds = skity::Rect::MakeXYWH(5, 5, 30, 30);
+  auto second = MakeAlias(typeface);
+  EXPECT_TRUE(cache.QueryPath(second, MakeGlyph(second_bounds), kFontSize)
+                  .getBounds() == second_bounds);
+
+  // a live typeface keeps its outline across frames
+  cache.EndFrame();
+  EXPECT_TRUE(cache.QueryPath(second, MakeGlyph(first_bounds), kFontSize)
+                  .getBounds() == second_bounds);
+}
+
+TEST(HWGlyphPathCache, load_outline_from_typeface) {
+  auto typeface = skity::Typeface::MakeFromFile(TEST_BUILD_IN_FONT);
+  ASSERT_TRUE(typeface);
+
+  skity::HWGlyphPathCache cache;
+  skity::GlyphInfo info = typeface->getGlyphInfo(36, kFontSize);
+
+  skity::Path const& path = cache.QueryPath(typeface, info, kFontSize);
+  EXPECT_FALSE(path.isEmpty());
+  EXPECT_TRUE(
+      path.getBounds() ==
+      typeface->getGlyphInfo(36, kFontSize, true).path.getBounds());
+}
+
+int main(int argc, const char** argv) {
+  testing::InitGoogleTest();
+  return RUN_ALL_TESTS();
+}
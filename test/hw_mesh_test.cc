@@ -0,0 +1,129 @@
+#include "src/render/hw/hw_mesh.hpp"
+
+#include <gtest/gtest.h>
+
+#include "src/render/hw/hw_path_raster.hpp"
+
+// canvas scale of the frame, geometry is recorded in local space
+static constexpr float kScale = 3.f;
+
+static skity::Path MakeJaggedPath(bool cubic) {
+  skity::Path path;
+  path.moveTo(123.37f, 456.91f);
+  path.lineTo(301.13f, 87.29f);
+  path.lineTo(517.71f, 433.07f);
+  path.quadTo(611.3f, 250.9f, 713.17f, 489.53f);
+  if (cubic) {
+    path.cubicTo(800.1f, 100.7f, 900.3f, 600.1f, 1013.9f, 377.7f);
+  }
+  return path;
+}
+
+// records the kind of geometry a typical frame holds into mesh
+static void RecordFrame(skity::HWMesh* mesh, bool use_gs) {
+  skity::Paint paint;
+  paint.setStyle(skity::Paint::kStroke_Style);
+  paint.setStrokeWidth(7.3f);
+  // round joins drawn by geometry shader, including the ones inside flattened
+  // cubics, store circle centers which only fit half floats close to the
+  // origin, see round_join_centers
+  paint.setStrokeJoin(use_gs ? skity::Paint::kMiter_Join
+                             : skity::Paint::kRound_Join);
+
+  skity::HWPathRaster stroke{mesh, paint, use_gs, kScale};
+  stroke.SetCenterTolerance(1.f / (16.f * kScale));
+  stroke.StrokePath(MakeJaggedPath(!use_gs));
+  stroke.FlushRaster();
+
+  paint.setStyle(skity::Paint::kFill_Style);
+  skity::HWPathRaster fill{mesh, paint, use_gs, kScale};
+  fill.FillPath(MakeJaggedPath(true));
+  fill.FlushRaster();
+
+  // analytic rrect fill and stroke, u and v are in units of corner radii
+  skity::RRect rrect;
+  rrect.setRectXY(skity::Rect::MakeXYWH(10.3f, 20.7f, 317.1f, 133.9f), 23.3f,
+                  23.3f);
+  for (auto style : {skity::Paint::kFill_Style, skity::Paint::kStroke_Style}) {
+    paint.setStyle(style);
+    skity::HWGeometryRaster rect{mesh, paint, use_gs};
+    rect.RasterAnalyticRRect(rrect, 1.f / kScale);
+    rect.FlushRaster();
+  }
+
+  // glyph quads sample a power of two atlas
+  skity::HWGeometryRaster text{mesh, paint, use_gs};
+  for (uint32_t i = 0; i < 64; i++) {
+    float x = 11.3f + i * 9.7f;
+    text.FillTextRect({x, 500.1f, x + 8.4f, 512.9f},
+                      {(i * 7.f) / 512.f, 13.f / 512.f},
+                      {(i * 7.f + 6.f) / 512.f, 25.f / 512.f});
+  }
+  text.FlushRaster();
+}
+
+TEST(HWMesh, frame_fits_compact_vertex) {
+  for (bool use_gs : {false, true}) {
+    skity::HWMesh mesh;
+    RecordFrame(&mesh, use_gs);
+
+    EXPECT_GT(mesh.VertexBase(), 0u);
+    EXPECT_TRUE(mesh.IsCompact()) << "use_gs: " << use_gs;
+  }
+}
+
+TEST(HWMesh, quantize_within_tolerance) {
+  skity::HWMesh mesh;
+
+  // type tags are exact integers, 0.5 and 1 are exact in half float
+  mesh.AppendVertex(1.f, 2.f, skity::HW_VERTEX_TYPE_QUAD_IN, 0.5f, 1.f);
+  mesh.AppendVertex(1.f, 2.f, skity::HW_VERTEX_TYPE_RRECT + 1023.f);
+  EXPECT_TRUE(mesh.IsCompact());
+
+  // circle center 0.2 pixel away from the nearest half float
+  mesh.AppendVertex(1.f, 2.f, skity::HW_VERTEX_TYPE_CIRCLE, 1000.2f, 20.f,
+                    0.25f);
+  EXPECT_TRUE(mesh.IsCompact());
+
+  mesh.AppendVertex(1.f, 2.f, skity::HW_VERTEX_TYPE_CIRCLE, 1000.2f, 20.f,
+                    0.1f);
+  EXPECT_FALSE(mesh.IsCompact());
+
+  // values out of half float range never fit
+  mesh.ResetMesh();
+  mesh.AppendVertex(1.f, 2.f, skity::HW_VERTEX_TYPE_CIRCLE, 70000.f, 0.f,
+                    1.f);
+  EXPECT_FALSE(mesh.IsCompact());
+
+  mesh.ResetMesh();
+  EXPECT_TRUE(mesh.IsCompact());
+}
+
+TEST(HWMesh, round_join_centers) {
+  skity::Paint paint;
+  paint.setStyle(skity::Paint::kStroke_Style);
+  paint.setStrokeWidth(4.f);
+  paint.setStrokeJoin(skity::Paint::kRound_Join);
+
+  skity::HWMesh mesh;
+  skity::HWPathRaster raster{&mesh, paint, true};
+  raster.SetCenterTolerance(1.f / 16.f);
+
+  for (float offset : {0.f, 2000.f}) {
+    skity::Path path;
+    path.moveTo(offset + 10.3f, offset + 20.7f);
+    path.lineTo(offset + 60.1f, offset + 90.3f);
+    path.lineTo(offset + 110.9f, offset + 30.1f);
+
+    raster.StrokePath(path);
+    raster.FlushRaster();
+
+    // a sixteenth of a pixel can not be kept far from the origin
+    EXPECT_EQ(mesh.IsCompact(), offset == 0.f);
+  }
+}
+
+int main(int argc, const char** argv) {
+  testing::InitGoogleTest();
+  return RUN_ALL_TESTS();
+}
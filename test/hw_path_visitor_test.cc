@@ -0,0 +1,71 @@
+#include "src/render/hw/hw_path_visitor.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+// pixels allowed between a curve and its flattened polyline
+static constexpr float kTolerance = 0.25f;
+
+class RecordPathVisitor : public skity::HWPathVisitor {
+ public:
+  RecordPathVisitor(skity::Paint const& paint, float scale)
+      : skity::HWPathVisitor(nullptr, paint, false, scale) {}
+  ~RecordPathVisitor() override = default;
+
+  std::vector<glm::vec2> const& Points() const { return points_; }
+
+ protected:
+  void OnBeginPath() override {}
+
+  void OnEndPath() override {}
+
+  void OnMoveTo(glm::vec2 const& p) override { points_.emplace_back(p); }
+
+  void OnLineTo(glm::vec2 const& p1, glm::vec2 const& p2) override {
+    points_.emplace_back(p2);
+  }
+
+  void OnQuadTo(glm::vec2 const& p1, glm::vec2 const& p2,
+                glm::vec2 const& p3) override {}
+
+ private:
+  std::vector<glm::vec2> points_;
+};
+
+// max distance in pixels between the flattened circle and the real one
+static float FlattenCircleError(float radius, float scale) {
+  skity::Path path;
+  path.addCircle(0.f, 0.f, radius);
+
+  skity::Paint paint;
+  RecordPathVisitor visitor{paint, scale};
+  visitor.VisitPath(path, true);
+
+  auto const& pts = visitor.Points();
+  EXPECT_GT(pts.size(), 2u);
+
+  float error = 0.f;
+  for (size_t i = 1; i < pts.size(); i++) {
+    error = std::max(error, std::abs(glm::length(pts[i]) - radius));
+    // chord sags most in the middle
+    glm::vec2 mid = (pts[i - 1] + pts[i]) * 0.5f;
+    error = std::max(error, std::abs(glm::length(mid) - radius));
+  }
+
+  return error * scale;
+}
+
+TEST(HWPathVisitor, small_circle_within_tolerance) {
+  EXPECT_LE(FlattenCircleError(10.f, 1.f), kTolerance);
+}
+
+TEST(HWPathVisitor, scaled_circle_within_tolerance) {
+  EXPECT_LE(FlattenCircleError(1.f, 1000.f), kTolerance);
+  EXPECT_LE(FlattenCircleError(500.f, 4.f), kTolerance);
+}
+
+int main(int argc, const char** argv) {
+  testing::InitGoogleTest();
+  return RUN_ALL_TESTS();
+}
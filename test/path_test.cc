@@ -631,6 +631,81 @@ TEST(path, test_range_iter) {
   EXPECT_TRUE(iter == iterate.end());
 }
 
+TEST(Path, test_generation_id) {
+  skity::Path path;
+  uint32_t empty_id = path.getGenerationID();
+  EXPECT_NE(empty_id, 0u);
+  EXPECT_EQ(path.getGenerationID(), empty_id);
+
+  path.moveTo(0, 0);
+  path.lineTo(10, 0);
+  path.lineTo(10, 10);
+  uint32_t id = path.getGenerationID();
+  EXPECT_NE(id, empty_id);
+
+  skity::Path copy = path;
+  EXPECT_EQ(copy.getGenerationID(), id);
+
+  // fill type is not part of geometry
+  copy.setFillType(skity::Path::PathFillType::kEvenOdd);
+  EXPECT_EQ(copy.getGenerationID(), id);
+
+  copy.close();
+  EXPECT_NE(copy.getGenerationID(), id);
+  EXPECT_EQ(path.getGenerationID(), id);
+
+  path.setLastPt(20, 20);
+  EXPECT_NE(path.getGenerationID(), id);
+
+  skity::Path other;
+  other.addPath(path);
+  EXPECT_NE(other.getGenerationID(), path.getGenerationID());
+
+  uint32_t reset_id = path.getGenerationID();
+  path.reset();
+  EXPECT_NE(path.getGenerationID(), reset_id);
+}
+
+TEST(Path, test_convexity) {
+  using ConvexityType = skity::Path::ConvexityType;
+
+  skity::Path triangle;
+  triangle.moveTo(0, 0);
+  triangle.lineTo(10, 0);
+  triangle.lineTo(5, 10);
+  triangle.close();
+  EXPECT_EQ(triangle.getConvexityType(), ConvexityType::kConvex);
+
+  // cached result is dropped on edit
+  triangle.lineTo(5, 2);
+  triangle.lineTo(0, 10);
+  EXPECT_EQ(triangle.getConvexityType(), ConvexityType::kConcave);
+
+  skity::Path oval;
+  oval.addOval(skity::Rect::MakeLTRB(0, 0, 20, 10));
+  EXPECT_EQ(oval.getConvexityType(), ConvexityType::kConvex);
+
+  skity::Path star;
+  star.moveTo(50, 0);
+  star.lineTo(79, 90);
+  star.lineTo(2, 35);
+  star.lineTo(98, 35);
+  star.lineTo(21, 90);
+  star.close();
+  EXPECT_EQ(star.getConvexityType(), ConvexityType::kConcave);
+
+  skity::Path two_rects;
+  two_rects.addRect(skity::Rect::MakeLTRB(0, 0, 10, 10));
+  two_rects.addRect(skity::Rect::MakeLTRB(20, 0, 30, 10));
+  EXPECT_EQ(two_rects.getConvexityType(), ConvexityType::kConcave);
+
+  skity::Path user_set;
+  user_set.moveTo(0, 0);
+  user_set.lineTo(10, 0);
+  user_set.setConvexityType(ConvexityType::kConcave);
+  EXPECT_EQ(user_set.getConvexityType(), ConvexityType::kConcave);
+}
+
 int main(int argc, const char **argv) {
   testing::InitGoogleTest();
   return RUN_ALL_TESTS();
@@ -0,0 +1,104 @@
+#include "src/render/sw/sw_blitter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+static uint32_t RefDiv255(uint32_t x) {
+  return (x * 2 + 255) / (255 * 2);
+}
+
+static uint32_t RefScale(uint32_t c, uint32_t scale) {
+  uint32_t ret = 0;
+  for (uint32_t i = 0; i < 32; i += 8) {
+    ret |= RefDiv255(((c >> i) & 0xFF) * scale) << i;
+  }
+  return ret;
+}
+
+static uint32_t RefBlend(uint32_t src, uint32_t dst, uint32_t coverage) {
+  src = RefScale(src, coverage);
+  return src + RefScale(dst, 255 - (src >> 24));
+}
+
+// random premultiplied color
+static uint32_t RandomPremul(std::mt19937& rng) {
+  uint32_t a = rng() % 256;
+  if (rng() % 4 == 0) {
+    a = (rng() % 2) ? 255 : 0;
+  }
+
+  uint32_t r = a ? rng() % (a + 1) : 0;
+  uint32_t g = a ? rng() % (a + 1) : 0;
+  uint32_t b = a ? rng() % (a + 1) : 0;
+
+  return skity::ColorSetARGB(a, r, g, b);
+}
+
+TEST(SWBlitter, BlitSolid) {
+  std::mt19937 rng(1);
+  std::vector<uint8_t> coverages = {0, 1, 77, 128, 254, 255};
+
+  for (int32_t count = 0; count < 40; count++) {
+    for (auto coverage : coverages) {
+      uint32_t color = RandomPremul(rng);
+
+      std::vector<uint32_t> dst(count + 2);
+      for (auto& p : dst) {
+        p = RandomPremul(rng);
+      }
+      std::vector<uint32_t> expect = dst;
+      for (int32_t i = 1; i <= count; i++) {
+        expect[i] = RefBlend(color, expect[i], coverage);
+      }
+
+      skity::SWBlitter::BlitSolid(dst.data() + 1, color, coverage, count);
+
+      EXPECT_EQ(dst, expect) << "count: " << count << " coverage: "
+                             << (int)coverage << " isa "
+                             << skity::SWBlitter::ISAName();
+    }
+  }
+}
+
+TEST(SWBlitter, BlitRow) {
+  std::mt19937 rng(2);
+  std::vector<uint8_t> coverages = {0, 1, 77, 128, 254, 255};
+
+  for (int32_t count = 0; count < 40; count++) {
+    for (auto coverage : coverages) {
+      std::vector<uint32_t> src(count);
+      for (auto& p : src) {
+        p = RandomPremul(rng);
+      }
+
+      std::vector<uint32_t> dst(count + 2);
+      for (auto& p : dst) {
+        p = RandomPremul(rng);
+      }
+      std::vector<uint32_t> expect = dst;
+      for (int32_t i = 1; i <= count; i++) {
+        expect[i] = RefBlend(src[i - 1], expect[i], coverage);
+      }
+
+      skity::SWBlitter::BlitRow(dst.data() + 1, src.data(), coverage, count);
+
+      EXPECT_EQ(dst, expect) << "count: " << count << " coverage: "
+                             << (int)coverage << " isa "
+                             << skity::SWBlitter::ISAName();
+    }
+  }
+}
+
+TEST(SWBlitter, PremulColor) {
+  EXPECT_EQ(skity::SWBlitter::PremulColor({1.f, 1.f, 1.f, 1.f}), 0xFFFFFFFF);
+  EXPECT_EQ(skity::SWBlitter::PremulColor({1.f, 0.f, 0.f, 0.5f}),
+            skity::ColorSetARGB(128, 128, 0, 0));
+  EXPECT_EQ(skity::SWBlitter::PremulColor({1.f, 1.f, 1.f, 0.f}), 0u);
+}
+
+int main(int argc, const char** argv) {
+  testing::InitGoogleTest();
+  return RUN_ALL_TESTS();
+}
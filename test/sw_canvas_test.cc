@@ -105,6 +105,7 @@ class SWCanvasTest : public test::TestApp {
     auto canvas = skity::Canvas::MakeSoftwareCanvas(&bitmap);
 
     DrawCanvas(canvas.get());
+    canvas->flush();
 
     texture_ = test::create_texture(bitmap.getPixelAddr(), bitmap.width(),
                                     bitmap.height());
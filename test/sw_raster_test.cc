@@ -0,0 +1,43 @@
+#include "src/render/sw/sw_raster.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+// rows of a large circle need to be covered within a fraction of a pixel at
+// both ends, faceted arcs shrink them by several pixels
+TEST(SWRaster, large_circle_row_coverage) {
+  float radius = 1000.f;
+  float center = 1024.f;
+
+  skity::Path path;
+  path.addCircle(center, center, radius);
+
+  skity::SWRaster raster;
+  raster.RastePath(path);
+
+  int32_t top = static_cast<int32_t>(center - radius * 0.9f);
+  int32_t bottom = static_cast<int32_t>(center + radius * 0.9f);
+  std::vector<float> coverage(bottom - top, 0.f);
+  for (auto const& span : raster.CurrentSpans()) {
+    if (span.y < top || span.y >= bottom) {
+      continue;
+    }
+    coverage[span.y - top] += span.len * span.cover / 255.f;
+  }
+
+  float max_error = 0.f;
+  for (int32_t y = top; y < bottom; y++) {
+    float dy = y + 0.5f - center;
+    float expect = 2.f * std::sqrt(radius * radius - dy * dy);
+    max_error = std::max(max_error, std::abs(coverage[y - top] - expect));
+  }
+
+  EXPECT_LE(max_error, 0.5f);
+}
+
+int main(int argc, const char** argv) {
+  testing::InitGoogleTest();
+  return RUN_ALL_TESTS();
+}
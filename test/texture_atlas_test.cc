@@ -1,27 +1,67 @@
 #include "src/render/texture_atlas.hpp"
 
-#include <iostream>
+#include <gtest/gtest.h>
 
-void print_region(glm::ivec4 const& region) {
-  std::cout << "region = {" << region.x << ", " << region.y << " ," << region.z
-            << ", " << region.w << "}" << std::endl;
-}
-
-int main(int argc, const char** argv) {
+TEST(TextureAtlas, resize_single_page) {
   skity::TextureAtlas texture_atlas{30, 30, 4};
 
   auto region = texture_atlas.AllocateRegion(20, 20);
-  print_region(region);
+  EXPECT_GE(region.x, 0);
+  EXPECT_GE(region.y, 0);
 
   auto region2 = texture_atlas.AllocateRegion(20, 15);
-  print_region(region2);
+  EXPECT_LT(region2.y, 0);
 
-  if (region2.y < 0) {
-    texture_atlas.Resize(60, 60);
-  }
+  texture_atlas.Resize(60, 60);
 
   region2 = texture_atlas.AllocateRegion(20, 15);
-  print_region(region2);
+  EXPECT_GE(region2.x, 0);
+  EXPECT_GE(region2.y, 0);
+  EXPECT_EQ(texture_atlas.PageCount(), 1u);
+}
+
+TEST(TextureAtlas, pages_pack_independently) {
+  // 2 x 2 pages
+  skity::TextureAtlas paged_atlas{64, 64, 1, 32};
+  ASSERT_EQ(paged_atlas.PageCount(), 4u);
 
-  return 0;
-}
\ No newline at end of file
+  auto region = paged_atlas.AllocateRegion(3, 20, 20);
+  ASSERT_GE(region.x, 0);
+  EXPECT_EQ(paged_atlas.PageOf(region.x, region.y), 3u);
+  EXPECT_GE(region.x, 32);
+  EXPECT_GE(region.y, 32);
+  EXPECT_EQ(paged_atlas.PageUsed(3), 400u);
+  EXPECT_EQ(paged_atlas.Used(), 400u);
+
+  // page 3 is too full, other pages are untouched
+  EXPECT_LT(paged_atlas.AllocateRegion(3, 30, 30).x, 0);
+  auto other = paged_atlas.AllocateRegion(30, 30);
+  ASSERT_GE(other.x, 0);
+  EXPECT_EQ(paged_atlas.PageOf(other.x, other.y), 0u);
+
+  paged_atlas.ClearPage(3);
+  EXPECT_EQ(paged_atlas.PageUsed(3), 0u);
+  EXPECT_EQ(paged_atlas.Used(), 900u);
+
+  region = paged_atlas.AllocateRegion(3, 30, 30);
+  ASSERT_GE(region.x, 0);
+  EXPECT_EQ(paged_atlas.PageOf(region.x, region.y), 3u);
+}
+
+TEST(TextureAtlas, resize_keeps_page_index) {
+  skity::TextureAtlas paged_atlas{64, 64, 1, 32};
+
+  auto region = paged_atlas.AllocateRegion(1, 20, 20);
+  ASSERT_GE(region.x, 0);
+
+  paged_atlas.Resize(128, 128);
+
+  EXPECT_EQ(paged_atlas.PageCount(), 16u);
+  EXPECT_EQ(paged_atlas.PageOf(region.x, region.y), 1u);
+  EXPECT_EQ(paged_atlas.PageUsed(1), 400u);
+}
+
+int main(int argc, const char** argv) {
+  testing::InitGoogleTest();
+  return RUN_ALL_TESTS();
+}